@@ -107,16 +107,69 @@ using namespace Async;
  *
  ****************************************************************************/
 
-AudioContainerOpus::AudioContainerOpus(void)
+unsigned AudioContainerOpus::packetSamples(const void *data, int len)
 {
-  m_enc = AudioEncoder::create("OPUS");
-  assert(m_enc != 0);
-  std::ostringstream ss;
-  ss << FRAME_SIZE;
-  m_enc->setOption("FRAME_SIZE", ss.str());
-  setHandler(m_enc);
-  m_enc->writeEncodedSamples.connect(
-      sigc::mem_fun(*this, &AudioContainerOpus::onWriteEncodedSamples));
+  if (len < 1)
+  {
+    return 0;
+  }
+  const unsigned char *p = reinterpret_cast<const unsigned char*>(data);
+  unsigned config = p[0] >> 3;
+  unsigned frame_size;  // In units of 1/8 ms, i.e. six samples at 48kHz
+  if (config < 12)                            // SILK-only
+  {
+    static const unsigned silk_sizes[] = { 80, 160, 320, 480 };
+    frame_size = silk_sizes[config & 3];
+  }
+  else if (config < 16)                       // Hybrid
+  {
+    frame_size = (config & 1) ? 160 : 80;
+  }
+  else                                        // CELT-only
+  {
+    frame_size = 20 << (config & 3);
+  }
+  unsigned frames;
+  switch (p[0] & 3)
+  {
+    case 0:
+      frames = 1;
+      break;
+    case 1:
+    case 2:
+      frames = 2;
+      break;
+    default:
+      if (len < 2)
+      {
+        return 0;
+      }
+      frames = p[1] & 0x3f;
+      break;
+  }
+  return frames * frame_size * 6;
+} /* AudioContainerOpus::packetSamples */
+
+
+AudioContainerOpus::AudioContainerOpus(bool use_encoder)
+  : m_enc(0),
+    m_comments({
+      "TITLE=SvxLink Audio Stream",
+      "DESCRIPTION=A SvxLink audio stream",
+      "GENRE=Ham Radio"
+    })
+{
+  if (use_encoder)
+  {
+    m_enc = AudioEncoder::create("OPUS");
+    assert(m_enc != 0);
+    std::ostringstream ss;
+    ss << FRAME_SIZE;
+    m_enc->setOption("FRAME_SIZE", ss.str());
+    setHandler(m_enc);
+    m_enc->writeEncodedSamples.connect(
+        sigc::mem_fun(*this, &AudioContainerOpus::onWriteEncodedSamples));
+  }
 
   //int ret = ogg_stream_init(&m_ogg_stream, m_ogg_serial++);
   int ret = ogg_stream_init(&m_ogg_stream, 1);
@@ -137,7 +190,13 @@ AudioContainerOpus::~AudioContainerOpus(void)
 
 void AudioContainerOpus::endStream(void)
 {
-  m_enc->flushSamples();
+  if (m_enc != 0)
+  {
+    m_enc->flushSamples();
+  }
+
+    // Write any packets that have not yet filled up a page
+  flushPages();
 
     // Assemble nil Ogg page
   oggpack_buffer oggbuf;
@@ -167,6 +226,35 @@ void AudioContainerOpus::endStream(void)
 } /* AudioContainerOpus::endStream */
 
 
+void AudioContainerOpus::setComments(const std::vector<std::string>& comments)
+{
+  m_comments = comments;
+  ogg_stream_reset(&m_ogg_stream);
+  m_packet = ogg_packet{0};
+  m_pending_packets = 0;
+  writeOggOpusHeader();
+} /* AudioContainerOpus::setComments */
+
+
+void AudioContainerOpus::writePacket(const void *data, int len)
+{
+  addPacket(data, len, packetSamples(data, len));
+} /* AudioContainerOpus::writePacket */
+
+
+void AudioContainerOpus::flushPages(void)
+{
+  ogg_page page;
+  while (ogg_stream_flush(&m_ogg_stream, &page) != 0)
+  {
+    m_block.clear();
+    writePage(page, m_block);
+    writeBlock(m_block.data(), m_block.size());
+  }
+  m_pending_packets = 0;
+} /* AudioContainerOpus::flushPages */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -186,6 +274,12 @@ void AudioContainerOpus::onWriteEncodedSamples(const void *data, int len)
   //std::cout << "### AudioContainerOpus::onWriteEncodedSamples: len="
   //          << len << std::endl;
 
+  addPacket(data, len, 48000 * FRAME_SIZE / 1000);
+} /* AudioContainerOpus::onWriteEncodedSamples */
+
+
+void AudioContainerOpus::addPacket(const void *data, int len, unsigned samples)
+{
   //if (m_packet.packet == nullptr)
   //{
   //  int ret = ogg_stream_init(&m_ogg_stream, m_ogg_serial++);
@@ -210,7 +304,7 @@ void AudioContainerOpus::onWriteEncodedSamples(const void *data, int len)
   //m_packet.e_o_s = 0;
   if (len > 0)
   {
-    m_packet.granulepos += 48000 * FRAME_SIZE / 1000;
+    m_packet.granulepos += samples;
   }
   m_packet.packetno += 1;
 
@@ -247,7 +341,7 @@ void AudioContainerOpus::onWriteEncodedSamples(const void *data, int len)
   {
     printf("### Ogg stream error\n");
   }
-} /* AudioContainerOpus::onWriteEncodedSamples */
+} /* AudioContainerOpus::addPacket */
 
 
 void AudioContainerOpus::oggpackWriteString(oggpack_buffer* oggbuf,
@@ -267,12 +361,12 @@ void AudioContainerOpus::oggpackWriteString(oggpack_buffer* oggbuf,
 
 
 void AudioContainerOpus::oggpackWriteCommentList(oggpack_buffer* oggbuf,
-    const std::vector<const char*> &comments)
+    const std::vector<std::string> &comments)
 {
   oggpack_write(oggbuf, comments.size(), 32); // User Comment List Length
   for (auto& comment : comments)
   {
-    oggpackWriteString(oggbuf, comment);
+    oggpackWriteString(oggbuf, comment.c_str());
   }
 } /* AudioContainerOpus::oggpackWriteCommentList */
 
@@ -345,14 +439,7 @@ bool AudioContainerOpus::writeOggOpusHeader(void)
   oggpack_writeinit(&oggbuf);
   oggpackWriteString(&oggbuf, "OpusTags", 0); // Magic Signature
   oggpackWriteString(&oggbuf, "SvxLink");     // Vendor String
-  oggpackWriteCommentList(&oggbuf, {          // User Comment List
-      //"R128_TRACK_GAIN=1536",
-      //"R128_ALBUM_GAIN=1536",
-      "TITLE=SvxLink Audio Stream",
-      "DESCRIPTION=A SvxLink audio stream",
-      //"DATE=2020-02-07",
-      "GENRE=Ham Radio"
-      });
+  oggpackWriteCommentList(&oggbuf, m_comments); // User Comment List
 
     // Put Opus Comment Header in an Ogg packet and add it to the stream
   oggpkt.packet = oggpack_get_buffer(&oggbuf);
@@ -40,6 +40,7 @@ An example of how to use the Async::AudioContainer class
 
 #include <ogg/ogg.h>
 #include <vector>
+#include <string>
 #include <cstring>
 
 
@@ -120,6 +121,11 @@ containers are normally created using a factory, via the
 Async::createAudioContainer function, but it is possible to create an audio
 container directly as well.
 
+The container can also be used to store audio that already is Opus encoded,
+e.g. audio received from the network. Create the container without an
+encoder and use the writePacket function to add the encoded packets. The
+packets are then just wrapped in Ogg pages, without any transcoding.
+
 \example AsyncAudioContainer_demo.cpp
 */
 class AudioContainerOpus : public AudioContainer
@@ -128,10 +134,27 @@ class AudioContainerOpus : public AudioContainer
       /// The name of this class when used by the object factory
     static constexpr const char *OBJNAME = "opus";
 
+    /**
+     * @brief   Get the number of samples in an Opus packet
+     * @param   data The encoded Opus packet
+     * @param   len The length of the packet
+     * @return  Returns the number of samples at 48kHz, 0 if malformed
+     *
+     * The number of samples is found by looking at the TOC byte of the
+     * packet, as described in RFC 6716 section 3.1, so the packet does not
+     * need to be decoded.
+     */
+    static unsigned packetSamples(const void *data, int len);
+
     /**
      * @brief   Default constructor
+     * @param   use_encoder Set to \em false to only use writePacket
+     *
+     * If the container is created without an encoder, no samples may be
+     * written to it. Only already encoded packets can then be added, using
+     * the writePacket function.
      */
-    AudioContainerOpus(void);
+    explicit AudioContainerOpus(bool use_encoder=true);
 
     /**
      * @brief   Destructor
@@ -181,6 +204,34 @@ class AudioContainerOpus : public AudioContainer
      */
     virtual const char* header(void) { return m_header.data(); }
 
+    /**
+     * @brief   Set the user comments written to the OpusTags header
+     * @param   comments The comments, each one on the form TAG=value
+     *
+     * This function must be called before any audio is written to the
+     * container since the header is regenerated.
+     */
+    void setComments(const std::vector<std::string>& comments);
+
+    /**
+     * @brief   Write an already encoded Opus packet to the container
+     * @param   data The encoded Opus packet
+     * @param   len The length of the packet
+     *
+     * The packet is added to the Ogg stream as is. Each time an Ogg page is
+     * completed, it is written using the writeBlock signal.
+     */
+    void writePacket(const void *data, int len);
+
+    /**
+     * @brief   Write all pending packets to a page
+     *
+     * Packets are normally collected into pages of a few packets each. Call
+     * this function to write the packets that have not yet been written, e.g.
+     * when there is a pause in a live stream. The stream is not ended.
+     */
+    void flushPages(void);
+
   protected:
 
   private:
@@ -194,15 +245,17 @@ class AudioContainerOpus : public AudioContainer
     AudioContainer*               m_container       = nullptr;
     std::vector<char>             m_header;
     std::vector<char>             m_block;
+    std::vector<std::string>      m_comments;
 
     AudioContainerOpus(const AudioContainerOpus&);
     AudioContainerOpus& operator=(const AudioContainerOpus&);
     void onWriteBlock(const char *buf, size_t len);
     void onWriteEncodedSamples(const void *data, int len);
+    void addPacket(const void *data, int len, unsigned samples);
     void oggpackWriteString(oggpack_buffer* oggbuf,
                             const char *str, int lenbits=32);
     void oggpackWriteCommentList(oggpack_buffer* oggbuf,
-                                 const std::vector<const char*> &comments);
+                                 const std::vector<std::string> &comments);
     bool writePage(const ogg_page& page, std::vector<char>& buf);
     bool writeOggOpusHeader(void);
 
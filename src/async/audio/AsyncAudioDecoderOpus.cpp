@@ -44,6 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -187,6 +188,8 @@ void AudioDecoderOpus::reset(void)
 
 void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
 {
+  ASYNC_TRACE_SCOPE_ARG("codec", "AudioDecoderOpus::writeEncodedSamples",
+                        size);
   unsigned char *packet = reinterpret_cast<unsigned char *>(buf);
   
   int frame_cnt = opus_packet_get_nb_frames(packet, size);
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -265,6 +266,7 @@ AudioDevice::~AudioDevice(void)
 
 void AudioDevice::putBlocks(int16_t *buf, size_t frame_cnt)
 {
+  ASYNC_TRACE_SCOPE_ARG("audiodev", "AudioDevice::putBlocks", frame_cnt);
   //printf("putBlocks: frame_cnt=%zu\n", frame_cnt);
   float samples[frame_cnt];
   for (size_t ch=0; ch<channels; ch++)
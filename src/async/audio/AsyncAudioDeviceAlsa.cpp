@@ -49,6 +49,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncTrace.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -102,12 +104,14 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
         {
           FdWatch *watch = new FdWatch(pfds[i].fd, FdWatch::FD_WATCH_WR);
           watch->activity.connect(mem_fun(*this, &AlsaWatch::writeEvent));
+          watch->setName("AudioDeviceAlsa::write");
           watch_list.push_back(watch);
         }
         if (pfds[i].events & POLLIN)
         {
           FdWatch *watch = new FdWatch(pfds[i].fd, FdWatch::FD_WATCH_RD);
           watch->activity.connect(mem_fun(*this, &AlsaWatch::readEvent));
+          watch->setName("AudioDeviceAlsa::read");
           watch_list.push_back(watch);
         }
         pfd_map[pfds[i].fd] = pfds[i];
@@ -159,6 +163,16 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
 };
 
 
+namespace {
+  void countXrun(const string& dev_name, const char *direction)
+  {
+    Metrics::instance().counter("async_audio_alsa_xruns_total",
+        "The number of ALSA overruns and underruns",
+        {{"device", dev_name}, {"direction", direction}})->inc();
+  }
+} /* anonymous namespace */
+
+
 /****************************************************************************
  *
  * Prototypes
@@ -409,6 +423,7 @@ void AudioDeviceAlsa::closeDevice(void)
 
 void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
 {
+  ASYNC_TRACE_SCOPE("audiodev", "AudioDeviceAlsa::audioReadHandler");
   assert(rec_handle != 0);
   assert((mode() == MODE_RD) || (mode() == MODE_RDWR));
   
@@ -420,6 +435,7 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
   snd_pcm_sframes_t frames_avail = snd_pcm_avail_update(rec_handle);
   if (frames_avail < 0)
   {
+    countXrun(devName(), "capture");
     if (!startCapture(rec_handle))
     {
       watch->setEnabled(false);
@@ -441,6 +457,7 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
                                                   frames_avail);
     if (frames_read < 0)
     {
+      countXrun(devName(), "capture");
       if (!startCapture(rec_handle))
       {
         watch->setEnabled(false);
@@ -456,6 +473,7 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
 
 void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents)
 {
+  ASYNC_TRACE_SCOPE("audiodev", "AudioDeviceAlsa::writeSpaceAvailable");
   //printf("AudioDeviceAlsa::writeSpaceAvailable\n");
   
   assert(play_handle != 0);
@@ -473,6 +491,7 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       // Bail out if there's an error
     if (space_avail < 0)
     {
+      countXrun(devName(), "playback");
       if (!startPlayback(play_handle))
       {
         watch->setEnabled(false);
@@ -512,6 +531,7 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
     //       blocks_gotten, (int)frames_written);
     if (frames_written < 0)
     {
+      countXrun(devName(), "playback");
       if (!startPlayback(play_handle))
       {
         watch->setEnabled(false);
@@ -0,0 +1,638 @@
+/**
+@file	 AsyncAudioDeviceFile.cpp
+@brief   An audio device that read and write audio from/to files
+@author  agent
+@date    2026-10-18
+
+Implements an "audio device" that read samples from a WAV or raw file and
+write samples to a WAV or raw file. The device is paced by timers so if the
+application run on a virtual clock, audio is processed as fast as the CPU
+allow. This is mainly useful for benchmarking and regression testing.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <strings.h>
+
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDeviceFile.h"
+#include "AsyncAudioDeviceFactory.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static bool isWavFilename(const string& filename);
+static uint32_t read32bitValue(const char *ptr);
+static uint16_t read16bitValue(const char *ptr);
+static char *store32bitValue(char *ptr, uint32_t val);
+static char *store16bitValue(char *ptr, uint16_t val);
+static bool getEnvBool(const char *name, bool default_value);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+REGISTER_AUDIO_DEVICE_TYPE("file", AudioDeviceFile);
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+size_t AudioDeviceFile::readBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceFile::readBlocksize */
+
+
+size_t AudioDeviceFile::writeBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceFile::writeBlocksize */
+
+
+bool AudioDeviceFile::isFullDuplexCapable(void)
+{
+  return true;
+} /* AudioDeviceFile::isFullDuplexCapable */
+
+
+void AudioDeviceFile::audioToWriteAvailable(void)
+{
+  if (!write_timer->isEnabled())
+  {
+    audioWriteHandler();
+  }
+} /* AudioDeviceFile::audioToWriteAvailable */
+
+
+void AudioDeviceFile::flushSamples(void)
+{
+  if (!write_timer->isEnabled())
+  {
+    audioWriteHandler();
+  }
+} /* AudioDeviceFile::flushSamples */
+
+
+int AudioDeviceFile::samplesToWrite(void) const
+{
+  return 0;
+} /* AudioDeviceFile::samplesToWrite */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+AudioDeviceFile::AudioDeviceFile(const string& dev_name)
+  : AudioDevice(dev_name), block_size(0), rx_file_channels(0),
+    tx_is_wav(false), tx_frames_written(0), read_buf(0), file_buf(0),
+    realtime(false), quit_at_eof(true), zerofill_on_underflow(false),
+    frames_read(0), start_cpu(0.0)
+{
+  assert(AudioDeviceFile_creator_registered);
+  assert(sampleRate() > 0);
+  size_t pace_interval = 1000 * block_size_hint / sampleRate();
+  block_size = pace_interval * sampleRate() / 1000;
+
+  size_t comma = dev_name.find(',');
+  rx_filename = dev_name.substr(0, comma);
+  if (comma != string::npos)
+  {
+    tx_filename = dev_name.substr(comma + 1);
+  }
+
+  read_buf = new int16_t[block_size * channels];
+  read_timer = new Timer(pace_interval, Timer::TYPE_PERIODIC, false);
+  read_timer->expired.connect(
+      sigc::hide(mem_fun(*this, &AudioDeviceFile::audioReadHandler)));
+  write_timer = new Timer(pace_interval, Timer::TYPE_PERIODIC, false);
+  write_timer->expired.connect(
+      sigc::hide(mem_fun(*this, &AudioDeviceFile::audioWriteHandler)));
+
+  realtime = getEnvBool("ASYNC_AUDIO_FILE_REALTIME", realtime);
+  quit_at_eof = getEnvBool("ASYNC_AUDIO_FILE_QUIT_AT_EOF", quit_at_eof);
+  zerofill_on_underflow = getEnvBool("ASYNC_AUDIO_FILE_ZEROFILL",
+                                     zerofill_on_underflow);
+
+  start_wall.tv_sec = 0;
+  start_wall.tv_nsec = 0;
+} /* AudioDeviceFile::AudioDeviceFile */
+
+
+AudioDeviceFile::~AudioDeviceFile(void)
+{
+  closeDevice();
+  delete read_timer;
+  delete write_timer;
+  delete [] read_buf;
+  delete [] file_buf;
+} /* AudioDeviceFile::~AudioDeviceFile */
+
+
+bool AudioDeviceFile::openDevice(Mode mode)
+{
+  bool open_rx = ((mode == MODE_RD) || (mode == MODE_RDWR));
+  bool open_tx = ((mode == MODE_WR) || (mode == MODE_RDWR));
+
+  if (open_rx && !rx_file.is_open() && !openRxFile())
+  {
+    return false;
+  }
+  if (!open_rx)
+  {
+    closeRxFile();
+  }
+
+  if (open_tx && !tx_file.is_open() && !openTxFile())
+  {
+    closeRxFile();
+    return false;
+  }
+  if (!open_tx)
+  {
+    closeTxFile();
+  }
+
+  if (!realtime && !Application::app().virtualClockEnabled())
+  {
+    if (Application::app().setVirtualClock(true))
+    {
+      cout << "AudioDeviceFile: Running on a virtual clock" << endl;
+    }
+    else
+    {
+      cerr << "*** WARNING: The application does not support a virtual "
+              "clock. Audio device \"file:" << devName()
+           << "\" will be paced in real time.\n";
+    }
+  }
+
+  return true;
+} /* AudioDeviceFile::openDevice */
+
+
+void AudioDeviceFile::closeDevice(void)
+{
+  closeRxFile();
+  closeTxFile();
+} /* AudioDeviceFile::closeDevice */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+bool AudioDeviceFile::openRxFile(void)
+{
+  if (rx_filename.empty())
+  {
+    cerr << "*** ERROR: No file to read audio from specified for audio "
+            "device \"file:" << devName() << "\". "
+            "Should be file:rx-file[,tx-file]\n";
+    return false;
+  }
+
+  rx_file.open(rx_filename.c_str(), ios::in | ios::binary);
+  if (!rx_file.is_open())
+  {
+    cerr << "*** ERROR: Could not open audio file \"" << rx_filename
+         << "\" for reading: " << strerror(errno) << endl;
+    return false;
+  }
+
+  rx_file_channels = channels;
+  if (isWavFilename(rx_filename))
+  {
+    char hdr[12];
+    rx_file.read(hdr, sizeof(hdr));
+    if (!rx_file.good() || (memcmp(hdr, "RIFF", 4) != 0) ||
+        (memcmp(hdr + 8, "WAVE", 4) != 0))
+    {
+      cerr << "*** ERROR: Illegal WAV file header in \"" << rx_filename
+           << "\"\n";
+      closeRxFile();
+      return false;
+    }
+
+      // Scan the subchunks until the data chunk is found
+    bool fmt_found = false;
+    for (;;)
+    {
+      char subchunk_hdr[8];
+      rx_file.read(subchunk_hdr, sizeof(subchunk_hdr));
+      if (!rx_file.good())
+      {
+        cerr << "*** ERROR: No data found in WAV file \"" << rx_filename
+             << "\"\n";
+        closeRxFile();
+        return false;
+      }
+      uint32_t subchunk_size = read32bitValue(subchunk_hdr + 4);
+      if (memcmp(subchunk_hdr, "data", 4) == 0)
+      {
+        break;
+      }
+      if ((memcmp(subchunk_hdr, "fmt ", 4) == 0) && (subchunk_size >= 16))
+      {
+        char fmt[16];
+        rx_file.read(fmt, sizeof(fmt));
+        uint16_t audio_format = read16bitValue(fmt);
+        uint16_t num_channels = read16bitValue(fmt + 2);
+        uint32_t sample_rate = read32bitValue(fmt + 4);
+        uint16_t bits_per_sample = read16bitValue(fmt + 14);
+        if ((audio_format != 1) || (bits_per_sample != 16) ||
+            (num_channels == 0))
+        {
+          cerr << "*** ERROR: Only 16 bit PCM WAV files are supported ("
+               << rx_filename << ")\n";
+          closeRxFile();
+          return false;
+        }
+        if (sample_rate != static_cast<uint32_t>(sampleRate()))
+        {
+          cerr << "*** ERROR: The sample rate of WAV file \"" << rx_filename
+               << "\" is " << sample_rate << "Hz but the audio device is "
+                  "configured for " << sampleRate() << "Hz\n";
+          closeRxFile();
+          return false;
+        }
+        rx_file_channels = num_channels;
+        fmt_found = true;
+        subchunk_size -= sizeof(fmt);
+      }
+      rx_file.seekg(subchunk_size + (subchunk_size & 1), ios::cur);
+    }
+    if (!fmt_found)
+    {
+      cerr << "*** ERROR: No format chunk found in WAV file \""
+           << rx_filename << "\"\n";
+      closeRxFile();
+      return false;
+    }
+  }
+
+  delete [] file_buf;
+  file_buf = new int16_t[block_size * rx_file_channels];
+
+  frames_read = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start_wall);
+  start_cpu = cpuTime();
+  read_timer->setEnable(true);
+
+  return true;
+} /* AudioDeviceFile::openRxFile */
+
+
+bool AudioDeviceFile::openTxFile(void)
+{
+  if (tx_filename.empty())
+  {
+    cerr << "*** ERROR: No file to write audio to specified for audio "
+            "device \"file:" << devName() << "\". "
+            "Should be file:rx-file[,tx-file]\n";
+    return false;
+  }
+
+  tx_file.open(tx_filename.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!tx_file.is_open())
+  {
+    cerr << "*** ERROR: Could not open audio file \"" << tx_filename
+         << "\" for writing: " << strerror(errno) << endl;
+    return false;
+  }
+
+    // Reserve space for the WAV header. It is written when the file is
+    // closed and the size of the audio data is known.
+  tx_is_wav = isWavFilename(tx_filename);
+  if (tx_is_wav)
+  {
+    char hdr[WAVE_HEADER_SIZE];
+    memset(hdr, 0, sizeof(hdr));
+    tx_file.write(hdr, sizeof(hdr));
+  }
+  tx_frames_written = 0;
+
+  if (zerofill_on_underflow)
+  {
+    write_timer->setEnable(true);
+  }
+
+  return true;
+} /* AudioDeviceFile::openTxFile */
+
+
+void AudioDeviceFile::closeRxFile(void)
+{
+  read_timer->setEnable(false);
+  if (rx_file.is_open())
+  {
+    rx_file.close();
+  }
+  rx_file.clear();
+} /* AudioDeviceFile::closeRxFile */
+
+
+void AudioDeviceFile::closeTxFile(void)
+{
+  write_timer->setEnable(false);
+  if (!tx_file.is_open())
+  {
+    return;
+  }
+
+  if (tx_is_wav)
+  {
+    const uint32_t frame_size = channels * sizeof(int16_t);
+    const uint32_t data_size = tx_frames_written * frame_size;
+    char hdr[WAVE_HEADER_SIZE];
+    char *ptr = hdr;
+    memcpy(ptr, "RIFF", 4); ptr += 4;
+    ptr = store32bitValue(ptr, WAVE_HEADER_SIZE - 8 + data_size);
+    memcpy(ptr, "WAVE", 4); ptr += 4;
+    memcpy(ptr, "fmt ", 4); ptr += 4;
+    ptr = store32bitValue(ptr, 16);
+    ptr = store16bitValue(ptr, 1);
+    ptr = store16bitValue(ptr, channels);
+    ptr = store32bitValue(ptr, sampleRate());
+    ptr = store32bitValue(ptr, sampleRate() * frame_size);
+    ptr = store16bitValue(ptr, frame_size);
+    ptr = store16bitValue(ptr, 16);
+    memcpy(ptr, "data", 4); ptr += 4;
+    ptr = store32bitValue(ptr, data_size);
+    assert(ptr - hdr == WAVE_HEADER_SIZE);
+    tx_file.seekp(0);
+    tx_file.write(hdr, sizeof(hdr));
+  }
+  tx_file.close();
+  tx_file.clear();
+} /* AudioDeviceFile::closeTxFile */
+
+
+void AudioDeviceFile::audioReadHandler(void)
+{
+  assert(rx_file.is_open());
+
+  rx_file.read(reinterpret_cast<char *>(file_buf),
+               block_size * rx_file_channels * sizeof(int16_t));
+  size_t frame_cnt =
+    rx_file.gcount() / (rx_file_channels * sizeof(int16_t));
+
+    // Map the file channels onto the device channels. If the file have
+    // fewer channels than the device, the file channels are repeated.
+  for (size_t i=0; i<frame_cnt; ++i)
+  {
+    for (size_t ch=0; ch<channels; ++ch)
+    {
+      read_buf[i * channels + ch] =
+        file_buf[i * rx_file_channels + ch % rx_file_channels];
+    }
+  }
+  if (frame_cnt > 0)
+  {
+    memset(read_buf + frame_cnt * channels, 0,
+           (block_size - frame_cnt) * channels * sizeof(int16_t));
+    putBlocks(read_buf, block_size);
+    frames_read += frame_cnt;
+  }
+
+  if (frame_cnt < block_size)
+  {
+    read_timer->setEnable(false);
+    printReport();
+    if (quit_at_eof)
+    {
+      Application::app().quit();
+    }
+  }
+} /* AudioDeviceFile::audioReadHandler */
+
+
+void AudioDeviceFile::audioWriteHandler(void)
+{
+  assert(tx_file.is_open());
+
+  int16_t buf[block_size * channels];
+  if (getBlocks(buf, 1) == 0)
+  {
+    if (!zerofill_on_underflow)
+    {
+      write_timer->setEnable(false);
+      return;
+    }
+    memset(buf, 0, sizeof(buf));
+  }
+
+  tx_file.write(reinterpret_cast<char *>(buf), sizeof(buf));
+  if (!tx_file.good())
+  {
+    cerr << "*** ERROR: Failed to write to audio file \"" << tx_filename
+         << "\": " << strerror(errno) << endl;
+    write_timer->setEnable(false);
+    return;
+  }
+  tx_frames_written += block_size;
+
+  write_timer->setEnable(true);
+} /* AudioDeviceFile::audioWriteHandler */
+
+
+void AudioDeviceFile::printReport(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double wall = (now.tv_sec - start_wall.tv_sec) +
+                (now.tv_nsec - start_wall.tv_nsec) / 1.0e9;
+  double cpu = cpuTime() - start_cpu;
+  double audio = static_cast<double>(frames_read) / sampleRate();
+
+  cout << "AudioDeviceFile: Processed " << fixed << setprecision(1)
+       << audio << "s of audio from \"" << rx_filename << "\" in " << wall
+       << "s";
+  if (wall > 0.0)
+  {
+    cout << " (" << audio / wall << " x realtime)";
+  }
+  cout << ". CPU time used: " << setprecision(3) << cpu << "s";
+  if (audio > 0.0)
+  {
+    cout << " (" << 1000.0 * cpu / audio << "ms per audio second)";
+  }
+  cout << defaultfloat << setprecision(6) << endl;
+} /* AudioDeviceFile::printReport */
+
+
+double AudioDeviceFile::cpuTime(void)
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == -1)
+  {
+    return 0.0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1.0e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1.0e6;
+} /* AudioDeviceFile::cpuTime */
+
+
+static bool isWavFilename(const string& filename)
+{
+  return (filename.size() > 4) &&
+         (strcasecmp(filename.c_str() + filename.size() - 4, ".wav") == 0);
+} /* isWavFilename */
+
+
+static uint32_t read32bitValue(const char *ptr)
+{
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(ptr);
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+} /* read32bitValue */
+
+
+static uint16_t read16bitValue(const char *ptr)
+{
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(ptr);
+  return static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8);
+} /* read16bitValue */
+
+
+static char *store32bitValue(char *ptr, uint32_t val)
+{
+  for (int i=0; i<4; ++i)
+  {
+    *ptr++ = val & 0xff;
+    val >>= 8;
+  }
+  return ptr;
+} /* store32bitValue */
+
+
+static char *store16bitValue(char *ptr, uint16_t val)
+{
+  *ptr++ = val & 0xff;
+  *ptr++ = (val >> 8) & 0xff;
+  return ptr;
+} /* store16bitValue */
+
+
+static bool getEnvBool(const char *name, bool default_value)
+{
+  const char *str = std::getenv(name);
+  if (str != 0)
+  {
+    std::istringstream(str) >> default_value;
+  }
+  return default_value;
+} /* getEnvBool */
+
+
+
+/*
+ * This file has not been truncated
+ */
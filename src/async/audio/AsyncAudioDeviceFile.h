@@ -0,0 +1,255 @@
+/**
+@file	 AsyncAudioDeviceFile.h
+@brief   An audio device that read and write audio from/to files
+@author  agent
+@date	 2026-10-18
+
+Implements an "audio device" that read samples from a WAV or raw file and
+write samples to a WAV or raw file. The device is paced by timers so if the
+application run on a virtual clock, audio is processed as fast as the CPU
+allow. This is mainly useful for benchmarking and regression testing.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_DEVICE_FILE_INCLUDED
+#define ASYNC_AUDIO_DEVICE_FILE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+
+#include <string>
+#include <fstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDevice.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class Timer;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An audio device reading and writing audio files
+@author agent
+@date   2026-10-18
+
+Implements an "audio device" that read recorded samples from a file and write
+played samples to a file. The device is specified as
+
+  file:<rx file>[,<tx file>]
+
+where either file name may be empty. Files with a .wav extension are handled
+as 16 bit PCM WAV files. All other files are handled as raw native endian 16
+bit samples with interleaved channels, using the sample rate and channel
+count of the audio device.
+
+When the device is opened, the application is switched over to a virtual
+clock (see Async::Application::setVirtualClock) so that audio is processed
+as fast as the CPU allow, while timers still see a time that is consistent
+with the processed audio. Set the environment variable
+ASYNC_AUDIO_FILE_REALTIME=1 to pace the device using the system clock instead.
+
+When the end of the receive file is reached, a report on the CPU time used
+per second of audio is printed and the application is asked to quit. Set the
+environment variable ASYNC_AUDIO_FILE_QUIT_AT_EOF=0 to keep the application
+running. Setting ASYNC_AUDIO_FILE_ZEROFILL=1 will write zeros to the transmit
+file when there is no audio to write, which keep it time aligned with the
+receive file.
+*/
+class AudioDeviceFile : public Async::AudioDevice
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	dev_name  The name of the device to associate this object with
+     */
+    explicit AudioDeviceFile(const std::string& dev_name);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioDeviceFile(void);
+
+    /**
+     * @brief 	Find out what the read (recording) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t readBlocksize(void);
+
+    /**
+     * @brief 	Find out what the write (playback) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t writeBlocksize(void);
+
+    /**
+     * @brief 	Check if the audio device has full duplex capability
+     * @return	Returns \em true if the device has full duplex capability
+     *	      	or else \em false
+     */
+    virtual bool isFullDuplexCapable(void);
+
+    /**
+     * @brief 	Tell the audio device handler that there are audio to be
+     *	      	written in the buffer
+     */
+    virtual void audioToWriteAvailable(void);
+
+    /**
+     * @brief	Tell the audio device to flush its buffers
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief 	Find out how many samples there are in the output buffer
+     * @return	Returns the number of samples in the output buffer on
+     *          success or -1 on failure.
+     *
+     * Samples are written directly to the file so this function will always
+     * return 0.
+     */
+    virtual int samplesToWrite(void) const;
+
+
+  protected:
+    /**
+     * @brief 	Open the audio device
+     * @param 	mode The mode to open the audio device in (See AudioIO::Mode)
+     * @return	Returns \em true on success or else \em false
+     */
+    virtual bool openDevice(Mode mode);
+
+    /**
+     * @brief 	Close the audio device
+     */
+    virtual void closeDevice(void);
+
+
+  private:
+    static const size_t WAVE_HEADER_SIZE = 44;
+
+    size_t              block_size;
+    std::string         rx_filename;
+    std::string         tx_filename;
+    std::ifstream       rx_file;
+    std::ofstream       tx_file;
+    size_t              rx_file_channels;
+    bool                tx_is_wav;
+    uint64_t            tx_frames_written;
+    int16_t             *read_buf;
+    int16_t             *file_buf;
+    Async::Timer        *read_timer;
+    Async::Timer        *write_timer;
+    bool                realtime;
+    bool                quit_at_eof;
+    bool                zerofill_on_underflow;
+    uint64_t            frames_read;
+    struct timespec     start_wall;
+    double              start_cpu;
+
+    bool openRxFile(void);
+    bool openTxFile(void);
+    void closeRxFile(void);
+    void closeTxFile(void);
+    void audioReadHandler(void);
+    void audioWriteHandler(void);
+    void printReport(void);
+    static double cpuTime(void);
+
+};  /* class AudioDeviceFile */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_DEVICE_FILE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
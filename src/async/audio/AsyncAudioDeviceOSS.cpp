@@ -58,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -350,6 +351,7 @@ bool AudioDeviceOSS::openDevice(Mode mode)
     assert(read_watch != 0);
     read_watch->activity.connect(
         mem_fun(*this, &AudioDeviceOSS::audioReadHandler));
+    read_watch->setName("AudioDeviceOSS::read");
     arg |= PCM_ENABLE_INPUT;
   }
   
@@ -359,6 +361,7 @@ bool AudioDeviceOSS::openDevice(Mode mode)
     assert(write_watch != 0);
     write_watch->activity.connect(
       	mem_fun(*this, &AudioDeviceOSS::writeSpaceAvailable));
+    write_watch->setName("AudioDeviceOSS::write");
     arg |= PCM_ENABLE_OUTPUT;
   }
   
@@ -415,6 +418,7 @@ void AudioDeviceOSS::closeDevice(void)
 
 void AudioDeviceOSS::audioReadHandler(FdWatch *watch)
 {
+  ASYNC_TRACE_SCOPE("audiodev", "AudioDeviceOSS::audioReadHandler");
   audio_buf_info info;
   if (ioctl(fd, SNDCTL_DSP_GETISPACE, &info) == -1)
   {
@@ -444,6 +448,7 @@ void AudioDeviceOSS::audioReadHandler(FdWatch *watch)
 
 void AudioDeviceOSS::writeSpaceAvailable(FdWatch *watch)
 {
+  ASYNC_TRACE_SCOPE("audiodev", "AudioDeviceOSS::writeSpaceAvailable");
   assert(fd >= 0);
   assert((mode() == MODE_WR) || (mode() == MODE_RDWR));
   
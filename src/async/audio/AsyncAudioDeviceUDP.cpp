@@ -202,6 +202,7 @@ AudioDeviceUDP::AudioDeviceUDP(const string& dev_name)
   read_buf = new int16_t[block_size * channels];
   pace_timer = new Timer(pace_interval, Timer::TYPE_PERIODIC);
   pace_timer->setEnable(false);
+  pace_timer->setName("AudioDeviceUDP::pace");
   pace_timer->expired.connect(
       sigc::hide(mem_fun(*this, &AudioDeviceUDP::audioWriteHandler)));
 
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstdlib>
 #include <sstream>
+#include <time.h>
 
 
 /****************************************************************************
@@ -44,6 +45,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -631,6 +634,7 @@ const char *AudioEncoderOpus::applicationTypeStr(opus_int32 type)
 
 int AudioEncoderOpus::writeSamples(const float *samples, int count)
 {
+  ASYNC_TRACE_SCOPE_ARG("codec", "AudioEncoderOpus::writeSamples", count);
   for (int i=0; i<count; ++i)
   {
     sample_buf[buf_len++] = samples[i];
@@ -639,8 +643,17 @@ int AudioEncoderOpus::writeSamples(const float *samples, int count)
     {
       buf_len = 0;
       unsigned char output_buf[4000];
+      static Metrics::Histogram *encode_time = Metrics::instance().histogram(
+          "async_audio_encoder_seconds", "The time used to encode a frame",
+          Metrics::exponentialBuckets(0.00005, 2.0, 10),
+          {{"codec", "OPUS"}});
+      struct timespec start, end;
+      clock_gettime(CLOCK_MONOTONIC, &start);
       opus_int32 nbytes = opus_encode_float(enc, sample_buf, frame_size,
                                             output_buf, sizeof(output_buf));
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      encode_time->observe((end.tv_sec - start.tv_sec) +
+                           (end.tv_nsec - start.tv_nsec) / 1.0e9);
       //cout << "### frame_size=" << frame_size << " nbytes=" << nbytes << endl;
       if (nbytes > 0)
       {
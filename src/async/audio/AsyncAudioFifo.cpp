@@ -46,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -181,6 +182,32 @@ void AudioFifo::clear(void)
 } /* AudioFifo::clear */
 
 
+unsigned AudioFifo::dropSamples(unsigned count)
+{
+  count = min(count, samplesInFifo(true));
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  tail = (tail + count) % fifo_size;
+  is_full = false;
+
+  if (is_flushing && empty())
+  {
+    sinkFlushSamples();
+  }
+
+  if (input_stopped)
+  {
+    input_stopped = false;
+    sourceResumeOutput();
+  }
+
+  return count;
+} /* AudioFifo::dropSamples */
+
+
 void AudioFifo::setPrebufSamples(unsigned prebuf_samples)
 {
   this->prebuf_samples = min(prebuf_samples, fifo_size-1);
@@ -252,6 +279,7 @@ int AudioFifo::writeSamples(const float *samples, int count)
   
   if (buffering_enabled)
   {
+    unsigned overwritten = 0;
     while (!is_full && (samples_written < count))
     {
       while (!is_full && (samples_written < count))
@@ -263,6 +291,7 @@ int AudioFifo::writeSamples(const float *samples, int count)
 	  if (do_overwrite)
 	  {
       	    tail = (tail < fifo_size-1) ? tail + 1 : 0;
+	    ++overwritten;
 	  }
 	  else
 	  {
@@ -278,6 +307,15 @@ int AudioFifo::writeSamples(const float *samples, int count)
 
       writeSamplesFromFifo();
     }
+
+    if (overwritten > 0)
+    {
+      static Metrics::Counter *overwritten_samples =
+        Metrics::instance().counter(
+          "async_audio_fifo_overwritten_samples_total",
+          "The number of samples lost due to audio FIFO overruns");
+      overwritten_samples->inc(overwritten);
+    }
   }
   else
   {
@@ -200,6 +200,16 @@ class AudioFifo : public AudioSink, public AudioSource
      */
     void clear(void);
 
+    /**
+     * @brief   Discard the oldest samples in the FIFO
+     * @param   count The number of samples to discard
+     * @return  Returns the number of samples actually discarded
+     *
+     * This can be used to shorten the delay through the FIFO without
+     * discarding the most recent audio.
+     */
+    unsigned dropSamples(unsigned count);
+
     /**
      * @brief	Set the number of samples that must be in the fifo before
      *		any samples are written out from it.
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -168,6 +169,7 @@ void AudioSink::unregisterSource(void)
  */
 void AudioSink::sourceResumeOutput(void)
 {
+  ASYNC_TRACE_SCOPE("audio", "AudioSink::sourceResumeOutput");
   if (m_source != 0)
   {
     m_source->resumeOutput();
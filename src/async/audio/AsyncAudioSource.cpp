@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -166,6 +167,7 @@ void AudioSource::unregisterSink(void)
 int AudioSource::sinkWriteSamples(const float *samples, int len)
 {
   assert(len > 0);
+  ASYNC_TRACE_SCOPE_ARG("audio", "AudioSource::sinkWriteSamples", len);
 
   is_flushing = false;
   
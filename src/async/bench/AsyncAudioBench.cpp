@@ -0,0 +1,448 @@
+/**
+@file	 AsyncAudioBench.cpp
+@brief   Micro-benchmarks for the Async audio library
+@author  agent
+@date	 2026-10-18
+
+Usage: AsyncAudioBench [--filter <substring>] [--json <file>]
+                       [--compare <baseline file>] [--threshold <percent>]
+
+Measure the time per sample and the number of heap allocations per block for
+the audio pipe components and the audio codecs. Use --json to save the
+results and --compare to check a build against saved results. See
+AsyncBench.h for all options.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncAudioFifo.h>
+#include <AsyncAudioReader.h>
+#include <AsyncAudioSplitter.h>
+#include <AsyncAudioMixer.h>
+#include <AsyncAudioFilter.h>
+#include <AsyncAudioDecimator.h>
+#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioCompressor.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioDecoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncBench.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // 20ms at the internal sample rate, the block size used by most of SvxLink
+static const unsigned BLOCK_SIZE = INTERNAL_SAMPLE_RATE / 50;
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  /*
+   * Generate a windowed sinc lowpass filter. The number of taps is the same
+   * as for the multirate filters used in SvxLink so the cost is comparable.
+   */
+  vector<float> firLowpass(unsigned taps, float cutoff)
+  {
+    vector<float> coeff(taps);
+    for (unsigned i=0; i<taps; ++i)
+    {
+      float n = i - (taps - 1) / 2.0f;
+      float sinc = (n == 0.0f) ? 2.0f * cutoff
+                               : sinf(2.0f * M_PI * cutoff * n) / (M_PI * n);
+      float window = 0.54f - 0.46f * cosf(2.0f * M_PI * i / (taps - 1));
+      coeff[i] = sinc * window;
+    }
+    return coeff;
+  }
+
+
+  class FifoFixture : public Bench::Fixture
+  {
+    public:
+      FifoFixture(Bench& bench)
+        : m_feeder(BLOCK_SIZE, INTERNAL_SAMPLE_RATE), m_fifo(16 * BLOCK_SIZE),
+          m_buffered_fifo(16 * BLOCK_SIZE), m_buf(BLOCK_SIZE)
+      {
+          // A FIFO with a sink that accept all samples pass them through
+        m_src.registerSink(&m_fifo);
+        m_fifo.registerSink(&m_sink);
+        bench.add("AudioFifo/passthrough", BLOCK_SIZE,
+            [this]() { m_src.write(m_feeder.nextBlock(), BLOCK_SIZE); });
+
+          // Samples are stored in the FIFO and read back by an AudioReader
+        m_buffered_src.registerSink(&m_buffered_fifo);
+        m_buffered_fifo.registerSink(&m_reader);
+        bench.add("AudioFifo/buffered", BLOCK_SIZE,
+            [this]()
+            {
+              m_buffered_src.write(m_feeder.nextBlock(), BLOCK_SIZE);
+              m_reader.readSamples(&m_buf[0], BLOCK_SIZE);
+            });
+      }
+
+    private:
+      Bench::Feeder   m_feeder;
+      Bench::Source   m_src;
+      AudioFifo       m_fifo;
+      Bench::Sink     m_sink;
+      Bench::Source   m_buffered_src;
+      AudioFifo       m_buffered_fifo;
+      AudioReader     m_reader;
+      vector<float>   m_buf;
+  };
+
+
+  class SplitterFixture : public Bench::Fixture
+  {
+    public:
+      SplitterFixture(Bench& bench)
+        : m_feeder(BLOCK_SIZE, INTERNAL_SAMPLE_RATE)
+      {
+        m_src.registerSink(&m_splitter);
+        for (unsigned i=0; i<SINK_CNT; ++i)
+        {
+          m_splitter.addSink(&m_sinks[i]);
+        }
+        bench.add("AudioSplitter/3sinks", BLOCK_SIZE,
+            [this]() { m_src.write(m_feeder.nextBlock(), BLOCK_SIZE); });
+      }
+
+    private:
+      static const unsigned SINK_CNT = 3;
+
+      Bench::Feeder   m_feeder;
+      Bench::Source   m_src;
+      AudioSplitter   m_splitter;
+      Bench::Sink     m_sinks[SINK_CNT];
+  };
+
+
+  /*
+   * The mixer write its output from a zero timer so the blocks are fed from
+   * the sink. When a block has been mixed the next block is written to the
+   * inputs, until the requested number of blocks have been processed.
+   */
+  class MixerFixture : public Bench::Fixture
+  {
+    public:
+      MixerFixture(Bench& bench)
+        : m_feeder(MIXER_BLOCK_SIZE, INTERNAL_SAMPLE_RATE), m_blocks_left(0),
+          m_received(0)
+      {
+        for (unsigned i=0; i<SOURCE_CNT; ++i)
+        {
+          m_mixer.addSource(&m_srcs[i]);
+        }
+        m_mixer.registerSink(&m_sink);
+        m_sink.received.connect(
+            sigc::mem_fun(*this, &MixerFixture::samplesReceived));
+        bench.addBatch("AudioMixer/2sources", MIXER_BLOCK_SIZE,
+            [this](unsigned blocks, const Bench::DoneFunc& done)
+            {
+              m_blocks_left = blocks;
+              m_done = done;
+              writeBlock();
+            });
+      }
+
+    private:
+      static const unsigned SOURCE_CNT = 2;
+
+        // The input FIFOs of the mixer only hold 256 samples so a full block
+        // would not fit. Use 10ms blocks instead.
+      static const unsigned MIXER_BLOCK_SIZE = BLOCK_SIZE / 2;
+
+      Bench::Feeder     m_feeder;
+      Bench::Source     m_srcs[SOURCE_CNT];
+      AudioMixer        m_mixer;
+      Bench::Sink       m_sink;
+      unsigned          m_blocks_left;
+      unsigned          m_received;
+      Bench::DoneFunc   m_done;
+
+      void writeBlock(void)
+      {
+        m_received = 0;
+        const float *block = m_feeder.nextBlock();
+        for (unsigned i=0; i<SOURCE_CNT; ++i)
+        {
+          m_srcs[i].write(block, MIXER_BLOCK_SIZE);
+        }
+      }
+
+      void samplesReceived(const float *samples, int count)
+      {
+        m_received += count;
+        if (m_received < MIXER_BLOCK_SIZE)
+        {
+          return;
+        }
+        if (--m_blocks_left > 0)
+        {
+          writeBlock();
+        }
+        else
+        {
+          m_done();
+        }
+      }
+  };
+
+
+  class CodecFixture : public Bench::Fixture
+  {
+    public:
+      CodecFixture(Bench& bench, const string& codec)
+        : m_feeder(BLOCK_SIZE, INTERNAL_SAMPLE_RATE),
+          m_enc(AudioEncoder::create(codec)),
+          m_dec(AudioDecoder::create(codec)), m_packet_idx(0),
+          m_samples_per_packet(0), m_collect_packets(true)
+      {
+        m_src.registerSink(m_enc.get());
+        m_dec->registerSink(&m_sink);
+
+          // Encode the test signal once to get packets to decode
+        m_enc->writeEncodedSamples.connect(
+            sigc::mem_fun(*this, &CodecFixture::packetEncoded));
+        for (unsigned i=0; i<Bench::Feeder::SIGNAL_BLOCKS; ++i)
+        {
+          m_src.write(m_feeder.nextBlock(), BLOCK_SIZE);
+        }
+        uint64_t samples_before = m_sink.samples();
+        for (size_t i=0; i<m_packets.size(); ++i)
+        {
+          m_dec->writeEncodedSamples(&m_packets[i][0], m_packets[i].size());
+        }
+        if (!m_packets.empty())
+        {
+          m_samples_per_packet =
+            (m_sink.samples() - samples_before) / m_packets.size();
+        }
+        m_collect_packets = false;
+
+        bench.add(string("AudioEncoder/") + codec, BLOCK_SIZE,
+            [this]() { m_src.write(m_feeder.nextBlock(), BLOCK_SIZE); });
+        if (m_samples_per_packet > 0)
+        {
+          bench.add(string("AudioDecoder/") + codec, m_samples_per_packet,
+              [this]()
+              {
+                vector<uint8_t>& packet = m_packets[m_packet_idx];
+                m_dec->writeEncodedSamples(&packet[0], packet.size());
+                m_packet_idx = (m_packet_idx + 1) % m_packets.size();
+              });
+        }
+      }
+
+    private:
+      Bench::Feeder             m_feeder;
+      Bench::Source             m_src;
+      unique_ptr<AudioEncoder>  m_enc;
+      unique_ptr<AudioDecoder>  m_dec;
+      Bench::Sink               m_sink;
+      vector<vector<uint8_t> >  m_packets;
+      size_t                    m_packet_idx;
+      unsigned                  m_samples_per_packet;
+      bool                      m_collect_packets;
+
+      void packetEncoded(const void *buf, int size)
+      {
+        if (m_collect_packets && (size > 0))
+        {
+          const uint8_t *ptr = reinterpret_cast<const uint8_t*>(buf);
+          m_packets.push_back(vector<uint8_t>(ptr, ptr + size));
+        }
+      }
+  };
+
+
+  template <class T>
+  void addProcessor(vector<unique_ptr<Bench::Fixture> >& fixtures,
+                    Bench& bench, const string& name, T *proc,
+                    unsigned block_size,
+                    unsigned sample_rate=INTERNAL_SAMPLE_RATE)
+  {
+    vector<float> signal = Bench::testSignal(
+        Bench::Feeder::SIGNAL_BLOCKS * block_size, sample_rate);
+    fixtures.push_back(unique_ptr<Bench::Fixture>(new Bench::SinkFixture(
+        bench, name, proc, signal, block_size, proc)));
+  }
+
+} /* anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  CppApplication app;
+
+  Bench bench("AsyncAudioBench");
+  if (!bench.parseArgs(argc, argv))
+  {
+    exit(1);
+  }
+
+    // The same factors and number of taps as the multirate filters in
+    // SvxLink. The coefficients must outlive the decimators and
+    // interpolators since they only keep a pointer to them.
+  vector<float> coeff_48_16 = firLowpass(54, 0.5f / 3.0f);
+  vector<float> coeff_16_8 = firLowpass(90, 0.5f / 2.0f);
+
+  vector<unique_ptr<Bench::Fixture> > fixtures;
+  fixtures.push_back(unique_ptr<Bench::Fixture>(new FifoFixture(bench)));
+  fixtures.push_back(unique_ptr<Bench::Fixture>(new SplitterFixture(bench)));
+  fixtures.push_back(unique_ptr<Bench::Fixture>(new MixerFixture(bench)));
+
+  const char *filter_specs[] =
+  {
+    "LpBu20/3500", "HpCh12/-0.05/300", "LpCh9/-0.05/5500 x HpCh12/-0.05/300",
+    "BpBu8/5400-6500"
+  };
+  for (size_t i=0; i<sizeof(filter_specs)/sizeof(*filter_specs); ++i)
+  {
+    addProcessor(fixtures, bench, string("AudioFilter/") + filter_specs[i],
+                 new AudioFilter(filter_specs[i]), BLOCK_SIZE);
+  }
+
+  addProcessor(fixtures, bench, "AudioDecimator/48k-16k",
+               new AudioDecimator(3, &coeff_48_16[0], coeff_48_16.size()),
+               3 * BLOCK_SIZE, 48000);
+  addProcessor(fixtures, bench, "AudioDecimator/16k-8k",
+               new AudioDecimator(2, &coeff_16_8[0], coeff_16_8.size()),
+               BLOCK_SIZE);
+  addProcessor(fixtures, bench, "AudioInterpolator/8k-16k",
+               new AudioInterpolator(2, &coeff_16_8[0], coeff_16_8.size()),
+               BLOCK_SIZE / 2, 8000);
+  addProcessor(fixtures, bench, "AudioInterpolator/16k-48k",
+               new AudioInterpolator(3, &coeff_48_16[0], coeff_48_16.size()),
+               BLOCK_SIZE);
+
+  AudioCompressor *comp = new AudioCompressor;
+  comp->setThreshold(-10);
+  comp->setRatio(0.25);
+  addProcessor(fixtures, bench, "AudioCompressor", comp, BLOCK_SIZE);
+
+  const char *codecs[] = { "RAW", "S16", "GSM", "SPEEX", "OPUS" };
+  for (size_t i=0; i<sizeof(codecs)/sizeof(*codecs); ++i)
+  {
+    if (AudioEncoder::isAvailable(codecs[i]) &&
+        AudioDecoder::isAvailable(codecs[i]))
+    {
+      fixtures.push_back(unique_ptr<Bench::Fixture>(
+            new CodecFixture(bench, codecs[i])));
+    }
+  }
+
+  app.runTask(sigc::mem_fun(bench, &Bench::run));
+  app.exec();
+
+  return bench.finish();
+
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
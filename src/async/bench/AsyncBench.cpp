@@ -0,0 +1,592 @@
+/**
+@file	 AsyncBench.cpp
+@brief   A small harness for micro-benchmarks of audio processing code
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/utsname.h>
+#include <time.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <atomic>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncBench.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  std::atomic<uint64_t> alloc_cnt(0);
+
+  double monotonicTime(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+  }
+
+  double median(vector<double> values)
+  {
+    sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    if (values.size() % 2 == 0)
+    {
+      return (values[mid - 1] + values[mid]) / 2.0;
+    }
+    return values[mid];
+  }
+
+  string jsonString(const string& str)
+  {
+    string quoted("\"");
+    for (string::const_iterator it=str.begin(); it!=str.end(); ++it)
+    {
+      if ((*it == '"') || (*it == '\\'))
+      {
+        quoted += '\\';
+      }
+      quoted += *it;
+    }
+    return quoted + "\"";
+  }
+
+  bool jsonField(const string& line, const string& field, string& value)
+  {
+    string key = "\"" + field + "\": ";
+    size_t pos = line.find(key);
+    if (pos == string::npos)
+    {
+      return false;
+    }
+    pos += key.size();
+    if (line[pos] == '"')
+    {
+      size_t end = line.find('"', pos + 1);
+      if (end == string::npos)
+      {
+        return false;
+      }
+      value = line.substr(pos + 1, end - pos - 1);
+    }
+    else
+    {
+      size_t end = line.find_first_of(",}", pos);
+      value = line.substr(pos, end - pos);
+    }
+    return true;
+  }
+} /* anonymous namespace */
+
+
+/*
+ * Count heap allocations. The replacement operators are linked into each
+ * benchmark application together with the harness.
+ */
+void *operator new(size_t size)
+{
+  alloc_cnt.fetch_add(1, memory_order_relaxed);
+  void *ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == 0)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const unsigned WARMUP_BLOCKS = 16;
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+vector<float> Bench::testSignal(size_t count, unsigned sample_rate)
+{
+  vector<float> signal(count);
+  uint32_t seed = 0x5eed1234;
+  for (size_t i=0; i<count; ++i)
+  {
+    seed = seed * 1664525 + 1013904223;
+    float noise = static_cast<int32_t>(seed) / 2147483648.0f;
+    signal[i] = 0.3f * sinf(2.0f * M_PI * 440.0f * i / sample_rate) +
+                0.2f * sinf(2.0f * M_PI * 1700.0f * i / sample_rate) +
+                0.01f * noise;
+  }
+  return signal;
+} /* Bench::testSignal */
+
+
+uint64_t Bench::allocCount(void)
+{
+  return alloc_cnt.load(memory_order_relaxed);
+} /* Bench::allocCount */
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+Bench::Bench(const string& name)
+  : m_name(name), m_min_time(0.2), m_repeat(5), m_threshold(10.0),
+    m_case_idx(0), m_state(STATE_WARMUP), m_blocks(0), m_allocs(0),
+    m_start_time(0.0), m_start_allocs(0)
+{
+} /* Bench::Bench */
+
+
+Bench::~Bench(void)
+{
+} /* Bench::~Bench */
+
+
+Bench::SinkFixture::SinkFixture(Bench& bench, const string& name,
+                                AudioSink *sink, const vector<float>& signal,
+                                unsigned block_size, AudioSource *sink_src)
+  : m_feeder(signal, block_size), m_sink(sink)
+{
+  m_src.registerSink(m_sink.get());
+  if (sink_src != 0)
+  {
+    sink_src->registerSink(&m_out);
+  }
+  bench.add(name, block_size,
+      [this]() { m_src.write(m_feeder.nextBlock(), m_feeder.blockSize()); });
+} /* Bench::SinkFixture::SinkFixture */
+
+
+bool Bench::parseArgs(int argc, const char * const *argv)
+{
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    bool has_value = (i + 1 < argc);
+    if ((arg == "--json") && has_value)
+    {
+      m_json_path = argv[++i];
+    }
+    else if ((arg == "--compare") && has_value)
+    {
+      m_compare_path = argv[++i];
+    }
+    else if ((arg == "--filter") && has_value)
+    {
+      m_filter = argv[++i];
+    }
+    else if ((arg == "--min-time") && has_value)
+    {
+      m_min_time = atof(argv[++i]);
+    }
+    else if ((arg == "--repeat") && has_value)
+    {
+      m_repeat = max(1, atoi(argv[++i]));
+    }
+    else if ((arg == "--threshold") && has_value)
+    {
+      m_threshold = atof(argv[++i]);
+    }
+    else
+    {
+      cerr << "Usage: " << m_name << " [--filter <substring>] "
+              "[--min-time <seconds>] [--repeat <count>]\n"
+              "       [--json <output file>] [--compare <baseline file>] "
+              "[--threshold <percent>]\n";
+      return false;
+    }
+  }
+  return true;
+} /* Bench::parseArgs */
+
+
+void Bench::add(const string& name, unsigned block_size, BlockFunc func)
+{
+  addBatch(name, block_size,
+      [func](unsigned blocks, const DoneFunc& done)
+      {
+        for (unsigned i=0; i<blocks; ++i)
+        {
+          func();
+        }
+        done();
+      });
+} /* Bench::add */
+
+
+void Bench::addBatch(const string& name, unsigned block_size, BatchFunc func)
+{
+  if (name.find(m_filter) == string::npos)
+  {
+    return;
+  }
+  Case c;
+  c.name = name;
+  c.block_size = block_size;
+  c.func = func;
+  m_cases.push_back(c);
+} /* Bench::addBatch */
+
+
+void Bench::run(void)
+{
+  cout << left << setw(48) << "Case" << right << setw(12) << "ns/sample"
+       << setw(12) << "min" << setw(12) << "Msample/s" << setw(14)
+       << "allocs/block" << endl;
+  m_case_idx = 0;
+  nextCase();
+} /* Bench::run */
+
+
+int Bench::finish(void)
+{
+  if (!m_json_path.empty() && !writeJson(m_json_path))
+  {
+    return 1;
+  }
+
+  if (m_compare_path.empty())
+  {
+    return 0;
+  }
+
+  map<string, double> baseline;
+  if (!readJson(m_compare_path, baseline))
+  {
+    return 1;
+  }
+  cout << "\nComparison with " << m_compare_path << " (threshold "
+       << m_threshold << "%):\n";
+  unsigned regressions = 0;
+  for (vector<Result>::const_iterator it=m_results.begin();
+       it!=m_results.end(); ++it)
+  {
+    map<string, double>::const_iterator bit = baseline.find(it->name);
+    if ((bit == baseline.end()) || (bit->second <= 0.0))
+    {
+      cout << left << setw(48) << it->name << "  no baseline" << endl;
+      continue;
+    }
+    double change = 100.0 * (it->ns_per_sample / bit->second - 1.0);
+    bool regression = (change > m_threshold);
+    regressions += regression ? 1 : 0;
+    cout << left << setw(48) << it->name << right << fixed
+         << setprecision(1) << setw(8) << showpos << change << "%"
+         << noshowpos << (regression ? "  REGRESSION" : "") << endl;
+  }
+  return (regressions > 0) ? 2 : 0;
+} /* Bench::finish */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void Bench::nextCase(void)
+{
+  if (m_case_idx >= m_cases.size())
+  {
+    Application::app().quit();
+    return;
+  }
+  m_state = STATE_WARMUP;
+  m_blocks = WARMUP_BLOCKS;
+  m_times.clear();
+  m_allocs = 0;
+  startBatch();
+} /* Bench::nextCase */
+
+
+void Bench::startBatch(void)
+{
+  const Case& c = m_cases[m_case_idx];
+  m_start_allocs = allocCount();
+  m_start_time = monotonicTime();
+  c.func(m_blocks, [this]() { batchDone(); });
+} /* Bench::startBatch */
+
+
+void Bench::batchDone(void)
+{
+  double elapsed = monotonicTime() - m_start_time;
+  uint64_t allocs = allocCount() - m_start_allocs;
+  if (m_state == STATE_MEASURE)
+  {
+    m_times.push_back(elapsed);
+    m_allocs += allocs;
+  }
+  else if (m_state == STATE_CALIBRATE)
+  {
+    m_times.assign(1, elapsed);
+  }
+
+    // Continue from the main loop so that batches do not nest and so that
+    // any deferred work in the measured objects is done between batches
+  Application::app().runTask(mem_fun(*this, &Bench::handleBatchResult));
+} /* Bench::batchDone */
+
+
+void Bench::handleBatchResult(void)
+{
+  const Case& c = m_cases[m_case_idx];
+  switch (m_state)
+  {
+    case STATE_WARMUP:
+      m_state = STATE_CALIBRATE;
+      m_blocks = 1;
+      break;
+
+    case STATE_CALIBRATE:
+    {
+      double elapsed = m_times.back();
+      if (elapsed < m_min_time)
+      {
+        double factor = (elapsed > 0.0) ? 1.2 * m_min_time / elapsed : 10.0;
+        factor = min(max(factor, 2.0), 100.0);
+        m_blocks = static_cast<unsigned>(ceil(m_blocks * factor));
+        break;
+      }
+      m_state = STATE_MEASURE;
+      m_times.clear();
+      break;
+    }
+
+    case STATE_MEASURE:
+    {
+      if (m_times.size() < m_repeat)
+      {
+        break;
+      }
+      double samples = static_cast<double>(m_blocks) * c.block_size;
+      Result res;
+      res.name = c.name;
+      res.block_size = c.block_size;
+      res.blocks = m_blocks;
+      res.ns_per_sample = 1.0e9 * median(m_times) / samples;
+      res.ns_per_sample_min =
+        1.0e9 * *min_element(m_times.begin(), m_times.end()) / samples;
+      res.allocs_per_block =
+        static_cast<double>(m_allocs) / (m_blocks * m_times.size());
+      m_results.push_back(res);
+
+      cout << left << setw(48) << res.name << right << fixed
+           << setprecision(2) << setw(12) << res.ns_per_sample
+           << setw(12) << res.ns_per_sample_min
+           << setw(12) << 1.0e3 / res.ns_per_sample
+           << setw(14) << res.allocs_per_block << endl;
+
+      ++m_case_idx;
+      nextCase();
+      return;
+    }
+  }
+  startBatch();
+} /* Bench::handleBatchResult */
+
+
+bool Bench::writeJson(const string& path) const
+{
+  ofstream os(path.c_str());
+  if (!os)
+  {
+    cerr << "*** ERROR: Could not open JSON output file " << path << endl;
+    return false;
+  }
+
+  struct utsname uts;
+  string machine = (uname(&uts) == 0) ? uts.machine : "unknown";
+
+    // One result per line to keep the file easy to diff and to read back
+  os << "{\n"
+     << "  \"benchmark\": " << jsonString(m_name) << ",\n"
+     << "  \"machine\": " << jsonString(machine) << ",\n"
+#ifdef __VERSION__
+     << "  \"compiler\": " << jsonString(__VERSION__) << ",\n"
+#endif
+     << "  \"internal_sample_rate\": " << INTERNAL_SAMPLE_RATE << ",\n"
+     << "  \"min_time\": " << m_min_time << ",\n"
+     << "  \"repeat\": " << m_repeat << ",\n"
+     << "  \"results\": [\n";
+  os << setprecision(4) << fixed;
+  for (size_t i=0; i<m_results.size(); ++i)
+  {
+    const Result& res = m_results[i];
+    os << "    {\"name\": " << jsonString(res.name)
+       << ", \"block_size\": " << res.block_size
+       << ", \"blocks\": " << res.blocks
+       << ", \"ns_per_sample\": " << res.ns_per_sample
+       << ", \"ns_per_sample_min\": " << res.ns_per_sample_min
+       << ", \"allocs_per_block\": " << res.allocs_per_block
+       << "}" << ((i + 1 < m_results.size()) ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+  return os.good();
+} /* Bench::writeJson */
+
+
+bool Bench::readJson(const string& path,
+                     map<string, double>& ns_per_sample) const
+{
+  ifstream is(path.c_str());
+  if (!is)
+  {
+    cerr << "*** ERROR: Could not open baseline file " << path << endl;
+    return false;
+  }
+  string line;
+  while (getline(is, line))
+  {
+    string name, value;
+    if (jsonField(line, "name", name) &&
+        jsonField(line, "ns_per_sample", value))
+    {
+      ns_per_sample[name] = atof(value.c_str());
+    }
+  }
+  return true;
+} /* Bench::readJson */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,401 @@
+/**
+@file	 AsyncBench.h
+@brief   A small harness for micro-benchmarks of audio processing code
+@author  agent
+@date	 2026-10-18
+
+This file contains the harness used by the benchmark applications. It is not
+part of the installed Async library.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_BENCH_INCLUDED
+#define ASYNC_BENCH_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSource.h>
+#include <AsyncAudioSink.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A small harness for micro-benchmarks of audio processing code
+@author agent
+@date   2026-10-18
+
+Each benchmark case process blocks of samples. The harness first find the
+number of blocks needed to run for at least the minimum time and then run
+that number of blocks a number of times. The median and the minimum time per
+sample is reported together with the number of heap allocations per block.
+All input signals are generated from a fixed seed so that the results of
+different builds can be compared.
+
+The cases are run from the Async main loop so that audio components that
+depend on timers or deferred tasks can be measured too. Such cases are added
+using addBatch and must call the done function when all blocks have been
+processed.
+
+\code
+Bench bench("MyBench");
+if (!bench.parseArgs(argc, argv))
+{
+  exit(1);
+}
+vector<unique_ptr<Bench::Fixture> > fixtures;
+fixtures.push_back(unique_ptr<Bench::Fixture>(new Bench::SinkFixture(
+    bench, "MyFilter", new MyFilter, Bench::testSignal(12800, 16000), 320)));
+Application::app().runTask(mem_fun(bench, &Bench::run));
+app.exec();
+return bench.finish();
+\endcode
+
+The results can be written as JSON using the --json option and a previous
+JSON file can be given using the --compare option. The exit status is then 2
+if any case is slower than the baseline by more than the threshold.
+*/
+class Bench : public sigc::trackable
+{
+  public:
+    typedef std::function<void(void)>                     BlockFunc;
+    typedef std::function<void(void)>                     DoneFunc;
+    typedef std::function<void(unsigned, const DoneFunc&)> BatchFunc;
+
+    /**
+     * @brief   An audio source that write blocks given to it
+     */
+    class Source : public AudioSource
+    {
+      public:
+        int write(const float *samples, int count)
+        {
+          return sinkWriteSamples(samples, count);
+        }
+        void flush(void) { sinkFlushSamples(); }
+        virtual void resumeOutput(void) {}
+        virtual void allSamplesFlushed(void) {}
+    };
+
+    /**
+     * @brief   An audio sink that accept and count all samples
+     *
+     * The received signal is emitted for each block of samples written to
+     * the sink.
+     */
+    class Sink : public AudioSink
+    {
+      public:
+        Sink(void) : m_samples(0) {}
+        virtual int writeSamples(const float *samples, int count)
+        {
+          m_samples += count;
+          received(samples, count);
+          return count;
+        }
+        virtual void flushSamples(void) { sourceAllSamplesFlushed(); }
+        uint64_t samples(void) const { return m_samples; }
+
+        sigc::signal<void, const float*, int> received;
+
+      private:
+        uint64_t m_samples;
+    };
+
+    /**
+     * @brief   The base class for the objects that set up benchmark cases
+     *
+     * The constructor of each fixture set up the objects to benchmark and
+     * add the cases. The fixture must live until all cases have been run.
+     */
+    class Fixture
+    {
+      public:
+        virtual ~Fixture(void) {}
+    };
+
+    /**
+     * @brief   Hand out a looping signal one block at a time
+     *
+     * The signal must be at least one block long. A partial block at the end
+     * of the signal is skipped.
+     */
+    class Feeder
+    {
+      public:
+        /**
+         * The length of the test signal, in blocks, used by the constructor
+         * that generate the signal
+         */
+        static const unsigned SIGNAL_BLOCKS = 50;
+
+        Feeder(const std::vector<float>& signal, unsigned block_size)
+          : m_signal(signal), m_block_size(block_size), m_pos(0)
+        {
+        }
+        Feeder(unsigned block_size, unsigned sample_rate)
+          : m_signal(testSignal(SIGNAL_BLOCKS * block_size, sample_rate)),
+            m_block_size(block_size), m_pos(0)
+        {
+        }
+
+        const float *nextBlock(void)
+        {
+          const float *block = &m_signal[m_pos];
+          m_pos += m_block_size;
+          if (m_pos + m_block_size > m_signal.size())
+          {
+            m_pos = 0;
+          }
+          return block;
+        }
+        unsigned blockSize(void) const { return m_block_size; }
+
+      private:
+        std::vector<float>  m_signal;
+        unsigned            m_block_size;
+        size_t              m_pos;
+    };
+
+    /**
+     * @brief   A case that write a signal, block by block, to an audio sink
+     *
+     * The fixture take ownership of the sink. If the sink is an audio
+     * processor, give it as the source too so that its output is terminated
+     * by a Bench::Sink.
+     */
+    class SinkFixture : public Fixture
+    {
+      public:
+        SinkFixture(Bench& bench, const std::string& name, AudioSink *sink,
+                    const std::vector<float>& signal, unsigned block_size,
+                    AudioSource *sink_src=0);
+
+      private:
+        Feeder                      m_feeder;
+        Source                      m_src;
+        std::unique_ptr<AudioSink>  m_sink;
+        Sink                        m_out;
+    };
+
+    /**
+     * @brief   Generate a reproducible test signal
+     * @param   count       The number of samples to generate
+     * @param   sample_rate The sample rate in Hz
+     * @return  Returns two tones, 440Hz and 1700Hz, plus white noise
+     */
+    static std::vector<float> testSignal(size_t count, unsigned sample_rate);
+
+    /**
+     * @brief   Get the number of heap allocations made by the process
+     * @return  Returns the number of calls to operator new
+     */
+    static uint64_t allocCount(void);
+
+    /**
+     * @brief 	Constructor
+     * @param 	name The name of the benchmark application
+     */
+    explicit Bench(const std::string& name);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~Bench(void);
+
+    /**
+     * @brief   Parse command line arguments
+     * @param   argc  The number of arguments
+     * @param   argv  The arguments
+     * @return  Returns \em true on success or \em false on error
+     */
+    bool parseArgs(int argc, const char * const *argv);
+
+    /**
+     * @brief   Add a benchmark case that process one block per call
+     * @param   name        The name of the case
+     * @param   block_size  The number of samples in each block
+     * @param   func        The function to call for each block
+     */
+    void add(const std::string& name, unsigned block_size, BlockFunc func);
+
+    /**
+     * @brief   Add a benchmark case that process a number of blocks
+     * @param   name        The name of the case
+     * @param   block_size  The number of samples in each block
+     * @param   func        The function to call to process a number of blocks
+     *
+     * The function is called with the number of blocks to process and a
+     * function that must be called when they have been processed. The done
+     * function may be called later from the main loop.
+     */
+    void addBatch(const std::string& name, unsigned block_size,
+                  BatchFunc func);
+
+    /**
+     * @brief   Run all selected cases
+     *
+     * Must be called from the main loop. Application::quit is called when
+     * all cases have been run.
+     */
+    void run(void);
+
+    /**
+     * @brief   Print and write the results
+     * @return  Returns the exit status for the application
+     */
+    int finish(void);
+
+  private:
+    struct Case
+    {
+      std::string name;
+      unsigned    block_size;
+      BatchFunc   func;
+    };
+    struct Result
+    {
+      std::string name;
+      unsigned    block_size;
+      unsigned    blocks;
+      double      ns_per_sample;
+      double      ns_per_sample_min;
+      double      allocs_per_block;
+    };
+    typedef enum
+    {
+      STATE_WARMUP, STATE_CALIBRATE, STATE_MEASURE
+    } State;
+
+    std::string               m_name;
+    std::string               m_json_path;
+    std::string               m_compare_path;
+    std::string               m_filter;
+    double                    m_min_time;
+    unsigned                  m_repeat;
+    double                    m_threshold;
+    std::vector<Case>         m_cases;
+    std::vector<Result>       m_results;
+    size_t                    m_case_idx;
+    State                     m_state;
+    unsigned                  m_blocks;
+    std::vector<double>       m_times;
+    uint64_t                  m_allocs;
+    double                    m_start_time;
+    uint64_t                  m_start_allocs;
+
+    Bench(const Bench&);
+    Bench& operator=(const Bench&);
+    void nextCase(void);
+    void startBatch(void);
+    void batchDone(void);
+    void handleBatchResult(void);
+    bool writeJson(const std::string& path) const;
+    bool readJson(const std::string& path,
+                  std::map<std::string, double>& ns_per_sample) const;
+
+};  /* class Bench */
+
+
+} /* namespace */
+
+#endif /* ASYNC_BENCH_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -85,6 +85,7 @@ class Timer;
 class FdWatch;
 class DnsLookup;
 class DnsLookupWorker;
+class LoopMonitor;
 
 
 /****************************************************************************
@@ -177,7 +178,37 @@ class Application : public sigc::trackable
      * and the second is an integer.
      */
     void runTask(sigc::slot<void> task);
-    
+
+    /**
+     * @brief   Enable or disable the virtual clock
+     * @param   enable Set to \em true to enable the virtual clock
+     * @return  Returns \em true on success or \em false if not supported
+     *
+     * When the virtual clock is enabled, timers are no longer driven by the
+     * system clock. Instead, as soon as there is no file descriptor activity
+     * pending, the time is advanced directly to the expiration time of the
+     * next timer. This makes it possible to run an application faster than
+     * real time in a deterministic way, e.g. when processing audio from a
+     * file. Not all application types support a virtual clock.
+     */
+    virtual bool setVirtualClock(bool enable) { return !enable; }
+
+    /**
+     * @brief   Check if the virtual clock is enabled
+     * @return  Returns \em true if the virtual clock is enabled
+     */
+    virtual bool virtualClockEnabled(void) const { return false; }
+
+    /**
+     * @brief   Get the main loop monitor
+     * @return  Returns the loop monitor or 0 if not supported
+     *
+     * The loop monitor collect statistics about the main loop, like how long
+     * each iteration take and how late timers fire. It is disabled by
+     * default. Not all application types support loop monitoring.
+     */
+    virtual LoopMonitor *loopMonitor(void) { return 0; }
+
   protected:
     void clearTasks(void);
     
@@ -44,6 +44,8 @@ An example of how to use the  Async::FdWatch class
 
 #include <sigc++/sigc++.h>
 
+#include <string>
+
 
 /****************************************************************************
  *
@@ -200,6 +202,21 @@ class FdWatch : public sigc::trackable
      */
     void setFd(int fd, FdWatchType type);
 
+    /**
+     * @brief Set a name for the watch
+     * @param name The name of the watch
+     *
+     * The name is used to identify the watch callback in the statistics
+     * collected by the main loop monitor (see Async::LoopMonitor).
+     */
+    void setName(const std::string& name) { m_name = name; }
+
+    /**
+     * @brief Get the name of the watch
+     * @return Returns the name of the watch or an empty string if not set
+     */
+    const std::string& name(void) const { return m_name; }
+
     /**
      * @brief Signal to indicate that the descriptor is active
      * @param watch Pointer to the watch object
@@ -213,6 +230,7 @@ class FdWatch : public sigc::trackable
     int       	m_fd;
     FdWatchType m_type;
     bool      	m_enabled;
+    std::string m_name;
   
 };  /* class FdWatch */
 
@@ -32,8 +32,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/uio.h>
+
 #include <cstring>
 #include <cerrno>
+#include <cassert>
 
 
 /****************************************************************************
@@ -134,10 +137,6 @@ FramedTcpConnection::FramedTcpConnection(
 
 FramedTcpConnection::~FramedTcpConnection(void)
 {
-  for (auto& item : m_txq)
-  {
-    delete item;
-  }
   m_txq.clear();
 } /* FramedTcpConnection::~FramedTcpConnection */
 
@@ -176,42 +175,14 @@ int FramedTcpConnection::write(const void *buf, int count)
   {
     return 0;
   }
-  else if (static_cast<uint32_t>(count) > m_max_frame_size)
-  {
-    errno = EMSGSIZE;
-    return -1;
-  }
-
-  QueueItem *qi = new QueueItem(buf, count);
-  if (m_txq.empty())
-  {
-    int ret = TcpConnection::write(qi->m_buf, qi->m_size);
-    //cout << "###   count=" << (qi->m_size-qi->m_pos) << " ret=" << ret << endl;
-    if (ret < 0)
-    {
-      delete qi;
-      qi = 0;
-      return -1;
-    }
-    if (ret >= qi->m_size)
-    {
-      delete qi;
-      qi = 0;
-    }
-    else
-    {
-      //cout << "### Not all bytes were sent: count=" << count
-      //     << " ret=" << ret << endl;
-      qi->m_pos += ret;
-    }
-  }
+  return writeFrame(buf, count, Frame());
+} /* FramedTcpConnection::write */
 
-  if (qi != 0)
-  {
-    m_txq.push_back(qi);
-  }
 
-  return count;
+int FramedTcpConnection::write(const Frame& frame)
+{
+  assert(frame);
+  return writeFrame(frame->data(), frame->size(), frame);
 } /* FramedTcpConnection::write */
 
 
@@ -289,29 +260,122 @@ int FramedTcpConnection::onDataReceived(void *buf, int count)
  *
  ****************************************************************************/
 
+void FramedTcpConnection::setHeader(uint8_t *hdr, uint32_t count)
+{
+  hdr[0] = count >> 24;
+  hdr[1] = (count >> 16) & 0xff;
+  hdr[2] = (count >> 8) & 0xff;
+  hdr[3] = count & 0xff;
+} /* FramedTcpConnection::setHeader */
+
+
+int FramedTcpConnection::QueueItem::fillIov(struct iovec *iov) const
+{
+  int cnt = 0;
+  if (m_pos < HEADER_SIZE)
+  {
+    iov[cnt].iov_base = const_cast<uint8_t*>(m_hdr) + m_pos;
+    iov[cnt].iov_len = HEADER_SIZE - m_pos;
+    ++cnt;
+  }
+  size_t data_pos = (m_pos > HEADER_SIZE) ? m_pos - HEADER_SIZE : 0;
+  if (data_pos < m_frame->size())
+  {
+    iov[cnt].iov_base = const_cast<char*>(m_frame->data()) + data_pos;
+    iov[cnt].iov_len = m_frame->size() - data_pos;
+    ++cnt;
+  }
+  return cnt;
+} /* FramedTcpConnection::QueueItem::fillIov */
+
+
+int FramedTcpConnection::writeFrame(const void *buf, int count,
+                                    const Frame& frame)
+{
+  if (static_cast<uint32_t>(count) > m_max_frame_size)
+  {
+    errno = EMSGSIZE;
+    return -1;
+  }
+
+  size_t pos = 0;
+  if (m_txq.empty())
+  {
+      // Send the length header and the frame data in one go, directly from
+      // the caller's buffer
+    uint8_t hdr[HEADER_SIZE];
+    setHeader(hdr, count);
+    struct iovec iov[2];
+    iov[0].iov_base = hdr;
+    iov[0].iov_len = HEADER_SIZE;
+    iov[1].iov_base = const_cast<void*>(buf);
+    iov[1].iov_len = count;
+    int ret = TcpConnection::writev(iov, 2);
+    //cout << "###   count=" << (HEADER_SIZE+count) << " ret=" << ret << endl;
+    if (ret < 0)
+    {
+      return -1;
+    }
+    pos = ret;
+    if (pos >= HEADER_SIZE + count)
+    {
+      return count;
+    }
+  }
+
+    // The data only has to be copied if the caller did not give us a
+    // shared frame
+  m_txq.push_back(QueueItem(frame ? frame : makeFrame(buf, count), pos));
+
+  return count;
+} /* FramedTcpConnection::writeFrame */
+
+
 void FramedTcpConnection::onSendBufferFull(bool is_full)
 {
   //cout << "### FramedTcpConnection::onSendBufferFull: is_full="
   //     << is_full << "\n";
-  if (!is_full)
+  if (is_full)
+  {
+    return;
+  }
+
+  while (!m_txq.empty())
   {
-    while (!m_txq.empty())
+      // Send as many queued frames as possible in one system call
+    struct iovec iov[MAX_IOV_CNT];
+    int iovcnt = 0;
+    size_t total = 0;
+    for (TxQueue::const_iterator it = m_txq.begin();
+         (it != m_txq.end()) && (iovcnt + 2 <= MAX_IOV_CNT); ++it)
     {
-      QueueItem *qi = m_txq.front();
-      int ret = TcpConnection::write(qi->m_buf+qi->m_pos, qi->m_size-qi->m_pos);
-      //cout << "###   count=" << (qi->m_size-qi->m_pos) << " ret=" << ret << endl;
-      if (ret <= 0)
-      {
-        return;
-      }
-      qi->m_pos += ret;
-      if (qi->m_pos < qi->m_size)
+      iovcnt += it->fillIov(iov + iovcnt);
+      total += it->size() - it->m_pos;
+    }
+    int ret = TcpConnection::writev(iov, iovcnt);
+    //cout << "###   count=" << total << " ret=" << ret << endl;
+    if (ret <= 0)
+    {
+      return;
+    }
+
+    size_t written = ret;
+    while (written > 0)
+    {
+      QueueItem& qi = m_txq.front();
+      size_t left = qi.size() - qi.m_pos;
+      if (written < left)
       {
+        qi.m_pos += written;
         break;
       }
+      written -= left;
       m_txq.pop_front();
-      delete qi;
-      qi = 0;
+    }
+
+    if (static_cast<size_t>(ret) < total)
+    {
+      break;
     }
   }
 } /* FramedTcpConnection::onSendBufferFull */
@@ -319,10 +383,6 @@ void FramedTcpConnection::onSendBufferFull(bool is_full)
 
 void FramedTcpConnection::disconnectCleanup(void)
 {
-  for (TxQueue::iterator it = m_txq.begin(); it != m_txq.end(); ++it)
-  {
-    delete *it;
-  }
   m_txq.clear();
 } /* FramedTcpConnection::disconnectCleanup */
 
@@ -46,6 +46,8 @@ An example of how to use the FramedTcpConnection class in a server
 #include <stdint.h>
 #include <vector>
 #include <deque>
+#include <string>
+#include <memory>
 #include <cstring>
 
 
@@ -131,6 +133,38 @@ that only want to see completely transfered messages at the other end.
 class FramedTcpConnection : public TcpConnection
 {
   public:
+    /**
+     * @brief A reference counted, immutable frame
+     *
+     * A frame that should be sent on many connections, like a message that
+     * is broadcast to all clients of a server, can be created once and then
+     * be written to all connections. The frame data is shared by the transmit
+     * queues of all connections so it is never copied per connection.
+     */
+    using Frame = std::shared_ptr<const std::string>;
+
+    /**
+     * @brief   Create a frame by copying a buffer
+     * @param   buf The buffer containing the frame data
+     * @param   count The number of bytes in the buffer
+     * @return  Returns the new frame
+     */
+    static Frame makeFrame(const void *buf, int count)
+    {
+      return std::make_shared<const std::string>(
+          reinterpret_cast<const char*>(buf), count);
+    }
+
+    /**
+     * @brief   Create a frame by taking over a string
+     * @param   data The frame data, e.g. the string from a packed message
+     * @return  Returns the new frame
+     */
+    static Frame makeFrame(std::string&& data)
+    {
+      return std::make_shared<const std::string>(std::move(data));
+    }
+
     /**
      * @brief 	Constructor
      * @param 	recv_buf_len  The length of the receiver buffer to use
@@ -187,6 +221,17 @@ class FramedTcpConnection : public TcpConnection
      */
     virtual int write(const void *buf, int count) override;
 
+    /**
+     * @brief 	Send a shared frame on the TCP connection
+     * @param 	frame The frame to send
+     * @return	Return bytes written or -1 on failure
+     *
+     * This function work just like the write function above but the frame
+     * data is not copied if it cannot be sent immediately. A reference to the
+     * frame is kept in the transmit queue instead.
+     */
+    int write(const Frame& frame);
+
     /**
      * @brief 	A signal that is emitted when a connection has been terminated
      * @param 	con   	The connection object
@@ -256,27 +301,24 @@ class FramedTcpConnection : public TcpConnection
 
   private:
     static const uint32_t DEFAULT_MAX_FRAME_SIZE = 1024 * 1024; // 1MB
+    static const size_t   HEADER_SIZE = sizeof(uint32_t);
+    static const int      MAX_IOV_CNT = 64;
 
     struct QueueItem
     {
-      char* m_buf;
-      int   m_size;
-      int   m_pos;
+      uint8_t m_hdr[HEADER_SIZE];
+      Frame   m_frame;
+      size_t  m_pos;
 
-      QueueItem(const void* buf, int count)
-        : m_buf(0), m_size(4+count), m_pos(0)
+      QueueItem(const Frame& frame, size_t pos=0)
+        : m_frame(frame), m_pos(pos)
       {
-        m_buf = new char[4+count];
-        char *ptr = m_buf;
-        *ptr++ = static_cast<uint32_t>(count) >> 24;
-        *ptr++ = (static_cast<uint32_t>(count) >> 16) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count) >> 8) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count)) & 0xff;
-        std::memcpy(ptr, buf, count);
+        setHeader(m_hdr, frame->size());
       }
-      ~QueueItem(void) { delete [] m_buf; }
+      size_t size(void) const { return HEADER_SIZE + m_frame->size(); }
+      int fillIov(struct iovec *iov) const;
     };
-    typedef std::deque<QueueItem*> TxQueue;
+    typedef std::deque<QueueItem> TxQueue;
 
     uint32_t              m_max_frame_size;
     bool                  m_size_received;
@@ -285,6 +327,8 @@ class FramedTcpConnection : public TcpConnection
     TxQueue               m_txq;
 
     FramedTcpConnection(const FramedTcpConnection&) = delete;
+    static void setHeader(uint8_t *hdr, uint32_t count);
+    int writeFrame(const void *buf, int count, const Frame& frame);
     void onSendBufferFull(bool is_full);
     void disconnectCleanup(void);
 
@@ -30,6 +30,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/uio.h>
+
+#include <cstdio>
 #include <cstring>
 #include <cerrno>
 #include <sstream>
@@ -232,13 +235,20 @@ bool HttpServerConnection::write(const char* buf, int len)
   int ret = -1;
   if (m_chunked)
   {
-    std::ostringstream os;
-    //os << hex << len << ";tg=240;talker=SM0SVX\r\n";
-    os << hex << len << "\r\n";
-    ret = TcpConnection::write(os.str().c_str(), os.str().size());
-    ret += TcpConnection::write(buf, len);
-    ret += TcpConnection::write("\r\n", 2);
-    len += os.str().size() + 2;
+      // Send the chunk header, data and trailer using one system call. This
+      // matter when the same data is written to many connections.
+    char chunk_head[16];
+    int head_len = snprintf(chunk_head, sizeof(chunk_head), "%x\r\n", len);
+    char chunk_tail[] = "\r\n";
+    struct iovec iov[3];
+    iov[0].iov_base = chunk_head;
+    iov[0].iov_len = head_len;
+    iov[1].iov_base = const_cast<char*>(buf);
+    iov[1].iov_len = len;
+    iov[2].iov_base = chunk_tail;
+    iov[2].iov_len = 2;
+    ret = TcpConnection::writev(iov, 3);
+    len += head_len + 2;
   }
   else
   {
@@ -438,6 +448,7 @@ void HttpServerConnection::onSendBufferFull(bool is_full)
   //    qi = 0;
   //  }
   //}
+  sendBufferFull(is_full);
 } /* HttpServerConnection::onSendBufferFull */
 
 
@@ -462,6 +473,8 @@ const char* HttpServerConnection::codeToString(unsigned code)
       return "Not Acceptable";
     case 501:
       return "Not Implemented";
+    case 503:
+      return "Service Unavailable";
     default:
       return "?";
   }
@@ -289,9 +289,18 @@ class HttpServerConnection : public TcpConnection
      */
     sigc::signal<void, HttpServerConnection *, Request&> requestReceived;
 
-  protected:
+    /**
+     * @brief   A signal that is emitted when the send buffer is full
+     * @param   is_full Set to \em true if the buffer is full
+     *
+     * There is no send queue in this class so data written while the send
+     * buffer of the socket is full is lost. The signal is emitted with
+     * is_full set to \em true when a write could not be completed. When the
+     * socket is writable again, it is emitted with is_full set to \em false.
+     */
     sigc::signal<void, bool> sendBufferFull;
 
+  protected:
     /**
      * @brief   Disconnect from the remote peer
      *
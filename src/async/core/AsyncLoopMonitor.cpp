@@ -0,0 +1,468 @@
+/**
+@file	 AsyncLoopMonitor.cpp
+@brief   Instrumentation of the application main loop
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncLoopMonitor.h"
+#include "AsyncTimer.h"
+#include "AsyncFdWatch.h"
+#include "AsyncConfig.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  const double bin_limits[LoopMonitor::Histogram::BIN_CNT] =
+  {
+    0.1, 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0, 200.0, 500.0, -1.0
+  };
+
+  double timespecDiffMs(const struct timespec& t1, const struct timespec& t2)
+  {
+    return (t1.tv_sec - t2.tv_sec) * 1000.0 +
+           (t1.tv_nsec - t2.tv_nsec) / 1000000.0;
+  }
+
+  typedef pair<string, const LoopMonitor::CallbackStats*> CallbackEntry;
+
+  bool slowerCallback(const CallbackEntry& e1, const CallbackEntry& e2)
+  {
+    return e1.second->max_wall_ms > e2.second->max_wall_ms;
+  }
+
+} /* anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * LoopMonitor::Histogram
+ *
+ ****************************************************************************/
+
+double LoopMonitor::Histogram::binLimit(unsigned bin)
+{
+  return bin_limits[bin];
+} /* LoopMonitor::Histogram::binLimit */
+
+
+void LoopMonitor::Histogram::add(double ms)
+{
+  unsigned bin = 0;
+  while ((bin < BIN_CNT - 1) && (ms > bin_limits[bin]))
+  {
+    ++bin;
+  }
+  ++m_bins[bin];
+  ++m_count;
+  m_sum_ms += ms;
+  if (ms > m_max_ms)
+  {
+    m_max_ms = ms;
+  }
+} /* LoopMonitor::Histogram::add */
+
+
+void LoopMonitor::Histogram::reset(void)
+{
+  fill(m_bins, m_bins + BIN_CNT, 0);
+  m_count = 0;
+  m_sum_ms = 0.0;
+  m_max_ms = 0.0;
+} /* LoopMonitor::Histogram::reset */
+
+
+void LoopMonitor::Histogram::print(ostream& os) const
+{
+  os << "count=" << m_count
+     << " mean=" << fixed << setprecision(3) << meanMs() << "ms"
+     << " max=" << m_max_ms << "ms" << endl;
+  os << " ";
+  for (unsigned bin=0; bin<BIN_CNT; ++bin)
+  {
+    if (bin_limits[bin] < 0.0)
+    {
+      os << " >" << setprecision(0) << bin_limits[bin-1];
+    }
+    else
+    {
+      os << " <=" << setprecision(bin_limits[bin] < 1.0 ? 1 : 0)
+         << bin_limits[bin];
+    }
+    os << ":" << m_bins[bin];
+  }
+  os << endl;
+} /* LoopMonitor::Histogram::print */
+
+
+
+/****************************************************************************
+ *
+ * LoopMonitor::CallbackTimer
+ *
+ ****************************************************************************/
+
+LoopMonitor::CallbackTimer::CallbackTimer(LoopMonitor& mon,
+                                          const Timer *timer)
+  : m_mon(mon), m_active(mon.callbackAccounting())
+{
+  if (m_active)
+  {
+    m_name = callbackName(timer);
+    start();
+  }
+} /* LoopMonitor::CallbackTimer::CallbackTimer */
+
+
+LoopMonitor::CallbackTimer::CallbackTimer(LoopMonitor& mon,
+                                          const FdWatch *watch)
+  : m_mon(mon), m_active(mon.callbackAccounting())
+{
+  if (m_active)
+  {
+    m_name = callbackName(watch);
+    start();
+  }
+} /* LoopMonitor::CallbackTimer::CallbackTimer */
+
+
+void LoopMonitor::CallbackTimer::done(void)
+{
+  if (!m_active)
+  {
+    return;
+  }
+  struct timespec wall, cpu;
+  clock_gettime(CLOCK_MONOTONIC, &wall);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+  m_mon.addCallback(m_name, timespecDiffMs(wall, m_wall),
+                    timespecDiffMs(cpu, m_cpu));
+} /* LoopMonitor::CallbackTimer::done */
+
+
+void LoopMonitor::CallbackTimer::start(void)
+{
+  clock_gettime(CLOCK_MONOTONIC, &m_wall);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &m_cpu);
+} /* LoopMonitor::CallbackTimer::start */
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+double LoopMonitor::monotonicMs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+} /* LoopMonitor::monotonicMs */
+
+
+string LoopMonitor::callbackName(const Timer *timer)
+{
+  if (!timer->name().empty())
+  {
+    return timer->name();
+  }
+  ostringstream ss;
+  ss << "Timer(" << timer->timeout() << "ms)";
+  return ss.str();
+} /* LoopMonitor::callbackName */
+
+
+string LoopMonitor::callbackName(const FdWatch *watch)
+{
+  if (!watch->name().empty())
+  {
+    return watch->name();
+  }
+  ostringstream ss;
+  ss << "FdWatch(fd=" << watch->fd() << ","
+     << ((watch->type() == FdWatch::FD_WATCH_RD) ? "rd" : "wr") << ")";
+  return ss.str();
+} /* LoopMonitor::callbackName */
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+LoopMonitor::LoopMonitor(void)
+  : m_enabled(false), m_cb_accounting(false), m_reset_time(monotonicMs()),
+    m_report_timer(0)
+{
+    // The same bucket limits as the internal histograms, in seconds. The
+    // overflow bin is the implicit +Inf bucket.
+  vector<double> bounds;
+  for (unsigned bin=0; bin<Histogram::BIN_CNT-1; ++bin)
+  {
+    bounds.push_back(Histogram::binLimit(bin) / 1000.0);
+  }
+  m_iteration_metric = Metrics::instance().histogram(
+      "async_loop_iteration_seconds",
+      "The processing time of each main loop iteration", bounds);
+  m_lateness_metric = Metrics::instance().histogram(
+      "async_timer_lateness_seconds",
+      "The time between the expiry time and the firing of a timer", bounds);
+} /* LoopMonitor::LoopMonitor */
+
+
+LoopMonitor::~LoopMonitor(void)
+{
+  delete m_report_timer;
+} /* LoopMonitor::~LoopMonitor */
+
+
+void LoopMonitor::configure(Config& cfg, const string& section)
+{
+  unsigned level = 0;
+  cfg.getValue(section, "LOOP_MONITOR", level);
+  setEnabled(level > 0);
+  setCallbackAccounting(level > 1);
+
+  unsigned interval = 0;
+  cfg.getValue(section, "LOOP_STATS_INTERVAL", interval);
+  setReportInterval(m_enabled ? interval : 0);
+} /* LoopMonitor::configure */
+
+
+void LoopMonitor::setEnabled(bool enable)
+{
+  if (enable && !m_enabled)
+  {
+    reset();
+  }
+  m_enabled = enable;
+  if (!m_enabled)
+  {
+    m_cb_accounting = false;
+  }
+} /* LoopMonitor::setEnabled */
+
+
+void LoopMonitor::setCallbackAccounting(bool enable)
+{
+  if (enable)
+  {
+    setEnabled(true);
+  }
+  m_cb_accounting = enable;
+} /* LoopMonitor::setCallbackAccounting */
+
+
+void LoopMonitor::setReportInterval(unsigned interval_s)
+{
+  delete m_report_timer;
+  m_report_timer = 0;
+  if (interval_s > 0)
+  {
+    m_report_timer = new Timer(1000 * interval_s, Timer::TYPE_PERIODIC);
+    m_report_timer->setName("LoopMonitor");
+    m_report_timer->expired.connect(
+        sigc::mem_fun(*this, &LoopMonitor::printReport));
+  }
+} /* LoopMonitor::setReportInterval */
+
+
+void LoopMonitor::addCallback(const string& name, double wall_ms,
+                              double cpu_ms)
+{
+  CallbackStats& stats = m_callbacks[name];
+  ++stats.count;
+  stats.wall_ms += wall_ms;
+  stats.cpu_ms += cpu_ms;
+  if (wall_ms > stats.max_wall_ms)
+  {
+    stats.max_wall_ms = wall_ms;
+  }
+} /* LoopMonitor::addCallback */
+
+
+void LoopMonitor::print(ostream& os, size_t top_n) const
+{
+  if (!m_enabled)
+  {
+    os << "Loop monitor disabled" << endl;
+    return;
+  }
+
+  ios_base::fmtflags flags = os.flags();
+  streamsize prec = os.precision();
+
+  os << "Loop statistics for the last " << fixed << setprecision(1)
+     << (monotonicMs() - m_reset_time) / 1000.0 << "s" << endl;
+  os << "Iteration time: ";
+  m_iteration.print(os);
+  os << "Timer lateness: ";
+  m_lateness.print(os);
+
+  if (m_cb_accounting)
+  {
+    vector<CallbackEntry> entries;
+    entries.reserve(m_callbacks.size());
+    for (CallbackMap::const_iterator it=m_callbacks.begin();
+         it!=m_callbacks.end(); ++it)
+    {
+      entries.push_back(make_pair(it->first, &it->second));
+    }
+    size_t cnt = min(top_n, entries.size());
+    partial_sort(entries.begin(), entries.begin() + cnt, entries.end(),
+                 slowerCallback);
+    os << "Slowest callbacks (max/mean wall ms, total cpu ms, count):"
+       << endl;
+    for (size_t i=0; i<cnt; ++i)
+    {
+      const CallbackStats& stats = *entries[i].second;
+      os << "  " << entries[i].first << ": "
+         << setprecision(3) << stats.max_wall_ms << "/"
+         << stats.wall_ms / stats.count << " "
+         << stats.cpu_ms << " " << stats.count << endl;
+    }
+  }
+
+  os.flags(flags);
+  os.precision(prec);
+} /* LoopMonitor::print */
+
+
+void LoopMonitor::reset(void)
+{
+  m_iteration.reset();
+  m_lateness.reset();
+  m_callbacks.clear();
+  m_reset_time = monotonicMs();
+} /* LoopMonitor::reset */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void LoopMonitor::printReport(Timer *t)
+{
+  print(cout);
+  reset();
+} /* LoopMonitor::printReport */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,375 @@
+/**
+@file	 AsyncLoopMonitor.h
+@brief   Instrumentation of the application main loop
+@author  agent
+@date	 2026-10-18
+
+This file contains a class that collect statistics about how long each
+iteration of the application main loop take, how late timers fire and,
+optionally, how much time is spent in each FdWatch and Timer callback.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_LOOP_MONITOR_INCLUDED
+#define ASYNC_LOOP_MONITOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+#include <stdint.h>
+
+#include <string>
+#include <map>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncMetrics.h"
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class Config;
+class Timer;
+class FdWatch;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Instrumentation of the application main loop
+@author agent
+@date   2026-10-18
+
+An object of this class is owned by the application object, if the
+application type support loop monitoring. It is retrieved using
+Async::Application::app().loopMonitor(). When enabled, the main loop record:
+
+  - A histogram of the time spent processing each loop iteration
+  - A histogram of how late timers fire compared to their expiration time
+
+If callback accounting also is enabled, the wall clock time and the CPU time
+of each FdWatch and Timer callback is recorded, keyed by the name set using
+FdWatch::setName or Timer::setName. Callbacks without a name are identified
+by their file descriptor or timeout value.
+
+When disabled, the overhead in the main loop is a test of a boolean per
+callback.
+*/
+class LoopMonitor
+{
+  public:
+    /**
+     * @brief   A histogram of durations
+     */
+    class Histogram
+    {
+      public:
+        static const unsigned BIN_CNT = 12;
+
+        /**
+         * @brief   Get the upper limit of a bin
+         * @param   bin The bin index
+         * @return  Returns the upper limit in milliseconds, or a negative
+         *          value for the last bin which has no upper limit
+         */
+        static double binLimit(unsigned bin);
+
+        Histogram(void) { reset(); }
+        void add(double ms);
+        void reset(void);
+        uint64_t count(void) const { return m_count; }
+        uint64_t binCount(unsigned bin) const { return m_bins[bin]; }
+        double maxMs(void) const { return m_max_ms; }
+        double meanMs(void) const
+        {
+          return (m_count > 0) ? m_sum_ms / m_count : 0.0;
+        }
+        void print(std::ostream& os) const;
+
+      private:
+        uint64_t  m_bins[BIN_CNT];
+        uint64_t  m_count;
+        double    m_sum_ms;
+        double    m_max_ms;
+    };
+
+    /**
+     * @brief   Accumulated statistics for one callback
+     */
+    struct CallbackStats
+    {
+      uint64_t  count;        ///< The number of invocations
+      double    wall_ms;      ///< Total wall clock time
+      double    cpu_ms;       ///< Total CPU time
+      double    max_wall_ms;  ///< The longest single invocation
+
+      CallbackStats(void)
+        : count(0), wall_ms(0.0), cpu_ms(0.0), max_wall_ms(0.0) {}
+    };
+    typedef std::map<std::string, CallbackStats> CallbackMap;
+
+    /**
+     * @brief   Measure the time of one callback invocation
+     *
+     * Create an object of this class on the stack just before the callback
+     * is called and call done() when it returns. The name of the callback is
+     * captured in the constructor since the timer or watch may be deleted by
+     * the callback. Nothing is measured if callback accounting is disabled.
+     */
+    class CallbackTimer
+    {
+      public:
+        CallbackTimer(LoopMonitor& mon, const Timer *timer);
+        CallbackTimer(LoopMonitor& mon, const FdWatch *watch);
+        void done(void);
+
+      private:
+        LoopMonitor&    m_mon;
+        bool            m_active;
+        std::string     m_name;
+        struct timespec m_wall;
+        struct timespec m_cpu;
+
+        void start(void);
+    };
+
+    /**
+     * @brief   Get the time of the monotonic clock in milliseconds
+     * @return  Returns the time in milliseconds
+     */
+    static double monotonicMs(void);
+
+    /**
+     * @brief   Get the accounting name of a timer
+     * @param   timer The timer
+     * @return  Returns the name of the timer or a generated name
+     */
+    static std::string callbackName(const Timer *timer);
+
+    /**
+     * @brief   Get the accounting name of a file descriptor watch
+     * @param   watch The watch
+     * @return  Returns the name of the watch or a generated name
+     */
+    static std::string callbackName(const FdWatch *watch);
+
+    /**
+     * @brief 	Default constructor
+     */
+    LoopMonitor(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~LoopMonitor(void);
+
+    /**
+     * @brief   Configure the monitor from a configuration file
+     * @param   cfg     The configuration object
+     * @param   section The configuration section to read
+     *
+     * The LOOP_MONITOR variable enable the monitor (1) and also callback
+     * accounting (2). LOOP_STATS_INTERVAL set the interval, in seconds, for
+     * printing the statistics to stdout.
+     */
+    void configure(Config& cfg, const std::string& section);
+
+    /**
+     * @brief   Enable or disable the monitor
+     * @param   enable Set to \em true to enable the monitor
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * @brief   Check if the monitor is enabled
+     * @return  Returns \em true if the monitor is enabled
+     */
+    bool isEnabled(void) const { return m_enabled; }
+
+    /**
+     * @brief   Enable or disable callback accounting
+     * @param   enable Set to \em true to enable callback accounting
+     *
+     * Enabling callback accounting also enable the monitor.
+     */
+    void setCallbackAccounting(bool enable);
+
+    /**
+     * @brief   Check if callback accounting is enabled
+     * @return  Returns \em true if callback accounting is enabled
+     */
+    bool callbackAccounting(void) const { return m_cb_accounting; }
+
+    /**
+     * @brief   Set the interval for printing the statistics
+     * @param   interval_s The interval in seconds, 0 to disable
+     *
+     * The statistics are printed to stdout and then reset.
+     */
+    void setReportInterval(unsigned interval_s);
+
+    /**
+     * @brief   Record the processing time of one loop iteration
+     * @param   ms The time in milliseconds
+     */
+    void addIteration(double ms)
+    {
+      m_iteration.add(ms);
+      m_iteration_metric->observe(ms / 1000.0);
+    }
+
+    /**
+     * @brief   Record how late a timer fired
+     * @param   ms The time in milliseconds
+     */
+    void addTimerLateness(double ms)
+    {
+      m_lateness.add(ms);
+      m_lateness_metric->observe(ms / 1000.0);
+    }
+
+    /**
+     * @brief   Record one callback invocation
+     * @param   name    The name of the callback
+     * @param   wall_ms The wall clock time in milliseconds
+     * @param   cpu_ms  The CPU time in milliseconds
+     */
+    void addCallback(const std::string& name, double wall_ms, double cpu_ms);
+
+    /**
+     * @brief   Get the loop iteration time histogram
+     * @return  Returns the histogram
+     */
+    const Histogram& iterationTime(void) const { return m_iteration; }
+
+    /**
+     * @brief   Get the timer lateness histogram
+     * @return  Returns the histogram
+     */
+    const Histogram& timerLateness(void) const { return m_lateness; }
+
+    /**
+     * @brief   Get the callback statistics
+     * @return  Returns the statistics for all callbacks, keyed by name
+     */
+    const CallbackMap& callbacks(void) const { return m_callbacks; }
+
+    /**
+     * @brief   Print the statistics
+     * @param   os    The stream to print to
+     * @param   top_n The number of slowest callbacks to print
+     */
+    void print(std::ostream& os, size_t top_n=10) const;
+
+    /**
+     * @brief   Reset all statistics
+     */
+    void reset(void);
+
+  private:
+    bool                m_enabled;
+    bool                m_cb_accounting;
+    Histogram           m_iteration;
+    Histogram           m_lateness;
+    Metrics::Histogram* m_iteration_metric;
+    Metrics::Histogram* m_lateness_metric;
+    CallbackMap         m_callbacks;
+    double              m_reset_time;
+    Timer*              m_report_timer;
+
+    LoopMonitor(const LoopMonitor&);
+    LoopMonitor& operator=(const LoopMonitor&);
+    void printReport(Timer *t);
+
+};  /* class LoopMonitor */
+
+
+} /* namespace */
+
+#endif /* ASYNC_LOOP_MONITOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
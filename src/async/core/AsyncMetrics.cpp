@@ -0,0 +1,451 @@
+/**
+@file	 AsyncMetrics.cpp
+@brief   A registry of counters, gauges and histograms
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncMetrics.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  void atomicAdd(atomic<double>& var, double delta)
+  {
+    double old_value = var.load(memory_order_relaxed);
+    while (!var.compare_exchange_weak(old_value, old_value + delta,
+                                      memory_order_relaxed))
+    {
+    }
+  }
+
+  void writeValue(ostream& os, double value)
+  {
+    if (std::isinf(value))
+    {
+      os << (value > 0 ? "+Inf" : "-Inf");
+    }
+    else if (std::isnan(value))
+    {
+      os << "NaN";
+    }
+    else
+    {
+      os << value;
+    }
+  }
+
+  void writeSample(ostream& os, const string& name, const string& labels,
+                   const string& extra_label=string())
+  {
+    os << name;
+    if (!labels.empty() || !extra_label.empty())
+    {
+      os << '{' << labels;
+      if (!labels.empty() && !extra_label.empty())
+      {
+        os << ',';
+      }
+      os << extra_label << '}';
+    }
+    os << ' ';
+  }
+
+  string escapeHelp(const string& help)
+  {
+    string escaped;
+    for (string::const_iterator it=help.begin(); it!=help.end(); ++it)
+    {
+      if (*it == '\\')
+      {
+        escaped += "\\\\";
+      }
+      else if (*it == '\n')
+      {
+        escaped += "\\n";
+      }
+      else
+      {
+        escaped += *it;
+      }
+    }
+    return escaped;
+  }
+
+} /* anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Metric types
+ *
+ ****************************************************************************/
+
+void Metrics::Counter::write(ostream& os, const string& name,
+                             const string& labels) const
+{
+  writeSample(os, name, labels);
+  os << value() << "\n";
+} /* Metrics::Counter::write */
+
+
+void Metrics::Gauge::add(double delta)
+{
+  atomicAdd(m_value, delta);
+} /* Metrics::Gauge::add */
+
+
+void Metrics::Gauge::write(ostream& os, const string& name,
+                           const string& labels) const
+{
+  writeSample(os, name, labels);
+  writeValue(os, value());
+  os << "\n";
+} /* Metrics::Gauge::write */
+
+
+Metrics::Histogram::Histogram(const vector<double>& bounds)
+  : m_bounds(bounds), m_buckets(new atomic<uint64_t>[bounds.size() + 1]),
+    m_count(0), m_sum(0.0)
+{
+  sort(m_bounds.begin(), m_bounds.end());
+  for (size_t i=0; i<=m_bounds.size(); ++i)
+  {
+    m_buckets[i].store(0, memory_order_relaxed);
+  }
+} /* Metrics::Histogram::Histogram */
+
+
+void Metrics::Histogram::observe(double value)
+{
+  size_t idx = lower_bound(m_bounds.begin(), m_bounds.end(), value) -
+               m_bounds.begin();
+  m_buckets[idx].fetch_add(1, memory_order_relaxed);
+  m_count.fetch_add(1, memory_order_relaxed);
+  atomicAdd(m_sum, value);
+} /* Metrics::Histogram::observe */
+
+
+void Metrics::Histogram::write(ostream& os, const string& name,
+                               const string& labels) const
+{
+    // Prometheus buckets are cumulative
+  uint64_t cumulative = 0;
+  for (size_t i=0; i<=m_bounds.size(); ++i)
+  {
+    cumulative += m_buckets[i].load(memory_order_relaxed);
+    ostringstream le;
+    le << "le=\"";
+    writeValue(le, (i < m_bounds.size())
+                   ? m_bounds[i] : numeric_limits<double>::infinity());
+    le << "\"";
+    writeSample(os, name + "_bucket", labels, le.str());
+    os << cumulative << "\n";
+  }
+  writeSample(os, name + "_sum", labels);
+  writeValue(os, m_sum.load(memory_order_relaxed));
+  os << "\n";
+  writeSample(os, name + "_count", labels);
+  os << cumulative << "\n";
+} /* Metrics::Histogram::write */
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+Metrics& Metrics::instance(void)
+{
+  static Metrics metrics;
+  return metrics;
+} /* Metrics::instance */
+
+
+vector<double> Metrics::exponentialBuckets(double start, double factor,
+                                           unsigned count)
+{
+  vector<double> bounds;
+  bounds.reserve(count);
+  double bound = start;
+  for (unsigned i=0; i<count; ++i)
+  {
+    bounds.push_back(bound);
+    bound *= factor;
+  }
+  return bounds;
+} /* Metrics::exponentialBuckets */
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+Metrics::Counter *Metrics::counter(const string& name, const string& help,
+                                   const Labels& labels)
+{
+  lock_guard<mutex> lock(m_mutex);
+  Family *fam = family(name, "counter", help);
+  if (fam == 0)
+  {
+    return 0;
+  }
+  unique_ptr<Metric>& metric = fam->metrics[labelString(labels)];
+  if (!metric)
+  {
+    metric.reset(new Counter);
+  }
+  return static_cast<Counter*>(metric.get());
+} /* Metrics::counter */
+
+
+Metrics::Gauge *Metrics::gauge(const string& name, const string& help,
+                               const Labels& labels)
+{
+  lock_guard<mutex> lock(m_mutex);
+  Family *fam = family(name, "gauge", help);
+  if (fam == 0)
+  {
+    return 0;
+  }
+  unique_ptr<Metric>& metric = fam->metrics[labelString(labels)];
+  if (!metric)
+  {
+    metric.reset(new Gauge);
+  }
+  return static_cast<Gauge*>(metric.get());
+} /* Metrics::gauge */
+
+
+Metrics::Histogram *Metrics::histogram(const string& name, const string& help,
+                                       const vector<double>& bounds,
+                                       const Labels& labels)
+{
+  lock_guard<mutex> lock(m_mutex);
+  Family *fam = family(name, "histogram", help);
+  if (fam == 0)
+  {
+    return 0;
+  }
+  unique_ptr<Metric>& metric = fam->metrics[labelString(labels)];
+  if (!metric)
+  {
+    metric.reset(new Histogram(bounds));
+  }
+  return static_cast<Histogram*>(metric.get());
+} /* Metrics::histogram */
+
+
+void Metrics::remove(const string& name)
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_families.erase(name);
+} /* Metrics::remove */
+
+
+void Metrics::writePrometheus(ostream& os)
+{
+  collect();
+
+  lock_guard<mutex> lock(m_mutex);
+  for (FamilyMap::const_iterator it=m_families.begin();
+       it!=m_families.end(); ++it)
+  {
+    const Family& fam = it->second;
+    if (fam.metrics.empty())
+    {
+      continue;
+    }
+    os << "# HELP " << it->first << " " << escapeHelp(fam.help) << "\n";
+    os << "# TYPE " << it->first << " " << fam.type << "\n";
+    for (map<string, unique_ptr<Metric> >::const_iterator mit =
+           fam.metrics.begin();
+         mit != fam.metrics.end(); ++mit)
+    {
+      mit->second->write(os, it->first, mit->first);
+    }
+  }
+} /* Metrics::writePrometheus */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+string Metrics::labelString(const Labels& labels)
+{
+  string str;
+  for (Labels::const_iterator it=labels.begin(); it!=labels.end(); ++it)
+  {
+    if (!str.empty())
+    {
+      str += ',';
+    }
+    str += it->first + "=\"";
+    for (string::const_iterator ch=it->second.begin();
+         ch!=it->second.end(); ++ch)
+    {
+      switch (*ch)
+      {
+        case '\\':
+          str += "\\\\";
+          break;
+        case '"':
+          str += "\\\"";
+          break;
+        case '\n':
+          str += "\\n";
+          break;
+        default:
+          str += *ch;
+          break;
+      }
+    }
+    str += '"';
+  }
+  return str;
+} /* Metrics::labelString */
+
+
+Metrics::Metrics(void)
+{
+} /* Metrics::Metrics */
+
+
+Metrics::Family *Metrics::family(const string& name, const string& type,
+                                 const string& help)
+{
+  Family& fam = m_families[name];
+  if (fam.type.empty())
+  {
+    fam.type = type;
+    fam.help = help;
+  }
+  else if (fam.type != type)
+  {
+    cerr << "*** WARNING: Metric \"" << name << "\" is a " << fam.type
+         << " and cannot be used as a " << type << endl;
+    return 0;
+  }
+  return &fam;
+} /* Metrics::family */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,352 @@
+/**
+@file	 AsyncMetrics.h
+@brief   A registry of counters, gauges and histograms
+@author  agent
+@date	 2026-10-18
+
+This file contains a registry for operational metrics that can be written in
+the Prometheus text exposition format.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_METRICS_INCLUDED
+#define ASYNC_METRICS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <iostream>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A registry of counters, gauges and histograms
+@author agent
+@date   2026-10-18
+
+This class hold all metrics of an application. A metric is looked up, or
+created, once using its name and labels. The returned pointer is then kept by
+the code that update the metric. Updating a metric is done using relaxed
+atomic operations so it is cheap and may be done from any thread.
+
+\code
+static Metrics::Counter *rx_packets = Metrics::instance().counter(
+    "myapp_rx_packets_total", "The number of received packets");
+rx_packets->inc();
+\endcode
+
+Metrics whose values are cheaper to compute when they are read, like the
+number of connected clients, can be updated by a slot connected to the
+\em collect signal, which is emitted just before the metrics are written.
+
+All metrics are written in the Prometheus text exposition format using the
+writePrometheus function. The handleHttpRequest function can be used to
+serve the metrics from an Async::HttpServerConnection.
+*/
+class Metrics
+{
+  public:
+    typedef std::map<std::string, std::string> Labels;
+
+    /**
+     * @brief   The base class for all metric types
+     */
+    class Metric
+    {
+      public:
+        virtual ~Metric(void) {}
+        virtual void write(std::ostream& os, const std::string& name,
+                           const std::string& labels) const = 0;
+    };
+
+    /**
+     * @brief   A monotonically increasing counter
+     */
+    class Counter : public Metric
+    {
+      public:
+        Counter(void) : m_value(0) {}
+        void inc(uint64_t n=1)
+        {
+          m_value.fetch_add(n, std::memory_order_relaxed);
+        }
+        uint64_t value(void) const
+        {
+          return m_value.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const;
+
+      private:
+        std::atomic<uint64_t> m_value;
+    };
+
+    /**
+     * @brief   A value that can go up and down
+     */
+    class Gauge : public Metric
+    {
+      public:
+        Gauge(void) : m_value(0.0) {}
+        void set(double value)
+        {
+          m_value.store(value, std::memory_order_relaxed);
+        }
+        void add(double delta);
+        double value(void) const
+        {
+          return m_value.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const;
+
+      private:
+        std::atomic<double> m_value;
+    };
+
+    /**
+     * @brief   A histogram with fixed bucket upper bounds
+     */
+    class Histogram : public Metric
+    {
+      public:
+        explicit Histogram(const std::vector<double>& bounds);
+        void observe(double value);
+        uint64_t count(void) const
+        {
+          return m_count.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const;
+
+      private:
+        std::vector<double>                       m_bounds;
+        std::unique_ptr<std::atomic<uint64_t>[]>  m_buckets;
+        std::atomic<uint64_t>                     m_count;
+        std::atomic<double>                       m_sum;
+    };
+
+    /**
+     * @brief   Get the application wide metrics registry
+     * @return  Returns the registry
+     */
+    static Metrics& instance(void);
+
+    /**
+     * @brief   Create exponentially growing histogram bucket bounds
+     * @param   start   The upper bound of the first bucket
+     * @param   factor  The factor between the bounds of adjacent buckets
+     * @param   count   The number of buckets
+     * @return  Returns the bucket upper bounds
+     */
+    static std::vector<double> exponentialBuckets(double start, double factor,
+                                                  unsigned count);
+
+    /**
+     * @brief   Serve the metrics on an HTTP connection
+     * @param   con The connection to write the response to
+     * @param   req The received request
+     * @return  Returns \em true if the request was for /metrics and it was
+     *          handled or \em false if not
+     */
+    template <typename ConT, typename ReqT>
+    static bool handleHttpRequest(ConT *con, ReqT& req)
+    {
+      if ((req.target != "/metrics") ||
+          ((req.method != "GET") && (req.method != "HEAD")))
+      {
+        return false;
+      }
+      std::ostringstream os;
+      instance().writePrometheus(os);
+      typename ConT::Response res;
+      res.setContent("text/plain; version=0.0.4", os.str());
+      res.setSendContent(req.method == "GET");
+      res.setCode(200);
+      con->write(res);
+      return true;
+    }
+
+    /**
+     * @brief   Get or create a counter
+     * @param   name    The name of the metric
+     * @param   help    A description of the metric
+     * @param   labels  The labels of this instance of the metric
+     * @return  Returns the counter or 0 if the name is used by another type
+     */
+    Counter *counter(const std::string& name, const std::string& help,
+                     const Labels& labels=Labels());
+
+    /**
+     * @brief   Get or create a gauge
+     * @param   name    The name of the metric
+     * @param   help    A description of the metric
+     * @param   labels  The labels of this instance of the metric
+     * @return  Returns the gauge or 0 if the name is used by another type
+     */
+    Gauge *gauge(const std::string& name, const std::string& help,
+                 const Labels& labels=Labels());
+
+    /**
+     * @brief   Get or create a histogram
+     * @param   name    The name of the metric
+     * @param   help    A description of the metric
+     * @param   bounds  The bucket upper bounds, in increasing order
+     * @param   labels  The labels of this instance of the metric
+     * @return  Returns the histogram or 0 if the name is used by another type
+     *
+     * The bounds are only used when the histogram is created.
+     */
+    Histogram *histogram(const std::string& name, const std::string& help,
+                         const std::vector<double>& bounds,
+                         const Labels& labels=Labels());
+
+    /**
+     * @brief   Remove all instances of a metric
+     * @param   name The name of the metric
+     *
+     * All pointers to the instances of the metric become invalid.
+     */
+    void remove(const std::string& name);
+
+    /**
+     * @brief   Write all metrics in the Prometheus text format
+     * @param   os The stream to write to
+     */
+    void writePrometheus(std::ostream& os);
+
+    /**
+     * @brief   A signal emitted just before the metrics are written
+     *
+     * The signal is emitted from the thread calling writePrometheus, which
+     * normally is the main thread.
+     */
+    sigc::signal<void> collect;
+
+  private:
+    struct Family
+    {
+      std::string type;
+      std::string help;
+      std::map<std::string, std::unique_ptr<Metric> > metrics;
+    };
+    typedef std::map<std::string, Family> FamilyMap;
+
+    std::mutex  m_mutex;
+    FamilyMap   m_families;
+
+    static std::string labelString(const Labels& labels);
+
+    Metrics(void);
+    Metrics(const Metrics&);
+    Metrics& operator=(const Metrics&);
+    Family *family(const std::string& name, const std::string& type,
+                   const std::string& help);
+
+};  /* class Metrics */
+
+
+} /* namespace */
+
+#endif /* ASYNC_METRICS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,202 @@
+/**
+@file	 AsyncMetricsHttpServer.cpp
+@brief   A minimal HTTP server that serve the metrics registry
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncMetricsHttpServer.h"
+#include "AsyncMetrics.h"
+#include "AsyncConfig.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+MetricsHttpServer *MetricsHttpServer::create(Config& cfg,
+                                             const string& section)
+{
+  string port;
+  if (!cfg.getValue(section, "METRICS_HTTP_PORT", port) || port.empty())
+  {
+    return 0;
+  }
+  IpAddress bind_ip;
+  string bind_ip_str;
+  if (cfg.getValue(section, "METRICS_HTTP_BIND_IP", bind_ip_str))
+  {
+    bind_ip = IpAddress(bind_ip_str);
+    if (bind_ip.isEmpty())
+    {
+      cerr << "*** WARNING: Illegal " << section
+           << "/METRICS_HTTP_BIND_IP specified: " << bind_ip_str
+           << ". Binding to all interfaces." << endl;
+    }
+  }
+  cout << "Serving metrics on HTTP port " << port << endl;
+  return new MetricsHttpServer(port, bind_ip);
+} /* MetricsHttpServer::create */
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+MetricsHttpServer::MetricsHttpServer(const string& port_str,
+                                     const IpAddress& bind_ip)
+  : m_server(port_str, bind_ip)
+{
+  m_server.clientConnected.connect(
+      sigc::mem_fun(*this, &MetricsHttpServer::clientConnected));
+} /* MetricsHttpServer::MetricsHttpServer */
+
+
+MetricsHttpServer::~MetricsHttpServer(void)
+{
+} /* MetricsHttpServer::~MetricsHttpServer */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void MetricsHttpServer::clientConnected(HttpServerConnection *con)
+{
+  con->requestReceived.connect(
+      sigc::mem_fun(*this, &MetricsHttpServer::requestReceived));
+} /* MetricsHttpServer::clientConnected */
+
+
+void MetricsHttpServer::requestReceived(HttpServerConnection *con,
+                                        HttpServerConnection::Request& req)
+{
+  if (Metrics::handleHttpRequest(con, req))
+  {
+    return;
+  }
+
+  HttpServerConnection::Response res;
+  res.setCode(404);
+  res.setContent("text/plain", "Not found\n");
+  con->write(res);
+} /* MetricsHttpServer::requestReceived */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,164 @@
+/**
+@file	 AsyncMetricsHttpServer.h
+@brief   A minimal HTTP server that serve the metrics registry
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_METRICS_HTTP_SERVER_INCLUDED
+#define ASYNC_METRICS_HTTP_SERVER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTcpServer.h>
+#include <AsyncHttpServerConnection.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class Config;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A minimal HTTP server that serve the metrics registry
+@author agent
+@date   2026-10-18
+
+This class is used by applications that do not have an HTTP server of their
+own to make the content of the Async::Metrics registry available to a
+Prometheus server. A GET request for /metrics is answered with all metrics in
+the Prometheus text format. All other requests are answered with 404.
+*/
+class MetricsHttpServer : public sigc::trackable
+{
+  public:
+    /**
+     * @brief   Create a metrics server if configured
+     * @param   cfg     The configuration object
+     * @param   section The configuration section to read
+     * @return  Returns a new server object or 0 if METRICS_HTTP_PORT is not
+     *          set in the given section
+     */
+    static MetricsHttpServer *create(Config& cfg, const std::string& section);
+
+    /**
+     * @brief 	Constructor
+     * @param 	port_str  The port number or service name to listen to
+     * @param   bind_ip   The IP address to bind the server to
+     */
+    explicit MetricsHttpServer(const std::string& port_str,
+                               const IpAddress& bind_ip=IpAddress());
+
+    /**
+     * @brief 	Destructor
+     */
+    ~MetricsHttpServer(void);
+
+  private:
+    TcpServer<HttpServerConnection> m_server;
+
+    MetricsHttpServer(const MetricsHttpServer&);
+    MetricsHttpServer& operator=(const MetricsHttpServer&);
+    void clientConnected(HttpServerConnection *con);
+    void requestReceived(HttpServerConnection *con,
+                         HttpServerConnection::Request& req);
+
+};  /* class MetricsHttpServer */
+
+
+} /* namespace */
+
+#endif /* ASYNC_METRICS_HTTP_SERVER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <assert.h>
@@ -182,7 +183,9 @@ TcpConnection::TcpConnection(int sock, const IpAddress& remote_addr,
 {
   recv_buf = new char[recv_buf_len];
   rd_watch.activity.connect(mem_fun(*this, &TcpConnection::recvHandler));
+  rd_watch.setName("TcpConnection::recv");
   wr_watch.activity.connect(mem_fun(*this, &TcpConnection::writeHandler));
+  wr_watch.setName("TcpConnection::write");
   setSocket(sock);
 } /* TcpConnection::TcpConnection */
 
@@ -272,6 +275,41 @@ int TcpConnection::write(const void *buf, int count)
  *
  ****************************************************************************/
 
+int TcpConnection::writev(const struct iovec *iov, int iovcnt)
+{
+  assert(sock >= 0);
+
+  size_t count = 0;
+  for (int i=0; i<iovcnt; ++i)
+  {
+    count += iov[i].iov_len;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  ssize_t cnt = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+  if (cnt < 0)
+  {
+    if (errno != EAGAIN)
+    {
+      return -1;
+    }
+    cnt = 0;
+  }
+
+  if (static_cast<size_t>(cnt) < count)
+  {
+    sendBufferFull(true);
+    wr_watch.setEnabled(true);
+  }
+
+  return cnt;
+
+} /* TcpConnection::writev */
+
+
 
 /*
  *------------------------------------------------------------------------
@@ -69,6 +69,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+struct iovec;
 
 
 /****************************************************************************
@@ -303,6 +304,17 @@ class TcpConnection : virtual public sigc::trackable
      */
     int socket(void) const { return sock; }
 
+    /**
+     * @brief 	Write data from multiple buffers to the TCP connection
+     * @param 	iov     The buffers containing the data to send
+     * @param 	iovcnt  The number of buffers
+     * @return	Returns the number of bytes written or -1 on failure
+     *
+     * This function work just like the write function but the data is
+     * gathered from a number of buffers in a single system call.
+     */
+    int writev(const struct iovec *iov, int iovcnt);
+
     /**
      * @brief   Disconnect from the remote peer
      *
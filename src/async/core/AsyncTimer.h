@@ -46,6 +46,8 @@ An example of how to use the Async::Timer class
 
 #include <sigc++/sigc++.h>
 
+#include <string>
+
 
 
 /****************************************************************************
@@ -198,6 +200,21 @@ class Timer : public sigc::trackable
      * If the timer is disabled, this function will do nothing.
      */
     void reset(void);
+
+    /**
+     * @brief   Set a name for the timer
+     * @param   name The name of the timer
+     *
+     * The name is used to identify the timer callback in the statistics
+     * collected by the main loop monitor (see Async::LoopMonitor).
+     */
+    void setName(const std::string& name) { m_name = name; }
+
+    /**
+     * @brief   Get the name of the timer
+     * @return  Returns the name of the timer or an empty string if not set
+     */
+    const std::string& name(void) const { return m_name; }
     
     /**
      * @brief 	A signal that is emitted when the timer expires
@@ -216,6 +233,7 @@ class Timer : public sigc::trackable
     Type  m_type;
     int   m_timeout_ms;
     bool  m_is_enabled;
+    std::string m_name;
   
 };  /* class Timer */
 
@@ -0,0 +1,441 @@
+/**
+@file	 AsyncTrace.cpp
+@brief   A low overhead trace ring buffer with Chrome trace export
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <iomanip>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncTrace.h"
+#include "AsyncConfig.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  /*
+   * The ring buffer of one thread. Only the owning thread write records and
+   * advance the head. A reader copy the records and then check the head
+   * again to discard records that may have been overwritten while copying.
+   */
+  struct Ring
+  {
+    vector<Trace::Record>     records;
+    uint64_t                  mask;
+    atomic<uint64_t>          head;
+    atomic<uint64_t>          tail;
+    long                      tid;
+    atomic<const char*>       name;
+
+    Ring(size_t size, long tid, const char *name)
+      : records(size), mask(size - 1), head(0), tail(0), tid(tid),
+        name(name)
+    {
+    }
+  };
+
+  mutex                     rings_mutex;
+  vector<shared_ptr<Ring> > rings;
+  size_t                    buffer_size = Trace::DEFAULT_BUFFER_SIZE;
+  thread_local Ring         *local_ring = 0;
+
+  Ring *localRing(void)
+  {
+    if (local_ring == 0)
+    {
+      long tid = syscall(SYS_gettid);
+      const char *name = (tid == getpid()) ? "main" : "thread";
+      lock_guard<mutex> lock(rings_mutex);
+      rings.push_back(make_shared<Ring>(buffer_size, tid, name));
+      local_ring = rings.back().get();
+    }
+    return local_ring;
+  }
+
+  void writeJsonString(ostream& os, const char *str)
+  {
+    os << '"';
+    for (const char *ch=str; *ch != 0; ++ch)
+    {
+      if ((*ch == '"') || (*ch == '\\'))
+      {
+        os << '\\';
+      }
+      if (static_cast<unsigned char>(*ch) >= 0x20)
+      {
+        os << *ch;
+      }
+    }
+    os << '"';
+  }
+
+  void writeJsonTime(ostream& os, uint64_t ns)
+  {
+    os << ns / 1000 << '.' << setw(3) << setfill('0') << ns % 1000
+       << setfill(' ');
+  }
+
+} /* anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+atomic<bool> Trace::s_enabled(false);
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+bool Trace::compiledIn(void)
+{
+#ifdef ASYNC_TRACE
+  return true;
+#else
+  return false;
+#endif
+} /* Trace::compiledIn */
+
+
+void Trace::configure(Config& cfg, const string& section)
+{
+  size_t size = DEFAULT_BUFFER_SIZE;
+  cfg.getValue(section, "TRACE_BUFFER_SIZE", size);
+  setBufferSize(size);
+
+  bool enable = false;
+  cfg.getValue(section, "TRACE", enable);
+  if (enable && !compiledIn())
+  {
+    cerr << "*** WARNING: " << section << "/TRACE is set but the trace "
+            "points were not compiled in. Rebuild with -DUSE_TRACE=ON."
+         << endl;
+  }
+  setEnabled(enable);
+} /* Trace::configure */
+
+
+void Trace::setEnabled(bool enable)
+{
+  s_enabled.store(enable, memory_order_relaxed);
+} /* Trace::setEnabled */
+
+
+void Trace::setBufferSize(size_t records)
+{
+  size_t size = 1;
+  while (size < records)
+  {
+    size <<= 1;
+  }
+  lock_guard<mutex> lock(rings_mutex);
+  buffer_size = size;
+} /* Trace::setBufferSize */
+
+
+void Trace::setThreadName(const char *name)
+{
+  localRing()->name.store(name, memory_order_relaxed);
+} /* Trace::setThreadName */
+
+
+uint64_t Trace::now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+} /* Trace::now */
+
+
+void Trace::complete(const char *cat, const char *name, uint64_t start_ns,
+                     int64_t arg)
+{
+  record('X', cat, name, start_ns, now() - start_ns, arg);
+} /* Trace::complete */
+
+
+void Trace::instant(const char *cat, const char *name, int64_t arg)
+{
+  record('i', cat, name, now(), 0, arg);
+} /* Trace::instant */
+
+
+void Trace::counter(const char *cat, const char *name, int64_t value)
+{
+  record('C', cat, name, now(), 0, value);
+} /* Trace::counter */
+
+
+size_t Trace::writeChromeJson(ostream& os, double window_s)
+{
+  vector<shared_ptr<Ring> > all_rings;
+  {
+    lock_guard<mutex> lock(rings_mutex);
+    all_rings = rings;
+  }
+
+    // Take a snapshot of all rings before writing anything so that the
+    // writer threads do not overwrite the records while they are formatted
+  vector<vector<Record> > snapshots(all_rings.size());
+  uint64_t latest_ns = 0;
+  for (size_t i=0; i<all_rings.size(); ++i)
+  {
+    Ring& ring = *all_rings[i];
+    uint64_t head = ring.head.load(memory_order_acquire);
+    uint64_t size = ring.mask + 1;
+    uint64_t first = ring.tail.load(memory_order_relaxed);
+    if (head - first > size)
+    {
+      first = head - size;
+    }
+    vector<Record>& snapshot = snapshots[i];
+    snapshot.reserve(head - first);
+    for (uint64_t pos=first; pos!=head; ++pos)
+    {
+      snapshot.push_back(ring.records[pos & ring.mask]);
+    }
+      // The record at new_head may be in the process of being written. The
+      // fence make sure that the copying above is not reordered after the
+      // head is read again.
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t new_head = ring.head.load(memory_order_acquire) + 1;
+    if (new_head - first > size)
+    {
+      size_t overwritten = min(snapshot.size(),
+                               static_cast<size_t>(new_head - first - size));
+      snapshot.erase(snapshot.begin(), snapshot.begin() + overwritten);
+    }
+    if (!snapshot.empty())
+    {
+      latest_ns = max(latest_ns, snapshot.back().ts_ns +
+                                 snapshot.back().dur_ns);
+    }
+  }
+
+  uint64_t start_ns = 0;
+  if ((window_s > 0.0) && (latest_ns > window_s * 1.0e9))
+  {
+    start_ns = latest_ns - static_cast<uint64_t>(window_s * 1.0e9);
+  }
+
+  long pid = getpid();
+  size_t cnt = 0;
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (size_t i=0; i<all_rings.size(); ++i)
+  {
+    const Ring& ring = *all_rings[i];
+    os << (i > 0 ? ",\n" : "\n")
+       << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"tid\":" << ring.tid << ",\"args\":{\"name\":";
+    writeJsonString(os, ring.name.load(memory_order_relaxed));
+    os << "}}";
+    const vector<Record>& snapshot = snapshots[i];
+    for (vector<Record>::const_iterator it=snapshot.begin();
+         it!=snapshot.end(); ++it)
+    {
+      if (it->ts_ns + it->dur_ns < start_ns)
+      {
+        continue;
+      }
+      os << ",\n{\"cat\":";
+      writeJsonString(os, it->cat);
+      os << ",\"name\":";
+      writeJsonString(os, it->name);
+      os << ",\"ph\":\"" << it->phase << "\",\"ts\":";
+      writeJsonTime(os, it->ts_ns);
+      if (it->phase == 'X')
+      {
+        os << ",\"dur\":";
+        writeJsonTime(os, it->dur_ns);
+      }
+      else if (it->phase == 'i')
+      {
+        os << ",\"s\":\"t\"";
+      }
+      os << ",\"pid\":" << pid << ",\"tid\":" << ring.tid;
+      if (it->phase == 'C')
+      {
+        os << ",\"args\":{\"value\":" << it->arg << "}";
+      }
+      else if (it->arg != 0)
+      {
+        os << ",\"args\":{\"arg\":" << it->arg << "}";
+      }
+      os << "}";
+      ++cnt;
+    }
+  }
+  os << "\n]}" << endl;
+  return cnt;
+} /* Trace::writeChromeJson */
+
+
+bool Trace::dumpToFile(const string& path, double window_s)
+{
+  ofstream ofs(path.c_str());
+  if (!ofs.is_open())
+  {
+    cerr << "*** ERROR: Could not open trace file \"" << path
+         << "\" for writing" << endl;
+    return false;
+  }
+  size_t cnt = writeChromeJson(ofs, window_s);
+  ofs.close();
+  if (ofs.fail())
+  {
+    cerr << "*** ERROR: Could not write trace file \"" << path << "\""
+         << endl;
+    return false;
+  }
+  cout << "Wrote " << cnt << " trace events to \"" << path << "\"" << endl;
+  return true;
+} /* Trace::dumpToFile */
+
+
+void Trace::clear(void)
+{
+  lock_guard<mutex> lock(rings_mutex);
+  for (size_t i=0; i<rings.size(); ++i)
+  {
+    rings[i]->tail.store(rings[i]->head.load(memory_order_acquire),
+                         memory_order_relaxed);
+  }
+} /* Trace::clear */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void Trace::record(char phase, const char *cat, const char *name,
+                   uint64_t ts_ns, uint64_t dur_ns, int64_t arg)
+{
+  Ring *ring = localRing();
+  uint64_t head = ring->head.load(memory_order_relaxed);
+  Record& rec = ring->records[head & ring->mask];
+  rec.ts_ns = ts_ns;
+  rec.dur_ns = dur_ns;
+  rec.cat = cat;
+  rec.name = name;
+  rec.arg = arg;
+  rec.phase = phase;
+  ring->head.store(head + 1, memory_order_release);
+} /* Trace::record */
+
+
+
+/*
+ * This file has not been truncated
+ */
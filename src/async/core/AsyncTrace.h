@@ -0,0 +1,345 @@
+/**
+@file	 AsyncTrace.h
+@brief   A low overhead trace ring buffer with Chrome trace export
+@author  agent
+@date	 2026-10-18
+
+This file contains a facility for recording trace events at hot paths into
+per thread ring buffers. The recorded events can be written to a file in the
+Chrome/Perfetto JSON trace format.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_TRACE_INCLUDED
+#define ASYNC_TRACE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <string>
+#include <atomic>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class Config;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+/*
+ * The trace point macros only generate code if ASYNC_TRACE is defined, which
+ * is done by configuring the build with -DUSE_TRACE=ON. The category and
+ * name arguments must be string literals since only the pointers are stored.
+ *
+ *   ASYNC_TRACE_SCOPE(cat, name)           Time the rest of the scope
+ *   ASYNC_TRACE_SCOPE_ARG(cat, name, arg)  Same, with an integer argument
+ *   ASYNC_TRACE_INSTANT(cat, name, arg)    A point in time event
+ *   ASYNC_TRACE_COUNTER(cat, name, value)  A counter value
+ *   ASYNC_TRACE_THREAD_NAME(name)          Name the calling thread
+ */
+#ifdef ASYNC_TRACE
+#define ASYNC_TRACE_CONCAT2(a, b) a ## b
+#define ASYNC_TRACE_CONCAT(a, b) ASYNC_TRACE_CONCAT2(a, b)
+#define ASYNC_TRACE_SCOPE(cat, name) \
+  Async::Trace::Scope ASYNC_TRACE_CONCAT(async_trace_scope_, __LINE__)( \
+      cat, name)
+#define ASYNC_TRACE_SCOPE_ARG(cat, name, arg) \
+  Async::Trace::Scope ASYNC_TRACE_CONCAT(async_trace_scope_, __LINE__)( \
+      cat, name, arg)
+#define ASYNC_TRACE_INSTANT(cat, name, arg) \
+  do { \
+    if (Async::Trace::enabled()) Async::Trace::instant(cat, name, arg); \
+  } while (0)
+#define ASYNC_TRACE_COUNTER(cat, name, value) \
+  do { \
+    if (Async::Trace::enabled()) Async::Trace::counter(cat, name, value); \
+  } while (0)
+#define ASYNC_TRACE_THREAD_NAME(name) Async::Trace::setThreadName(name)
+#else
+#define ASYNC_TRACE_SCOPE(cat, name) do {} while (0)
+#define ASYNC_TRACE_SCOPE_ARG(cat, name, arg) do {} while (0)
+#define ASYNC_TRACE_INSTANT(cat, name, arg) do {} while (0)
+#define ASYNC_TRACE_COUNTER(cat, name, value) do {} while (0)
+#define ASYNC_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A low overhead trace ring buffer with Chrome trace export
+@author agent
+@date   2026-10-18
+
+Trace events are written as fixed size records into a ring buffer that is
+private to the thread writing the event, so no locking is needed when
+recording. Each ring hold the latest events, older events are overwritten.
+The rings of all threads can be written to a JSON file in the Chrome trace
+event format, which can be opened in chrome://tracing or in the Perfetto UI
+(https://ui.perfetto.dev). This make it possible to see exactly what the
+application did during the last seconds before some problem occurred.
+
+Trace points are normally added using the ASYNC_TRACE_* macros so that they
+compile to nothing unless tracing is enabled at build time. Recording must
+also be enabled at runtime using Trace::setEnabled, otherwise a trace point
+cost a test of a boolean.
+
+\code
+void MyClass::processBlock(const float *samples, int count)
+{
+  ASYNC_TRACE_SCOPE_ARG("audio", "MyClass::processBlock", count);
+  ...
+}
+\endcode
+*/
+class Trace
+{
+  public:
+    /**
+     * @brief   A trace record
+     */
+    struct Record
+    {
+      uint64_t    ts_ns;      ///< The start time (CLOCK_MONOTONIC)
+      uint64_t    dur_ns;     ///< The duration of a complete event
+      const char  *cat;       ///< The category
+      const char  *name;      ///< The name of the event
+      int64_t     arg;        ///< An optional argument or counter value
+      char        phase;      ///< 'X' complete, 'i' instant, 'C' counter
+    };
+
+    /**
+     * @brief   Time a scope
+     *
+     * A complete event covering the lifetime of the object is recorded when
+     * the object is destroyed.
+     */
+    class Scope
+    {
+      public:
+        Scope(const char *cat, const char *name, int64_t arg=0)
+          : m_cat(cat), m_name(name), m_arg(arg),
+            m_start_ns(enabled() ? now() : 0)
+        {
+        }
+        ~Scope(void)
+        {
+          if (m_start_ns != 0)
+          {
+            complete(m_cat, m_name, m_start_ns, m_arg);
+          }
+        }
+
+      private:
+        const char  *m_cat;
+        const char  *m_name;
+        int64_t     m_arg;
+        uint64_t    m_start_ns;
+
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    static const size_t DEFAULT_BUFFER_SIZE = 32768;
+
+    /**
+     * @brief   Check if the trace points were compiled in
+     * @return  Returns \em true if the library was built with ASYNC_TRACE
+     */
+    static bool compiledIn(void);
+
+    /**
+     * @brief   Configure tracing from a configuration file
+     * @param   cfg     The configuration object
+     * @param   section The configuration section to read
+     *
+     * The TRACE variable enable recording and TRACE_BUFFER_SIZE set the
+     * number of records in the ring buffer of each thread.
+     */
+    static void configure(Config& cfg, const std::string& section);
+
+    /**
+     * @brief   Check if recording is enabled
+     * @return  Returns \em true if recording is enabled
+     */
+    static bool enabled(void)
+    {
+      return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Enable or disable recording
+     * @param   enable Set to \em true to enable recording
+     */
+    static void setEnabled(bool enable);
+
+    /**
+     * @brief   Set the size of the ring buffers
+     * @param   records The number of records in each ring buffer
+     *
+     * The size is rounded up to a power of two. It only apply to ring
+     * buffers created after the call so it should be set at startup,
+     * before any threads are started.
+     */
+    static void setBufferSize(size_t records);
+
+    /**
+     * @brief   Set the name of the calling thread
+     * @param   name The name of the thread (must be a string literal)
+     */
+    static void setThreadName(const char *name);
+
+    /**
+     * @brief   Get the current time of the trace clock
+     * @return  Returns the time in nanoseconds
+     */
+    static uint64_t now(void);
+
+    /**
+     * @brief   Record a complete event
+     * @param   cat       The category
+     * @param   name      The name of the event
+     * @param   start_ns  The start time, as returned by now()
+     * @param   arg       An optional argument
+     */
+    static void complete(const char *cat, const char *name, uint64_t start_ns,
+                         int64_t arg=0);
+
+    /**
+     * @brief   Record an instant event
+     * @param   cat   The category
+     * @param   name  The name of the event
+     * @param   arg   An optional argument
+     */
+    static void instant(const char *cat, const char *name, int64_t arg=0);
+
+    /**
+     * @brief   Record a counter value
+     * @param   cat   The category
+     * @param   name  The name of the counter
+     * @param   value The value of the counter
+     */
+    static void counter(const char *cat, const char *name, int64_t value);
+
+    /**
+     * @brief   Write the recorded events in the Chrome trace format
+     * @param   os        The stream to write to
+     * @param   window_s  Only write events this many seconds back from the
+     *                    latest event, 0 to write all recorded events
+     * @return  Returns the number of events written
+     */
+    static size_t writeChromeJson(std::ostream& os, double window_s=0.0);
+
+    /**
+     * @brief   Write the recorded events to a file in the Chrome trace format
+     * @param   path      The path to the file to write
+     * @param   window_s  See writeChromeJson
+     * @return  Returns \em true on success or \em false on failure
+     */
+    static bool dumpToFile(const std::string& path, double window_s=0.0);
+
+    /**
+     * @brief   Discard all recorded events
+     */
+    static void clear(void);
+
+  private:
+    static std::atomic<bool> s_enabled;
+
+    static void record(char phase, const char *cat, const char *name,
+                       uint64_t ts_ns, uint64_t dur_ns, int64_t arg);
+
+    Trace(void);
+
+};  /* class Trace */
+
+
+} /* namespace */
+
+#endif /* ASYNC_TRACE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -54,6 +54,8 @@
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncTrace.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -109,6 +111,36 @@ class UdpPacket
 };
 
 
+namespace {
+  struct UdpMetrics
+  {
+    Metrics::Counter *rx_packets;
+    Metrics::Counter *rx_bytes;
+    Metrics::Counter *tx_packets;
+    Metrics::Counter *tx_bytes;
+
+    UdpMetrics(void)
+    {
+      Metrics& metrics = Metrics::instance();
+      rx_packets = metrics.counter("async_udp_rx_packets_total",
+          "The number of received UDP datagrams");
+      rx_bytes = metrics.counter("async_udp_rx_bytes_total",
+          "The number of received UDP payload bytes");
+      tx_packets = metrics.counter("async_udp_tx_packets_total",
+          "The number of sent UDP datagrams");
+      tx_bytes = metrics.counter("async_udp_tx_bytes_total",
+          "The number of sent UDP payload bytes");
+    }
+  };
+
+  UdpMetrics& udpMetrics(void)
+  {
+    static UdpMetrics udp_metrics;
+    return udp_metrics;
+  }
+} /* anonymous namespace */
+
+
 /****************************************************************************
  *
  * Prototypes
@@ -201,12 +233,14 @@ UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
   rd_watch = new FdWatch(sock, FdWatch::FD_WATCH_RD);
   assert(rd_watch != 0);
   rd_watch->activity.connect(mem_fun(*this, &UdpSocket::handleInput));
+  rd_watch->setName("UdpSocket::input");
 
     // Setup a watch for outgoing data (signals activity when a buffer full
     // condition occurs)
   wr_watch = new FdWatch(sock, FdWatch::FD_WATCH_WR);
   assert(wr_watch != 0);
   wr_watch->activity.connect(mem_fun(*this, &UdpSocket::sendRest));
+  wr_watch->setName("UdpSocket::sendRest");
   wr_watch->setEnabled(false);
   
 } /* UdpSocket::UdpSocket */
@@ -221,6 +255,7 @@ UdpSocket::~UdpSocket(void)
 bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
     const void *buf, int count)
 {
+  ASYNC_TRACE_SCOPE_ARG("net", "UdpSocket::write", count);
   if (send_buf != 0)
   {
     return false;
@@ -248,6 +283,8 @@ bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
     }
   }
   assert(ret == count);
+  udpMetrics().tx_packets->inc();
+  udpMetrics().tx_bytes->inc(count);
   
   return true;
   
@@ -323,6 +360,7 @@ void UdpSocket::cleanup(void)
 
 void UdpSocket::handleInput(FdWatch *watch)
 {
+  ASYNC_TRACE_SCOPE("net", "UdpSocket::handleInput");
   char buf[65536];
   struct sockaddr_in addr;
   socklen_t addr_len = sizeof(addr);
@@ -334,6 +372,8 @@ void UdpSocket::handleInput(FdWatch *watch)
     perror("recvfrom in UdpSocket::handleInput");
     return;
   }
+  udpMetrics().rx_packets->inc();
+  udpMetrics().rx_bytes->inc(len);
   
   dataReceived(IpAddress(addr.sin_addr), ntohs(addr.sin_port), buf, len);
   
@@ -367,6 +407,8 @@ void UdpSocket::sendRest(FdWatch *watch)
   else
   {
     assert(ret == send_buf->len);
+    udpMetrics().tx_packets->inc();
+    udpMetrics().tx_bytes->inc(ret);
     sendBufferFull(false);
   }
   
@@ -53,6 +53,7 @@
  *
  ****************************************************************************/
 
+#include <AsyncTrace.h>
 
 
 /****************************************************************************
@@ -162,8 +163,11 @@ int CppApplication::sighandler_pipe[2];
  *------------------------------------------------------------------------
  */
 CppApplication::CppApplication(void)
-  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0)
+  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0),
+    virtual_clock(false)
 {
+  virtual_now.tv_sec = 0;
+  virtual_now.tv_nsec = 0;
   FD_ZERO(&rd_set);
   FD_ZERO(&wr_set);
   sighandler_pipe[0] = sighandler_pipe[1] = -1;
@@ -213,7 +217,7 @@ void CppApplication::exec(void)
       if (titer->second != 0)
       {
 	struct timespec ts;
-	clock_gettime(CLOCK_MONOTONIC, &ts);
+	currentTime(&ts);
 	clock_timersub(&titer->first, &ts, &timeout);
 	if (timeout.tv_sec < 0)
 	{
@@ -230,10 +234,20 @@ void CppApplication::exec(void)
       titer = timer_map.begin();
     }
     
+      // When running on a virtual clock we never sleep while waiting for a
+      // timer. File descriptors are just polled and if none of them are
+      // active, time is advanced to the expiration time of the next timer.
+    struct timespec poll_timeout = {0, 0};
+    struct timespec *select_timeout_ptr = timeout_ptr;
+    if (virtual_clock && (timeout_ptr != 0))
+    {
+      select_timeout_ptr = &poll_timeout;
+    }
+
     fd_set local_rd_set = rd_set;
     fd_set local_wr_set = wr_set;
     int dcnt = pselect(max_desc, &local_rd_set, &local_wr_set, NULL,
-	timeout_ptr, NULL);
+	select_timeout_ptr, NULL);
     if (dcnt == -1)
     {
       if ((errno == EINTR) || (errno == EAGAIN))
@@ -246,6 +260,14 @@ void CppApplication::exec(void)
         exit(1);
       }
     }
+
+    ASYNC_TRACE_SCOPE_ARG("loop", "CppApplication::iteration", dcnt);
+
+    double iteration_start = 0.0;
+    if (loop_monitor.isEnabled())
+    {
+      iteration_start = LoopMonitor::monotonicMs();
+    }
     
     if ((timeout_ptr != 0)
         && ((dcnt == 0)
@@ -253,7 +275,21 @@ void CppApplication::exec(void)
            )
        )
     {
+      if (virtual_clock && lttimespec()(virtual_now, titer->first))
+      {
+        virtual_now = titer->first;
+      }
+      if (loop_monitor.isEnabled() && !virtual_clock)
+      {
+        struct timespec now, late;
+        currentTime(&now);
+        clock_timersub(&now, &titer->first, &late);
+        loop_monitor.addTimerLateness(
+            late.tv_sec * 1000.0 + late.tv_nsec / 1000000.0);
+      }
+      LoopMonitor::CallbackTimer cb_timer(loop_monitor, titer->second);
       titer->second->expired(titer->second);
+      cb_timer.done();
       if ((titer->second != 0) &&
 	  (titer->second->type() == Timer::TYPE_PERIODIC))
       {
@@ -274,7 +310,9 @@ void CppApplication::exec(void)
       {
 	if (witer->second != 0)
 	{
+	  LoopMonitor::CallbackTimer cb_timer(loop_monitor, witer->second);
 	  witer->second->activity(witer->second);
+	  cb_timer.done();
 	}
 	else
 	{
@@ -295,7 +333,9 @@ void CppApplication::exec(void)
       {
 	if (witer->second != 0)
 	{
+	  LoopMonitor::CallbackTimer cb_timer(loop_monitor, witer->second);
 	  witer->second->activity(witer->second);
+	  cb_timer.done();
 	}
 	else
 	{
@@ -307,6 +347,11 @@ void CppApplication::exec(void)
     }
     
     assert(dcnt == 0);
+
+    if (loop_monitor.isEnabled() && (iteration_start > 0.0))
+    {
+      loop_monitor.addIteration(LoopMonitor::monotonicMs() - iteration_start);
+    }
   }
 
   for (UnixSignalMap::const_iterator it = unix_signals.begin();
@@ -332,6 +377,24 @@ void CppApplication::quit(void)
 } /* CppApplication::quit */
 
 
+bool CppApplication::setVirtualClock(bool enable)
+{
+  if (enable == virtual_clock)
+  {
+    return true;
+  }
+
+    // Start out from the current system time so that already queued timers
+    // keep their relative expiration times
+  if (enable)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &virtual_now);
+  }
+  virtual_clock = enable;
+  return true;
+} /* CppApplication::setVirtualClock */
+
+
 void CppApplication::catchUnixSignal(int signum)
 {
   UnixSignalMap::iterator it = unix_signals.find(signum);
@@ -500,10 +563,23 @@ void CppApplication::delFdWatch(FdWatch *fd_watch)
 } /* CppApplication::delFdWatch */
 
 
+void CppApplication::currentTime(struct timespec *ts) const
+{
+  if (virtual_clock)
+  {
+    *ts = virtual_now;
+  }
+  else
+  {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+  }
+} /* CppApplication::currentTime */
+
+
 void CppApplication::addTimer(Timer *timer)
 {
   struct timespec current;
-  clock_gettime(CLOCK_MONOTONIC, &current);
+  currentTime(&current);
   addTimerP(timer, current);
 } /* CppApplication::addTimer */
 
@@ -55,6 +55,7 @@
  ****************************************************************************/
 
 #include <AsyncApplication.h>
+#include <AsyncLoopMonitor.h>
 
 
 /****************************************************************************
@@ -174,6 +175,31 @@ class CppApplication : public Application
      */
     void quit(void);
 
+    /**
+     * @brief   Enable or disable the virtual clock
+     * @param   enable Set to \em true to enable the virtual clock
+     * @return  Returns \em true on success
+     *
+     * When the virtual clock is enabled, the main loop will not sleep while
+     * waiting for the next timer to expire. If no file descriptor is active,
+     * the virtual time is advanced directly to the expiration time of the
+     * next timer. The virtual time start out at the current time of the
+     * monotonic system clock.
+     */
+    bool setVirtualClock(bool enable);
+
+    /**
+     * @brief   Check if the virtual clock is enabled
+     * @return  Returns \em true if the virtual clock is enabled
+     */
+    bool virtualClockEnabled(void) const { return virtual_clock; }
+
+    /**
+     * @brief   Get the main loop monitor
+     * @return  Returns the loop monitor
+     */
+    LoopMonitor *loopMonitor(void) { return &loop_monitor; }
+
     /**
      * @brief   A signal that is emitted when a monitored UNIX signal is caught
      * @param   signum The signal number that was caught
@@ -212,9 +238,13 @@ class CppApplication : public Application
     UnixSignalMap       unix_signals;
     int                 unix_signal_recv;
     size_t              unix_signal_recv_cnt;
-    
+    bool                virtual_clock;
+    struct timespec     virtual_now;
+    LoopMonitor         loop_monitor;
+
     static void unixSignalHandler(int signum);
 
+    void currentTime(struct timespec *ts) const;
     void addFdWatch(FdWatch *fd_watch);
     void delFdWatch(FdWatch *fd_watch);
     void addTimer(Timer *timer);
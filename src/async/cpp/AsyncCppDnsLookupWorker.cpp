@@ -126,8 +126,6 @@ using namespace Async;
 CppDnsLookupWorker::CppDnsLookupWorker(const DnsLookup& dns)
   : DnsLookupWorker(dns)
 {
-  m_notifier_watch.activity.connect(
-      sigc::mem_fun(*this, &CppDnsLookupWorker::notificationReceived));
 } /* CppDnsLookupWorker::CppDnsLookupWorker */
 
 
@@ -144,10 +142,12 @@ DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
 
   abortLookup();
 
-  m_result = std::move(other.m_result);
-  assert(!other.m_result.valid());
-
-  m_notifier_watch = std::move(other.m_notifier_watch);
+  if (other.m_pending)
+  {
+    CppDnsResolver::instance().moveClient(&other, this);
+    m_pending = true;
+    other.m_pending = false;
+  }
 
   return *this;
 } /* CppDnsLookupWorker::operator=(DnsLookupWorker&&) */
@@ -162,30 +162,15 @@ DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
 bool CppDnsLookupWorker::doLookup(void)
 {
     // A lookup is already running
-  if (m_result.valid())
+  if (m_pending)
   {
     return true;
   }
 
   setLookupFailed(false);
 
-  int fd[2];
-  if (pipe(fd) != 0)
-  {
-    printErrno("ERROR: Could not create pipe");
-    setLookupFailed();
-    return false;
-  }
-  m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
-  m_notifier_watch.setEnabled(true);
-
-  m_ctx = std::unique_ptr<ThreadContext>(new ThreadContext);
-  m_ctx->label = dns().label();
-  m_ctx->type = dns().type();
-  m_ctx->notifier_wr = fd[1];
-  m_ctx->anslen = 0;
-  m_ctx->thread_cerr.clear();
-  m_result = std::async(std::launch::async, workerFunc, std::ref(*m_ctx));
+  m_pending = true;
+  CppDnsResolver::instance().lookup(this, dns().label(), dns().type());
 
   return true;
 
@@ -194,157 +179,21 @@ bool CppDnsLookupWorker::doLookup(void)
 
 void CppDnsLookupWorker::abortLookup(void)
 {
-  if (m_result.valid())
-  {
-    m_result.get();
-  }
-
-  int fd = m_notifier_watch.fd();
-  if (fd >= 0)
+  if (m_pending)
   {
-    m_notifier_watch.setFd(-1, FdWatch::FD_WATCH_RD);
-    close(fd);
+    CppDnsResolver::instance().cancel(this);
+    m_pending = false;
   }
-
-  m_ctx.reset();
 } /* CppDnsLookupWorker::abortLookup */
 
 
-/****************************************************************************
- *
- * Private member functions
- *
- ****************************************************************************/
-
-/*
- *----------------------------------------------------------------------------
- * Method:    CppDnsLookupWorker::workerFunc
- * Purpose:   This is the function that do the actual DNS lookup. It is
- *    	      started as a separate thread since res_nsearch is a
- *    	      blocking function.
- * Input:     ctx - A context containing query and result parameters
- * Output:    The answer and anslen variables in the ThreadContext will be
- *            filled in with the lookup result. The context will be returned
- *            from this function.
- * Author:    Tobias Blomberg
- * Created:   2021-07-14
- * Remarks:   
- * Bugs:      
- *----------------------------------------------------------------------------
- */
-void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
-{
-  std::ostream& th_cerr = ctx.thread_cerr;
-
-  int qtype = 0;
-  switch (ctx.type)
-  {
-    case DnsLookup::Type::A:
-    {
-      struct addrinfo hints = {0};
-      hints.ai_family = AF_INET;
-      int ret = getaddrinfo(ctx.label.c_str(), NULL, &hints, &ctx.addrinfo);
-      if (ret != 0)
-      {
-        th_cerr << "*** WARNING[getaddrinfo]: Could not look up host \""
-                << ctx.label << "\": " << gai_strerror(ret) << std::endl;
-      }
-      else if (ctx.addrinfo == nullptr)
-      {
-        th_cerr << "*** WARNING[getaddrinfo]: No address info returned "
-                   "for host \"" << ctx.label << "\"" << std::endl;
-      }
-      break;
-    }
-    case DnsLookup::Type::PTR:
-    {
-      IpAddress ip_addr;
-      size_t arpa_domain_pos = ctx.label.find(".in-addr.arpa");
-      if (arpa_domain_pos != std::string::npos)
-      {
-        ip_addr.setIpFromString(ctx.label.substr(0, arpa_domain_pos));
-        struct in_addr addr = ip_addr.ip4Addr();
-        addr.s_addr = htonl(addr.s_addr);
-        ip_addr.setIp(addr);
-      }
-      else
-      {
-        ip_addr.setIpFromString(ctx.label);
-      }
-      if (!ip_addr.isEmpty())
-      {
-        struct sockaddr_in in_addr = {0};
-        in_addr.sin_family = AF_INET;
-        in_addr.sin_addr = ip_addr.ip4Addr();
-        int ret = getnameinfo(reinterpret_cast<struct sockaddr*>(&in_addr),
-                              sizeof(in_addr),
-                              ctx.host, sizeof(ctx.host),
-                              NULL, 0, NI_NAMEREQD);
-        if (ret != 0)
-        {
-          th_cerr << "*** WARNING[getnameinfo]: Could not look up IP \""
-                  << ctx.label << "\": " << gai_strerror(ret) << std::endl;
-        }
-      }
-      else
-      {
-        th_cerr << "*** WARNING: Failed to parse PTR label \""
-                << ctx.label << "\"" << std::endl;
-      }
-      break;
-    }
-    case DnsLookup::Type::CNAME:
-      qtype = ns_t_cname;
-      break;
-    case DnsLookup::Type::SRV:
-      qtype = ns_t_srv;
-      break;
-    default:
-      assert(0);
-  }
-
-  if (qtype != 0)
-  {
-    struct __res_state state;
-    int ret = res_ninit(&state);
-    if (ret != -1)
-    {
-      state.options = RES_DEFAULT;
-      const char *dname = ctx.label.c_str();
-      ctx.anslen = res_nsearch(&state, dname, ns_c_in, qtype,
-                               ctx.answer, sizeof(ctx.answer));
-      if (ctx.anslen == -1)
-      {
-        th_cerr << "*** ERROR: Name resolver failure -- res_nsearch: "
-                << hstrerror(h_errno) << std::endl;
-      }
-
-        // FIXME: Valgrind complain about leaked memory in the resolver library
-        //        when a lookup fails. It seems to be a one time leak though so it
-        //        does not grow with every failed lookup. But even so, it seems
-        //        that res_close is not cleaning up properly.
-        //        Glibc 2.33-18 on Fedora 34.
-      res_nclose(&state);
-    }
-    else
-    {
-      th_cerr << "*** ERROR: Name resolver failure -- res_ninit: "
-              << hstrerror(h_errno) << std::endl;
-    }
-  }
-
-  close(ctx.notifier_wr);
-  ctx.notifier_wr = -1;
-} /* CppDnsLookupWorker::workerFunc */
-
-
 /*
  *----------------------------------------------------------------------------
- * Method:    CppDnsLookupWorker::notificationReceived
- * Purpose:   When the DNS lookup thread is done, this function will be
+ * Method:    CppDnsLookupWorker::answerReceived
+ * Purpose:   When the resolver has an answer, this function will be
  *            called to parse the result and notify the user that an answer
  *            is available.
- * Input:     w - The file watch object (notification pipe)
+ * Input:     answer - The answer from the resolver
  * Output:    None
  * Author:    Tobias Blomberg
  * Created:   2005-04-12
@@ -352,70 +201,49 @@ void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
  * Bugs:      
  *----------------------------------------------------------------------------
  */
-void CppDnsLookupWorker::notificationReceived(FdWatch *w)
+void CppDnsLookupWorker::answerReceived(CppDnsResolver::AnswerPtr answer)
 {
-  char buf[1];
-  int cnt = read(w->fd(), buf, sizeof(buf));
-  assert(cnt == 0);
-  close(w->fd());
-  w->setFd(-1, FdWatch::FD_WATCH_RD);
+  m_pending = false;
 
-  m_result.get();
-
-  const std::string& thread_errstr = m_ctx->thread_cerr.str();
-  if (!thread_errstr.empty())
+    // Errors have already been printed by the resolver
+  if (!answer->errstr.empty())
   {
-    std::cerr << thread_errstr;
     setLookupFailed();
   }
 
-  if (m_ctx->type == DnsResourceRecord::Type::A)
+  if (answer->type == DnsResourceRecord::Type::A)
   {
-    if (m_ctx->addrinfo != nullptr)
+    for (const auto& ip_addr : answer->addresses)
     {
-      struct addrinfo *entry;
-      std::vector<IpAddress> the_addresses;
-      for (entry = m_ctx->addrinfo; entry != 0; entry = entry->ai_next)
-      {
-        IpAddress ip_addr(
-            reinterpret_cast<struct sockaddr_in*>(entry->ai_addr)->sin_addr);
-        //std::cout << "### ai_family=" << entry->ai_family
-        //          << "  ai_socktype=" << entry->ai_socktype
-        //          << "  ai_protocol=" << entry->ai_protocol
-        //          << "  ip=" << ip_addr << std::endl;
-        if (find(the_addresses.begin(), the_addresses.end(), ip_addr) ==
-            the_addresses.end())
-        {
-          the_addresses.push_back(ip_addr);
-          addResourceRecord(
-              new DnsResourceRecordA(m_ctx->label, 0, ip_addr));
-        }
-      }
-      m_ctx.reset();
+      addResourceRecord(new DnsResourceRecordA(answer->label, 0, ip_addr));
     }
   }
-  else if (m_ctx->type == DnsResourceRecord::Type::PTR)
+  else if (answer->type == DnsResourceRecord::Type::PTR)
   {
-    if (m_ctx->host[0] != '\0')
+    if (!answer->host.empty())
     {
       addResourceRecord(
-          new DnsResourceRecordPTR(m_ctx->label, 0, m_ctx->host));
+          new DnsResourceRecordPTR(answer->label, 0, answer->host));
     }
   }
   else
   {
-    if (m_ctx->anslen == -1)
+    if (answer->anslen == -1)
     {
       workerDone();
       return;
     }
 
+      // The answer may have been cached so the TTL values are adjusted for
+      // the time the answer has been in the cache
+    const uint32_t age = answer->age();
+
     ns_msg msg;
-    int ret = ns_initparse(m_ctx->answer, m_ctx->anslen, &msg);
+    int ret = ns_initparse(answer->answer.data(), answer->anslen, &msg);
     if (ret == -1)
     {
       std::stringstream ss;
-      ss << "WARNING: ns_initparse failed (anslen=" << m_ctx->anslen << ")";
+      ss << "WARNING: ns_initparse failed (anslen=" << answer->anslen << ")";
       printErrno(ss.str());
       setLookupFailed();
       workerDone();
@@ -447,6 +275,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
         continue;
       }
       uint32_t ttl = ns_rr_ttl(rr);
+      ttl = (ttl > age) ? ttl - age : 0;
       uint16_t type = ns_rr_type(rr);
       const unsigned char *cp = ns_rr_rdata(rr);
       switch (type)
@@ -531,9 +360,15 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
     }
   }
   workerDone();
-} /* CppDnsLookupWorker::notificationReceived */
+} /* CppDnsLookupWorker::answerReceived */
 
 
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
 void CppDnsLookupWorker::printErrno(const std::string& msg)
 {
   char errbuf[1024];
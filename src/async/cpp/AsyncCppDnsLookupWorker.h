@@ -41,12 +41,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <sigc++/sigc++.h>
-#include <arpa/nameser.h>
 
 #include <string>
-#include <sstream>
-#include <future>
-#include <netdb.h>
 
 
 /****************************************************************************
@@ -55,7 +51,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-#include <AsyncFdWatch.h>
 
 
 /****************************************************************************
@@ -65,6 +60,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "../core/AsyncDnsLookupWorker.h"
+#include "AsyncCppDnsResolver.h"
 
 
 
@@ -122,9 +118,12 @@ namespace Async
 
 This is the DNS lookup worker for the Cpp variant of the async environment.
 It is an internal class that should only be used from within the async
-library.
+library. The actual lookup is done by the process wide CppDnsResolver, which
+also cache the answers and coalesce identical queries.
 */
-class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
+class CppDnsLookupWorker : public DnsLookupWorker,
+                           public CppDnsResolver::Client,
+                           public sigc::trackable
 {
   public:
     /**
@@ -158,34 +157,15 @@ class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
      */
     virtual void abortLookup(void);
 
+    /**
+     * @brief   Called by the resolver when the answer is available
+     * @param   answer The answer to the query
+     */
+    virtual void answerReceived(CppDnsResolver::AnswerPtr answer);
+
   private:
-    struct ThreadContext
-    {
-      std::string         label;
-      DnsLookup::Type     type                = DnsLookup::Type::A;
-      int                 notifier_wr         = -1;
-      unsigned char       answer[NS_MAXMSG];
-      int                 anslen              = 0;
-      struct addrinfo*    addrinfo            = nullptr;
-      char                host[NI_MAXHOST]    = {0};
-      std::ostringstream  thread_cerr;
-
-      ~ThreadContext(void)
-      {
-        if (addrinfo != nullptr)
-        {
-          freeaddrinfo(addrinfo);
-          addrinfo = nullptr;
-        }
-      }
-    };
-
-    Async::FdWatch                  m_notifier_watch;
-    std::future<void>               m_result;
-    std::unique_ptr<ThreadContext>  m_ctx;
-
-    static void workerFunc(ThreadContext& ctx);
-    void notificationReceived(FdWatch *w);
+    bool m_pending = false;
+
     void printErrno(const std::string& msg);
 
 };  /* class CppDnsLookupWorker */
@@ -0,0 +1,552 @@
+/**
+@file	 AsyncCppDnsResolver.cpp
+@brief   A process wide caching DNS resolver for the Posix environment
+@author  agent
+@date	 2026-10-18
+
+This file contains the process wide DNS resolver used by the DNS lookup
+workers in the Cpp variant of the async environment. This class should never
+be used directly. It is used by Async::CppDnsLookupWorker.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTrace.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncCppDnsResolver.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+CppDnsResolver& CppDnsResolver::instance(void)
+{
+    // The resolver is never deleted since the worker threads use it
+  static CppDnsResolver *resolver = new CppDnsResolver;
+  return *resolver;
+} /* CppDnsResolver::instance */
+
+
+void CppDnsResolver::lookup(Client *client, const std::string& label,
+                            Type type)
+{
+  const Key key(type, label);
+
+  auto cache_it = m_cache.find(key);
+  if (cache_it != m_cache.end())
+  {
+    if (cache_it->second->age() < cache_it->second->ttl)
+    {
+      m_deliveries.push_back(Delivery(client, cache_it->second));
+      notify();
+      return;
+    }
+    m_cache.erase(cache_it);
+  }
+
+    // Coalesce with an identical query that is already in progress
+  auto flight_it = m_in_flight.find(key);
+  if (flight_it != m_in_flight.end())
+  {
+    flight_it->second.push_back(client);
+    return;
+  }
+  m_in_flight[key].push_back(client);
+
+    // The worker threads are detached since they may be blocked in the
+    // resolver library when the application exit
+  if (!m_threads_started)
+  {
+    for (unsigned i=0; i<THREAD_CNT; ++i)
+    {
+      std::thread(&CppDnsResolver::workerThread, this).detach();
+    }
+    m_threads_started = true;
+  }
+
+  auto answer = std::make_shared<Answer>();
+  answer->label = label;
+  answer->type = type;
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_pending.push_back(answer);
+  m_cond.notify_one();
+} /* CppDnsResolver::lookup */
+
+
+void CppDnsResolver::cancel(Client *client)
+{
+  for (auto& query : m_in_flight)
+  {
+    auto& clients = query.second;
+    clients.erase(std::remove(clients.begin(), clients.end(), client),
+                  clients.end());
+  }
+  m_deliveries.erase(
+      std::remove_if(m_deliveries.begin(), m_deliveries.end(),
+                     [&](const Delivery& d) { return d.first == client; }),
+      m_deliveries.end());
+} /* CppDnsResolver::cancel */
+
+
+void CppDnsResolver::moveClient(Client *from, Client *to)
+{
+  for (auto& query : m_in_flight)
+  {
+    std::replace(query.second.begin(), query.second.end(), from, to);
+  }
+  for (auto& delivery : m_deliveries)
+  {
+    if (delivery.first == from)
+    {
+      delivery.first = to;
+    }
+  }
+} /* CppDnsResolver::moveClient */
+
+
+void CppDnsResolver::clearCache(void)
+{
+  m_cache.clear();
+} /* CppDnsResolver::clearCache */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+CppDnsResolver::CppDnsResolver(void)
+  : m_threads_started(false), m_event_fd(-1)
+{
+  m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_event_fd < 0)
+  {
+    std::cerr << "*** ERROR: Could not create DNS resolver eventfd: "
+              << strerror(errno) << std::endl;
+    abort();
+  }
+  m_event_watch.activity.connect(
+      sigc::mem_fun(*this, &CppDnsResolver::eventReceived));
+  m_event_watch.setFd(m_event_fd, FdWatch::FD_WATCH_RD);
+  m_event_watch.setEnabled(true);
+} /* CppDnsResolver::CppDnsResolver */
+
+
+CppDnsResolver::~CppDnsResolver(void)
+{
+  m_event_watch.setFd(-1, FdWatch::FD_WATCH_RD);
+  close(m_event_fd);
+} /* CppDnsResolver::~CppDnsResolver */
+
+
+void CppDnsResolver::notify(void)
+{
+  uint64_t cnt = 1;
+  ssize_t ret = write(m_event_fd, &cnt, sizeof(cnt));
+  (void)ret;
+} /* CppDnsResolver::notify */
+
+
+void CppDnsResolver::workerThread(void)
+{
+  ASYNC_TRACE_THREAD_NAME("DnsWorker");
+  std::unique_lock<std::mutex> lk(m_mutex);
+  for (;;)
+  {
+    m_cond.wait(lk, [this] { return !m_pending.empty(); });
+    auto answer = m_pending.front();
+    m_pending.pop_front();
+    lk.unlock();
+
+    {
+      ASYNC_TRACE_SCOPE("dns", "CppDnsResolver::resolve");
+      resolve(*answer);
+    }
+
+    lk.lock();
+    m_completed.push_back(answer);
+    notify();
+  }
+} /* CppDnsResolver::workerThread */
+
+
+/*
+ *----------------------------------------------------------------------------
+ * Method:    CppDnsResolver::resolve
+ * Purpose:   This is the function that do the actual DNS lookup. It is
+ *    	      run in one of the worker threads since the resolver library
+ *    	      functions are blocking.
+ * Input:     answer - The query to run. The label and type must be set.
+ * Output:    The answer is filled in with the lookup result.
+ * Author:    Tobias Blomberg
+ * Created:   2021-07-14
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+void CppDnsResolver::resolve(Answer& answer)
+{
+  std::ostringstream th_cerr;
+
+  int qtype = 0;
+  switch (answer.type)
+  {
+    case Type::A:
+    {
+      struct addrinfo hints = {0};
+      hints.ai_family = AF_INET;
+      struct addrinfo *addrinfo = nullptr;
+      int ret = getaddrinfo(answer.label.c_str(), NULL, &hints, &addrinfo);
+      if (ret != 0)
+      {
+        th_cerr << "*** WARNING[getaddrinfo]: Could not look up host \""
+                << answer.label << "\": " << gai_strerror(ret) << std::endl;
+      }
+      else if (addrinfo == nullptr)
+      {
+        th_cerr << "*** WARNING[getaddrinfo]: No address info returned "
+                   "for host \"" << answer.label << "\"" << std::endl;
+      }
+      for (auto entry = addrinfo; entry != nullptr; entry = entry->ai_next)
+      {
+        IpAddress ip_addr(
+            reinterpret_cast<struct sockaddr_in*>(entry->ai_addr)->sin_addr);
+        if (std::find(answer.addresses.begin(), answer.addresses.end(),
+                      ip_addr) == answer.addresses.end())
+        {
+          answer.addresses.push_back(ip_addr);
+        }
+      }
+      if (addrinfo != nullptr)
+      {
+        freeaddrinfo(addrinfo);
+      }
+      break;
+    }
+    case Type::PTR:
+    {
+      IpAddress ip_addr;
+      size_t arpa_domain_pos = answer.label.find(".in-addr.arpa");
+      if (arpa_domain_pos != std::string::npos)
+      {
+        ip_addr.setIpFromString(answer.label.substr(0, arpa_domain_pos));
+        struct in_addr addr = ip_addr.ip4Addr();
+        addr.s_addr = htonl(addr.s_addr);
+        ip_addr.setIp(addr);
+      }
+      else
+      {
+        ip_addr.setIpFromString(answer.label);
+      }
+      if (!ip_addr.isEmpty())
+      {
+        struct sockaddr_in in_addr = {0};
+        in_addr.sin_family = AF_INET;
+        in_addr.sin_addr = ip_addr.ip4Addr();
+        char host[NI_MAXHOST] = {0};
+        int ret = getnameinfo(reinterpret_cast<struct sockaddr*>(&in_addr),
+                              sizeof(in_addr), host, sizeof(host),
+                              NULL, 0, NI_NAMEREQD);
+        if (ret != 0)
+        {
+          th_cerr << "*** WARNING[getnameinfo]: Could not look up IP \""
+                  << answer.label << "\": " << gai_strerror(ret) << std::endl;
+        }
+        else
+        {
+          answer.host = host;
+        }
+      }
+      else
+      {
+        th_cerr << "*** WARNING: Failed to parse PTR label \""
+                << answer.label << "\"" << std::endl;
+      }
+      break;
+    }
+    case Type::CNAME:
+      qtype = ns_t_cname;
+      break;
+    case Type::SRV:
+      qtype = ns_t_srv;
+      break;
+    default:
+      assert(0);
+  }
+
+  if (qtype != 0)
+  {
+    struct __res_state state;
+    int ret = res_ninit(&state);
+    if (ret != -1)
+    {
+      state.options = RES_DEFAULT;
+      answer.answer.resize(NS_MAXMSG);
+      answer.anslen = res_nsearch(&state, answer.label.c_str(), ns_c_in,
+                                  qtype, answer.answer.data(),
+                                  answer.answer.size());
+      if (answer.anslen == -1)
+      {
+        th_cerr << "*** ERROR: Name resolver failure -- res_nsearch: "
+                << hstrerror(h_errno) << std::endl;
+        answer.answer.clear();
+      }
+      else
+      {
+        answer.answer.resize(answer.anslen);
+      }
+
+        // FIXME: Valgrind complain about leaked memory in the resolver library
+        //        when a lookup fails. It seems to be a one time leak though so it
+        //        does not grow with every failed lookup. But even so, it seems
+        //        that res_close is not cleaning up properly.
+        //        Glibc 2.33-18 on Fedora 34.
+      res_nclose(&state);
+    }
+    else
+    {
+      answer.anslen = -1;
+      th_cerr << "*** ERROR: Name resolver failure -- res_ninit: "
+              << hstrerror(h_errno) << std::endl;
+    }
+  }
+
+  answer.errstr = th_cerr.str();
+  answer.ts = Clock::now();
+  answer.ttl = answerTtl(answer);
+} /* CppDnsResolver::resolve */
+
+
+unsigned CppDnsResolver::answerTtl(const Answer& answer)
+{
+  if (!answer.errstr.empty())
+  {
+    return NEGATIVE_TTL;
+  }
+
+  switch (answer.type)
+  {
+    case Type::A:
+      return answer.addresses.empty() ? NEGATIVE_TTL : ADDRINFO_TTL;
+    case Type::PTR:
+      return answer.host.empty() ? NEGATIVE_TTL : ADDRINFO_TTL;
+    default:
+      break;
+  }
+
+    // Use the lowest TTL of all records in the answer section
+  ns_msg msg;
+  if (ns_initparse(answer.answer.data(), answer.anslen, &msg) == -1)
+  {
+    return NEGATIVE_TTL;
+  }
+  uint16_t msg_cnt = ns_msg_count(msg, ns_s_an);
+  if (msg_cnt == 0)
+  {
+    return NEGATIVE_TTL;
+  }
+  unsigned min_ttl = std::numeric_limits<unsigned>::max();
+  for (uint16_t rrnum=0; rrnum<msg_cnt; ++rrnum)
+  {
+    ns_rr rr;
+    if (ns_parserr(&msg, ns_s_an, rrnum, &rr) == -1)
+    {
+      return NEGATIVE_TTL;
+    }
+    min_ttl = std::min(min_ttl, static_cast<unsigned>(ns_rr_ttl(rr)));
+  }
+  return min_ttl;
+} /* CppDnsResolver::answerTtl */
+
+
+void CppDnsResolver::addToCache(const Key& key, AnswerPtr answer)
+{
+  if (answer->ttl == 0)
+  {
+    return;
+  }
+
+  if (m_cache.size() >= MAX_CACHE_SIZE)
+  {
+    for (auto it = m_cache.begin(); it != m_cache.end(); )
+    {
+      if (it->second->age() >= it->second->ttl)
+      {
+        it = m_cache.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    if (m_cache.size() >= MAX_CACHE_SIZE)
+    {
+      return;
+    }
+  }
+  m_cache[key] = answer;
+} /* CppDnsResolver::addToCache */
+
+
+void CppDnsResolver::eventReceived(FdWatch *w)
+{
+  uint64_t cnt = 0;
+  ssize_t ret = read(w->fd(), &cnt, sizeof(cnt));
+  (void)ret;
+
+  std::deque<std::shared_ptr<Answer>> completed;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    completed.swap(m_completed);
+  }
+
+  for (const auto& answer : completed)
+  {
+    std::cerr << answer->errstr;
+    const Key key(answer->type, answer->label);
+    addToCache(key, answer);
+    auto flight_it = m_in_flight.find(key);
+    assert(flight_it != m_in_flight.end());
+    for (auto client : flight_it->second)
+    {
+      m_deliveries.push_back(Delivery(client, answer));
+    }
+    m_in_flight.erase(flight_it);
+  }
+
+    // Clients may start new lookups or cancel other clients when called so
+    // only deliver what is in the queue right now. Deliveries added while
+    // calling the clients have signalled the eventfd again.
+  size_t delivery_cnt = m_deliveries.size();
+  while ((delivery_cnt-- > 0) && !m_deliveries.empty())
+  {
+    Delivery delivery = m_deliveries.front();
+    m_deliveries.pop_front();
+    delivery.first->answerReceived(delivery.second);
+  }
+} /* CppDnsResolver::eventReceived */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,280 @@
+/**
+@file	 AsyncCppDnsResolver.h
+@brief   A process wide caching DNS resolver for the Posix environment
+@author  agent
+@date	 2026-10-18
+
+This file contains the process wide DNS resolver used by the DNS lookup
+workers in the Cpp variant of the async environment. This class should never
+be used directly. It is used by Async::CppDnsLookupWorker.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_CPP_DNS_RESOLVER_INCLUDED
+#define ASYNC_CPP_DNS_RESOLVER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+#include <AsyncIpAddress.h>
+#include <AsyncDnsLookup.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A process wide caching DNS resolver
+@author agent
+@date   2026-10-18
+
+The blocking resolver library functions are run by a small fixed pool of
+worker threads. When a thread is done with a query, the answer is queued and
+the main thread is woken up through a single eventfd.
+
+Answers are cached for the time-to-live given in the answer. Since
+getaddrinfo and getnameinfo do not return any TTL, answers from these
+functions are cached for a short fixed time. Failed lookups are also cached
+for a short time so that many clients looking up a name that cannot be
+resolved, e.g. after a server restart, do not all hit the resolver.
+
+Identical queries that are issued while a lookup is in progress are
+coalesced so that only one query is sent to the resolver.
+
+Answers are always delivered from the main event loop, even when they are
+found in the cache, so a client is never called back from within the lookup
+function.
+*/
+class CppDnsResolver
+{
+  public:
+    using Type = DnsLookup::Type;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief The answer to a DNS query
+     *
+     * The answer is in raw form. It is up to the client to parse it into
+     * resource records. The same answer object may be shared by many
+     * clients so it must not be modified.
+     */
+    struct Answer
+    {
+      std::string                 label;
+      Type                        type      = Type::A;
+      std::vector<unsigned char>  answer;         // res_nsearch answer
+      int                         anslen    = 0;  // -1 on failure
+      std::vector<IpAddress>      addresses;      // getaddrinfo result
+      std::string                 host;           // getnameinfo result
+      std::string                 errstr;         // Errors from the thread
+      Clock::time_point           ts;             // When answer was received
+      unsigned                    ttl       = 0;  // Cache time in seconds
+
+      /**
+       * @brief   Get the age of this answer
+       * @return  Returns the number of seconds since the answer was received
+       */
+      unsigned age(void) const
+      {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            Clock::now() - ts).count();
+      }
+    };
+    using AnswerPtr = std::shared_ptr<const Answer>;
+
+    /**
+     * @brief The interface for objects waiting for a DNS answer
+     */
+    class Client
+    {
+      public:
+        /**
+         * @brief   Destructor
+         */
+        virtual ~Client(void) {}
+
+        /**
+         * @brief   Called when the answer to a query is available
+         * @param   answer The answer
+         */
+        virtual void answerReceived(AnswerPtr answer) = 0;
+    };
+
+    /**
+     * @brief   Get the resolver instance
+     * @return  Returns the process wide resolver instance
+     */
+    static CppDnsResolver& instance(void);
+
+    /**
+     * @brief   Start a DNS query
+     * @param   client The object to deliver the answer to
+     * @param   label The label to look up
+     * @param   type The type of query
+     *
+     * The client will be called exactly once, unless the query is cancelled.
+     * A client can only have one outstanding query at a time.
+     */
+    void lookup(Client *client, const std::string& label, Type type);
+
+    /**
+     * @brief   Cancel all outstanding queries for a client
+     * @param   client The client to cancel queries for
+     *
+     * The query itself is not aborted. The answer will be cached when it
+     * arrive.
+     */
+    void cancel(Client *client);
+
+    /**
+     * @brief   Move outstanding queries from one client to another
+     * @param   from The client that started the query
+     * @param   to The client that should receive the answer instead
+     */
+    void moveClient(Client *from, Client *to);
+
+    /**
+     * @brief   Remove all answers from the cache
+     */
+    void clearCache(void);
+
+  private:
+    using Key = std::pair<Type, std::string>;
+    using Delivery = std::pair<Client*, AnswerPtr>;
+
+    static const unsigned THREAD_CNT            = 4;
+    static const unsigned ADDRINFO_TTL          = 30;
+    static const unsigned NEGATIVE_TTL          = 10;
+    static const size_t   MAX_CACHE_SIZE        = 1024;
+
+      // Shared with the worker threads and protected by m_mutex
+    std::mutex                                    m_mutex;
+    std::condition_variable                       m_cond;
+    std::deque<std::shared_ptr<Answer>>           m_pending;
+    std::deque<std::shared_ptr<Answer>>           m_completed;
+
+      // Only used by the main thread
+    bool                                          m_threads_started;
+    int                                           m_event_fd;
+    FdWatch                                       m_event_watch;
+    std::map<Key, std::vector<Client*>>           m_in_flight;
+    std::map<Key, AnswerPtr>                      m_cache;
+    std::deque<Delivery>                          m_deliveries;
+
+    CppDnsResolver(void);
+    ~CppDnsResolver(void);
+    CppDnsResolver(const CppDnsResolver&);
+    CppDnsResolver& operator=(const CppDnsResolver&);
+    void notify(void);
+    void workerThread(void);
+    static void resolve(Answer& answer);
+    static unsigned answerTtl(const Answer& answer);
+    void addToCache(const Key& key, AnswerPtr answer);
+    void eventReceived(FdWatch *w);
+
+};  /* class CppDnsResolver */
+
+
+} /* namespace */
+
+#endif /* ASYNC_CPP_DNS_RESOLVER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <queue>
 #include <regex.h>
+#include <iterator>
 
 
 /****************************************************************************
@@ -53,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
 #include <AsyncFdWatch.h>
+#include <AsyncApplication.h>
 
 
 
@@ -170,10 +172,12 @@ class ModuleMetarInfo::Http : public sigc::trackable
    WatchMap watch_map;
    std::queue<CURL*> url_queue;
    CURL* pending_curl;
+   std::string data;
+   bool failed;
 
   public:
 
-   Http() : multi_handle(0), pending_curl(0)
+   Http() : multi_handle(0), pending_curl(0), failed(false)
    {
      multi_handle = curl_multi_init();
      long curl_timeout = -1;
@@ -208,8 +212,10 @@ class ModuleMetarInfo::Http : public sigc::trackable
    {
      int handle_count;
      curl_multi_perform(multi_handle, &handle_count);
-     if (handle_count == 0) 
+     bool done = (handle_count == 0);
+     if (done)
      {
+       checkResult();
        disableAllWatches();
        curl_easy_cleanup(pending_curl);
        if (url_queue.empty())
@@ -227,14 +233,20 @@ class ModuleMetarInfo::Http : public sigc::trackable
      }
      updateWatchMap();
      update_timer.reset();
+     if (done)
+     {
+       emitResult();
+     }
    } /* Update */
 
    void onActivity(Async::FdWatch *watch)
    {
      int handle_count;
      curl_multi_perform(multi_handle, &handle_count);
-     if (handle_count == 0)
+     bool done = (handle_count == 0);
+     if (done)
      {
+       checkResult();
        disableAllWatches();
        curl_easy_cleanup(pending_curl);
        if (url_queue.empty())
@@ -252,6 +264,10 @@ class ModuleMetarInfo::Http : public sigc::trackable
        }
      }
      update_timer.reset();
+     if (done)
+     {
+       emitResult();
+     }
    } /* onActivity */
 
    static size_t callback(char *contents, size_t size, size_t nmemb,
@@ -259,15 +275,15 @@ class ModuleMetarInfo::Http : public sigc::trackable
    {
      if (userp == NULL) return 0;
      size_t written = size * nmemb;
-     std::string html((const char *)contents, written);
-     static_cast<Http*>(userp)->metarInfo(html, html.size());
+     static_cast<Http*>(userp)->data.append(contents, written);
      return written;
    } /* callback */
 
-   void AddRequest(const char* uri)
+   void AddRequest(const char* uri, long timeout)
    {
      CURL* curl = curl_easy_init();
      curl_easy_setopt(curl, CURLOPT_URL, uri);
+     curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &Http::callback);
      curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
 
@@ -287,6 +303,37 @@ class ModuleMetarInfo::Http : public sigc::trackable
 
   private:
 
+   // the whole reply is collected before it is handed over since
+   // curl may deliver it in several chunks
+   void checkResult(void)
+   {
+     CURLMsg *msg;
+     int msgs_left;
+     while ((msg = curl_multi_info_read(multi_handle, &msgs_left)) != 0)
+     {
+       if (msg->msg == CURLMSG_DONE)
+       {
+         failed = failed || (msg->data.result != CURLE_OK);
+       }
+     }
+   } /* checkResult */
+
+   void emitResult(void)
+   {
+     std::string reply;
+     reply.swap(data);
+     bool reply_failed = failed || reply.empty();
+     failed = false;
+     if (reply_failed)
+     {
+       metarTimeout();
+     }
+     else
+     {
+       metarInfo(reply, reply.size());
+     }
+   } /* emitResult */
+
    void updateWatchMap()
    {
      fd_set fdread;
@@ -385,6 +432,78 @@ std::string clouds[] = {"acc", "ac", "as", "cbmam", "cb",
                         "cc", "cf",  "ci", "cs", "cu",
                         "tcu", "ns", "sc", "sf", "st"};
 
+// All METAR token patterns. They are compiled once when the module is
+// initialized and then tried in the sorted order of the pattern strings.
+struct TokenPatternDef
+{
+  const char *pattern;
+  int         type;
+};
+
+const TokenPatternDef token_pattern_defs[] =
+{
+  { "^[0-9]/[0-9]sm$", ISPARTOFMILES },
+  { "^(a|q)([0-9]{4})$", QNH },
+  { "^([0-9]{3}|vrb)([0-9]{2}g)?([0-9]{2})(kt|mph|mps|kph)", WIND },
+  { "^[0-9]{4}(ndv|n|ne|e|se|s|sw|w|nw)?$", ISVIEW },
+  { "^[0-9]{6}z", UTC },
+  { "^[0-9]{1,2}sm$", ISVIEW },
+  { "^[0-9]{3}v[0-9]{3}$", VALUEVARIES },
+  { "^(m)?(//|[0-9]{2})/(m)?(//|[0-9]{2})$", TEMPERATURE },
+  { "^(cavok|tcu)$", WORDSEXT },
+  { "(becmg|nosig)", FORECAST },
+  { "^(all|ws|clr|rwy|skc|nsc|tempo|ocnl|frq|nsw|cons)$", WORDSNOEXT },
+  { "^(fm|tl|at)([0-9]{4})z$", TIME },
+  { "^((few|sct|bkn|ovc)[0-9]{3})(///)?"
+    "(ac|acc|as|cb|cbmam|cc|cf|ci|cs|cu|tcu|ns|sc|sf|st)?",
+    CLOUDSVALID },
+  { "^r[0-3][0-9](ll|l|c|r|rr)?/(p|m)?([0-9]{4})(v(p|m)[0-9]{4})?"
+    "(u|d|n)?(ft)?$",
+    RVR },
+  { "^r[0-8][0-9](ll|l|c|r|rr)?/([0-9]|/|c)([1259]|/|l)([0-9]|/|r)"
+    "([0-9]|/|d)([0-9]|/){2}$",
+    ALLRWYSTATE },
+  { "^vv[0-9]{3}$", VERTICALVIEW },
+  { "^(\\+|\\-|vc|re)?([bdfimprstv][a-z]){1,2}$", ACTUALWX },
+  { "^r(wy)?[0-9]{2}(ll|l|c|r|rr)?$", RUNWAY },
+  { "^cig$", CEILING },
+  { "^[1-9]$", IS1STPARTOFVIEW },
+  { "^rmk$", RMK },
+  { "^slp", SLP },
+  { "^snoclo$", SNOWCLOSED },
+  { "^wnd$", PEAKWIND },
+  { "^auto$", AUTO },
+  { "^nospeci$", NOSPECI },
+  { "^ao[1|2]$", AUTOTYPE },
+  { "^wshft$", WINDSHIFT },
+  { "^vis$", RMKVISIBILITY },
+  { "^fropa", FROPA },
+  { "^ltg[ciag]{2,8}$", LIGHTNING },
+  { "^virga$", VIRGA },
+  { "^tx(m)?[0-9]{2}/[0-9]{2}z$", DAYTEMPMAX },
+  { "^tn(m)?[0-9]{2}/[0-9]{2}z$", DAYTEMPMIN },
+  { "^fl[0-9]?[0-9]{2}$", FLIGHTLEVEL },
+  { "^tempo[0-9]{4}$", TEMPOOBSCURATION },
+  { "^t[0-1][0-9]{3}[0-1][0-9]{3}$", TEMPINRMK },
+  { "^1[0-9]{4}$", MAXTEMP },
+  { "^2[0-9]{4}$", MINTEMP },
+  { "^4[0-9]{8}$", MINMAXTEMP },
+  { "^5[0-9]{4}$", PRESSURETENDENCY },
+  { "^p(cpn)?[0-9]{4}$", PRECIPITATION1 },
+  { "^6[0-9]{4}$", PRECIPITATION6 },
+  { "^7[0-9]{4}$", PRECIPITATION24 },
+  { "^(tsno|fzrano)$", NOSEVEREWX },
+  { "^qfe[0-9]{3}\\.[0-9]$", QFEINRMK },
+  { "^[\\$]$", MAINTENANCE },
+  { "^[a-z]{2,4}(b|e)([0-9]{2}){1,2}(e[0-9]{2,4})?$", PRECIPINRMK },
+  { "^((ac|acc|as|cb|cbmam|cc|cf|ci|cs|cu|tcu|ns|sc|sf|st)[1-8]){1,4}$",
+    CLOUDTYPE },
+  { "^(mar|alqds|mod|twr|sfc|dsnt|lan|loc|fir|presrr|presfr|abv|agl|btn|"
+    "cld|cot|nil|obs|obsc|stnr|turb|valid|wkn|wspd|ltg|wx)$",
+    WORDSINRMK },
+};
+
+
 /****************************************************************************
  *
  * Pure C-functions
@@ -410,16 +529,37 @@ extern "C" {
 
 ModuleMetarInfo::ModuleMetarInfo(void *dl_handle, Logic *logic,
                                  const string& cfg_name)
-  : Module(dl_handle, logic, cfg_name), remarks(false), debug(false), http(0)
+  : Module(dl_handle, logic, cfg_name), remarks(false), debug(false),
+    cache_ttl(DEFAULT_CACHE_TTL), capture(0),
+    refresh_timer(1000, Timer::TYPE_PERIODIC, false)
 {
   cout << "\tModule MetarInfo v" MODULE_METAR_INFO_VERSION " starting...\n";
 
+  refresh_timer.expired.connect(
+      mem_fun(*this, &ModuleMetarInfo::refreshReports));
 } /* ModuleMetarInfo */
 
 
 ModuleMetarInfo::~ModuleMetarInfo(void)
 {
+  for (FetchMap::iterator it = fetches.begin(); it != fetches.end(); ++it)
+  {
+    delete it->second;
+  }
+  deleteFinishedFetches();
 
+  for (TokenPatterns::iterator it = token_patterns.begin();
+       it != token_patterns.end(); ++it)
+  {
+    regfree(it->first);
+    delete it->first;
+  }
+  for (RegexCache::iterator it = regex_cache.begin();
+       it != regex_cache.end(); ++it)
+  {
+    regfree(it->second);
+    delete it->second;
+  }
 } /* ~ModuleMetarInfo */
 
 
@@ -496,7 +636,6 @@ bool ModuleMetarInfo::initialize(void)
   string value;
   StrList apset;
   std::string tp;
-  html = "";
 
   repstr["shra"] = "ra sh ";
   repstr["shsn"] = "sn sh ";
@@ -527,6 +666,8 @@ bool ModuleMetarInfo::initialize(void)
     return false;
   }
 
+  compileTokenPatterns();
+
   if (!cfg().getValue(cfgName(), "AIRPORTS", value))
   {
       cout << "*** ERROR: Config variable " << cfgName()
@@ -604,6 +745,23 @@ bool ModuleMetarInfo::initialize(void)
      longmsg = "_long ";  // taking "cavok_long" instead of "cavok"
   }
 
+  // reports are cached for CACHE_TTL seconds and refreshed in the
+  // background, 0 fetch the report for each request
+  cfg().getValue(cfgName(), "CACHE_TTL", cache_ttl);
+  if (cache_ttl > 0)
+  {
+    unsigned interval = max(cache_ttl / 2, 10U);
+    refresh_timer.setTimeout(1000 * interval);
+    refresh_timer.setEnable(true);
+
+    // prefetch the preconfigured airports so that the first request
+    // also can be answered directly
+    for (StrList::const_iterator it = aplist.begin(); it != aplist.end(); ++it)
+    {
+      fetchReport(*it);
+    }
+  }
+
   return true;
 
 } /* initialize */
@@ -850,47 +1008,225 @@ void ModuleMetarInfo::allMsgsWritten(void)
 
 
 /*
-* establish a https-connection to the METAR-Server
-* using curl library
+* answer the request for the current icao. A fresh report is taken from
+* the cache, otherwise it is fetched from the METAR-Server using the
+* curl library
 */
 void ModuleMetarInfo::openConnection(void)
 {
-  closeConnection();
+  waiting_icao = icao;
+
+  ReportCache::iterator it = report_cache.find(icao);
+  if (it != report_cache.end())
+  {
+    CachedReport& report = it->second;
+    time_t now = time(NULL);
+    report.requested = now;
+    if (difftime(now, report.fetched) < cache_ttl)
+    {
+      if (debug)
+      {
+        cout << "METAR for " << icao << " taken from the cache" << endl;
+      }
+      waiting_icao = "";
+      playEvents(report.events);
+      return;
+    }
+  }
+
+  fetchReport(icao);
+} /* openConnection */
+
+
+void ModuleMetarInfo::closeConnection(void)
+{
+    // Any fetch in progress is left running to update the cache
+  waiting_icao = "";
+} /* ModuleMetarInfo::closeConnection */
 
-  http = new Http();
 
-  html = "";
+void ModuleMetarInfo::compileTokenPatterns(void)
+{
+    // Sort the patterns to get the same precedence as before they were
+    // precompiled, when they were tried in the order of a std::map
+  typedef std::map<std::string, int> PatternMap;
+  PatternMap patterns;
+  const size_t cnt = sizeof(token_pattern_defs) / sizeof(*token_pattern_defs);
+  for (size_t i = 0; i < cnt; ++i)
+  {
+    patterns[token_pattern_defs[i].pattern] = token_pattern_defs[i].type;
+  }
+
+  for (PatternMap::const_iterator it = patterns.begin(); it != patterns.end();
+       ++it)
+  {
+    regex_t *re = new regex_t;
+    if (regcomp(re, it->first.c_str(), REG_EXTENDED | REG_NOSUB) != 0)
+    {
+      cerr << "*** WARNING: Could not compile METAR token pattern \""
+           << it->first << "\"" << endl;
+      delete re;
+      continue;
+    }
+    token_patterns.push_back(make_pair(re, it->second));
+  }
+} /* ModuleMetarInfo::compileTokenPatterns */
+
+
+void ModuleMetarInfo::fetchReport(const std::string& station)
+{
+  if (fetches.find(station) != fetches.end())
+  {
+    return;
+  }
+
+  Http *http = new Http();
   std::string path = server;
               path += link;
-              path += icao;
+              path += station;
 
-  http->AddRequest(path.c_str());
+  http->AddRequest(path.c_str(), FETCH_TIMEOUT);
   cout << path << endl;
-  http->metarInfo.connect(mem_fun(*this, &ModuleMetarInfo::onData));
-  http->metarTimeout.connect(mem_fun(*this, &ModuleMetarInfo::onTimeout));
+  http->metarInfo.connect(
+      sigc::bind(mem_fun(*this, &ModuleMetarInfo::onData), station));
+  http->metarTimeout.connect(
+      sigc::bind(mem_fun(*this, &ModuleMetarInfo::onTimeout), station));
+  fetches[station] = http;
+} /* ModuleMetarInfo::fetchReport */
 
-} /* openConnection */
 
+void ModuleMetarInfo::fetchFinished(const std::string& station)
+{
+    // The Http object is still executing when it emit its signals so it
+    // is deleted later
+  FetchMap::iterator it = fetches.find(station);
+  if (it != fetches.end())
+  {
+    finished_fetches.push_back(it->second);
+    fetches.erase(it);
+    Application::app().runTask(
+        mem_fun(*this, &ModuleMetarInfo::deleteFinishedFetches));
+  }
+} /* ModuleMetarInfo::fetchFinished */
 
-void ModuleMetarInfo::closeConnection(void)
+
+void ModuleMetarInfo::deleteFinishedFetches(void)
 {
-  delete http;
-  http = 0;
-} /* ModuleMetarInfo::closeConnection */
+  for (std::vector<Http*>::iterator it = finished_fetches.begin();
+       it != finished_fetches.end(); ++it)
+  {
+    delete *it;
+  }
+  finished_fetches.clear();
+} /* ModuleMetarInfo::deleteFinishedFetches */
+
+
+void ModuleMetarInfo::refreshReports(Async::Timer *t)
+{
+  time_t now = time(NULL);
+  ReportCache::iterator it = report_cache.begin();
+  while (it != report_cache.end())
+  {
+    const std::string& station = it->first;
+    CachedReport& report = it->second;
+    bool preconfigured =
+      find(aplist.begin(), aplist.end(), station) != aplist.end();
+    if (!preconfigured && (difftime(now, report.requested) > CACHE_IDLE_TIME))
+    {
+      report_cache.erase(it++);
+      continue;
+    }
+    if (difftime(now, report.fetched) >= cache_ttl / 2)
+    {
+      fetchReport(station);
+    }
+    ++it;
+  }
 
+    // Preconfigured airports that failed to be fetched are retried
+  for (StrList::const_iterator it = aplist.begin(); it != aplist.end(); ++it)
+  {
+    if (report_cache.find(*it) == report_cache.end())
+    {
+      fetchReport(*it);
+    }
+  }
+} /* ModuleMetarInfo::refreshReports */
 
-void ModuleMetarInfo::onTimeout(void)
+
+void ModuleMetarInfo::playEvents(const EventList& events)
 {
-  stringstream temp;
-  temp << "metar_not_valid";
-  say(temp);
+  for (EventList::const_iterator it = events.begin(); it != events.end();
+       ++it)
+  {
+    if (debug) cout << *it << endl;
+    processEvent(*it);
+  }
+} /* ModuleMetarInfo::playEvents */
+
+
+void ModuleMetarInfo::emitEvent(const std::string& event)
+{
+  if (capture != 0)
+  {
+    capture->push_back(event);
+  }
+  else
+  {
+    processEvent(event);
+  }
+} /* ModuleMetarInfo::emitEvent */
+
+
+void ModuleMetarInfo::onTimeout(std::string station)
+{
+  fetchFinished(station);
+  if (station == waiting_icao)
+  {
+    waiting_icao = "";
+    stringstream temp;
+    temp << "metar_not_valid";
+    say(temp);
+  }
 } /* ModuleMetarInfo::onTimeout */
 
 
-void ModuleMetarInfo::onData(std::string metarinput, size_t count)
+void ModuleMetarInfo::onData(std::string metarinput, size_t count,
+                             std::string station)
+{
+  fetchFinished(station);
+
+    // The events of the report are captured so that they can be cached
+  time_t now = time(NULL);
+  CachedReport report;
+  report.fetched = now;
+  report.requested = now;
+  capture = &report.events;
+  bool valid = parseReport(station, metarinput);
+  capture = 0;
+
+  if (valid && (cache_ttl > 0))
+  {
+    ReportCache::iterator it = report_cache.find(station);
+    if (it != report_cache.end())
+    {
+      report.requested = it->second.requested;
+    }
+    report_cache[station] = report;
+  }
+
+  if (station == waiting_icao)
+  {
+    waiting_icao = "";
+    playEvents(report.events);
+  }
+} /* ModuleMetarInfo::onData */
+
+
+bool ModuleMetarInfo::parseReport(const std::string& station,
+                                  std::string html)
 {
   std::string metar = "";
-  html += metarinput;
 
   // switching between the newer xml-service by aviationweather and the old 
   // noaa.gov version. With the standard TXT format anybody will be able to 
@@ -909,7 +1245,7 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
       cout << "Metar information not available" << endl;
       temp << "metar_not_valid";
       say(temp);
-      return;
+      return false;
     }
 
     // check day and time, if not in limit throw information away
@@ -932,7 +1268,7 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
         cout << "Metar information outdated" << endl;
         temp << "metar_not_valid";
         say(temp);
-        return;
+        return false;
       }
     }
   }
@@ -944,20 +1280,25 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
     // 2009/04/07 13:20
     // FBJW 071300Z 09013KT 9999 FEW030 29/15 Q1023 RMK ...
 
-    size_t found;
     StrList values;
     std::stringstream temp;
 
     splitStr(values, html, "\n");
 
     // split \n -> <SPACE>
-    while ((found = html.find('\n')) != string::npos) html[found] = ' ';
+    replace(html.begin(), html.end(), '\n', ' ');
     if (html.find("404 Not Found") != string::npos)
     {
       cout << "ERROR 404 from webserver -> no such airport\n";
       temp << "no_such_airport";
       say(temp);
-      return;
+      return false;
+    }
+
+    if (values.size() < 2)
+    {
+      cout << "ERROR: wrong Metarfile format, expected two lines" << endl;
+      return false;
     }
 
     metar = values.back();  // contains the METAR
@@ -971,15 +1312,15 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
       cout << "ERROR: wrong Metarfile format, first line should have the date + UTC and "
            << "must have 16 digits, e.g.:\n"
            << "2019/04/07 13:20" << endl;
-      return;
+      return false;
     }
 
-    if ((metar.find(icao)) == string::npos)
+    if ((metar.find(station)) == string::npos)
     {
       cout << "ERROR: wrong Metarfile format, second line must begin with the correct "
-           << "ICAO airport code (" << icao << ") configured in ModuleMetarInfo.conf,"
+           << "ICAO airport code (" << station << ") configured in ModuleMetarInfo.conf,"
            << "but is \"" << metar << "\"" << endl;
-      return;
+      return false;
     }
 
     if (debug)
@@ -992,17 +1333,18 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
     {
       temp << "metar_not_valid";
       say(temp);
-      return;
+      return false;
     }
   }
 
-  handleMetar(metar);
+  handleMetar(metar, station);
 
-  html = "";
-} /* onDataReceived */
+  return !metar.empty();
+} /* parseReport */
 
 
-std::string ModuleMetarInfo::getXmlParam(std::string token, std::string input)
+std::string ModuleMetarInfo::getXmlParam(const std::string& token,
+                                         const std::string& input)
 {
   std::string start = "<";
   std::string stop = "</";
@@ -1026,7 +1368,8 @@ std::string ModuleMetarInfo::getXmlParam(std::string token, std::string input)
 } /* getXmlParam */
 
 
-int ModuleMetarInfo::handleMetar(std::string input)
+int ModuleMetarInfo::handleMetar(const std::string& input,
+                                 const std::string& station)
 {
    std::string current;
    std::string tempstr;
@@ -1047,7 +1390,7 @@ int ModuleMetarInfo::handleMetar(std::string input)
    temp << "metar \"" << input << "\"";
    say(temp);
 
-   temp << "announce_airport " << icao;
+   temp << "announce_airport " << station;
    say(temp);
 
    splitStr(values, input, " ");
@@ -1133,7 +1476,7 @@ int ModuleMetarInfo::handleMetar(std::string input)
             {
               if (!is_false)     // only once
               {
-                 processEvent("say clouds");
+                 emitEvent("say clouds");
                  is_false = true;
               }
               temp << "clouds " << tempstr;
@@ -1218,7 +1561,7 @@ int ModuleMetarInfo::handleMetar(std::string input)
             break;
 
          case SNOWCLOSED:
-            processEvent("snowclosed");
+            emitEvent("snowclosed");
             break;
 
          case PEAKWIND:
@@ -1232,7 +1575,7 @@ int ModuleMetarInfo::handleMetar(std::string input)
             break;
 
          case NOSPECI:
-            processEvent("nospeci");
+            emitEvent("nospeci");
             break;
 
          case WINDSHIFT:
@@ -1392,77 +1735,20 @@ int ModuleMetarInfo::handleMetar(std::string input)
 }
 
 
-// here we check the current METAR-token with regex
-// function, it returns the type (temperature, dewpoint, clouds, ...)
+// here we check the current METAR-token with the precompiled regex
+// patterns, it returns the type (temperature, dewpoint, clouds, ...)
 int ModuleMetarInfo::checkToken(std::string token)
 {
-    int retvalue = INVALID;
-    typedef std::map<std::string, int> Mregex;
-    Mregex mre;
-
-    map<string, int>::iterator rt;
-
-    mre["^[0-9]/[0-9]sm$"]                           = ISPARTOFMILES;
-    mre["^(a|q)([0-9]{4})$"]                         = QNH;
-    mre["^([0-9]{3}|vrb)([0-9]{2}g)?([0-9]{2})(kt|mph|mps|kph)"] = WIND; // wind
-    mre["^[0-9]{4}(ndv|n|ne|e|se|s|sw|w|nw)?$"]      = ISVIEW;   // view
-    mre["^[0-9]{6}z"]                                = UTC;
-    mre["^[0-9]{1,2}sm$"]                            = ISVIEW;
-    mre["^[0-9]{3}v[0-9]{3}$"]                         = VALUEVARIES;
-    mre["^(m)?(//|[0-9]{2})/(m)?(//|[0-9]{2})$"]     = TEMPERATURE;
-    mre["^(cavok|tcu)$"]                               = WORDSEXT;
-    mre["(becmg|nosig)"]                             = FORECAST;
-    mre["^(all|ws|clr|rwy|skc|nsc|tempo|ocnl|frq|nsw|cons)$"] = WORDSNOEXT;
-    mre["^(fm|tl|at)([0-9]{4})z$"]                     = TIME;
-    mre["^((few|sct|bkn|ovc)[0-9]{3})(///)?(ac|acc|as|cb|cbmam|cc|cf|ci|cs|cu|tcu|ns|sc|sf|st)?"] = CLOUDSVALID;
-    mre["^r[0-3][0-9](ll|l|c|r|rr)?/(p|m)?([0-9]{4})(v(p|m)[0-9]{4})?(u|d|n)?(ft)?$"] = RVR;
-    mre["^r[0-8][0-9](ll|l|c|r|rr)?/([0-9]|/|c)([1259]|/|l)([0-9]|/|r)([0-9]|/|d)([0-9]|/){2}$"] = ALLRWYSTATE;
-    mre["^vv[0-9]{3}$"]                              = VERTICALVIEW;
-    mre["^(\\+|\\-|vc|re)?([bdfimprstv][a-z]){1,2}$"]= ACTUALWX;
-    mre["^r(wy)?[0-9]{2}(ll|l|c|r|rr)?$"]             = RUNWAY;
-    mre["^cig$"]                                       = CEILING;
-    mre["^[1-9]$"]                                   = IS1STPARTOFVIEW;
-    mre["^rmk$"]                                       = RMK;
-    mre["^slp"]                                        = SLP;
-    mre["^snoclo$"]                                    = SNOWCLOSED;
-    mre["^wnd$"]                                       = PEAKWIND;
-    mre["^auto$"]                                      = AUTO;
-    mre["^nospeci$"]                                   = NOSPECI;
-    mre["^ao[1|2]$"]                                   = AUTOTYPE;
-    mre["^wshft$"]                                     = WINDSHIFT;
-    mre["^vis$"]                                       = RMKVISIBILITY;
-    mre["^fropa"]                                      = FROPA;
-    mre["^ltg[ciag]{2,8}$"]                            = LIGHTNING;
-    mre["^virga$"]                                     = VIRGA;
-    mre["^tx(m)?[0-9]{2}/[0-9]{2}z$"]                  = DAYTEMPMAX;
-    mre["^tn(m)?[0-9]{2}/[0-9]{2}z$"]                  = DAYTEMPMIN;
-    mre["^fl[0-9]?[0-9]{2}$"]                          = FLIGHTLEVEL;
-    mre["^tempo[0-9]{4}$"]                             = TEMPOOBSCURATION;
-    mre["^t[0-1][0-9]{3}[0-1][0-9]{3}$"]               = TEMPINRMK;
-    mre["^1[0-9]{4}$"]                                 = MAXTEMP;
-    mre["^2[0-9]{4}$"]                                 = MINTEMP;
-    mre["^4[0-9]{8}$"]                                 = MINMAXTEMP;
-    mre["^5[0-9]{4}$"]                                 = PRESSURETENDENCY;
-    mre["^p(cpn)?[0-9]{4}$"]                           = PRECIPITATION1;
-    mre["^6[0-9]{4}$"]                                 = PRECIPITATION6;
-    mre["^7[0-9]{4}$"]                                 = PRECIPITATION24;
-    mre["^(tsno|fzrano)$"]                             = NOSEVEREWX;
-    mre["^qfe[0-9]{3}\\.[0-9]$"]                       = QFEINRMK;
-    mre["^[\\$]$"]                                     = MAINTENANCE;
-    mre["^[a-z]{2,4}(b|e)([0-9]{2}){1,2}(e[0-9]{2,4})?$"]  = PRECIPINRMK;
-    mre["^((ac|acc|as|cb|cbmam|cc|cf|ci|cs|cu|tcu|ns|sc|sf|st)[1-8]){1,4}$"] = CLOUDTYPE;
-    mre["^(mar|alqds|mod|twr|sfc|dsnt|lan|loc|fir|presrr|presfr|abv|agl|btn|cld|cot|nil|obs|obsc|stnr|turb|valid|wkn|wspd|ltg|wx)$"] = WORDSINRMK;
-
-    for (rt = mre.begin(); rt != mre.end(); rt++)
+    TokenPatterns::const_iterator it;
+    for (it = token_patterns.begin(); it != token_patterns.end(); ++it)
     {
-       if (rmatch(token, rt->first))
+       if (regexec(it->first, token.c_str(), 0, NULL, 0) == 0)
        {
-           retvalue = rt->second;
-           break;
+           return it->second;
        }
     }
 
-    return retvalue;
+    return INVALID;
 } /* checkToken */
 
 
@@ -1866,19 +2152,22 @@ bool ModuleMetarInfo::isActualWX(std::string &retval, std::string token)
 } /* isActualWX */
 
 
-// needed by regex
-bool ModuleMetarInfo::rmatch(std::string tok, std::string pattern)
+// needed by regex, each pattern is only compiled the first time it is used
+bool ModuleMetarInfo::rmatch(const std::string& tok, const std::string& pattern)
 {
-  regex_t re;
-  int status = regcomp(&re, pattern.c_str(), REG_EXTENDED);
-  if (status != 0)
+  RegexCache::iterator it = regex_cache.find(pattern);
+  if (it == regex_cache.end())
   {
-    return false;
+    regex_t *re = new regex_t;
+    if (regcomp(re, pattern.c_str(), REG_EXTENDED | REG_NOSUB) != 0)
+    {
+      delete re;
+      return false;
+    }
+    it = regex_cache.insert(make_pair(pattern, re)).first;
   }
 
-  bool success = (regexec(&re, tok.c_str(), 0, NULL, 0) == 0);
-  regfree(&re);
-  return success;
+  return (regexec(it->second, tok.c_str(), 0, NULL, 0) == 0);
 
 } /* rmatch */
 
@@ -2269,7 +2558,7 @@ bool ModuleMetarInfo::ispObscurance(std::string &retval, std::string token)
 void ModuleMetarInfo::say(stringstream &tmp)
 {
    if (debug) cout << tmp.str() << endl;  // debug
-   processEvent(tmp.str());
+   emitEvent(tmp.str());
    tmp.str("");
 } /* say */
 
@@ -43,6 +43,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <list>
 #include <map>
 #include <iostream>
+#include <ctime>
+#include <regex.h>
 #include <curl/curl.h>
 
 
@@ -54,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <Module.h>
 #include <AsyncConfig.h>
+#include <AsyncTimer.h>
 
 
 
@@ -90,9 +93,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-namespace Async {
-  class Timer;
-};
 
 
 /****************************************************************************
@@ -138,6 +138,23 @@ class ModuleMetarInfo : public Module
   private:
     class Http;
 
+    static const unsigned DEFAULT_CACHE_TTL = 600;
+    static const unsigned CACHE_IDLE_TIME = 3600;
+    static const long     FETCH_TIMEOUT = 30;
+
+    typedef std::vector<std::pair<regex_t*, int> > TokenPatterns;
+    typedef std::map<std::string, regex_t*>        RegexCache;
+    typedef std::vector<std::string>               EventList;
+
+    struct CachedReport
+    {
+      time_t    fetched;
+      time_t    requested;
+      EventList events;
+    };
+    typedef std::map<std::string, CachedReport>    ReportCache;
+    typedef std::map<std::string, Http*>           FetchMap;
+
     std::string icao;
     std::string icao_default;
     std::string longmsg;
@@ -154,11 +171,19 @@ class ModuleMetarInfo : public Module
     typedef std::map<std::string, std::string> Repdefs;
     Repdefs repstr;
 
-    std::string html;
     std::string type;
     std::string server;
     std::string link;
-    Http* http;
+
+    TokenPatterns token_patterns;
+    RegexCache    regex_cache;
+    unsigned      cache_ttl;
+    ReportCache   report_cache;
+    FetchMap      fetches;
+    std::vector<Http*> finished_fetches;
+    std::string   waiting_icao;
+    EventList*    capture;
+    Async::Timer  refresh_timer;
 
     bool initialize(void);
     void activateInit(void);
@@ -170,7 +195,14 @@ class ModuleMetarInfo : public Module
     void allMsgsWritten(void);
     void openConnection(void);
     void closeConnection(void);
-    void onTimeout(void);
+    void compileTokenPatterns(void);
+    void fetchReport(const std::string& station);
+    void fetchFinished(const std::string& station);
+    void deleteFinishedFetches(void);
+    void refreshReports(Async::Timer *t);
+    void playEvents(const EventList& events);
+    void emitEvent(const std::string& event);
+    void onTimeout(std::string station);
     std::string getSlp(std::string token);
     std::string getTempTime(std::string token);
     std::string getTempinRmk(std::string token);
@@ -181,12 +213,13 @@ class ModuleMetarInfo : public Module
     std::string getPrecipitation(std::string token);
     std::string getCloudType(std::string token);
     void isRwyState(std::string &retval, std::string token);
-    void onData(std::string metarinput, size_t count);
+    void onData(std::string metarinput, size_t count, std::string station);
+    bool parseReport(const std::string& station, std::string html);
     int  splitEmptyStr(StrList& L, const std::string& seq);
     bool isWind(std::string &retval, std::string token);
     bool isvalidUTC(std::string utctoken);
     int checkToken(std::string token);
-    bool rmatch(std::string tok, std::string token);
+    bool rmatch(const std::string& tok, const std::string& pattern);
     bool checkDirection(std::string &retval, std::string token);
     bool getRmkVisibility(std::string &retval, std::string token);
     void isTime(std::string &retval, std::string token);
@@ -203,8 +236,9 @@ class ModuleMetarInfo : public Module
     bool ispObscurance(std::string &tempstr, std::string token);
     bool getPeakWind(std::string &retval, std::string token);
     void say(std::stringstream &tmp);
-    int handleMetar(std::string input);
-    std::string getXmlParam(std::string token, std::string input);
+    int handleMetar(const std::string& input, const std::string& station);
+    std::string getXmlParam(const std::string& token,
+                            const std::string& input);
 };  /* class ModuleMetarInfo */
 
 
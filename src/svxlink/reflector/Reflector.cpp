@@ -33,6 +33,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <cassert>
+#include <cstring>
+#include <ctime>
 #include <json/json.h>
 
 
@@ -47,6 +49,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncUdpSocket.h>
 #include <AsyncApplication.h>
 #include <AsyncPty.h>
+#include <AsyncLoopMonitor.h>
+#include <AsyncTrace.h>
 #include <common.h>
 #include <codecvt>
 
@@ -81,6 +85,15 @@ using namespace Async;
  *
  ****************************************************************************/
 
+#define SESSION_TOKEN_VERSION     2
+#define SESSION_TOKEN_DATA_LEN    7
+#define SESSION_TOKEN_DIGEST_LEN  12
+#define SESSION_TOKEN_LEN         (SESSION_TOKEN_DATA_LEN + \
+                                   SESSION_TOKEN_DIGEST_LEN)
+#define SESSION_KEY_LEN           20
+
+#define TRUNK_NAME_MAX_LEN        32
+
 
 
 /****************************************************************************
@@ -89,6 +102,25 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+  /**
+   * @brief Print the number of suppressed log messages, if any
+   */
+  struct Suppressed
+  {
+    unsigned long cnt;
+  };
+
+  ostream& operator<<(ostream& os, const Suppressed& s)
+  {
+    if (s.cnt > 0)
+    {
+      os << " (" << s.cnt << " similar messages suppressed)";
+    }
+    return os;
+  }
+};
+
 
 
 /****************************************************************************
@@ -129,18 +161,46 @@ namespace {
 
 Reflector::Reflector(void)
   : m_srv(0), m_udp_sock(0), m_tg_for_v1_clients(1), m_random_qsy_lo(0),
-    m_random_qsy_hi(0), m_random_qsy_tg(0), m_http_server(0), m_cmd_pty(0)
+    m_random_qsy_hi(0), m_random_qsy_tg(0), m_http_server(0), m_cmd_pty(0),
+    m_session_lifetime(300), m_trunk_srv(0), m_trunk_udp_sock(0),
+    m_recorder(0), m_streamer(0), m_udp_frames_lost(0),
+    m_udp_frames_out_of_seq(0)
 {
   TGHandler::instance()->talkerUpdated.connect(
       mem_fun(*this, &Reflector::onTalkerUpdated));
   TGHandler::instance()->requestAutoQsy.connect(
       mem_fun(*this, &Reflector::onRequestAutoQsy));
-
+  TGHandler::instance()->remoteTalkerUpdated.connect(
+      mem_fun(*this, &Reflector::onRemoteTalkerUpdated));
+  TGHandler::instance()->activeTGsChanged.connect(
+      mem_fun(*this, &Reflector::onActiveTGsChanged));
+
+  Metrics& metrics = Metrics::instance();
+  m_udp_frames_lost = metrics.counter("svxreflector_udp_frames_lost_total",
+      "The number of audio frames lost between the clients and the reflector");
+  m_udp_frames_out_of_seq = metrics.counter(
+      "svxreflector_udp_frames_out_of_seq_total",
+      "The number of UDP frames dropped since they were out of sequence");
+  metrics.collect.connect(mem_fun(*this, &Reflector::collectMetrics));
 } /* Reflector::Reflector */
 
 
 Reflector::~Reflector(void)
 {
+  for (auto trunk : m_trunks)
+  {
+    delete trunk;
+  }
+  m_trunks.clear();
+  m_trunk_pending.clear();
+  delete m_trunk_srv;
+  m_trunk_srv = 0;
+  delete m_trunk_udp_sock;
+  m_trunk_udp_sock = 0;
+  delete m_recorder;
+  m_recorder = 0;
+  delete m_streamer;
+  m_streamer = 0;
   delete m_http_server;
   m_http_server = 0;
   delete m_udp_sock;
@@ -201,6 +261,34 @@ bool Reflector::initialize(Async::Config &cfg)
   m_udp_sock->dataReceived.connect(
       mem_fun(*this, &Reflector::udpDatagramReceived));
 
+  unsigned udp_client_rate_limit = 100;
+  cfg.getValue("GLOBAL", "UDP_CLIENT_RATE_LIMIT", udp_client_rate_limit);
+  m_udp_admission.setClientRateLimit(udp_client_rate_limit);
+
+  unsigned udp_source_rate_limit = 1000;
+  cfg.getValue("GLOBAL", "UDP_SOURCE_RATE_LIMIT", udp_source_rate_limit);
+  m_udp_admission.setSourceRateLimit(udp_source_rate_limit);
+
+  m_cfg->getValue("GLOBAL", "SESSION_RESUME_TIMEOUT", m_session_lifetime);
+  if (!m_cfg->getValue("GLOBAL", "SESSION_KEY", m_session_key) ||
+      m_session_key.empty())
+  {
+      // Without a configured key, sessions can only be resumed as long as
+      // this reflector instance is running
+    m_session_key.resize(SESSION_KEY_LEN);
+    gcry_create_nonce(&m_session_key[0], m_session_key.size());
+  }
+
+  if (!initTrunks())
+  {
+    return false;
+  }
+
+  if (!initRecorder())
+  {
+    return false;
+  }
+
   unsigned sql_timeout = 0;
   cfg.getValue("GLOBAL", "SQL_TIMEOUT", sql_timeout);
   TGHandler::instance()->setSqlTimeout(sql_timeout);
@@ -233,6 +321,10 @@ bool Reflector::initialize(Async::Config &cfg)
         sigc::mem_fun(*this, &Reflector::httpClientConnected));
     m_http_server->clientDisconnected.connect(
         sigc::mem_fun(*this, &Reflector::httpClientDisconnected));
+    if (!initStreamer())
+    {
+      return false;
+    }
   }
     
     // Path for command PTY
@@ -306,13 +398,24 @@ void Reflector::nodeList(std::vector<std::string>& nodes) const
 void Reflector::broadcastMsg(const ReflectorMsg& msg,
                              const ReflectorClient::Filter& filter)
 {
+    // The message is packed once, when the first receiver is found, and the
+    // packed frame is then shared by all receiving clients
+  FramedTcpConnection::Frame frame;
   for (const auto& item : m_client_con_map)
   {
     ReflectorClient *client = item.second;
     if (filter(client) &&
         (client->conState() == ReflectorClient::STATE_CONNECTED))
     {
-      client->sendMsg(msg);
+      if (!frame)
+      {
+        frame = ReflectorClient::packMsg(msg);
+        if (!frame)
+        {
+          return;
+        }
+      }
+      client->sendFrame(msg.type(), frame);
     }
   }
 } /* Reflector::broadcastMsg */
@@ -367,6 +470,84 @@ void Reflector::requestQsy(ReflectorClient *client, uint32_t tg)
 } /* Reflector::requestQsy */
 
 
+std::vector<uint8_t> Reflector::createSessionToken(const std::string& callsign,
+                                                   ReflectorUdpMsg::ClientId client_id)
+{
+    // Token layout: version (1), client id (2), expiry time (4), truncated
+    // digest (12). It is kept short since the client send it back before
+    // login, where the frame size is limited.
+  static_assert(SESSION_TOKEN_LEN == MsgSessionToken::TOKEN_LEN,
+                "Session token length mismatch");
+  std::vector<uint8_t> token(SESSION_TOKEN_LEN);
+  uint32_t expire = time(NULL) + m_session_lifetime;
+  token[0] = SESSION_TOKEN_VERSION;
+  token[1] = client_id >> 8;
+  token[2] = client_id & 0xff;
+  for (int i=0; i<4; ++i)
+  {
+    token[3+i] = (expire >> (8 * (3-i))) & 0xff;
+  }
+  if (!calcSessionTokenDigest(token, callsign, &token[SESSION_TOKEN_DATA_LEN]))
+  {
+    return std::vector<uint8_t>();
+  }
+  return token;
+} /* Reflector::createSessionToken */
+
+
+bool Reflector::useSessionToken(const std::vector<uint8_t>& token,
+                                const std::string& callsign,
+                                ReflectorUdpMsg::ClientId& client_id)
+{
+  if ((m_session_lifetime == 0) || (token.size() != SESSION_TOKEN_LEN) ||
+      (token[0] != SESSION_TOKEN_VERSION))
+  {
+    return false;
+  }
+
+  uint8_t digest[SESSION_TOKEN_DIGEST_LEN];
+  if (!calcSessionTokenDigest(token, callsign, digest) ||
+      (memcmp(digest, &token[SESSION_TOKEN_DATA_LEN],
+              SESSION_TOKEN_DIGEST_LEN) != 0))
+  {
+    return false;
+  }
+
+  uint32_t expire = 0;
+  for (int i=0; i<4; ++i)
+  {
+    expire = (expire << 8) | token[3+i];
+  }
+  time_t now = time(NULL);
+  if (static_cast<uint32_t>(now) > expire)
+  {
+    return false;
+  }
+
+    // A token may only be used once
+  for (auto it = m_used_session_tokens.begin();
+       it != m_used_session_tokens.end(); )
+  {
+    if (it->second < now)
+    {
+      it = m_used_session_tokens.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  if (!m_used_session_tokens.insert(std::make_pair(token, expire)).second)
+  {
+    return false;
+  }
+
+  client_id = (static_cast<ReflectorUdpMsg::ClientId>(token[1]) << 8) |
+              token[2];
+  return true;
+} /* Reflector::useSessionToken */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -458,6 +639,18 @@ void Reflector::broadcastIfCurrentTalker(ReflectorClient* client, uint32_t tg, c
                         ReflectorClient::mkAndFilter(
                                 ReflectorClient::ExceptFilter(client),
                                 ReflectorClient::TgFilter(tg)));
+        for (auto trunk : m_trunks)
+        {
+          trunk->sendAudio(tg, msg.audioData());
+        }
+        if (m_recorder != 0)
+        {
+          m_recorder->writePacket(tg, msg.audioData());
+        }
+        if (m_streamer != 0)
+        {
+          m_streamer->writePacket(tg, msg.audioData());
+        }
     }
 }
 
@@ -470,29 +663,65 @@ void Reflector::resetVadStates() {
 void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
                                     void *buf, int count)
 {
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), count);
+  ASYNC_TRACE_SCOPE_ARG("net", "Reflector::udpDatagramReceived", count);
 
+    // Sort out unwanted traffic before spending any resources on unpacking
+    // the datagram. Only the fixed size header is looked at in this stage.
+  unsigned long suppressed = 0;
   ReflectorUdpMsg header;
-  if (!header.unpack(ss))
+  if (!header.peek(buf, count))
   {
-    cout << "*** WARNING: Unpacking message header failed for UDP datagram "
-            "from " << addr << ":" << port << endl;
+    if (m_udp_admission.reject(UdpAdmission::REJECT_SHORT, suppressed))
+    {
+      cout << "*** WARNING: Unpacking message header failed for UDP datagram "
+              "from " << addr << ":" << port << Suppressed{suppressed} << endl;
+    }
     return;
   }
 
   ReflectorClient *client = ReflectorClient::lookup(header.clientId());
   if (client == nullptr)
   {
-    cerr << "*** WARNING: Incoming UDP datagram from " << addr << ":" << port
-         << " has invalid client id " << header.clientId() << endl;
+    if (m_udp_admission.reject(UdpAdmission::REJECT_UNKNOWN_CLIENT,
+                               suppressed))
+    {
+      cerr << "*** WARNING: Incoming UDP datagram from " << addr << ":"
+           << port << " has invalid client id " << header.clientId()
+           << Suppressed{suppressed} << endl;
+    }
     return;
   }
   if (addr != client->remoteHost())
   {
-    cerr << "*** WARNING[" << client->callsign()
-         << "]: Incoming UDP packet has the wrong source ip, "
-         << addr << " instead of " << client->remoteHost() << endl;
+    if (m_udp_admission.reject(UdpAdmission::REJECT_WRONG_HOST, suppressed))
+    {
+      cerr << "*** WARNING[" << client->callsign()
+           << "]: Incoming UDP packet has the wrong source ip, "
+           << addr << " instead of " << client->remoteHost()
+           << Suppressed{suppressed} << endl;
+    }
+    return;
+  }
+    // The source is only rate limited after the client has been looked up.
+    // A source rate limit bucket is then only created for addresses that
+    // belong to connected clients, so spoofed sources cannot fill the table.
+  if (!m_udp_admission.admitSource(addr))
+  {
+    if (m_udp_admission.reject(UdpAdmission::REJECT_SOURCE_RATE, suppressed))
+    {
+      cerr << "*** WARNING: Dropping UDP datagrams from " << addr
+           << " due to rate limiting" << Suppressed{suppressed} << endl;
+    }
+    return;
+  }
+  if (!m_udp_admission.admitClient(header.clientId()))
+  {
+    if (m_udp_admission.reject(UdpAdmission::REJECT_CLIENT_RATE, suppressed))
+    {
+      cerr << "*** WARNING[" << client->callsign()
+           << "]: Dropping UDP datagrams due to rate limiting"
+           << Suppressed{suppressed} << endl;
+    }
     return;
   }
   if (client->remoteUdpPort() == 0)
@@ -502,10 +731,13 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   }
   else if (port != client->remoteUdpPort())
   {
-    cerr << "*** WARNING[" << client->callsign()
-         << "]: Incoming UDP packet has the wrong source UDP "
-            "port number, " << port << " instead of "
-         << client->remoteUdpPort() << endl;
+    if (m_udp_admission.reject(UdpAdmission::REJECT_WRONG_PORT, suppressed))
+    {
+      cerr << "*** WARNING[" << client->callsign()
+           << "]: Incoming UDP packet has the wrong source UDP "
+              "port number, " << port << " instead of "
+           << client->remoteUdpPort() << Suppressed{suppressed} << endl;
+    }
     return;
   }
 
@@ -513,19 +745,34 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   uint16_t udp_rx_seq_diff = header.sequenceNum() - client->nextUdpRxSeq();
   if (udp_rx_seq_diff > 0x7fff) // Frame out of sequence (ignore)
   {
-    cout << client->callsign()
-         << ": Dropping out of sequence frame with seq="
-         << header.sequenceNum() << ". Expected seq="
-         << client->nextUdpRxSeq() << endl;
+    m_udp_frames_out_of_seq->inc();
+    if (m_udp_admission.reject(UdpAdmission::REJECT_OUT_OF_SEQ, suppressed))
+    {
+      cout << client->callsign()
+           << ": Dropping out of sequence frame with seq="
+           << header.sequenceNum() << ". Expected seq="
+           << client->nextUdpRxSeq() << Suppressed{suppressed} << endl;
+    }
     return;
   }
   else if (udp_rx_seq_diff > 0) // Frame(s) lost
   {
-    cout << client->callsign()
-         << ": UDP frame(s) lost. Expected seq=" << client->nextUdpRxSeq()
-         << ". Received seq=" << header.sequenceNum() << endl;
+    m_udp_frames_lost->inc(udp_rx_seq_diff);
+    if (m_udp_admission.reject(UdpAdmission::REJECT_FRAMES_LOST, suppressed))
+    {
+      cout << client->callsign()
+           << ": UDP frame(s) lost. Expected seq=" << client->nextUdpRxSeq()
+           << ". Received seq=" << header.sequenceNum()
+           << Suppressed{suppressed} << endl;
+    }
   }
 
+    // The datagram has been admitted so now set up the stream used for
+    // unpacking the message body
+  stringstream ss;
+  ss.write(reinterpret_cast<const char *>(buf) + ReflectorUdpMsg::HEADER_SIZE,
+           count - ReflectorUdpMsg::HEADER_SIZE);
+
   client->udpMsgReceived(header);
 
   switch (header.type())
@@ -726,36 +973,109 @@ void Reflector::onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
       resetVadStates();
       old_talker->voiceDetected = false;
     cout << old_talker->callsign() << ": Talker stop on TG #" << tg << endl;
-    broadcastMsg(MsgTalkerStop(tg, old_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
-    if (tg == tgForV1Clients())
+    notifyTalkerStop(tg, old_talker->callsign(), old_talker);
+    for (auto trunk : m_trunks)
     {
-      broadcastMsg(MsgTalkerStopV1(old_talker->callsign()), v1_client_filter);
+      trunk->sendTalkerStop(tg, old_talker->callsign());
     }
-    broadcastUdpMsg(MsgUdpFlushSamples(),
-          ReflectorClient::mkAndFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::ExceptFilter(old_talker)));
   }
   if (new_talker != 0)
   {
     cout << new_talker->callsign() << ": Talker start on TG #" << tg << endl;
-    broadcastMsg(MsgTalkerStart(tg, new_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
-    if (tg == tgForV1Clients())
+    Metrics::instance().counter("svxreflector_talker_starts_total",
+        "The number of talker starts per talk group",
+        {{"tg", to_string(tg)}})->inc();
+    notifyTalkerStart(tg, new_talker->callsign());
+    for (auto trunk : m_trunks)
+    {
+      trunk->sendTalkerStart(tg, new_talker->callsign());
+    }
+  }
+} /* Reflector::onTalkerUpdated */
+
+
+void Reflector::collectMetrics(void)
+{
+  Metrics& metrics = Metrics::instance();
+  metrics.gauge("svxreflector_clients",
+      "The number of connected clients")->set(m_client_con_map.size());
+
+    // Recreate the per client metrics so that disconnected clients go away
+  metrics.remove("svxreflector_client_udp_jitter_seconds");
+  for (const auto& item : m_client_con_map)
+  {
+    ReflectorClient* client = item.second;
+    if (client->conState() != ReflectorClient::STATE_CONNECTED)
     {
-      broadcastMsg(MsgTalkerStartV1(new_talker->callsign()), v1_client_filter);
+      continue;
     }
+    metrics.gauge("svxreflector_client_udp_jitter_seconds",
+        "The interarrival jitter of audio frames received from a client",
+        {{"callsign", client->callsign()}})->set(client->udpAudioJitter());
+  }
+} /* Reflector::collectMetrics */
+
+
+void Reflector::onRemoteTalkerUpdated(uint32_t tg,
+                                      const std::string& old_callsign,
+                                      const std::string& new_callsign)
+{
+  if (!old_callsign.empty())
+  {
+    notifyTalkerStop(tg, old_callsign, 0);
+  }
+  if (!new_callsign.empty())
+  {
+    notifyTalkerStart(tg, new_callsign);
+  }
+} /* Reflector::onRemoteTalkerUpdated */
+
+
+void Reflector::notifyTalkerStart(uint32_t tg, const std::string& callsign)
+{
+  broadcastMsg(MsgTalkerStart(tg, callsign),
+      ReflectorClient::mkAndFilter(
+        v2_client_filter,
+        ReflectorClient::mkOrFilter(
+          ReflectorClient::TgFilter(tg),
+          ReflectorClient::TgMonitorFilter(tg))));
+  if (tg == tgForV1Clients())
+  {
+    broadcastMsg(MsgTalkerStartV1(callsign), v1_client_filter);
+  }
+  if (m_recorder != 0)
+  {
+    m_recorder->talkerStart(tg, callsign);
+  }
+} /* Reflector::notifyTalkerStart */
+
+
+void Reflector::notifyTalkerStop(uint32_t tg, const std::string& callsign,
+                                 ReflectorClient *old_talker)
+{
+  broadcastMsg(MsgTalkerStop(tg, callsign),
+      ReflectorClient::mkAndFilter(
+        v2_client_filter,
+        ReflectorClient::mkOrFilter(
+          ReflectorClient::TgFilter(tg),
+          ReflectorClient::TgMonitorFilter(tg))));
+  if (tg == tgForV1Clients())
+  {
+    broadcastMsg(MsgTalkerStopV1(callsign), v1_client_filter);
   }
-} /* Reflector::setTalker */
+  broadcastUdpMsg(MsgUdpFlushSamples(),
+        ReflectorClient::mkAndFilter(
+          ReflectorClient::TgFilter(tg),
+          ReflectorClient::ExceptFilter(old_talker)));
+  if (m_recorder != 0)
+  {
+    m_recorder->talkerStop(tg);
+  }
+  if (m_streamer != 0)
+  {
+    m_streamer->flush(tg);
+  }
+} /* Reflector::notifyTalkerStop */
 
 
 void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
@@ -773,6 +1093,17 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
     return;
   }
 
+  if ((m_streamer != 0) && (req.target.compare(0, 8, "/stream/") == 0))
+  {
+    httpStreamRequest(con, req);
+    return;
+  }
+
+  if (Metrics::handleHttpRequest(con, req))
+  {
+    return;
+  }
+
   if (req.target != "/status")
   {
     res.setCode(404);
@@ -861,6 +1192,45 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
     }
     status["nodes"][client->callsign()] = node;
   }
+  Json::Value udp_rejects(Json::objectValue);
+  for (int i=0; i<UdpAdmission::REJECT_REASON_CNT; ++i)
+  {
+    auto reason = static_cast<UdpAdmission::Reason>(i);
+    udp_rejects[UdpAdmission::reasonName(reason)] =
+      Json::UInt64(m_udp_admission.rejectCount(reason));
+  }
+  status["udpRejects"] = udp_rejects;
+  if (!m_trunks.empty())
+  {
+    Json::Value trunks(Json::objectValue);
+    for (auto trunk : m_trunks)
+    {
+      Json::Value t(Json::objectValue);
+      t["section"] = trunk->section();
+      t["up"] = trunk->isUp();
+      Json::Value tgs(Json::arrayValue);
+      for (uint32_t tg : trunk->peerTGs())
+      {
+        tgs.append(tg);
+      }
+      t["peerTGs"] = tgs;
+      trunks[trunk->peerName()] = t;
+    }
+    status["trunks"] = trunks;
+  }
+  if (m_recorder != 0)
+  {
+    Json::Value recorder(Json::objectValue);
+    recorder["droppedPackets"] = Json::UInt64(m_recorder->droppedPackets());
+    status["recorder"] = recorder;
+  }
+  if (m_streamer != 0)
+  {
+    Json::Value stream(Json::objectValue);
+    stream["listeners"] = Json::UInt64(m_streamer->listenerCount());
+    stream["evicted"] = Json::UInt64(m_streamer->evictedCount());
+    status["httpStream"] = stream;
+  }
   std::ostringstream os;
   Json::StreamWriterBuilder builder;
   builder["commentStyle"] = "None";
@@ -893,9 +1263,58 @@ void Reflector::httpClientDisconnected(Async::HttpServerConnection *con,
   //          << con->remoteHost() << ":" << con->remotePort()
   //          << ": " << Async::HttpServerConnection::disconnectReasonStr(reason)
   //          << std::endl;
+  if (m_streamer != 0)
+  {
+    m_streamer->removeListener(con);
+  }
 } /* Reflector::httpClientDisconnected */
 
 
+void Reflector::httpStreamRequest(Async::HttpServerConnection *con,
+                                  Async::HttpServerConnection::Request& req)
+{
+  Async::HttpServerConnection::Response res;
+
+    // The target is on the form /stream/<tg>, optionally followed by a
+    // filename extension, e.g. /stream/240.ogg
+  const char *tg_str = req.target.c_str() + 8;
+  char *endptr = 0;
+  unsigned long tg = strtoul(tg_str, &endptr, 10);
+  if ((endptr == tg_str) || ((*endptr != '\0') && (*endptr != '.')) ||
+      (tg > UINT32_MAX) || !m_streamer->isAllowed(tg) ||
+      TGHandler::instance()->isRestricted(tg))
+  {
+    res.setCode(404);
+    res.setContent("application/json", "{\"msg\":\"Not found!\"}");
+    con->write(res);
+    return;
+  }
+
+  if (m_streamer->isFull())
+  {
+    res.setCode(503);
+    res.setContent("application/json",
+        "{\"msg\":\"Too many stream listeners\"}");
+    con->write(res);
+    return;
+  }
+
+  if (req.method == "HEAD")
+  {
+    res.setCode(200);
+    res.setHeader("Content-type", "audio/ogg");
+    con->write(res);
+    return;
+  }
+
+  if (!m_streamer->addListener(tg, con))
+  {
+    con->disconnect();
+    con->disconnected(con, Async::HttpServerConnection::DR_ORDERED_DISCONNECT);
+  }
+} /* Reflector::httpStreamRequest */
+
+
 void Reflector::onRequestAutoQsy(uint32_t from_tg)
 {
   uint32_t tg = nextRandomQsyTg();
@@ -964,10 +1383,61 @@ void Reflector::ctrlPtyDataReceived(const void *buf, size_t count)
     }
     m_cfg->setValue(section, tag, value);
   }
+  else if (cmd == "LOOPSTATS")
+  {
+    std::string arg;
+    ss >> arg;
+    if ((!arg.empty() && (arg != "RESET")) || !(ss >> std::ws).eof())
+    {
+      errss << "Invalid PTY command '" << cmdline << "'. "
+               "Usage: LOOPSTATS [RESET]";
+      goto write_status;
+    }
+    Async::LoopMonitor *mon = Async::Application::app().loopMonitor();
+    if (mon == 0)
+    {
+      errss << "Loop monitoring not supported";
+      goto write_status;
+    }
+    std::ostringstream os;
+    mon->print(os);
+    m_cmd_pty->write(os.str());
+    if (arg == "RESET")
+    {
+      mon->reset();
+    }
+  }
+  else if (cmd == "TRACE")
+  {
+    std::string subcmd, path;
+    double window_s = 0.0;
+    ss >> subcmd;
+    if ((subcmd == "ON") || (subcmd == "OFF"))
+    {
+      Async::Trace::setEnabled(subcmd == "ON");
+    }
+    else if (subcmd == "CLEAR")
+    {
+      Async::Trace::clear();
+    }
+    else if ((subcmd == "DUMP") && (ss >> path))
+    {
+      ss >> window_s;
+      if (!Async::Trace::dumpToFile(path, window_s))
+      {
+        errss << "Could not write trace file \"" << path << "\"";
+      }
+    }
+    else
+    {
+      errss << "Invalid PTY command '" << cmdline << "'. "
+               "Usage: TRACE ON|OFF|CLEAR|DUMP <file> [<seconds>]";
+    }
+  }
   else
   {
     errss << "Unknown PTY command '" << cmdline
-          << "'. Valid commands are: CFG";
+          << "'. Valid commands are: CFG, LOOPSTATS, TRACE";
   }
 
   write_status:
@@ -1017,10 +1487,316 @@ void Reflector::cfgUpdated(const std::string& section, const std::string& tag)
       TGHandler::instance()->setSqlTimeout(t);
       //std::cout << "### New value for " << tag << "=" << t << std::endl;
     }
+    else if ((tag == "UDP_CLIENT_RATE_LIMIT") ||
+             (tag == "UDP_SOURCE_RATE_LIMIT"))
+    {
+      unsigned pps = 0;
+      if (!SvxLink::setValueFromString(pps, value))
+      {
+        std::cout << "*** ERROR: Failed to set updated configuration "
+                     "variable '" << section << "/" << tag << "'" << std::endl;
+        return;
+      }
+      if (tag == "UDP_CLIENT_RATE_LIMIT")
+      {
+        m_udp_admission.setClientRateLimit(pps);
+      }
+      else
+      {
+        m_udp_admission.setSourceRateLimit(pps);
+      }
+    }
   }
 } /* Reflector::cfgUpdated */
 
 
+bool Reflector::initTrunks(void)
+{
+  std::vector<std::string> trunk_sections;
+  m_cfg->getValue("GLOBAL", "TRUNKS", trunk_sections);
+  if (trunk_sections.empty())
+  {
+    return true;
+  }
+
+  if (!m_cfg->getValue("GLOBAL", "TRUNK_NAME", m_trunk_name) ||
+      m_trunk_name.empty())
+  {
+    cerr << "*** ERROR: GLOBAL/TRUNK_NAME must be set when GLOBAL/TRUNKS "
+            "is set" << endl;
+    return false;
+  }
+  if (m_trunk_name.size() > TRUNK_NAME_MAX_LEN)
+  {
+    cerr << "*** ERROR: GLOBAL/TRUNK_NAME must not be longer than "
+         << TRUNK_NAME_MAX_LEN << " characters" << endl;
+    return false;
+  }
+
+  uint16_t trunk_listen_port = 5302;
+  m_cfg->getValue("GLOBAL", "TRUNK_LISTEN_PORT", trunk_listen_port);
+  m_trunk_srv = new FramedTcpServer(to_string(trunk_listen_port));
+  m_trunk_srv->clientConnected.connect(
+      mem_fun(*this, &Reflector::trunkClientConnected));
+  m_trunk_srv->clientDisconnected.connect(
+      mem_fun(*this, &Reflector::trunkClientDisconnected));
+
+  m_trunk_udp_sock = new UdpSocket(trunk_listen_port);
+  if ((m_trunk_udp_sock == 0) || !m_trunk_udp_sock->initOk())
+  {
+    cerr << "*** ERROR: Could not initialize trunk UDP socket" << endl;
+    return false;
+  }
+  m_trunk_udp_sock->dataReceived.connect(
+      mem_fun(*this, &Reflector::trunkUdpDatagramReceived));
+
+  for (const auto& section : trunk_sections)
+  {
+    TrunkLink *trunk = new TrunkLink(*m_cfg, section, m_trunk_name,
+                                     m_trunk_udp_sock, trunk_listen_port);
+    m_trunks.push_back(trunk);
+    if (!trunk->initialize())
+    {
+      return false;
+    }
+    for (auto other : m_trunks)
+    {
+      if ((other != trunk) && (other->peerName() == trunk->peerName()))
+      {
+        cerr << "*** ERROR: Trunk sections " << other->section() << " and "
+             << section << " have the same PEER_NAME" << endl;
+        return false;
+      }
+    }
+    trunk->audioReceived.connect(
+        mem_fun(*this, &Reflector::trunkAudioReceived));
+  }
+
+  cout << "Trunk name " << m_trunk_name << " listening on port "
+       << trunk_listen_port << endl;
+
+  return true;
+} /* Reflector::initTrunks */
+
+
+bool Reflector::initRecorder(void)
+{
+  std::string recorder_dir;
+  if (!m_cfg->getValue("GLOBAL", "RECORDER_DIR", recorder_dir) ||
+      recorder_dir.empty())
+  {
+    return true;
+  }
+
+  std::set<uint32_t> recorder_tgs;
+  std::string recorder_tgs_str;
+  m_cfg->getValue("GLOBAL", "RECORDER_TGS", recorder_tgs_str);
+  if (!recorder_tgs_str.empty() && (recorder_tgs_str != "*") &&
+      !m_cfg->getValue("GLOBAL", "RECORDER_TGS", recorder_tgs))
+  {
+    cerr << "*** ERROR: Illegal value for GLOBAL/RECORDER_TGS: "
+         << recorder_tgs_str << endl;
+    return false;
+  }
+
+  m_recorder = new TgRecorder;
+  if (!m_recorder->initialize(recorder_dir, recorder_tgs))
+  {
+    delete m_recorder;
+    m_recorder = 0;
+    return false;
+  }
+  cout << "Recording ";
+  if (recorder_tgs.empty())
+  {
+    cout << "all talk groups";
+  }
+  else
+  {
+    cout << "talk groups " << recorder_tgs_str;
+  }
+  cout << " to " << recorder_dir << endl;
+
+  return true;
+} /* Reflector::initRecorder */
+
+
+bool Reflector::initStreamer(void)
+{
+  std::string stream_tgs_str;
+  if (!m_cfg->getValue("GLOBAL", "HTTP_STREAM_TGS", stream_tgs_str) ||
+      stream_tgs_str.empty())
+  {
+    return true;
+  }
+
+  if (!TgStreamer::isAvailable())
+  {
+    cerr << "*** ERROR: HTTP streaming is not available since svxreflector "
+            "was compiled without Ogg support" << endl;
+    return false;
+  }
+
+  std::set<uint32_t> stream_tgs;
+  if ((stream_tgs_str != "*") &&
+      !m_cfg->getValue("GLOBAL", "HTTP_STREAM_TGS", stream_tgs))
+  {
+    cerr << "*** ERROR: Illegal value for GLOBAL/HTTP_STREAM_TGS: "
+         << stream_tgs_str << endl;
+    return false;
+  }
+
+  m_streamer = new TgStreamer;
+  m_streamer->setTGs(stream_tgs);
+  unsigned max_listeners = 100;
+  m_cfg->getValue("GLOBAL", "HTTP_STREAM_MAX_LISTENERS", max_listeners);
+  m_streamer->setMaxListeners(max_listeners);
+
+  return true;
+} /* Reflector::initStreamer */
+
+
+void Reflector::trunkClientConnected(Async::FramedTcpConnection *con)
+{
+  cout << "Trunk peer " << con->remoteHost() << ":" << con->remotePort()
+       << " connected" << endl;
+  con->setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
+  m_trunk_pending[con] = con->frameReceived.connect(
+      mem_fun(*this, &Reflector::trunkFrameReceived));
+} /* Reflector::trunkClientConnected */
+
+
+void Reflector::trunkClientDisconnected(Async::FramedTcpConnection *con,
+    Async::FramedTcpConnection::DisconnectReason reason)
+{
+    // Connections that have been handed over to a trunk link are taken care
+    // of by the link itself
+  m_trunk_pending.erase(con);
+} /* Reflector::trunkClientDisconnected */
+
+
+void Reflector::trunkFrameReceived(Async::FramedTcpConnection *con,
+                                   std::vector<uint8_t>& data)
+{
+  auto it = m_trunk_pending.find(con);
+  if (it == m_trunk_pending.end())
+  {
+    return;
+  }
+  it->second.disconnect();
+  m_trunk_pending.erase(it);
+
+  stringstream ss;
+  ss.write(reinterpret_cast<const char*>(data.data()), data.size());
+  ReflectorMsg header;
+  MsgTrunkHello hello;
+  if (!header.unpack(ss) || (header.type() != MsgTrunkHello::TYPE) ||
+      !hello.unpack(ss))
+  {
+    cerr << "*** WARNING: Expected MsgTrunkHello from trunk peer "
+         << con->remoteHost() << ":" << con->remotePort() << endl;
+    con->disconnect();
+    con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+    return;
+  }
+
+  for (auto trunk : m_trunks)
+  {
+    if (trunk->peerName() == hello.name())
+    {
+      trunk->acceptConnection(con, hello);
+      return;
+    }
+  }
+
+  cerr << "*** WARNING: Unknown trunk peer \"" << hello.name() << "\" at "
+       << con->remoteHost() << ":" << con->remotePort() << endl;
+  con->disconnect();
+  con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+} /* Reflector::trunkFrameReceived */
+
+
+void Reflector::trunkUdpDatagramReceived(const IpAddress& addr, uint16_t port,
+                                         void *buf, int count)
+{
+  ReflectorUdpMsg header;
+  if (!header.peek(buf, count))
+  {
+    return;
+  }
+
+  for (auto trunk : m_trunks)
+  {
+    if (trunk->isUdpPeer(addr, port))
+    {
+      stringstream ss;
+      ss.write(reinterpret_cast<const char *>(buf) +
+                 ReflectorUdpMsg::HEADER_SIZE,
+               count - ReflectorUdpMsg::HEADER_SIZE);
+      trunk->udpMsgReceived(header, ss);
+      return;
+    }
+  }
+
+  unsigned long suppressed = 0;
+  if (m_udp_admission.reject(UdpAdmission::REJECT_UNKNOWN_CLIENT, suppressed))
+  {
+    cerr << "*** WARNING: Incoming trunk UDP datagram from unknown peer "
+         << addr << ":" << port << Suppressed{suppressed} << endl;
+  }
+} /* Reflector::trunkUdpDatagramReceived */
+
+
+void Reflector::trunkAudioReceived(uint32_t tg,
+                                   const std::vector<uint8_t>& audio)
+{
+  broadcastUdpMsg(MsgUdpAudio(audio), ReflectorClient::TgFilter(tg));
+  if (m_recorder != 0)
+  {
+    m_recorder->writePacket(tg, audio);
+  }
+  if (m_streamer != 0)
+  {
+    m_streamer->writePacket(tg, audio);
+  }
+} /* Reflector::trunkAudioReceived */
+
+
+void Reflector::onActiveTGsChanged(void)
+{
+  for (auto trunk : m_trunks)
+  {
+    trunk->updateInterest();
+  }
+} /* Reflector::onActiveTGsChanged */
+
+
+bool Reflector::calcSessionTokenDigest(const std::vector<uint8_t>& token,
+                                       const std::string& callsign,
+                                       uint8_t *digest) const
+{
+  gcry_md_hd_t hd = { 0 };
+  gcry_error_t err = gcry_md_open(&hd, GCRY_MD_SHA1, GCRY_MD_FLAG_HMAC);
+  if (!err)
+  {
+    err = gcry_md_setkey(hd, m_session_key.data(), m_session_key.size());
+  }
+  if (err)
+  {
+    gcry_md_close(hd);
+    cerr << "*** ERROR: gcrypt error: "
+         << gcry_strsource(err) << "/" << gcry_strerror(err) << endl;
+    return false;
+  }
+  gcry_md_write(hd, token.data(), SESSION_TOKEN_DATA_LEN);
+  gcry_md_write(hd, callsign.data(), callsign.size());
+    // The HMAC is truncated to keep the token short
+  memcpy(digest, gcry_md_read(hd, 0), SESSION_TOKEN_DIGEST_LEN);
+  gcry_md_close(hd);
+  return true;
+} /* Reflector::calcSessionTokenDigest */
+
+
 /*
  * This file has not been truncated
  */
@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 #include <vector>
+#include <map>
 #include <string>
 
 
@@ -50,6 +51,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncFramedTcpConnection.h>
 #include <AsyncTimer.h>
 #include <AsyncHttpServerConnection.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -60,6 +62,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ProtoVer.h"
 #include "ReflectorClient.h"
+#include "UdpAdmission.h"
+#include "TrunkLink.h"
+#include "TgRecorder.h"
+#include "TgStreamer.h"
 #include "VadIterator.h"
 
 /****************************************************************************
@@ -185,6 +191,37 @@ class Reflector : public sigc::trackable
     uint32_t randomQsyLo(void) const { return m_random_qsy_lo; }
     uint32_t randomQsyHi(void) const { return m_random_qsy_hi; }
 
+    /**
+     * @brief   Get the lifetime of session tokens
+     * @return  Returns the token lifetime in seconds, 0 if disabled
+     */
+    unsigned sessionTokenLifetime(void) const { return m_session_lifetime; }
+
+    /**
+     * @brief   Create a token that can be used to resume a session
+     * @param   callsign The callsign of the client
+     * @param   client_id The client id used by the client
+     * @return  Returns the token
+     *
+     * The token hold the client id and the expiry time and is signed using
+     * the session key so no state need to be kept in the reflector. If the
+     * session key is set in the configuration, a token may be used to resume
+     * a session even after the reflector has been restarted.
+     */
+    std::vector<uint8_t> createSessionToken(const std::string& callsign,
+                                            ReflectorUdpMsg::ClientId client_id);
+
+    /**
+     * @brief   Verify a session token and mark it as used
+     * @param   token The token to verify
+     * @param   callsign The callsign of the client trying to resume
+     * @param   client_id Set to the client id stored in the token
+     * @return  Returns \em true if the token is valid
+     */
+    bool useSessionToken(const std::vector<uint8_t>& token,
+                         const std::string& callsign,
+                         ReflectorUdpMsg::ClientId& client_id);
+
   private:
     typedef std::map<Async::FramedTcpConnection*,
                      ReflectorClient*> ReflectorClientConMap;
@@ -200,6 +237,20 @@ class Reflector : public sigc::trackable
     uint32_t                                        m_random_qsy_tg;
     Async::TcpServer<Async::HttpServerConnection>*  m_http_server;
     Async::Pty*                                     m_cmd_pty;
+    UdpAdmission                                    m_udp_admission;
+    unsigned                                        m_session_lifetime;
+    std::string                                     m_session_key;
+    std::map<std::vector<uint8_t>, time_t>          m_used_session_tokens;
+    std::string                                     m_trunk_name;
+    FramedTcpServer*                                m_trunk_srv;
+    Async::UdpSocket*                               m_trunk_udp_sock;
+    std::vector<TrunkLink*>                         m_trunks;
+    std::map<Async::FramedTcpConnection*,
+             sigc::connection>                      m_trunk_pending;
+    TgRecorder*                                     m_recorder;
+    TgStreamer*                                     m_streamer;
+    Async::Metrics::Counter*                        m_udp_frames_lost;
+    Async::Metrics::Counter*                        m_udp_frames_out_of_seq;
 
     Reflector(const Reflector&);
     Reflector& operator=(const Reflector&);
@@ -210,15 +261,38 @@ class Reflector : public sigc::trackable
                              void *buf, int count);
     void onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
                          ReflectorClient *new_talker);
+    void onRemoteTalkerUpdated(uint32_t tg, const std::string& old_callsign,
+                               const std::string& new_callsign);
+    void notifyTalkerStart(uint32_t tg, const std::string& callsign);
+    void notifyTalkerStop(uint32_t tg, const std::string& callsign,
+                          ReflectorClient *old_talker);
+    bool initTrunks(void);
+    bool initRecorder(void);
+    bool initStreamer(void);
+    void trunkClientConnected(Async::FramedTcpConnection *con);
+    void trunkClientDisconnected(Async::FramedTcpConnection *con,
+                           Async::FramedTcpConnection::DisconnectReason reason);
+    void trunkFrameReceived(Async::FramedTcpConnection *con,
+                            std::vector<uint8_t>& data);
+    void trunkUdpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
+                                  void *buf, int count);
+    void trunkAudioReceived(uint32_t tg, const std::vector<uint8_t>& audio);
+    void onActiveTGsChanged(void);
+    void collectMetrics(void);
     void httpRequestReceived(Async::HttpServerConnection *con,
                              Async::HttpServerConnection::Request& req);
     void httpClientConnected(Async::HttpServerConnection *con);
     void httpClientDisconnected(Async::HttpServerConnection *con,
         Async::HttpServerConnection::DisconnectReason reason);
+    void httpStreamRequest(Async::HttpServerConnection *con,
+                           Async::HttpServerConnection::Request& req);
     void onRequestAutoQsy(uint32_t from_tg);
     uint32_t nextRandomQsyTg(void);
     void ctrlPtyDataReceived(const void *buf, size_t count);
     void cfgUpdated(const std::string& section, const std::string& tag);
+    bool calcSessionTokenDigest(const std::vector<uint8_t>& token,
+                                const std::string& callsign,
+                                uint8_t *digest) const;
 
     std::unique_ptr<VadIterator> vadIterator;
     std::vector<float> pcmSampleBuffer;
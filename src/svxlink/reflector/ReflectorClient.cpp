@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <cerrno>
 #include <iterator>
+#include <cmath>
+#include <time.h>
 
 
 /****************************************************************************
@@ -147,8 +149,8 @@ void ReflectorClient::cleanup(void)
 bool ReflectorClient::TgFilter::operator()(ReflectorClient* client) const
 {
   //cout << "m_tg=" << m_tg << "  client_tg="
-  //     << TGHandler::instance()->TGForClient(client) << endl;
-  return m_tg == TGHandler::instance()->TGForClient(client);
+  //     << client->currentTG() << endl;
+  return m_tg == client->currentTG();
 }
 
 
@@ -164,8 +166,11 @@ ReflectorClient::ReflectorClient(Reflector *ref, Async::FramedTcpConnection *con
     m_udp_heartbeat_tx_cnt(UDP_HEARTBEAT_TX_CNT_RESET),
     m_udp_heartbeat_rx_cnt(UDP_HEARTBEAT_RX_CNT_RESET),
     m_reflector(ref), m_blocktime(0), m_remaining_blocktime(0),
-    m_current_tg(0)
+    m_current_tg(0), m_session_token_cnt(0), m_udp_audio_interval(0.0),
+    m_udp_audio_jitter(0.0)
 {
+  m_last_udp_audio_rx.tv_sec = 0;
+  m_last_udp_audio_rx.tv_nsec = 0;
   m_con->setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
   m_con->frameReceived.connect(
       mem_fun(*this, &ReflectorClient::onFrameReceived));
@@ -223,18 +228,43 @@ int ReflectorClient::sendMsg(const ReflectorMsg& msg)
     return -1;
   }
 
-  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+  FramedTcpConnection::Frame frame = packMsg(msg);
+  if (!frame)
+  {
+    errno = EBADMSG;
+    return -1;
+  }
+  return sendFrame(msg.type(), frame);
+} /* ReflectorClient::sendMsg */
 
+
+FramedTcpConnection::Frame ReflectorClient::packMsg(const ReflectorMsg& msg)
+{
   ReflectorMsg header(msg.type());
   ostringstream ss;
   if (!header.pack(ss) || !msg.pack(ss))
   {
     cerr << "*** ERROR: Failed to pack TCP message\n";
-    errno = EBADMSG;
+    return FramedTcpConnection::Frame();
+  }
+  return FramedTcpConnection::makeFrame(ss.str());
+} /* ReflectorClient::packMsg */
+
+
+int ReflectorClient::sendFrame(uint16_t type,
+                               const FramedTcpConnection::Frame& frame)
+{
+  if (((m_con_state != STATE_CONNECTED) && (type >= 100)) ||
+      !m_con->isConnected())
+  {
+    errno = ENOTCONN;
     return -1;
   }
-  return m_con->write(ss.str().data(), ss.str().size());
-} /* ReflectorClient::sendMsg */
+
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+
+  return m_con->write(frame);
+} /* ReflectorClient::sendFrame */
 
 
 void ReflectorClient::udpMsgReceived(const ReflectorUdpMsg &header)
@@ -243,9 +273,13 @@ void ReflectorClient::udpMsgReceived(const ReflectorUdpMsg &header)
 
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
 
-  if ((m_blocktime > 0) && (header.type() == MsgUdpAudio::TYPE))
+  if (header.type() == MsgUdpAudio::TYPE)
   {
-    m_remaining_blocktime = m_blocktime;
+    updateUdpAudioJitter();
+    if (m_blocktime > 0)
+    {
+      m_remaining_blocktime = m_blocktime;
+    }
   }
 } /* ReflectorClient::udpMsgReceived */
 
@@ -346,6 +380,9 @@ void ReflectorClient::onFrameReceived(FramedTcpConnection *con,
     case MsgAuthResponse::TYPE:
       handleMsgAuthResponse(ss);
       break;
+    case MsgSessionResume::TYPE:
+      handleMsgSessionResume(ss);
+      break;
     case MsgSelectTG::TYPE:
       handleSelectTG(ss);
       break;
@@ -465,30 +502,19 @@ void ReflectorClient::handleMsgAuthResponse(std::istream& is)
     if (find(connected_nodes.begin(), connected_nodes.end(),
              msg.callsign()) == connected_nodes.end())
     {
-      m_con->setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
       m_callsign = msg.callsign();
-      sendMsg(MsgAuthOk());
+      loginOk();
       cout << m_callsign << ": Login OK from "
            << m_con->remoteHost() << ":" << m_con->remotePort()
            << " with protocol version " << m_client_proto_ver.majorVer()
            << "." << m_client_proto_ver.minorVer()
            << endl;
-      m_con_state = STATE_CONNECTED;
-      MsgServerInfo msg_srv_info(m_client_id, m_supported_codecs);
-      m_reflector->nodeList(msg_srv_info.nodes());
-      sendMsg(msg_srv_info);
-      if (m_client_proto_ver < ProtoVer(0, 7))
-      {
-        MsgNodeList msg_node_list(msg_srv_info.nodes());
-        sendMsg(msg_node_list);
-      }
       if (m_client_proto_ver < ProtoVer(2, 0))
       {
         if (TGHandler::instance()->switchTo(this, m_reflector->tgForV1Clients()))
         {
           std::cout << m_callsign << ": Select TG #"
                     << m_reflector->tgForV1Clients() << std::endl;
-          m_current_tg = m_reflector->tgForV1Clients();
         }
         else
         {
@@ -515,44 +541,101 @@ void ReflectorClient::handleMsgAuthResponse(std::istream& is)
 } /* ReflectorClient::handleMsgAuthResponse */
 
 
-void ReflectorClient::handleSelectTG(std::istream& is)
+void ReflectorClient::handleMsgSessionResume(std::istream& is)
 {
-  MsgSelectTG msg;
+  if (m_con_state != STATE_EXPECT_AUTH_RESPONSE)
+  {
+    cout << "Client " << m_con->remoteHost() << ":" << m_con->remotePort()
+         << " Session resume request unexpected" << endl;
+    sendError("Session resume request unexpected");
+    return;
+  }
+
+  MsgSessionResume msg;
   if (!msg.unpack(is))
   {
     cout << "Client " << m_con->remoteHost() << ":" << m_con->remotePort()
-         << " ERROR: Could not unpack MsgSelectTG" << endl;
-    sendError("Illegal MsgSelectTG protocol message received");
+         << " ERROR: Could not unpack MsgSessionResume" << endl;
+    sendError("Illegal MsgSessionResume protocol message received");
     return;
   }
-  if (msg.tg() != m_current_tg)
+
+    // On failure the client will go on answering the authentication
+    // challenge that was sent in response to the MsgProtoVer message
+  string auth_key = lookupUserKey(msg.callsign());
+  ClientId prev_client_id = 0;
+  if (auth_key.empty() || !msg.verify(auth_key) ||
+      !m_reflector->useSessionToken(msg.token(), msg.callsign(),
+                                    prev_client_id))
   {
-    ReflectorClient *talker = TGHandler::instance()->talkerForTG(m_current_tg);
-    if (talker == this)
-    {
-      m_reflector->broadcastUdpMsg(MsgUdpFlushSamples(),
-          mkAndFilter(
-            TgFilter(m_current_tg),
-            ExceptFilter(this)));
-    }
-    else if (talker != 0)
+    cout << "Client " << m_con->remoteHost() << ":" << m_con->remotePort()
+         << " Could not resume session for user \"" << msg.callsign()
+         << "\"" << endl;
+    sendMsg(MsgSessionResumeFailed("Invalid or expired session token"));
+    return;
+  }
+
+    // If the connection was lost without the reflector noticing it, the old
+    // connection is still there. Since the client has proven that it owns
+    // the session it's safe to throw the old connection out.
+  ReflectorClient *stale_client = nullptr;
+  for (const auto& item : client_map)
+  {
+    ReflectorClient *client = item.second;
+    if ((client != this) && (client->m_callsign == msg.callsign()) &&
+        (client->m_con_state != STATE_DISCONNECTED))
     {
-      sendUdpMsg(MsgUdpFlushSamples());
+      cout << msg.callsign() << ": Replacing stale connection from "
+           << client->m_con->remoteHost() << ":"
+           << client->m_con->remotePort() << endl;
+      client->disconnect();
+      stale_client = client;
+      break;
     }
-    if (TGHandler::instance()->switchTo(this, msg.tg()))
+  }
+
+    // Reuse the previous client id if it's free. The stale client object is
+    // only deleted later so if it still hold the previous id, the ids are
+    // swapped.
+  if (prev_client_id != m_client_id)
+  {
+    auto it = client_map.find(prev_client_id);
+    if (it == client_map.end())
     {
-      cout << m_callsign << ": Select TG #" << msg.tg() << endl;
-      m_current_tg = msg.tg();
+      client_map.erase(m_client_id);
+      m_client_id = prev_client_id;
+      client_map[m_client_id] = this;
     }
-    else
+    else if (it->second == stale_client)
     {
-      // FIXME: Notify the client that the TG selection was not allowed
-      std::cout << m_callsign << ": Not allowed to use TG #"
-                << msg.tg() << std::endl;
-      TGHandler::instance()->switchTo(this, 0);
-      m_current_tg = 0;
+      std::swap(stale_client->m_client_id, m_client_id);
+      client_map[stale_client->m_client_id] = stale_client;
+      client_map[m_client_id] = this;
     }
   }
+
+  m_callsign = msg.callsign();
+  loginOk();
+  cout << m_callsign << ": Session resumed from "
+       << m_con->remoteHost() << ":" << m_con->remotePort()
+       << " with protocol version " << m_client_proto_ver.majorVer()
+       << "." << m_client_proto_ver.minorVer()
+       << endl;
+  m_reflector->broadcastMsg(MsgNodeJoined(m_callsign), ExceptFilter(this));
+} /* ReflectorClient::handleMsgSessionResume */
+
+
+void ReflectorClient::handleSelectTG(std::istream& is)
+{
+  MsgSelectTG msg;
+  if (!msg.unpack(is))
+  {
+    cout << "Client " << m_con->remoteHost() << ":" << m_con->remotePort()
+         << " ERROR: Could not unpack MsgSelectTG" << endl;
+    sendError("Illegal MsgSelectTG protocol message received");
+    return;
+  }
+  selectTG(msg.tg());
 } /* ReflectorClient::handleSelectTG */
 
 
@@ -566,25 +649,7 @@ void ReflectorClient::handleTgMonitor(std::istream& is)
     sendError("Illegal MsgTgMonitor protocol message received");
     return;
   }
-  auto tgs = msg.tgs();
-  auto it = tgs.cbegin();
-  while (it != tgs.end())
-  {
-    const auto& tg = *it;
-    if (!TGHandler::instance()->allowTgSelection(this, tg) || (tg == 0))
-    {
-      std::cout << m_callsign << ": Not allowed to monitor TG #"
-                << tg << std::endl;
-      tgs.erase(it++);
-      continue;
-    }
-    ++it;
-  }
-  cout << m_callsign << ": Monitor TG#: [ ";
-  std::copy(tgs.begin(), tgs.end(), std::ostream_iterator<uint32_t>(cout, " "));
-  cout << "]" << endl;
-
-  m_monitored_tgs = tgs;
+  setMonitoredTGs(msg.tgs());
 } /* ReflectorClient::handleTgMonitor */
 
 
@@ -868,6 +933,12 @@ void ReflectorClient::handleHeartbeat(Async::Timer *t)
     sendError("UDP heartbeat timeout");
   }
 
+  if ((m_con_state == STATE_CONNECTED) && (m_session_token_cnt > 0) &&
+      (--m_session_token_cnt == 0))
+  {
+    sendSessionToken();
+  }
+
   if (m_blocktime > 0)
   {
     if (m_remaining_blocktime == 0)
@@ -882,6 +953,126 @@ void ReflectorClient::handleHeartbeat(Async::Timer *t)
 } /* ReflectorClient::handleHeartbeat */
 
 
+void ReflectorClient::updateUdpAudioJitter(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if ((m_last_udp_audio_rx.tv_sec != 0) || (m_last_udp_audio_rx.tv_nsec != 0))
+  {
+    double interval = (now.tv_sec - m_last_udp_audio_rx.tv_sec) +
+                      (now.tv_nsec - m_last_udp_audio_rx.tv_nsec) / 1.0e9;
+
+      // A long gap is a pause between talk spurts, not jitter. Restart the
+      // mean estimate from the next interval instead.
+    if (interval > 0.5)
+    {
+      m_udp_audio_interval = 0.0;
+    }
+    else if (m_udp_audio_interval == 0.0)
+    {
+      m_udp_audio_interval = interval;
+    }
+    else
+    {
+        // Smoothing as in RFC 3550, section 6.4.1
+      m_udp_audio_interval += (interval - m_udp_audio_interval) / 16.0;
+      double deviation = fabs(interval - m_udp_audio_interval);
+      m_udp_audio_jitter += (deviation - m_udp_audio_jitter) / 16.0;
+    }
+  }
+  m_last_udp_audio_rx = now;
+} /* ReflectorClient::updateUdpAudioJitter */
+
+
+void ReflectorClient::loginOk(void)
+{
+  m_con->setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+  sendMsg(MsgAuthOk());
+  m_con_state = STATE_CONNECTED;
+  MsgServerInfo msg_srv_info(m_client_id, m_supported_codecs);
+  m_reflector->nodeList(msg_srv_info.nodes());
+  sendMsg(msg_srv_info);
+  if (m_client_proto_ver < ProtoVer(0, 7))
+  {
+    MsgNodeList msg_node_list(msg_srv_info.nodes());
+    sendMsg(msg_node_list);
+  }
+  sendSessionToken();
+} /* ReflectorClient::loginOk */
+
+
+void ReflectorClient::sendSessionToken(void)
+{
+  unsigned lifetime = m_reflector->sessionTokenLifetime();
+  if ((lifetime == 0) || (m_client_proto_ver < ProtoVer(2, 0)))
+  {
+    return;
+  }
+  std::vector<uint8_t> token =
+    m_reflector->createSessionToken(m_callsign, m_client_id);
+  if (!token.empty())
+  {
+    sendMsg(MsgSessionToken(token, lifetime));
+  }
+    // Refresh the token well before it expires
+  m_session_token_cnt = std::max(lifetime / 3, 1U);
+} /* ReflectorClient::sendSessionToken */
+
+
+void ReflectorClient::selectTG(uint32_t tg)
+{
+  if (tg != m_current_tg)
+  {
+    ReflectorClient *talker = TGHandler::instance()->talkerForTG(m_current_tg);
+    if (talker == this)
+    {
+      m_reflector->broadcastUdpMsg(MsgUdpFlushSamples(),
+          mkAndFilter(
+            TgFilter(m_current_tg),
+            ExceptFilter(this)));
+    }
+    else if (talker != 0)
+    {
+      sendUdpMsg(MsgUdpFlushSamples());
+    }
+    if (TGHandler::instance()->switchTo(this, tg))
+    {
+      cout << m_callsign << ": Select TG #" << tg << endl;
+    }
+    else
+    {
+      // FIXME: Notify the client that the TG selection was not allowed
+      std::cout << m_callsign << ": Not allowed to use TG #"
+                << tg << std::endl;
+      TGHandler::instance()->switchTo(this, 0);
+    }
+  }
+} /* ReflectorClient::selectTG */
+
+
+void ReflectorClient::setMonitoredTGs(std::set<uint32_t> tgs)
+{
+  auto it = tgs.cbegin();
+  while (it != tgs.end())
+  {
+    const auto& tg = *it;
+    if (!TGHandler::instance()->allowTgSelection(this, tg) || (tg == 0))
+    {
+      std::cout << m_callsign << ": Not allowed to monitor TG #"
+                << tg << std::endl;
+      tgs.erase(it++);
+      continue;
+    }
+    ++it;
+  }
+  cout << m_callsign << ": Monitor TG#: [ ";
+  std::copy(tgs.begin(), tgs.end(), std::ostream_iterator<uint32_t>(cout, " "));
+  cout << "]" << endl;
+
+  m_monitored_tgs = tgs;
+} /* ReflectorClient::setMonitoredTGs */
+
+
 std::string ReflectorClient::lookupUserKey(const std::string& callsign)
 {
   string auth_group;
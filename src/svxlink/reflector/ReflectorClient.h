@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <json/json.h>
 #include <random>
+#include <unordered_map>
 
 
 /****************************************************************************
@@ -333,6 +334,25 @@ class ReflectorClient
      */
     int sendMsg(const ReflectorMsg& msg);
 
+    /**
+     * @brief   Pack a TCP message into a frame
+     * @param   msg The message to pack
+     * @return  Returns the packed frame or an empty pointer on failure
+     *
+     * A packed frame can be sent to any number of clients using the sendFrame
+     * function. Use this to only pack a message once when it is to be sent
+     * to many clients.
+     */
+    static Async::FramedTcpConnection::Frame packMsg(const ReflectorMsg& msg);
+
+    /**
+     * @brief   Send a packed TCP message to the remote end
+     * @param   type The type of the packed message
+     * @param   frame The packed message, @see packMsg
+     * @return  On success 0 is returned or else -1
+     */
+    int sendFrame(uint16_t type, const Async::FramedTcpConnection::Frame& frame);
+
     /**
      * @brief   Handle a received UDP message
      * @param   The received UDP message
@@ -342,6 +362,16 @@ class ReflectorClient
      */
     void udpMsgReceived(const ReflectorUdpMsg &header);
 
+    /**
+     * @brief   Get the interarrival jitter of received audio packets
+     * @return  Returns the smoothed jitter in seconds
+     *
+     * The jitter is the smoothed absolute deviation of the time between
+     * received audio packets from its smoothed mean. Gaps between talk
+     * spurts are not included.
+     */
+    double udpAudioJitter(void) const { return m_udp_audio_jitter; }
+
     /**
      * @brief   Send a UDP message to the client
      * @param   The message to send
@@ -382,6 +412,15 @@ class ReflectorClient
      */
     uint32_t currentTG(void) const { return m_current_tg; }
 
+    /**
+     * @brief   Set the current talk group
+     * @param   tg The talk group
+     *
+     * This function is only to be called by TGHandler, which keep the
+     * current talk group of each client up to date.
+     */
+    void setCurrentTG(uint32_t tg) { m_current_tg = tg; }
+
     /**
      * @brief   Get the monitored talk groups
      * @return  Returns the monitored talk groups
@@ -432,7 +471,8 @@ class ReflectorClient
 
 private:
     using ClientIdRandomDist  = std::uniform_int_distribution<ClientId>;
-    using ClientMap           = std::map<ClientId, ReflectorClient*>;
+    using ClientMap           = std::unordered_map<ClientId,
+                                                 ReflectorClient*>;
 
     static const uint16_t MIN_MAJOR_VER = 0;
     static const uint16_t MIN_MINOR_VER = 6;
@@ -473,6 +513,10 @@ private:
     RxMap                       m_rx_map;
     TxMap                       m_tx_map;
     Json::Value                 m_node_info;
+    unsigned                    m_session_token_cnt;
+    struct timespec             m_last_udp_audio_rx;
+    double                      m_udp_audio_interval;
+    double                      m_udp_audio_jitter;
 
     static ClientId newClient(ReflectorClient* client);
 
@@ -482,6 +526,7 @@ private:
                          std::vector<uint8_t>& data);
     void handleMsgProtoVer(std::istream& is);
     void handleMsgAuthResponse(std::istream& is);
+    void handleMsgSessionResume(std::istream& is);
     void handleSelectTG(std::istream& is);
     void handleTgMonitor(std::istream& is);
     void handleNodeInfo(std::istream& is);
@@ -494,6 +539,11 @@ private:
     void onDiscTimeout(Async::Timer *t);
 
     void handleHeartbeat(Async::Timer *t);
+    void updateUdpAudioJitter(void);
+    void loginOk(void);
+    void sendSessionToken(void);
+    void selectTG(uint32_t tg);
+    void setMonitoredTGs(std::set<uint32_t> tgs);
     std::string lookupUserKey(const std::string& callsign);
 
 };  /* class ReflectorClient */
@@ -0,0 +1,1135 @@
+/**
+@file	 ReflectorLoadGen.cpp
+@brief   Load generator and benchmark tool for the SvxReflector
+@author  agent
+@date	 2026-10-18
+
+This utility is used to find out how many nodes and simultaneous talkers a
+SvxReflector installation can handle. A number of synthetic clients log in to
+the reflector using the real authentication handshake. A number of them are
+talkers, each on its own talk group, that stream pre-encoded Opus frames at
+the normal 20ms cadence. The rest of the clients select one of the talker talk
+groups and measure the forwarding latency, jitter and loss for every frame
+they receive. When the test is done, a JSON report is written so that the
+results can be tracked from one build to the next.
+
+The reflector must be configured to accept the synthetic clients, e.g.:
+
+  [USERS]
+  LOADGEN1=LoadGen
+  LOADGEN2=LoadGen
+  ...
+
+  [PASSWORDS]
+  LoadGen="secret"
+
+Since the load generator and the reflector measure time using the same clock,
+the latency figures are only meaningful when both are run on the same host or
+on hosts with a low and stable delay between them.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <popt.h>
+#include <sigc++/sigc++.h>
+#include <json/json.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncTcpClient.h>
+#include <AsyncFramedTcpConnection.h>
+#include <AsyncUdpSocket.h>
+#include <AsyncAudioEncoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define PROGRAM_NAME "SvxReflectorLoadGen"
+
+  // The length of each audio frame in milliseconds
+#define FRAME_LEN_MS      20
+
+  // The number of unique frames to pre-encode. The frames are used to
+  // identify a received frame so the frame sequence must be much longer than
+  // the highest latency that can be measured.
+#define FRAME_CNT         50
+
+  // Give up on clients that have not logged in within this time
+#define LOGIN_TIMEOUT_MS  30000
+
+  // The time to wait for straggling frames after the talkers have stopped
+#define DRAIN_TIME_MS     1000
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+/**
+ * Pre-encoded audio frames. White noise is used so that every encoded frame
+ * is unique. That way a received frame can be mapped back to the time it was
+ * sent without having to add anything to the audio data.
+ */
+class FrameSet : public sigc::trackable
+{
+  public:
+    bool encode(void)
+    {
+      AudioEncoder *enc = AudioEncoder::create("OPUS");
+      if (enc == 0)
+      {
+        cerr << "*** ERROR: The OPUS audio codec is not available\n";
+        return false;
+      }
+      enc->writeEncodedSamples.connect(
+          sigc::mem_fun(*this, &FrameSet::frameEncoded));
+      enc->setOption("FRAME_SIZE", "20");
+
+      const int frame_samples = INTERNAL_SAMPLE_RATE * FRAME_LEN_MS / 1000;
+      std::mt19937 rng(4711);
+      std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+      vector<float> samples(frame_samples);
+      for (int i=0; i<FRAME_CNT; ++i)
+      {
+        std::generate(samples.begin(), samples.end(),
+                      [&](void) { return noise(rng); });
+        enc->writeSamples(&samples[0], samples.size());
+      }
+      delete enc;
+
+      if (m_frames.size() != FRAME_CNT)
+      {
+        cerr << "*** ERROR: Expected " << FRAME_CNT << " encoded frames but "
+             << "got " << m_frames.size() << endl;
+        return false;
+      }
+      for (size_t i=0; i<m_frames.size(); ++i)
+      {
+        if (!m_index.insert(make_pair(m_frames[i], i)).second)
+        {
+          cerr << "*** ERROR: The pre-encoded frames are not unique\n";
+          return false;
+        }
+      }
+      return true;
+    }
+
+    size_t size(void) const { return m_frames.size(); }
+
+    const vector<uint8_t>& frame(size_t idx) const { return m_frames[idx]; }
+
+    int find(const vector<uint8_t>& frame) const
+    {
+      map<vector<uint8_t>, size_t>::const_iterator it = m_index.find(frame);
+      return (it != m_index.end()) ? static_cast<int>(it->second) : -1;
+    }
+
+  private:
+    vector<vector<uint8_t> >      m_frames;
+    map<vector<uint8_t>, size_t>  m_index;
+
+    void frameEncoded(const void *buf, int size)
+    {
+      const uint8_t *ptr = reinterpret_cast<const uint8_t*>(buf);
+      m_frames.push_back(vector<uint8_t>(ptr, ptr + size));
+    }
+}; /* class FrameSet */
+
+
+/**
+ * One synthetic reflector node. A client is either a talker, streaming audio
+ * on its own talk group, or a listener on the talk group of one of the
+ * talkers.
+ */
+class LoadGenClient : public sigc::trackable
+{
+  public:
+    struct Stats
+    {
+      unsigned        received      = 0;
+      unsigned        unknown       = 0;
+      double          jitter        = 0.0;
+      vector<float>   latencies;
+    };
+
+    LoadGenClient(const string& host, uint16_t port, const string& callsign,
+                  const string& auth_key, uint32_t tg,
+                  const set<uint32_t>& monitor_tgs, const FrameSet& frames)
+      : m_con(host, port), m_callsign(callsign), m_auth_key(auth_key),
+        m_tg(tg), m_monitor_tgs(monitor_tgs), m_frames(frames),
+        m_state(STATE_DISCONNECTED), m_client_id(0), m_udp_sock(0),
+        m_next_udp_tx_seq(0), m_is_talker(false), m_talker(0),
+        m_frames_sent(0), m_sent_at(frames.size()), m_heartbeat_cnt(0),
+        m_prev_transit(0.0)
+    {
+      m_con.connected.connect(
+          sigc::mem_fun(*this, &LoadGenClient::onConnected));
+      m_con.disconnected.connect(
+          sigc::mem_fun(*this, &LoadGenClient::onDisconnected));
+      m_con.frameReceived.connect(
+          sigc::mem_fun(*this, &LoadGenClient::onFrameReceived));
+      m_con.setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
+    }
+
+    ~LoadGenClient(void)
+    {
+      delete m_udp_sock;
+    }
+
+    void connect(void)
+    {
+      m_connect_start = Clock::now();
+      m_con.connect();
+    }
+
+    void disconnect(void)
+    {
+      m_con.disconnect();
+      delete m_udp_sock;
+      m_udp_sock = 0;
+      m_state = STATE_DISCONNECTED;
+    }
+
+    const string& callsign(void) const { return m_callsign; }
+    uint32_t tg(void) const { return m_tg; }
+    bool isLoggedIn(void) const { return m_state == STATE_CONNECTED; }
+    double loginTime(void) const { return m_login_time; }
+
+    void setTalker(void) { m_is_talker = true; }
+    bool isTalker(void) const { return m_is_talker; }
+
+      // The talker to measure latency against for a listener
+    void setTalkerRef(const LoadGenClient *talker) { m_talker = talker; }
+
+    const Stats& stats(void) const { return m_stats; }
+    unsigned framesSent(void) const { return m_frames_sent; }
+
+      // Only used for talkers
+    Clock::time_point sentAt(size_t idx) const { return m_sent_at[idx]; }
+
+    void sendFrame(void)
+    {
+      size_t idx = m_frames_sent % m_frames.size();
+      m_sent_at[idx] = Clock::now();
+      sendUdpMsg(MsgUdpAudio(m_frames.frame(idx)));
+      ++m_frames_sent;
+    }
+
+    void stopTalking(void)
+    {
+      sendUdpMsg(MsgUdpFlushSamples());
+    }
+
+      // Called once every second
+    void heartbeat(void)
+    {
+      if (!isLoggedIn())
+      {
+        return;
+      }
+      if (++m_heartbeat_cnt >= HEARTBEAT_INTERVAL)
+      {
+        m_heartbeat_cnt = 0;
+        sendMsg(MsgHeartbeat());
+        sendUdpMsg(MsgUdpHeartbeat());
+      }
+    }
+
+    sigc::signal<void, LoadGenClient*> loggedIn;
+    sigc::signal<void, LoadGenClient*> loginFailed;
+
+  private:
+    typedef TcpClient<FramedTcpConnection> FramedTcpClient;
+
+    typedef enum
+    {
+      STATE_DISCONNECTED, STATE_EXPECT_AUTH_CHALLENGE, STATE_EXPECT_AUTH_OK,
+      STATE_EXPECT_SERVER_INFO, STATE_CONNECTED
+    } ConState;
+
+    static const unsigned HEARTBEAT_INTERVAL = 10;
+
+    FramedTcpClient         m_con;
+    string                  m_callsign;
+    string                  m_auth_key;
+    uint32_t                m_tg;
+    set<uint32_t>           m_monitor_tgs;
+    const FrameSet&         m_frames;
+    ConState                m_state;
+    uint16_t                m_client_id;
+    UdpSocket*              m_udp_sock;
+    uint16_t                m_next_udp_tx_seq;
+    bool                    m_is_talker;
+    const LoadGenClient*    m_talker;
+    unsigned                m_frames_sent;
+    vector<Clock::time_point> m_sent_at;
+    unsigned                m_heartbeat_cnt;
+    Clock::time_point       m_connect_start;
+    double                  m_login_time = 0.0;
+    Stats                   m_stats;
+    double                  m_prev_transit;
+
+    void onConnected(void)
+    {
+      sendMsg(MsgProtoVer());
+      m_state = STATE_EXPECT_AUTH_CHALLENGE;
+    }
+
+    void onDisconnected(FramedTcpConnection *con,
+                        FramedTcpConnection::DisconnectReason reason)
+    {
+      bool was_logged_in = isLoggedIn();
+      cerr << m_callsign << ": Disconnected: "
+           << TcpConnection::disconnectReasonStr(reason) << endl;
+      delete m_udp_sock;
+      m_udp_sock = 0;
+      m_state = STATE_DISCONNECTED;
+      if (!was_logged_in)
+      {
+        loginFailed(this);
+      }
+    }
+
+    void onFrameReceived(FramedTcpConnection *con, vector<uint8_t>& data)
+    {
+      stringstream ss;
+      ss.write(reinterpret_cast<const char*>(&data.front()), data.size());
+
+      ReflectorMsg header;
+      if (!header.unpack(ss))
+      {
+        cerr << "*** ERROR[" << m_callsign
+             << "]: Unpacking failed for TCP message header\n";
+        failLogin();
+        return;
+      }
+
+      switch (header.type())
+      {
+        case MsgAuthChallenge::TYPE:
+        {
+          MsgAuthChallenge msg;
+          if ((m_state != STATE_EXPECT_AUTH_CHALLENGE) || !msg.unpack(ss) ||
+              (msg.challenge() == 0))
+          {
+            cerr << "*** ERROR[" << m_callsign
+                 << "]: Unexpected or illegal MsgAuthChallenge\n";
+            failLogin();
+            return;
+          }
+          sendMsg(MsgAuthResponse(m_callsign, m_auth_key, msg.challenge()));
+          m_state = STATE_EXPECT_AUTH_OK;
+          break;
+        }
+
+        case MsgAuthOk::TYPE:
+          if (m_state != STATE_EXPECT_AUTH_OK)
+          {
+            cerr << "*** ERROR[" << m_callsign << "]: Unexpected MsgAuthOk\n";
+            failLogin();
+            return;
+          }
+          m_state = STATE_EXPECT_SERVER_INFO;
+          m_con.setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+          break;
+
+        case MsgServerInfo::TYPE:
+        {
+          MsgServerInfo msg;
+          if ((m_state != STATE_EXPECT_SERVER_INFO) || !msg.unpack(ss))
+          {
+            cerr << "*** ERROR[" << m_callsign
+                 << "]: Unexpected or illegal MsgServerInfo\n";
+            failLogin();
+            return;
+          }
+          if (std::find(msg.codecs().begin(), msg.codecs().end(), "OPUS") ==
+              msg.codecs().end())
+          {
+            cerr << "*** WARNING[" << m_callsign
+                 << "]: The reflector does not announce the OPUS codec\n";
+          }
+          handleServerInfo(msg);
+          break;
+        }
+
+        case MsgError::TYPE:
+        {
+          MsgError msg;
+          msg.unpack(ss);
+          cerr << "*** ERROR[" << m_callsign << "]: Error message from "
+               << "the reflector: " << msg.message() << endl;
+          failLogin();
+          break;
+        }
+
+        case MsgProtoVerDowngrade::TYPE:
+          cerr << "*** ERROR[" << m_callsign << "]: The reflector does not "
+                  "support protocol version " << MsgProtoVer::MAJOR << "."
+               << MsgProtoVer::MINOR << endl;
+          failLogin();
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    void handleServerInfo(MsgServerInfo& msg)
+    {
+      m_client_id = msg.clientId();
+
+      delete m_udp_sock;
+      m_udp_sock = new UdpSocket;
+      m_udp_sock->dataReceived.connect(
+          sigc::mem_fun(*this, &LoadGenClient::udpDatagramReceived));
+
+      m_state = STATE_CONNECTED;
+      sendMsg(MsgNodeInfo("{\"sw\":\"" PROGRAM_NAME "\"}"));
+      sendMsg(MsgSelectTG(m_tg));
+      if (!m_monitor_tgs.empty())
+      {
+        sendMsg(MsgTgMonitor(m_monitor_tgs));
+      }
+      sendUdpMsg(MsgUdpHeartbeat());
+
+      m_login_time = std::chrono::duration<double, std::milli>(
+          Clock::now() - m_connect_start).count();
+      loggedIn(this);
+    }
+
+    void failLogin(void)
+    {
+      bool was_logged_in = isLoggedIn();
+      disconnect();
+      if (!was_logged_in)
+      {
+        loginFailed(this);
+      }
+    }
+
+    void udpDatagramReceived(const IpAddress& addr, uint16_t port,
+                             void *buf, int count)
+    {
+      Clock::time_point now = Clock::now();
+
+      stringstream ss;
+      ss.write(reinterpret_cast<const char *>(buf), count);
+
+      ReflectorUdpMsg header;
+      if (!header.unpack(ss) || (header.clientId() != m_client_id) ||
+          (header.type() != MsgUdpAudio::TYPE))
+      {
+        return;
+      }
+
+      MsgUdpAudio msg;
+      if (!msg.unpack(ss) || msg.audioData().empty())
+      {
+        return;
+      }
+
+      int idx = m_frames.find(msg.audioData());
+      if ((idx < 0) || (m_talker == 0))
+      {
+        m_stats.unknown += 1;
+        return;
+      }
+
+      m_stats.received += 1;
+      double transit = std::chrono::duration<double, std::milli>(
+          now - m_talker->sentAt(idx)).count();
+      m_stats.latencies.push_back(transit);
+
+        // Interarrival jitter as defined in RFC 3550
+      if (m_stats.received > 1)
+      {
+        double d = std::fabs(transit - m_prev_transit);
+        m_stats.jitter += (d - m_stats.jitter) / 16.0;
+      }
+      m_prev_transit = transit;
+    }
+
+    void sendMsg(const ReflectorMsg& msg)
+    {
+      if (!m_con.isConnected())
+      {
+        return;
+      }
+      ostringstream ss;
+      ReflectorMsg header(msg.type());
+      if (!header.pack(ss) || !msg.pack(ss))
+      {
+        cerr << "*** ERROR[" << m_callsign
+             << "]: Failed to pack reflector TCP message\n";
+        return;
+      }
+      m_con.write(ss.str().data(), ss.str().size());
+    }
+
+    void sendUdpMsg(const ReflectorUdpMsg& msg)
+    {
+      if (!isLoggedIn() || (m_udp_sock == 0))
+      {
+        return;
+      }
+      ReflectorUdpMsg header(msg.type(), m_client_id, m_next_udp_tx_seq++);
+      ostringstream ss;
+      if (!header.pack(ss) || !msg.pack(ss))
+      {
+        cerr << "*** ERROR[" << m_callsign
+             << "]: Failed to pack reflector UDP message\n";
+        return;
+      }
+      m_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
+                        ss.str().data(), ss.str().size());
+    }
+}; /* class LoadGenClient */
+
+}; /* anonymous namespace */
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static void parse_arguments(int argc, const char **argv);
+static bool process_cpu_time(int pid, double& user, double& system);
+static void connect_next_client(Timer *t);
+static void client_logged_in(LoadGenClient *client);
+static void client_login_failed(LoadGenClient *client);
+static void check_login_done(void);
+static void login_timeout(Timer *t);
+static void start_talking(Timer *t);
+static void talk_tick(Timer *t);
+static void heartbeat_tick(Timer *t);
+static void stop_talking(Timer *t);
+static void write_report(Timer *t);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static char   *host                 = const_cast<char*>("localhost");
+static int    port                  = 5300;
+static int    client_cnt            = 10;
+static int    talker_cnt            = 1;
+static int    tg_base               = 9000;
+static char   *callsign_prefix      = const_cast<char*>("LOADGEN");
+static char   *auth_key             = 0;
+static int    duration              = 60;
+static int    warmup                = 2;
+static int    connect_interval      = 10;
+static int    reflector_pid         = 0;
+static char   *report_file          = 0;
+
+static FrameSet               frames;
+static vector<LoadGenClient*> clients;
+static vector<LoadGenClient*> talkers;
+static size_t                 next_client           = 0;
+static unsigned               login_ok_cnt          = 0;
+static unsigned               login_fail_cnt        = 0;
+static bool                   test_started          = false;
+static Timer                  *connect_timer        = 0;
+static Timer                  *login_timer          = 0;
+static Timer                  *phase_timer          = 0;
+static Timer                  *talk_timer           = 0;
+static Timer                  *heartbeat_timer      = 0;
+static Clock::time_point      talk_start;
+static unsigned               ticks_sent            = 0;
+static double                 max_send_lag          = 0.0;
+static double                 talk_time             = 0.0;
+static double                 refl_cpu_start[2]     = { 0.0, 0.0 };
+static double                 refl_cpu[2]           = { 0.0, 0.0 };
+static bool                   refl_cpu_valid        = false;
+static double                 own_cpu_start         = 0.0;
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  CppApplication app;
+
+  parse_arguments(argc, argv);
+  if ((auth_key == 0) || (client_cnt <= 0) || (talker_cnt <= 0) ||
+      (talker_cnt >= client_cnt) || (duration <= 0) || (port <= 0))
+  {
+    cerr << "*** ERROR: Illegal arguments. An authentication key must be "
+            "given and there must be more clients than talkers.\n";
+    exit(1);
+  }
+
+    // Initialize the GCrypt library
+  gcry_check_version(NULL);
+  gcry_control(GCRYCTL_DISABLE_SECMEM, 0);
+  gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0);
+
+  if (!frames.encode())
+  {
+    exit(1);
+  }
+
+    // Every talker use its own talk group. All clients monitor all talker
+    // talk groups, just like a real node would monitor a few talk groups.
+  set<uint32_t> monitor_tgs;
+  for (int i=0; i<talker_cnt; ++i)
+  {
+    monitor_tgs.insert(tg_base + i);
+  }
+  for (int i=0; i<client_cnt; ++i)
+  {
+    ostringstream callsign;
+    callsign << callsign_prefix << (i + 1);
+    uint32_t tg = tg_base + (i % talker_cnt);
+    LoadGenClient *client = new LoadGenClient(host, port, callsign.str(),
+        auth_key, tg, monitor_tgs, frames);
+    client->loggedIn.connect(sigc::ptr_fun(client_logged_in));
+    client->loginFailed.connect(sigc::ptr_fun(client_login_failed));
+    if (i < talker_cnt)
+    {
+      client->setTalker();
+      talkers.push_back(client);
+    }
+    else
+    {
+      client->setTalkerRef(talkers[i % talker_cnt]);
+    }
+    clients.push_back(client);
+  }
+
+  cerr << "Logging in " << client_cnt << " clients to " << host << ":"
+       << port << "\n";
+  connect_timer = new Timer(max(connect_interval, 1), Timer::TYPE_PERIODIC);
+  connect_timer->expired.connect(sigc::ptr_fun(connect_next_client));
+  login_timer = new Timer(LOGIN_TIMEOUT_MS);
+  login_timer->expired.connect(sigc::ptr_fun(login_timeout));
+  heartbeat_timer = new Timer(1000, Timer::TYPE_PERIODIC);
+  heartbeat_timer->expired.connect(sigc::ptr_fun(heartbeat_tick));
+
+  app.exec();
+
+  delete connect_timer;
+  delete login_timer;
+  delete phase_timer;
+  delete talk_timer;
+  delete heartbeat_timer;
+  for (vector<LoadGenClient*>::iterator it=clients.begin();
+       it!=clients.end(); ++it)
+  {
+    delete *it;
+  }
+
+  return (login_ok_cnt == clients.size()) ? 0 : 1;
+
+} /* main */
+
+
+
+/****************************************************************************
+ *
+ * Functions
+ *
+ ****************************************************************************/
+
+/*
+ *----------------------------------------------------------------------------
+ * Function:  parse_arguments
+ * Purpose:   Parse the command line arguments.
+ * Input:     argc  - Number of arguments in the command line
+ *    	      argv  - Array of strings with the arguments
+ * Output:    None
+ * Author:    agent
+ * Created:   2026-10-18
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+static void parse_arguments(int argc, const char **argv)
+{
+  poptContext optCon;
+  const struct poptOption optionsTable[] =
+  {
+    POPT_AUTOHELP
+    {"host", 0, POPT_ARG_STRING, &host, 0,
+            "The reflector host (default localhost)", "<host>"},
+    {"port", 0, POPT_ARG_INT, &port, 0,
+            "The reflector port (default 5300)", "<port>"},
+    {"clients", 0, POPT_ARG_INT, &client_cnt, 0,
+            "The total number of clients, talkers included (default 10)",
+            "<count>"},
+    {"talkers", 0, POPT_ARG_INT, &talker_cnt, 0,
+            "The number of simultaneous talkers (default 1)", "<count>"},
+    {"tg-base", 0, POPT_ARG_INT, &tg_base, 0,
+            "The first talk group to use (default 9000)", "<tg>"},
+    {"callsign-prefix", 0, POPT_ARG_STRING, &callsign_prefix, 0,
+            "The client callsign prefix (default LOADGEN)", "<prefix>"},
+    {"auth-key", 0, POPT_ARG_STRING, &auth_key, 0,
+            "The authentication key for all clients", "<key>"},
+    {"duration", 0, POPT_ARG_INT, &duration, 0,
+            "The time to stream audio in seconds (default 60)", "<seconds>"},
+    {"warmup", 0, POPT_ARG_INT, &warmup, 0,
+            "The time to wait after login before talking (default 2)",
+            "<seconds>"},
+    {"connect-interval", 0, POPT_ARG_INT, &connect_interval, 0,
+            "The time between client connections in ms (default 10)",
+            "<ms>"},
+    {"reflector-pid", 0, POPT_ARG_INT, &reflector_pid, 0,
+            "The reflector process id, to measure its CPU usage", "<pid>"},
+    {"report", 0, POPT_ARG_STRING, &report_file, 0,
+            "Write the JSON report to a file instead of stdout", "<filename>"},
+    {NULL, 0, 0, NULL, 0}
+  };
+  int err;
+
+  optCon = poptGetContext(PROGRAM_NAME, argc, argv, optionsTable, 0);
+  poptReadDefaultConfig(optCon, 0);
+
+  err = poptGetNextOpt(optCon);
+  if (err != -1)
+  {
+    fprintf(stderr, "\t%s: %s\n",
+	    poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
+	    poptStrerror(err));
+    exit(1);
+  }
+
+  poptFreeContext(optCon);
+
+} /* parse_arguments */
+
+
+static bool process_cpu_time(int pid, double& user, double& system)
+{
+  if (pid <= 0)
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    user = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1.0e6;
+    system = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1.0e6;
+    return true;
+  }
+
+  ostringstream path;
+  path << "/proc/" << pid << "/stat";
+  ifstream is(path.str().c_str());
+  string line;
+  if (!getline(is, line))
+  {
+    return false;
+  }
+
+    // The process name may contain spaces so start after the parenthesis.
+    // The utime and stime fields are field 14 and 15 in the stat file.
+  string::size_type pos = line.rfind(')');
+  if (pos == string::npos)
+  {
+    return false;
+  }
+  istringstream fields(line.substr(pos + 2));
+  string field;
+  unsigned long utime = 0, stime = 0;
+  for (int i=3; i<=15; ++i)
+  {
+    if (!(fields >> field))
+    {
+      return false;
+    }
+    if (i == 14)
+    {
+      utime = strtoul(field.c_str(), NULL, 10);
+    }
+    else if (i == 15)
+    {
+      stime = strtoul(field.c_str(), NULL, 10);
+    }
+  }
+  const double ticks = sysconf(_SC_CLK_TCK);
+  user = utime / ticks;
+  system = stime / ticks;
+  return true;
+} /* process_cpu_time */
+
+
+static void connect_next_client(Timer *t)
+{
+  if (next_client >= clients.size())
+  {
+    delete connect_timer;
+    connect_timer = 0;
+    return;
+  }
+  clients[next_client++]->connect();
+} /* connect_next_client */
+
+
+static void client_logged_in(LoadGenClient *client)
+{
+  ++login_ok_cnt;
+  check_login_done();
+} /* client_logged_in */
+
+
+static void client_login_failed(LoadGenClient *client)
+{
+  if (!test_started)
+  {
+    cerr << "*** ERROR: " << client->callsign() << " failed to log in\n";
+    ++login_fail_cnt;
+    check_login_done();
+  }
+} /* client_login_failed */
+
+
+static void check_login_done(void)
+{
+  if (test_started || (login_ok_cnt + login_fail_cnt < clients.size()))
+  {
+    return;
+  }
+  login_timeout(0);
+} /* check_login_done */
+
+
+static void login_timeout(Timer *t)
+{
+  if (test_started)
+  {
+    return;
+  }
+  test_started = true;
+  delete login_timer;
+  login_timer = 0;
+
+  cerr << login_ok_cnt << " of " << clients.size() << " clients logged in\n";
+  for (vector<LoadGenClient*>::iterator it=talkers.begin();
+       it!=talkers.end(); ++it)
+  {
+    if (!(*it)->isLoggedIn())
+    {
+      cerr << "*** ERROR: Talker " << (*it)->callsign()
+           << " is not logged in\n";
+      Application::app().quit();
+      return;
+    }
+  }
+
+  phase_timer = new Timer(max(warmup, 0) * 1000);
+  phase_timer->expired.connect(sigc::ptr_fun(start_talking));
+} /* login_timeout */
+
+
+static void start_talking(Timer *t)
+{
+  delete phase_timer;
+  cerr << "Streaming audio from " << talkers.size() << " talkers for "
+       << duration << " seconds\n";
+
+  refl_cpu_valid = process_cpu_time(reflector_pid, refl_cpu_start[0],
+                                    refl_cpu_start[1]) &&
+                   (reflector_pid > 0);
+  double user, system;
+  process_cpu_time(0, user, system);
+  own_cpu_start = user + system;
+
+  talk_start = Clock::now();
+  talk_timer = new Timer(FRAME_LEN_MS / 2, Timer::TYPE_PERIODIC);
+  talk_timer->expired.connect(sigc::ptr_fun(talk_tick));
+  phase_timer = new Timer(duration * 1000);
+  phase_timer->expired.connect(sigc::ptr_fun(stop_talking));
+  talk_tick(0);
+} /* start_talking */
+
+
+static void talk_tick(Timer *t)
+{
+    // The timer runs at twice the frame rate. The frames are sent based on
+    // the elapsed time so that the average rate is exact even if the timer
+    // is late.
+  double elapsed = std::chrono::duration<double, std::milli>(
+      Clock::now() - talk_start).count();
+  while (ticks_sent * FRAME_LEN_MS <= elapsed)
+  {
+    max_send_lag = max(max_send_lag, elapsed - ticks_sent * FRAME_LEN_MS);
+    for (vector<LoadGenClient*>::iterator it=talkers.begin();
+         it!=talkers.end(); ++it)
+    {
+      (*it)->sendFrame();
+    }
+    ++ticks_sent;
+  }
+} /* talk_tick */
+
+
+static void heartbeat_tick(Timer *t)
+{
+  for (vector<LoadGenClient*>::iterator it=clients.begin();
+       it!=clients.end(); ++it)
+  {
+    (*it)->heartbeat();
+  }
+} /* heartbeat_tick */
+
+
+static void stop_talking(Timer *t)
+{
+  delete talk_timer;
+  talk_timer = 0;
+  talk_time = std::chrono::duration<double>(Clock::now() - talk_start).count();
+  for (vector<LoadGenClient*>::iterator it=talkers.begin();
+       it!=talkers.end(); ++it)
+  {
+    (*it)->stopTalking();
+  }
+
+  if (refl_cpu_valid)
+  {
+    double user, system;
+    refl_cpu_valid = process_cpu_time(reflector_pid, user, system);
+    refl_cpu[0] = user - refl_cpu_start[0];
+    refl_cpu[1] = system - refl_cpu_start[1];
+  }
+
+  delete phase_timer;
+  phase_timer = new Timer(DRAIN_TIME_MS);
+  phase_timer->expired.connect(sigc::ptr_fun(write_report));
+} /* stop_talking */
+
+
+static void write_report(Timer *t)
+{
+  double user, system;
+  process_cpu_time(0, user, system);
+  double own_cpu = user + system - own_cpu_start;
+
+  unsigned frames_sent = 0;
+  for (vector<LoadGenClient*>::iterator it=talkers.begin();
+       it!=talkers.end(); ++it)
+  {
+    frames_sent += (*it)->framesSent();
+  }
+
+  unsigned listener_cnt = 0;
+  unsigned expected = 0;
+  unsigned received = 0;
+  unsigned unknown = 0;
+  double jitter_sum = 0.0;
+  double jitter_max = 0.0;
+  double login_time_sum = 0.0;
+  double login_time_max = 0.0;
+  vector<float> latencies;
+  for (vector<LoadGenClient*>::iterator it=clients.begin();
+       it!=clients.end(); ++it)
+  {
+    LoadGenClient *client = *it;
+    if (!client->isLoggedIn())
+    {
+      continue;
+    }
+    login_time_sum += client->loginTime();
+    login_time_max = max(login_time_max, client->loginTime());
+    if (client->isTalker())
+    {
+      continue;
+    }
+    const LoadGenClient::Stats& stats = client->stats();
+    ++listener_cnt;
+    expected += talkers[(client->tg() - tg_base)]->framesSent();
+    received += stats.received;
+    unknown += stats.unknown;
+    jitter_sum += stats.jitter;
+    jitter_max = max(jitter_max, stats.jitter);
+    latencies.insert(latencies.end(), stats.latencies.begin(),
+                     stats.latencies.end());
+  }
+  sort(latencies.begin(), latencies.end());
+
+  Json::Value report(Json::objectValue);
+  report["clients"] = static_cast<Json::UInt>(clients.size());
+  report["clients_logged_in"] = login_ok_cnt;
+  report["talkers"] = static_cast<Json::UInt>(talkers.size());
+  report["listeners"] = listener_cnt;
+  report["duration_s"] = talk_time;
+  report["frame_len_ms"] = FRAME_LEN_MS;
+  report["frames_sent"] = frames_sent;
+  report["frames_expected"] = expected;
+  report["frames_received"] = received;
+  report["frames_unknown"] = unknown;
+  report["loss_ratio"] =
+    (expected > 0) ? 1.0 - static_cast<double>(received) / expected : 0.0;
+  report["frames_forwarded_per_s"] =
+    (talk_time > 0.0) ? received / talk_time : 0.0;
+
+  Json::Value login(Json::objectValue);
+  login["mean_ms"] = (login_ok_cnt > 0) ? login_time_sum / login_ok_cnt : 0.0;
+  login["max_ms"] = login_time_max;
+  report["login"] = login;
+
+  Json::Value latency(Json::objectValue);
+  if (!latencies.empty())
+  {
+    double sum = 0.0;
+    for (size_t i=0; i<latencies.size(); ++i)
+    {
+      sum += latencies[i];
+    }
+    const size_t n = latencies.size();
+    latency["min_ms"] = latencies.front();
+    latency["mean_ms"] = sum / n;
+    latency["p50_ms"] = latencies[n * 50 / 100];
+    latency["p90_ms"] = latencies[n * 90 / 100];
+    latency["p99_ms"] = latencies[min(n - 1, n * 99 / 100)];
+    latency["max_ms"] = latencies.back();
+  }
+  report["latency"] = latency;
+
+  Json::Value jitter(Json::objectValue);
+  jitter["mean_ms"] = (listener_cnt > 0) ? jitter_sum / listener_cnt : 0.0;
+  jitter["max_ms"] = jitter_max;
+  report["jitter"] = jitter;
+
+  if (refl_cpu_valid)
+  {
+    Json::Value cpu(Json::objectValue);
+    cpu["user_s"] = refl_cpu[0];
+    cpu["system_s"] = refl_cpu[1];
+    cpu["percent"] =
+      (talk_time > 0.0) ? 100.0 * (refl_cpu[0] + refl_cpu[1]) / talk_time : 0.0;
+    report["reflector_cpu"] = cpu;
+  }
+
+    // If the load generator itself is overloaded the figures above are not
+    // to be trusted. Check the maximum send lag and CPU usage for that.
+  Json::Value loadgen(Json::objectValue);
+  loadgen["cpu_percent"] = (talk_time > 0.0) ? 100.0 * own_cpu / talk_time : 0.0;
+  loadgen["max_send_lag_ms"] = max_send_lag;
+  report["loadgen"] = loadgen;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  if (report_file != 0)
+  {
+    ofstream os(report_file);
+    writer->write(report, &os);
+    os << endl;
+    if (!os)
+    {
+      cerr << "*** ERROR: Could not write report file " << report_file << endl;
+    }
+  }
+  else
+  {
+    writer->write(report, &cout);
+    cout << endl;
+  }
+
+  for (vector<LoadGenClient*>::iterator it=clients.begin();
+       it!=clients.end(); ++it)
+  {
+    (*it)->disconnect();
+  }
+  Application::app().quit();
+} /* write_report */
+
+
+
+/*
+ * This file has not been truncated
+ */
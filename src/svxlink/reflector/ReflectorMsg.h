@@ -164,6 +164,9 @@ class ReflectorUdpMsg : public Async::Msg
   public:
     using ClientId = uint16_t;
 
+      // The size of the packed header: type, client ID and sequence number
+    static const size_t HEADER_SIZE = 6;
+
     /**
      * @brief 	Constuctor
      * @param 	type The message type
@@ -172,6 +175,30 @@ class ReflectorUdpMsg : public Async::Msg
     ReflectorUdpMsg(uint16_t type=0, ClientId client_id=0, uint16_t seq=0)
       : m_type(type), m_client_id(client_id), m_seq(seq) {}
 
+    /**
+     * @brief   Read the header directly from a raw datagram
+     * @param   buf The buffer containing the datagram
+     * @param   count The number of bytes in the buffer
+     * @return  Returns \em true on success or \em false if the buffer is too
+     *          short to contain a header
+     *
+     * This function read the header fields at their fixed offsets without
+     * setting up a stream. It is used to quickly sort out what to do with a
+     * datagram before spending any more resources on it.
+     */
+    bool peek(const void *buf, size_t count)
+    {
+      if (count < HEADER_SIZE)
+      {
+        return false;
+      }
+      const uint8_t *p = reinterpret_cast<const uint8_t*>(buf);
+      m_type = (static_cast<uint16_t>(p[0]) << 8) | p[1];
+      m_client_id = (static_cast<uint16_t>(p[2]) << 8) | p[3];
+      m_seq = (static_cast<uint16_t>(p[4]) << 8) | p[5];
+      return true;
+    }
+
     /**
      * @brief 	Destructor
      */
@@ -466,6 +493,133 @@ class MsgError : public ReflectorMsgBase<13>
 }; /* MsgError */
 
 
+/**
+@brief	 Session resume request TCP network message
+@author  agent
+@date    2026-10-18
+
+This message may be sent by a client, directly after the MsgProtoVer message,
+to resume a previous session without going through the full authentication
+process. The session token is the one last received in a MsgSessionToken
+message. To prove that the client is the owner of the session, the callsign
+and the token are combined with the authentication key into a HMAC digest.
+
+The message is sent before the client has logged in so the packed message
+must fit in MAX_PREAUTH_FRAME_SIZE bytes. For that reason the digest is
+truncated and the selected and monitored talk groups are not included. The
+client send them after login as usual. Use fitsPreAuthFrame to check that the
+callsign is not too long for the message to be sent.
+
+If the session is resumed, the server responds with a MsgAuthOk message
+followed by a MsgServerInfo message, just like for a normal login. If not,
+a MsgSessionResumeFailed message is sent and the client must answer the
+MsgAuthChallenge, that the server sent in response to the MsgProtoVer
+message, as usual.
+*/
+class MsgSessionResume : public ReflectorMsgBase<14>
+{
+  public:
+    static const int      ALGO        = GCRY_MD_SHA1;
+    static const size_t   DIGEST_LEN  = 16;
+    MsgSessionResume(void) {}
+
+    /**
+     * @brief   Constructor
+     * @param   callsign The callsign (username) of the client
+     * @param   key The authentication key (clear text password)
+     * @param   token The session token received from the server
+     */
+    MsgSessionResume(const std::string& callsign, const std::string &key,
+                     const std::vector<uint8_t>& token)
+      : m_callsign(callsign), m_token(token), m_digest(DIGEST_LEN)
+    {
+      if (!calcDigest(&m_digest.front(), key))
+      {
+        exit(1);
+      }
+    }
+
+    const std::string& callsign(void) const { return m_callsign; }
+    const std::vector<uint8_t>& token(void) const { return m_token; }
+
+    /**
+     * @brief   Verify that the given key, the callsign and the token match
+     *          the digest
+     * @param   key The authentication key
+     */
+    bool verify(const std::string &key) const
+    {
+      unsigned char digest[DIGEST_LEN];
+      bool ok = calcDigest(digest, key);
+      return ok && (m_digest.size() == DIGEST_LEN) &&
+             (memcmp(&m_digest.front(), digest, DIGEST_LEN) == 0);
+    }
+
+    /**
+     * @brief   Check if the message can be sent before login
+     * @return  Returns \em true if the packed message, including the message
+     *          type, fit in MAX_PREAUTH_FRAME_SIZE bytes
+     */
+    bool fitsPreAuthFrame(void) const
+    {
+      return ReflectorMsg::packedSize() + packedSize() <=
+             MAX_PREAUTH_FRAME_SIZE;
+    }
+
+    ASYNC_MSG_MEMBERS(m_callsign, m_token, m_digest)
+
+  private:
+    std::string           m_callsign;
+    std::vector<uint8_t>  m_token;
+    std::vector<uint8_t>  m_digest;
+
+    bool calcDigest(unsigned char *digest, const std::string& key) const
+    {
+      unsigned char *digest_ptr = 0;
+      gcry_md_hd_t hd = { 0 };
+      gcry_error_t err = gcry_md_open(&hd, ALGO, GCRY_MD_FLAG_HMAC);
+      if (err) goto error;
+      err = gcry_md_setkey(hd, key.c_str(), key.size());
+      if (err) goto error;
+      gcry_md_write(hd, m_callsign.data(), m_callsign.size());
+      gcry_md_write(hd, m_token.data(), m_token.size());
+      digest_ptr = gcry_md_read(hd, 0);
+      memcpy(digest, digest_ptr, DIGEST_LEN);
+      gcry_md_close(hd);
+      return true;
+
+      error:
+        gcry_md_close(hd);
+        std::cerr << "*** ERROR: gcrypt error: "
+                  << gcry_strsource(err) << "/" << gcry_strerror(err)
+                  << std::endl;
+        return false;
+    }
+}; /* MsgSessionResume */
+
+
+/**
+@brief	 Session resume failure TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is sent by the server when a MsgSessionResume request could not
+be fulfilled. The client should continue with a normal login by answering the
+previously received MsgAuthChallenge.
+*/
+class MsgSessionResumeFailed : public ReflectorMsgBase<15>
+{
+  public:
+    MsgSessionResumeFailed(const std::string& reason="") : m_reason(reason) {}
+    const std::string& reason(void) const { return m_reason; }
+
+    ASYNC_MSG_MEMBERS(m_reason)
+
+  private:
+    std::string m_reason;
+}; /* MsgSessionResumeFailed */
+
+
 /**
 @brief	 Server information TCP network message
 @author  Tobias Blomberg / SM0SVX
@@ -1111,6 +1265,41 @@ class MsgTxStatus : public ReflectorMsgBase<113>
 }; /* class MsgTxStatus */
 
 
+/**
+@brief   Session token for resuming a session
+@author  agent
+@date    2026-10-18
+
+This message is sent by the server after a successful login and then
+periodically to keep the token fresh. The token is opaque to the client. It
+is used in a MsgSessionResume message to resume the session after the
+connection has been lost, e.g. because the server was restarted. The token is
+valid for the given number of seconds.
+
+The token must be short since it is sent back in a MsgSessionResume message,
+before login, where the frame size is limited. TOKEN_LEN is the length of
+the tokens issued by the server.
+*/
+class MsgSessionToken : public ReflectorMsgBase<114>
+{
+  public:
+    static const size_t TOKEN_LEN = 19;
+
+    MsgSessionToken(void) : m_lifetime(0) {}
+    MsgSessionToken(const std::vector<uint8_t>& token, uint32_t lifetime)
+      : m_token(token), m_lifetime(lifetime) {}
+
+    const std::vector<uint8_t>& token(void) const { return m_token; }
+    uint32_t lifetime(void) const { return m_lifetime; }
+
+    ASYNC_MSG_MEMBERS(m_token, m_lifetime)
+
+  private:
+    std::vector<uint8_t>  m_token;
+    uint32_t              m_lifetime;
+}; /* MsgSessionToken */
+
+
 /***************************** UDP Messages *****************************/
 
 /**
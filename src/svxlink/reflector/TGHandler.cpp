@@ -35,6 +35,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <sstream>
 #include <regex>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -128,6 +131,14 @@ TGHandler::~TGHandler(void)
 } /* TGHandler::~TGHandler */
 
 
+void TGHandler::setConfig(Async::Config* cfg)
+{
+  m_cfg = cfg;
+  m_cfg->valueUpdated.connect(mem_fun(*this, &TGHandler::onCfgUpdated));
+  updatePolicies();
+} /* TGHandler::setConfig */
+
+
 void TGHandler::setSqlTimeoutBlocktime(unsigned sql_timeout_blocktime)
 {
   m_sql_timeout_blocktime = std::max(sql_timeout_blocktime, 1U);
@@ -163,17 +174,17 @@ bool TGHandler::switchTo(ReflectorClient *client, uint32_t tg)
     else
     {
       tg_info = new TGInfo(tg);
-      std::ostringstream ss;
-      ss << "TG#" << tg;
-      m_cfg->getValue(ss.str(), "AUTO_QSY_AFTER", tg_info->auto_qsy_after_s);
+      tg_info->auto_qsy_after_s = policy(tg).auto_qsy_after_s;
       if (tg_info->auto_qsy_after_s > 0)
       {
         tg_info->auto_qsy_time = time(NULL) + tg_info->auto_qsy_after_s;
       }
       m_id_map[tg] = tg_info;
+      activeTGsChanged();
     }
     tg_info->clients.insert(client);
     m_client_map[client] = tg_info;
+    client->setCurrentTG(tg);
   }
 
   //printTGStatus();
@@ -219,6 +230,11 @@ void TGHandler::setTalkerForTG(uint32_t tg, ReflectorClient* new_talker)
   }
   TGInfo* tg_info = id_map_it->second;
   ReflectorClient* old_talker = tg_info->talker;
+  if ((new_talker != 0) && (m_remote_talkers.count(tg) > 0))
+  {
+      // A talker on another reflector hold the talk group
+    return;
+  }
   if (new_talker == old_talker)
   {
     gettimeofday(&tg_info->last_talker_timestamp, NULL);
@@ -250,60 +266,93 @@ ReflectorClient* TGHandler::talkerForTG(uint32_t tg) const
 } /* TGHandler::talkerForTG */
 
 
-uint32_t TGHandler::TGForClient(ReflectorClient* client)
+bool TGHandler::allowTgSelection(ReflectorClient *client, uint32_t tg)
 {
-  ClientMap::iterator client_map_it = m_client_map.find(client);
-  if (client_map_it == m_client_map.end())
+  const TGPolicy& tg_policy = policy(tg);
+  if (!tg_policy.restricted)
   {
-    return 0;
+    return true;
   }
-  return client_map_it->second->id;
-} /* TGHandler::TGForClient */
+    // An ALLOW expression that could not be parsed deny everyone
+  return tg_policy.allow_valid &&
+         std::regex_match(client->callsign(), tg_policy.allow);
+} /* TGHandler::allowTgSelection */
 
 
-bool TGHandler::allowTgSelection(ReflectorClient *client, uint32_t tg)
+void TGHandler::activeTGs(std::set<uint32_t>& tgs) const
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  try
+  tgs.clear();
+  for (const auto& item : m_id_map)
   {
-    std::string allow;
-    if (m_cfg->getValue(ss.str(), "ALLOW", allow))
+    tgs.insert(item.first);
+  }
+} /* TGHandler::activeTGs */
+
+
+void TGHandler::setRemoteTalkerForTG(uint32_t tg, const std::string& trunk,
+                                     const std::string& callsign)
+{
+  if (talkerForTG(tg) != 0)
+  {
+    setTalkerForTG(tg, 0);
+  }
+  std::string old_callsign;
+  RemoteTalkerMap::iterator it = m_remote_talkers.find(tg);
+  if (it != m_remote_talkers.end())
+  {
+    if ((it->second.trunk == trunk) && (it->second.callsign == callsign))
     {
-      if (!std::regex_match(client->callsign(), std::regex(allow)))
-      {
-        return false;
-      }
-      //std::cout << "### " << client->callsign() << " Match!" << std::endl;
+      return;
     }
-    return true;
+    old_callsign = it->second.callsign;
   }
-  catch (std::regex_error& e)
+  m_remote_talkers[tg] = RemoteTalker{trunk, callsign};
+  remoteTalkerUpdated(tg, old_callsign, callsign);
+} /* TGHandler::setRemoteTalkerForTG */
+
+
+void TGHandler::clearRemoteTalkerForTG(uint32_t tg)
+{
+  RemoteTalkerMap::iterator it = m_remote_talkers.find(tg);
+  if (it == m_remote_talkers.end())
   {
-    std::cerr << "*** WARNING: Regular expression parsing error in "
-              << ss.str() << "/ALLOW: " << e.what() << std::endl;
+    return;
   }
-  return false;
-} /* TGHandler::allowTgSelection */
+  std::string old_callsign = it->second.callsign;
+  m_remote_talkers.erase(it);
+  remoteTalkerUpdated(tg, old_callsign, "");
+} /* TGHandler::clearRemoteTalkerForTG */
 
 
-bool TGHandler::showActivity(uint32_t tg) const
+bool TGHandler::remoteTalkerForTG(uint32_t tg, std::string& trunk,
+                                  std::string& callsign) const
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  bool show_activity = true;
-  m_cfg->getValue(ss.str(), "SHOW_ACTIVITY", show_activity);
-  return show_activity;
-} /* TGHandler::showActivity */
+  RemoteTalkerMap::const_iterator it = m_remote_talkers.find(tg);
+  if (it == m_remote_talkers.end())
+  {
+    return false;
+  }
+  trunk = it->second.trunk;
+  callsign = it->second.callsign;
+  return true;
+} /* TGHandler::remoteTalkerForTG */
 
 
-bool TGHandler::isRestricted(uint32_t tg) const
+void TGHandler::removeTrunk(const std::string& trunk)
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  std::string allow;
-  return m_cfg->getValue(ss.str(), "ALLOW", allow);
-} /* TGHandler::isRestricted */
+  std::vector<uint32_t> tgs;
+  for (const auto& item : m_remote_talkers)
+  {
+    if (item.second.trunk == trunk)
+    {
+      tgs.push_back(item.first);
+    }
+  }
+  for (uint32_t tg : tgs)
+  {
+    clearRemoteTalkerForTG(tg);
+  }
+} /* TGHandler::removeTrunk */
 
 
 /****************************************************************************
@@ -320,6 +369,58 @@ bool TGHandler::isRestricted(uint32_t tg) const
  *
  ****************************************************************************/
 
+void TGHandler::updatePolicies(void)
+{
+  m_policies.clear();
+  for (const auto& section : m_cfg->listSections())
+  {
+    if (section.compare(0, 3, "TG#") != 0)
+    {
+      continue;
+    }
+    const char *tg_str = section.c_str() + 3;
+    char *endptr = 0;
+    unsigned long tg = strtoul(tg_str, &endptr, 10);
+    if ((endptr == tg_str) || (*endptr != '\0') || (tg == 0) ||
+        (tg > UINT32_MAX))
+    {
+      std::cerr << "*** WARNING: Illegal talk group configuration section "
+                   "name \"" << section << "\". Ignored." << std::endl;
+      continue;
+    }
+
+    TGPolicy& tg_policy = m_policies[tg];
+    std::string allow;
+    if (m_cfg->getValue(section, "ALLOW", allow))
+    {
+      tg_policy.restricted = true;
+      try
+      {
+        tg_policy.allow = std::regex(allow, std::regex::optimize);
+      }
+      catch (std::regex_error& e)
+      {
+        std::cerr << "*** WARNING: Regular expression parsing error in "
+                  << section << "/ALLOW: " << e.what() << std::endl;
+        tg_policy.allow_valid = false;
+      }
+    }
+    m_cfg->getValue(section, "SHOW_ACTIVITY", tg_policy.show_activity);
+    m_cfg->getValue(section, "AUTO_QSY_AFTER", tg_policy.auto_qsy_after_s);
+  }
+} /* TGHandler::updatePolicies */
+
+
+void TGHandler::onCfgUpdated(const std::string& section,
+                             const std::string& tag)
+{
+  if (section.compare(0, 3, "TG#") == 0)
+  {
+    updatePolicies();
+  }
+} /* TGHandler::onCfgUpdated */
+
+
 void TGHandler::checkTimers(Async::Timer *t)
 {
   for (IdMap::iterator it = m_id_map.begin(); it != m_id_map.end(); ++it)
@@ -369,10 +470,12 @@ void TGHandler::removeClientP(TGInfo *tg_info, ReflectorClient* client)
   }
   tg_info->clients.erase(client);
   m_client_map.erase(client);
+  client->setCurrentTG(0);
   if (tg_info->clients.empty())
   {
     m_id_map.erase(tg_info->id);
     delete tg_info;
+    activeTGsChanged();
   }
 } /* TGHandler::removeClientP */
 
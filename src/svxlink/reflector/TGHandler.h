@@ -36,6 +36,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <map>
 #include <set>
+#include <string>
+#include <regex>
+#include <unordered_map>
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 
@@ -136,11 +139,14 @@ class TGHandler : public sigc::trackable
     ~TGHandler(void);
 
     /**
-     * @brief   A_brief_member_function_description
-     * @param   param1 Description_of_param1
-     * @return  Return_value_of_this_member_function
+     * @brief   Set the configuration object to read talk group settings from
+     * @param   cfg The configuration object
+     *
+     * The TG#<tg> configuration sections are compiled into a policy table
+     * directly and then again each time a variable in such a section is
+     * updated.
      */
-    void setConfig(const Async::Config* cfg) { m_cfg = cfg; }
+    void setConfig(Async::Config* cfg);
 
     unsigned sqlTimeout(void) const { return m_sql_timeout; }
     void setSqlTimeout(unsigned sql_timeout) { m_sql_timeout = sql_timeout; }
@@ -161,19 +167,80 @@ class TGHandler : public sigc::trackable
 
     ReflectorClient* talkerForTG(uint32_t tg) const;
 
-    uint32_t TGForClient(ReflectorClient* client);
+    uint32_t TGForClient(ReflectorClient* client) const
+    {
+      return client->currentTG();
+    }
 
     bool allowTgSelection(ReflectorClient *client, uint32_t tg);
 
-    bool showActivity(uint32_t tg) const;
+    bool showActivity(uint32_t tg) const { return policy(tg).show_activity; }
+
+    bool isRestricted(uint32_t tg) const { return policy(tg).restricted; }
+
+    /**
+     * @brief   Get all talk groups that have local clients
+     * @param   tgs The set to return the talk groups in
+     */
+    void activeTGs(std::set<uint32_t>& tgs) const;
 
-    bool isRestricted(uint32_t tg) const;
+    /**
+     * @brief   Set a talker on another reflector, connected via a trunk
+     * @param   tg The talk group
+     * @param   trunk The name of the trunk the talker is connected through
+     * @param   callsign The callsign of the talker
+     *
+     * A remote talker take precedence over local talkers. If there is a local
+     * talker on the talk group, it will be stopped. No local talker can be
+     * set on the talk group until the remote talker has been cleared.
+     */
+    void setRemoteTalkerForTG(uint32_t tg, const std::string& trunk,
+                              const std::string& callsign);
+
+    /**
+     * @brief   Clear the remote talker for a talk group
+     * @param   tg The talk group
+     */
+    void clearRemoteTalkerForTG(uint32_t tg);
+
+    /**
+     * @brief   Get the remote talker for a talk group
+     * @param   tg The talk group
+     * @param   trunk Set to the name of the trunk for the remote talker
+     * @param   callsign Set to the callsign of the remote talker
+     * @return  Returns \em true if there is a remote talker on the talk group
+     */
+    bool remoteTalkerForTG(uint32_t tg, std::string& trunk,
+                           std::string& callsign) const;
+
+    /**
+     * @brief   Clear all remote talkers connected through a trunk
+     * @param   trunk The name of the trunk
+     */
+    void removeTrunk(const std::string& trunk);
 
     sigc::signal<void, uint32_t,
       ReflectorClient*, ReflectorClient*> talkerUpdated;
 
     sigc::signal<void, uint32_t> requestAutoQsy;
 
+    /**
+     * @brief   A signal that is emitted when a remote talker is set or cleared
+     * @param   tg The talk group
+     * @param   old_callsign The previous remote talker, empty if none
+     * @param   new_callsign The new remote talker, empty if none
+     */
+    sigc::signal<void, uint32_t, const std::string&,
+                 const std::string&> remoteTalkerUpdated;
+
+    /**
+     * @brief   A signal that is emitted when the set of active TGs change
+     *
+     * This signal is emitted when the first client select a talk group or
+     * when the last client leave a talk group.
+     */
+    sigc::signal<void> activeTGsChanged;
+
   private:
     static const time_t TALKER_AUDIO_TIMEOUT = 3; // Max three seconds gap
 
@@ -194,18 +261,43 @@ class TGHandler : public sigc::trackable
         timerclear(&last_talker_timestamp);
       }
     };
+    struct RemoteTalker
+    {
+      std::string trunk;
+      std::string callsign;
+    };
+    struct TGPolicy
+    {
+      bool        restricted        = false;
+      bool        allow_valid       = true;
+      std::regex  allow;
+      bool        show_activity     = true;
+      time_t      auto_qsy_after_s  = 0;
+    };
     typedef std::map<uint32_t, TGInfo*>               IdMap;
     typedef std::map<const ReflectorClient*, TGInfo*> ClientMap;
+    typedef std::map<uint32_t, RemoteTalker>          RemoteTalkerMap;
+    typedef std::unordered_map<uint32_t, TGPolicy>    PolicyMap;
 
-    const Async::Config*  m_cfg;
+    Async::Config*        m_cfg;
+    PolicyMap             m_policies;
     IdMap                 m_id_map;
     ClientMap             m_client_map;
+    RemoteTalkerMap       m_remote_talkers;
     Async::Timer          m_timeout_timer;
     unsigned              m_sql_timeout;
     unsigned              m_sql_timeout_blocktime;
 
     TGHandler(const TGHandler&);
     TGHandler& operator=(const TGHandler&);
+    const TGPolicy& policy(uint32_t tg) const
+    {
+      static const TGPolicy default_policy;
+      PolicyMap::const_iterator it = m_policies.find(tg);
+      return (it != m_policies.end()) ? it->second : default_policy;
+    }
+    void updatePolicies(void);
+    void onCfgUpdated(const std::string& section, const std::string& tag);
     void checkTimers(Async::Timer *t);
     void removeClientP(TGInfo *tg_info, ReflectorClient* client);
     void printTGStatus(void);
@@ -0,0 +1,518 @@
+/**
+@file	 TgRecorder.cpp
+@brief   Archive the audio of talk groups to Ogg/Opus files
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <json/json.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#ifdef OGG_MAJOR
+#include <AsyncAudioContainerOpus.h>
+#endif
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TgRecorder.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+#ifdef OGG_MAJOR
+struct TgRecorder::Segment
+{
+  Async::AudioContainerOpus container;
+  FILE*                     file        = nullptr;
+  string                    dir;
+  string                    filename;
+  string                    callsign;
+  struct timeval            start;
+  unsigned long long        samples     = 0;
+  unsigned long             packets     = 0;
+  unsigned long             bytes       = 0;
+
+  Segment(void) : container(false) {}
+
+  void onWriteBlock(const char *buf, size_t len)
+  {
+    if ((file != nullptr) && (fwrite(buf, 1, len, file) != len))
+    {
+      cerr << "*** ERROR: Could not write to recorder file \""
+           << dir << "/" << filename << "\": " << strerror(errno) << endl;
+      fclose(file);
+      file = nullptr;
+    }
+    bytes += len;
+  }
+};
+#else
+struct TgRecorder::Segment {};
+#endif
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static bool makePath(const string& path);
+static string sanitizeCallsign(const string& callsign);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+TgRecorder::TgRecorder(void)
+  : m_dropped(0)
+{
+} /* TgRecorder::TgRecorder */
+
+
+TgRecorder::~TgRecorder(void)
+{
+  if (m_thread.joinable())
+  {
+    Job job;
+    job.type = JOB_QUIT;
+    job.tg = 0;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_queue.push_back(std::move(job));
+    }
+    m_cond.notify_one();
+    m_thread.join();
+  }
+} /* TgRecorder::~TgRecorder */
+
+
+bool TgRecorder::initialize(const std::string& dir,
+                            const std::set<uint32_t>& tgs)
+{
+#ifdef OGG_MAJOR
+  m_dir = dir;
+  while ((m_dir.size() > 1) && (m_dir.back() == '/'))
+  {
+    m_dir.erase(m_dir.size() - 1);
+  }
+  m_tgs = tgs;
+  if (!makePath(m_dir))
+  {
+    cerr << "*** ERROR: Could not create recorder directory \""
+         << m_dir << "\": " << strerror(errno) << endl;
+    return false;
+  }
+  m_thread = std::thread(&TgRecorder::writerThread, this);
+  return true;
+#else
+  cerr << "*** ERROR: The talk group recorder is not available since "
+          "svxreflector was compiled without Ogg support" << endl;
+  return false;
+#endif
+} /* TgRecorder::initialize */
+
+
+void TgRecorder::talkerStart(uint32_t tg, const std::string& callsign)
+{
+  if (!isRecording(tg))
+  {
+    return;
+  }
+  Job job;
+  job.type = JOB_START;
+  job.tg = tg;
+  job.callsign = callsign;
+  enqueue(std::move(job));
+} /* TgRecorder::talkerStart */
+
+
+void TgRecorder::talkerStop(uint32_t tg)
+{
+  if (!isRecording(tg))
+  {
+    return;
+  }
+  Job job;
+  job.type = JOB_STOP;
+  job.tg = tg;
+  enqueue(std::move(job));
+} /* TgRecorder::talkerStop */
+
+
+void TgRecorder::writePacket(uint32_t tg, const std::vector<uint8_t>& packet)
+{
+  if (!isRecording(tg) || packet.empty())
+  {
+    return;
+  }
+  Job job;
+  job.type = JOB_AUDIO;
+  job.tg = tg;
+  job.data = packet;
+  enqueue(std::move(job));
+} /* TgRecorder::writePacket */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void TgRecorder::enqueue(Job&& job)
+{
+  if (!m_thread.joinable())
+  {
+    return;
+  }
+  gettimeofday(&job.timestamp, NULL);
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+      // Start and stop jobs are never dropped so that segments are always
+      // closed properly. They are few compared to the audio jobs.
+    if ((job.type == JOB_AUDIO) && (m_queue.size() >= MAX_QUEUE_LEN))
+    {
+      ++m_dropped;
+      return;
+    }
+    m_queue.push_back(std::move(job));
+  }
+  m_cond.notify_one();
+} /* TgRecorder::enqueue */
+
+
+void TgRecorder::writerThread(void)
+{
+  std::deque<Job> jobs;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cond.wait(lk, [this]{ return !m_queue.empty(); });
+      jobs.swap(m_queue);
+    }
+
+    for (const auto& job : jobs)
+    {
+      switch (job.type)
+      {
+        case JOB_START:
+          openSegment(job);
+          break;
+        case JOB_AUDIO:
+          writeSegmentPacket(job);
+          break;
+        case JOB_STOP:
+          closeSegment(job.tg);
+          break;
+        case JOB_QUIT:
+          while (!m_segments.empty())
+          {
+            closeSegment(m_segments.begin()->first);
+          }
+          return;
+      }
+    }
+    jobs.clear();
+  }
+} /* TgRecorder::writerThread */
+
+
+void TgRecorder::openSegment(const Job& job)
+{
+#ifdef OGG_MAJOR
+  closeSegment(job.tg);
+
+  struct tm tm;
+  time_t t = job.timestamp.tv_sec;
+  localtime_r(&t, &tm);
+  char date[16];
+  strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+  char tstr[16];
+  strftime(tstr, sizeof(tstr), "%H%M%S", &tm);
+  char iso[32];
+  strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%S%z", &tm);
+
+  Segment* seg = new Segment;
+  std::ostringstream ss;
+  ss << m_dir << "/TG" << job.tg << "/" << date;
+  seg->dir = ss.str();
+  seg->callsign = job.callsign;
+  seg->start = job.timestamp;
+  if (!makePath(seg->dir))
+  {
+    cerr << "*** ERROR: Could not create recorder directory \""
+         << seg->dir << "\": " << strerror(errno) << endl;
+    delete seg;
+    return;
+  }
+
+    // A talker that key up again within the same second must not overwrite
+    // the previous file so a counter is added to the name if it exists
+  const string basename = string(tstr) + "_" + sanitizeCallsign(job.callsign);
+  string path;
+  int fd = -1;
+  for (unsigned cnt=0; (fd < 0) && (cnt < MAX_NAME_COLLISIONS); ++cnt)
+  {
+    std::ostringstream name;
+    name << basename;
+    if (cnt > 0)
+    {
+      name << "-" << cnt;
+    }
+    name << "." << seg->container.filenameExtension();
+    seg->filename = name.str();
+    path = seg->dir + "/" + seg->filename;
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if ((fd < 0) && (errno != EEXIST))
+    {
+      break;
+    }
+  }
+  if (fd >= 0)
+  {
+    seg->file = fdopen(fd, "wb");
+    if (seg->file == nullptr)
+    {
+      int errno_save = errno;
+      close(fd);
+      errno = errno_save;
+    }
+  }
+  if (seg->file == nullptr)
+  {
+    cerr << "*** ERROR: Could not open recorder file \"" << path
+         << "\": " << strerror(errno) << endl;
+    delete seg;
+    return;
+  }
+
+  std::ostringstream tg_str;
+  tg_str << job.tg;
+  seg->container.setComments({
+      "TITLE=TG" + tg_str.str() + " " + job.callsign,
+      "ARTIST=" + job.callsign,
+      "ALBUM=TG" + tg_str.str(),
+      string("DATE=") + iso,
+      "ENCODER=SvxReflector"
+    });
+  seg->container.writeBlock.connect(
+      sigc::mem_fun(*seg, &Segment::onWriteBlock));
+  seg->onWriteBlock(seg->container.header(), seg->container.headerSize());
+  m_segments[job.tg] = seg;
+#endif
+} /* TgRecorder::openSegment */
+
+
+void TgRecorder::closeSegment(uint32_t tg)
+{
+#ifdef OGG_MAJOR
+  SegmentMap::iterator it = m_segments.find(tg);
+  if (it == m_segments.end())
+  {
+    return;
+  }
+  Segment* seg = it->second;
+  m_segments.erase(it);
+
+  seg->container.endStream();
+  bool ok = (seg->file != nullptr);
+  if (ok && (fclose(seg->file) != 0))
+  {
+    cerr << "*** ERROR: Could not close recorder file \""
+         << seg->dir << "/" << seg->filename << "\": "
+         << strerror(errno) << endl;
+    ok = false;
+  }
+  seg->file = nullptr;
+
+  if (ok)
+  {
+    Json::Value entry;
+    entry["file"] = seg->filename;
+    entry["callsign"] = seg->callsign;
+    entry["tg"] = tg;
+    entry["start"] = static_cast<Json::UInt64>(seg->start.tv_sec);
+    entry["duration"] = seg->samples / 48000.0;
+    entry["bytes"] = static_cast<Json::UInt64>(seg->bytes);
+    entry["packets"] = static_cast<Json::UInt64>(seg->packets);
+
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    const string line = Json::writeString(builder, entry) + "\n";
+    const string index_path = seg->dir + "/index.jsonl";
+    FILE* index = fopen(index_path.c_str(), "a");
+    if ((index == nullptr) ||
+        (fwrite(line.data(), 1, line.size(), index) != line.size()) ||
+        (fclose(index) != 0))
+    {
+      cerr << "*** ERROR: Could not write to recorder index file \""
+           << index_path << "\": " << strerror(errno) << endl;
+    }
+  }
+  delete seg;
+#endif
+} /* TgRecorder::closeSegment */
+
+
+void TgRecorder::writeSegmentPacket(const Job& job)
+{
+#ifdef OGG_MAJOR
+  SegmentMap::iterator it = m_segments.find(job.tg);
+  if (it == m_segments.end())
+  {
+    return;
+  }
+  Segment* seg = it->second;
+  seg->samples += Async::AudioContainerOpus::packetSamples(
+      job.data.data(), job.data.size());
+  seg->packets += 1;
+  seg->container.writePacket(job.data.data(), job.data.size());
+#endif
+} /* TgRecorder::writeSegmentPacket */
+
+
+/**
+ * @brief   Create a directory and all missing parents
+ * @param   path The directory to create
+ * @return  Returns \em true if the directory exist on return
+ */
+static bool makePath(const string& path)
+{
+  string::size_type pos = 0;
+  do
+  {
+    pos = path.find('/', pos + 1);
+    const string dir = path.substr(0, pos);
+    if ((mkdir(dir.c_str(), 0755) != 0) && (errno != EEXIST))
+    {
+      return false;
+    }
+  } while (pos != string::npos);
+  return true;
+} /* makePath */
+
+
+/**
+ * @brief   Make a callsign safe to use in a filename
+ * @param   callsign The callsign
+ * @return  Returns the callsign with unsafe characters replaced
+ */
+static string sanitizeCallsign(const string& callsign)
+{
+  string safe(callsign);
+  for (auto& ch : safe)
+  {
+    if (!isalnum(static_cast<unsigned char>(ch)) && (ch != '-'))
+    {
+      ch = '_';
+    }
+  }
+  return safe.empty() ? string("unknown") : safe;
+} /* sanitizeCallsign */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,235 @@
+/**
+@file	 TgRecorder.h
+@brief   Archive the audio of talk groups to Ogg/Opus files
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TG_RECORDER_INCLUDED
+#define TG_RECORDER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Archive the audio of talk groups to Ogg/Opus files
+@author agent
+@date   2026-10-18
+
+This class write the Opus packets received by the reflector directly into
+Ogg/Opus files, without decoding them. Each talker transmission is written to
+its own file, a segment, and a line describing the segment is appended to a
+JSON index file when the segment is closed. The files are organized like this:
+
+  <dir>/TG<tg>/<YYYY-MM-DD>/<HHMMSS>_<callsign>.opus
+  <dir>/TG<tg>/<YYYY-MM-DD>/index.jsonl
+
+Existing files are never overwritten. If a file with the same name already
+exist, e.g. when a talker key up twice within one second, a counter is added
+to the name: <HHMMSS>_<callsign>-1.opus, <HHMMSS>_<callsign>-2.opus etc.
+
+All file operations are done in a background writer thread. The reflector
+thread only put jobs on a queue so that a slow disk never stall the audio
+distribution. If the queue grows too long, audio packets are dropped and
+counted.
+*/
+class TgRecorder
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     */
+    TgRecorder(void);
+
+    /**
+     * @brief 	Destructor
+     *
+     * All open segments are closed before the destructor return.
+     */
+    ~TgRecorder(void);
+
+    /**
+     * @brief 	Initialize the recorder and start the writer thread
+     * @param 	dir The directory to write the archive to
+     * @param   tgs The talk groups to record, empty to record all
+     * @return	Return \em true on success or else \em false
+     */
+    bool initialize(const std::string& dir, const std::set<uint32_t>& tgs);
+
+    /**
+     * @brief   Check if a talk group should be recorded
+     * @param   tg The talk group
+     * @return  Returns \em true if the talk group is recorded
+     */
+    bool isRecording(uint32_t tg) const
+    {
+      return m_tgs.empty() ? (tg > 0) : (m_tgs.count(tg) > 0);
+    }
+
+    /**
+     * @brief   A talker started on a talk group
+     * @param   tg The talk group
+     * @param   callsign The callsign of the talker
+     *
+     * A new segment is started for the talk group.
+     */
+    void talkerStart(uint32_t tg, const std::string& callsign);
+
+    /**
+     * @brief   A talker stopped on a talk group
+     * @param   tg The talk group
+     *
+     * The current segment for the talk group is closed and indexed.
+     */
+    void talkerStop(uint32_t tg);
+
+    /**
+     * @brief   Write an Opus packet to the current segment of a talk group
+     * @param   tg The talk group
+     * @param   packet The encoded Opus packet
+     */
+    void writePacket(uint32_t tg, const std::vector<uint8_t>& packet);
+
+    /**
+     * @brief   Get the number of packets dropped due to a full queue
+     * @return  Returns the number of dropped packets
+     */
+    unsigned long droppedPackets(void) const { return m_dropped; }
+
+  private:
+    static const size_t MAX_QUEUE_LEN = 5000;
+    static const unsigned MAX_NAME_COLLISIONS = 100;
+
+    typedef enum
+    {
+      JOB_START, JOB_AUDIO, JOB_STOP, JOB_QUIT
+    } JobType;
+
+    struct Job
+    {
+      JobType               type;
+      uint32_t              tg;
+      struct timeval        timestamp;
+      std::string           callsign;
+      std::vector<uint8_t>  data;
+    };
+
+    struct Segment;
+    typedef std::map<uint32_t, Segment*> SegmentMap;
+
+    std::string                 m_dir;
+    std::set<uint32_t>          m_tgs;
+    std::thread                 m_thread;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+    std::deque<Job>             m_queue;
+    std::atomic<unsigned long>  m_dropped;
+    SegmentMap                  m_segments;   // Only used by the writer
+
+    TgRecorder(const TgRecorder&);
+    TgRecorder& operator=(const TgRecorder&);
+    void enqueue(Job&& job);
+    void writerThread(void);
+    void openSegment(const Job& job);
+    void closeSegment(uint32_t tg);
+    void writeSegmentPacket(const Job& job);
+
+};  /* class TgRecorder */
+
+
+#endif /* TG_RECORDER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,360 @@
+/**
+@file	 TgStreamer.cpp
+@brief   Live streaming of talk groups over HTTP
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncHttpServerConnection.h>
+#ifdef OGG_MAJOR
+#include <AsyncAudioContainerOpus.h>
+#endif
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TgStreamer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+#ifdef OGG_MAJOR
+struct TgStreamer::Stream
+{
+  AudioContainerOpus                  container;
+  std::vector<HttpServerConnection*>  listeners;
+
+  Stream(void) : container(false) {}
+};
+#else
+struct TgStreamer::Stream
+{
+  std::vector<HttpServerConnection*>  listeners;
+};
+#endif
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool TgStreamer::isAvailable(void)
+{
+#ifdef OGG_MAJOR
+  return true;
+#else
+  return false;
+#endif
+} /* TgStreamer::isAvailable */
+
+
+TgStreamer::TgStreamer(void)
+  : m_max_listeners(100), m_evicted(0), m_writing(false)
+{
+} /* TgStreamer::TgStreamer */
+
+
+TgStreamer::~TgStreamer(void)
+{
+  for (auto& item : m_listeners)
+  {
+    item.second.full_con.disconnect();
+  }
+  m_listeners.clear();
+  for (auto& item : m_streams)
+  {
+    delete item.second;
+  }
+  m_streams.clear();
+} /* TgStreamer::~TgStreamer */
+
+
+bool TgStreamer::addListener(uint32_t tg, HttpServerConnection *con)
+{
+#ifdef OGG_MAJOR
+  if (!isAllowed(tg) || isFull() || (m_listeners.count(con) > 0))
+  {
+    return false;
+  }
+
+  Stream*& stream = m_streams[tg];
+  if (stream == nullptr)
+  {
+    stream = new Stream;
+    std::ostringstream ss;
+    ss << "TG" << tg;
+    stream->container.setComments({
+        "TITLE=" + ss.str(),
+        "ALBUM=" + ss.str(),
+        "ENCODER=SvxReflector"
+      });
+    stream->container.writeBlock.connect(
+        sigc::bind(mem_fun(*this, &TgStreamer::onWriteBlock), tg));
+  }
+
+  HttpServerConnection::Response res;
+  res.setCode(200);
+  res.setHeader("Content-type", "audio/ogg");
+  res.setHeader("Cache-Control", "no-cache, no-store");
+  con->setChunked();
+  if (!con->write(res) ||
+      !con->write(stream->container.header(),
+                  stream->container.headerSize()))
+  {
+    deleteIdleStream(tg);
+    return false;
+  }
+
+  Listener& listener = m_listeners[con];
+  listener.tg = tg;
+  listener.stalled = false;
+  listener.full_con = con->sendBufferFull.connect(
+      sigc::bind(mem_fun(*this, &TgStreamer::onSendBufferFull), con));
+  stream->listeners.push_back(con);
+
+  cout << "HTTP stream listener " << con->remoteHost() << ":"
+       << con->remotePort() << " added to TG #" << tg << endl;
+
+  return true;
+#else
+  return false;
+#endif
+} /* TgStreamer::addListener */
+
+
+void TgStreamer::removeListener(HttpServerConnection *con)
+{
+  ListenerMap::iterator lit = m_listeners.find(con);
+  if (lit == m_listeners.end())
+  {
+    return;
+  }
+  const uint32_t tg = lit->second.tg;
+  lit->second.full_con.disconnect();
+  m_listeners.erase(lit);
+
+  StreamMap::iterator sit = m_streams.find(tg);
+  if (sit != m_streams.end())
+  {
+    auto& listeners = sit->second->listeners;
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), con),
+                    listeners.end());
+    if (!m_writing)
+    {
+      deleteIdleStream(tg);
+    }
+  }
+
+  cout << "HTTP stream listener " << con->remoteHost() << ":"
+       << con->remotePort() << " removed from TG #" << tg << endl;
+} /* TgStreamer::removeListener */
+
+
+void TgStreamer::writePacket(uint32_t tg, const std::vector<uint8_t>& packet)
+{
+#ifdef OGG_MAJOR
+  StreamMap::iterator it = m_streams.find(tg);
+  if ((it == m_streams.end()) || packet.empty())
+  {
+    return;
+  }
+  m_writing = true;
+  it->second->container.writePacket(packet.data(), packet.size());
+  m_writing = false;
+  deleteIdleStream(tg);
+#endif
+} /* TgStreamer::writePacket */
+
+
+void TgStreamer::flush(uint32_t tg)
+{
+#ifdef OGG_MAJOR
+  StreamMap::iterator it = m_streams.find(tg);
+  if (it == m_streams.end())
+  {
+    return;
+  }
+  m_writing = true;
+  it->second->container.flushPages();
+  m_writing = false;
+  deleteIdleStream(tg);
+#endif
+} /* TgStreamer::flush */
+
+
+size_t TgStreamer::listenerCount(uint32_t tg) const
+{
+  StreamMap::const_iterator it = m_streams.find(tg);
+  return (it != m_streams.end()) ? it->second->listeners.size() : 0;
+} /* TgStreamer::listenerCount */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void TgStreamer::onWriteBlock(const char *buf, size_t len, uint32_t tg)
+{
+  StreamMap::iterator sit = m_streams.find(tg);
+  if (sit == m_streams.end())
+  {
+    return;
+  }
+
+    // The page is written to all listeners before anyone is evicted since
+    // evicting a listener modify the listener list.
+  std::vector<HttpServerConnection*> evict;
+  for (auto con : sit->second->listeners)
+  {
+    Listener& listener = m_listeners[con];
+    if (listener.stalled || !con->write(buf, len))
+    {
+      evict.push_back(con);
+    }
+  }
+
+  for (auto con : evict)
+  {
+    cout << "*** WARNING: HTTP stream listener " << con->remoteHost() << ":"
+         << con->remotePort() << " on TG #" << tg
+         << " cannot keep up. Disconnecting." << endl;
+    ++m_evicted;
+    removeListener(con);
+    con->disconnect();
+    con->disconnected(con, HttpServerConnection::DR_ORDERED_DISCONNECT);
+  }
+} /* TgStreamer::onWriteBlock */
+
+
+void TgStreamer::onSendBufferFull(bool is_full, HttpServerConnection *con)
+{
+    // A partially written page cannot be resent since there is no send
+    // queue, so the listener is evicted when the next page is written.
+  if (is_full)
+  {
+    ListenerMap::iterator it = m_listeners.find(con);
+    if (it != m_listeners.end())
+    {
+      it->second.stalled = true;
+    }
+  }
+} /* TgStreamer::onSendBufferFull */
+
+
+void TgStreamer::deleteIdleStream(uint32_t tg)
+{
+  StreamMap::iterator it = m_streams.find(tg);
+  if ((it != m_streams.end()) && it->second->listeners.empty())
+  {
+    delete it->second;
+    m_streams.erase(it);
+  }
+} /* TgStreamer::deleteIdleStream */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,258 @@
+/**
+@file	 TgStreamer.h
+@brief   Live streaming of talk groups over HTTP
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TG_STREAMER_INCLUDED
+#define TG_STREAMER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class HttpServerConnection;
+};
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Live streaming of talk groups over HTTP
+@author agent
+@date   2026-10-18
+
+This class stream the audio of talk groups to HTTP clients, e.g. web browsers,
+as Ogg/Opus using chunked transfer encoding. The Opus packets received by the
+reflector are put into Ogg pages as is, without transcoding. The pages are
+built once per talk group and the same pages are then written to all
+listeners of that talk group. A talk group is only packetized while it has
+listeners.
+
+A listener that joins get the Ogg/Opus header pages followed by the pages
+produced from that point on. There is no send queue for HTTP connections so
+a listener that cannot keep up, i.e. when the send buffer of the socket is
+full, is disconnected.
+*/
+class TgStreamer : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     */
+    TgStreamer(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~TgStreamer(void);
+
+    /**
+     * @brief   Check if streaming is available
+     * @return  Returns \em false if compiled without Ogg support
+     */
+    static bool isAvailable(void);
+
+    /**
+     * @brief   Set the talk groups that may be streamed
+     * @param   tgs The talk groups, empty to allow all
+     */
+    void setTGs(const std::set<uint32_t>& tgs) { m_tgs = tgs; }
+
+    /**
+     * @brief   Set the maximum number of listeners
+     * @param   max_listeners The maximum number of listeners in total
+     */
+    void setMaxListeners(unsigned max_listeners)
+    {
+      m_max_listeners = max_listeners;
+    }
+
+    /**
+     * @brief   Check if a talk group may be streamed
+     * @param   tg The talk group
+     * @return  Returns \em true if the talk group may be streamed
+     */
+    bool isAllowed(uint32_t tg) const
+    {
+      return (tg > 0) && (m_tgs.empty() || (m_tgs.count(tg) > 0));
+    }
+
+    /**
+     * @brief   Check if the maximum number of listeners has been reached
+     * @return  Returns \em true if no more listeners can be added
+     */
+    bool isFull(void) const { return m_listeners.size() >= m_max_listeners; }
+
+    /**
+     * @brief   Start streaming a talk group to a HTTP connection
+     * @param   tg The talk group
+     * @param   con The HTTP connection
+     * @return  Returns \em true on success or else \em false
+     *
+     * The HTTP response header and the Ogg/Opus header pages are written to
+     * the connection. The connection must be removed using removeListener
+     * when it is disconnected.
+     */
+    bool addListener(uint32_t tg, Async::HttpServerConnection *con);
+
+    /**
+     * @brief   Stop streaming to a HTTP connection
+     * @param   con The HTTP connection
+     *
+     * It is safe to call this function for connections that are not
+     * listeners.
+     */
+    void removeListener(Async::HttpServerConnection *con);
+
+    /**
+     * @brief   Write an Opus packet to the listeners of a talk group
+     * @param   tg The talk group
+     * @param   packet The encoded Opus packet
+     */
+    void writePacket(uint32_t tg, const std::vector<uint8_t>& packet);
+
+    /**
+     * @brief   Write all buffered audio for a talk group to the listeners
+     * @param   tg The talk group
+     *
+     * Call this function when a talker stop so that the end of the
+     * transmission is not held back until the next talker start.
+     */
+    void flush(uint32_t tg);
+
+    /**
+     * @brief   Get the number of listeners
+     * @return  Returns the number of listeners for all talk groups
+     */
+    size_t listenerCount(void) const { return m_listeners.size(); }
+
+    /**
+     * @brief   Get the number of listeners for a talk group
+     * @param   tg The talk group
+     * @return  Returns the number of listeners for the talk group
+     */
+    size_t listenerCount(uint32_t tg) const;
+
+    /**
+     * @brief   Get the number of listeners that have been disconnected
+     * @return  Returns the number of listeners that could not keep up
+     */
+    unsigned long evictedCount(void) const { return m_evicted; }
+
+  private:
+    struct Stream;
+    struct Listener
+    {
+      uint32_t          tg;
+      bool              stalled;
+      sigc::connection  full_con;
+    };
+    typedef std::map<uint32_t, Stream*> StreamMap;
+    typedef std::map<Async::HttpServerConnection*, Listener> ListenerMap;
+
+    std::set<uint32_t>  m_tgs;
+    unsigned            m_max_listeners;
+    StreamMap           m_streams;
+    ListenerMap         m_listeners;
+    unsigned long       m_evicted;
+    bool                m_writing;
+
+    TgStreamer(const TgStreamer&);
+    TgStreamer& operator=(const TgStreamer&);
+    void onWriteBlock(const char *buf, size_t len, uint32_t tg);
+    void onSendBufferFull(bool is_full, Async::HttpServerConnection *con);
+    void deleteIdleStream(uint32_t tg);
+
+};  /* class TgStreamer */
+
+
+#endif /* TG_STREAMER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
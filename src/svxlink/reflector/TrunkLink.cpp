@@ -0,0 +1,680 @@
+/**
+@file	 TrunkLink.cpp
+@brief   A trunk link to another reflector
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sstream>
+#include <cstdlib>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncConfig.h>
+#include <AsyncUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TrunkLink.h"
+#include "TGHandler.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+TrunkLink::TrunkLink(Async::Config& cfg, const std::string& section,
+                     const std::string& local_name, Async::UdpSocket* udp_sock,
+                     uint16_t udp_port)
+  : m_cfg(cfg), m_section(section), m_local_name(local_name),
+    m_udp_sock(udp_sock), m_udp_port(udp_port), m_client(0), m_con(0),
+    m_state(STATE_DISCONNECTED), m_peer_udp_port(0), m_interest_sent(false),
+    m_udp_tx_seq(0), m_next_udp_rx_seq(0),
+    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC),
+    m_reconnect_timer(RECONNECT_INTERVAL, Timer::TYPE_ONESHOT, false),
+    m_heartbeat_tx_cnt(0), m_heartbeat_rx_cnt(0)
+{
+  m_heartbeat_timer.expired.connect(mem_fun(*this, &TrunkLink::heartbeat));
+  m_reconnect_timer.expired.connect(mem_fun(*this, &TrunkLink::reconnect));
+} /* TrunkLink::TrunkLink */
+
+
+TrunkLink::~TrunkLink(void)
+{
+  if ((m_con != 0) && (m_con != m_client))
+  {
+    m_con->disconnect();
+  }
+  delete m_client;
+  m_client = 0;
+  m_con = 0;
+} /* TrunkLink::~TrunkLink */
+
+
+bool TrunkLink::initialize(void)
+{
+  if (!m_cfg.getValue(m_section, "PEER_NAME", m_peer_name) ||
+      m_peer_name.empty())
+  {
+    cerr << "*** ERROR: " << m_section << "/PEER_NAME must be set" << endl;
+    return false;
+  }
+  if (m_peer_name == m_local_name)
+  {
+    cerr << "*** ERROR: " << m_section << "/PEER_NAME must not be the same "
+            "as GLOBAL/TRUNK_NAME" << endl;
+    return false;
+  }
+  if (!m_cfg.getValue(m_section, "SECRET", m_secret) || m_secret.empty())
+  {
+    cerr << "*** ERROR: " << m_section << "/SECRET must be set" << endl;
+    return false;
+  }
+
+  string host;
+  if (m_cfg.getValue(m_section, "HOST", host) && !host.empty())
+  {
+    uint16_t port = DEFAULT_PORT;
+    m_cfg.getValue(m_section, "PORT", port);
+    m_client = new FramedTcpClient(host, port);
+    m_client->connected.connect(mem_fun(*this, &TrunkLink::onConnected));
+    m_client->disconnected.connect(mem_fun(*this, &TrunkLink::onDisconnected));
+    m_client->frameReceived.connect(
+        mem_fun(*this, &TrunkLink::onFrameReceived));
+    m_client->setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
+    m_con = m_client;
+    m_client->connect();
+  }
+
+  return true;
+} /* TrunkLink::initialize */
+
+
+void TrunkLink::acceptConnection(Async::FramedTcpConnection *con,
+                                 const MsgTrunkHello& hello)
+{
+  if (isOutbound())
+  {
+    cerr << "*** WARNING[" << m_section << "]: Rejecting incoming trunk "
+            "connection from " << con->remoteHost() << ":"
+         << con->remotePort() << " since HOST is set for this trunk" << endl;
+    con->disconnect();
+    con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+    return;
+  }
+
+  if (m_con != 0)
+  {
+    cout << m_section << ": Replacing trunk connection from "
+         << m_con->remoteHost() << ":" << m_con->remotePort() << endl;
+    disconnect();
+  }
+
+  cout << m_section << ": Incoming trunk connection from "
+       << con->remoteHost() << ":" << con->remotePort() << endl;
+  m_con = con;
+  m_con->disconnected.connect(mem_fun(*this, &TrunkLink::onDisconnected));
+  m_con->frameReceived.connect(mem_fun(*this, &TrunkLink::onFrameReceived));
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+  m_peer_addr = con->remoteHost();
+  m_peer_udp_port = hello.udpPort();
+  sendHello();
+  sendMsg(MsgTrunkAuth(m_secret, hello.nonce(), m_local_name));
+  m_state = STATE_EXPECT_AUTH;
+} /* TrunkLink::acceptConnection */
+
+
+void TrunkLink::udpMsgReceived(const ReflectorUdpMsg& header,
+                               std::istream& is)
+{
+  uint16_t udp_rx_seq_diff = header.sequenceNum() - m_next_udp_rx_seq;
+  if (udp_rx_seq_diff > 0x7fff)
+  {
+    return;
+  }
+  m_next_udp_rx_seq = header.sequenceNum() + 1;
+
+  switch (header.type())
+  {
+    case MsgTrunkUdpAudio::TYPE:
+    {
+      MsgTrunkUdpAudio msg;
+      if (!msg.unpack(is))
+      {
+        cerr << "*** WARNING[" << m_section
+             << "]: Could not unpack incoming MsgTrunkUdpAudio message"
+             << endl;
+        return;
+      }
+      string trunk, callsign;
+      if (!msg.audioData().empty() &&
+          TGHandler::instance()->remoteTalkerForTG(msg.tg(), trunk,
+                                                   callsign) &&
+          (trunk == m_peer_name))
+      {
+        audioReceived(msg.tg(), msg.audioData());
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+} /* TrunkLink::udpMsgReceived */
+
+
+void TrunkLink::updateInterest(void)
+{
+  if (m_state != STATE_UP)
+  {
+    return;
+  }
+  std::set<uint32_t> tgs;
+  TGHandler::instance()->activeTGs(tgs);
+  if (m_interest_sent && (tgs == m_sent_tgs))
+  {
+    return;
+  }
+  sendMsg(MsgTrunkTgInterest(tgs));
+  m_sent_tgs = tgs;
+  m_interest_sent = true;
+} /* TrunkLink::updateInterest */
+
+
+void TrunkLink::sendTalkerStart(uint32_t tg, const std::string& callsign)
+{
+  if (m_state == STATE_UP)
+  {
+    sendMsg(MsgTrunkTalkerStart(tg, callsign));
+  }
+} /* TrunkLink::sendTalkerStart */
+
+
+void TrunkLink::sendTalkerStop(uint32_t tg, const std::string& callsign)
+{
+  if (m_state == STATE_UP)
+  {
+    sendMsg(MsgTrunkTalkerStop(tg, callsign));
+  }
+} /* TrunkLink::sendTalkerStop */
+
+
+void TrunkLink::sendAudio(uint32_t tg, const std::vector<uint8_t>& audio)
+{
+  if ((m_state == STATE_UP) && (m_peer_tgs.count(tg) > 0))
+  {
+    sendUdpMsg(MsgTrunkUdpAudio(tg, audio));
+  }
+} /* TrunkLink::sendAudio */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void TrunkLink::onConnected(void)
+{
+  cout << m_section << ": Connected to trunk peer "
+       << m_client->remoteHost() << ":" << m_client->remotePort() << endl;
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+  m_peer_addr = m_client->remoteHost();
+  sendHello();
+  m_state = STATE_EXPECT_HELLO;
+} /* TrunkLink::onConnected */
+
+
+void TrunkLink::onDisconnected(Async::FramedTcpConnection *con,
+    Async::FramedTcpConnection::DisconnectReason reason)
+{
+  if (con != m_con)
+  {
+    return;
+  }
+
+  if (m_state == STATE_UP)
+  {
+    cout << m_section << ": Trunk to " << m_peer_name << " down: "
+         << TcpConnection::disconnectReasonStr(reason) << endl;
+  }
+  else if (m_state != STATE_DISCONNECTED)
+  {
+    cout << m_section << ": Trunk connection closed during handshake: "
+         << TcpConnection::disconnectReasonStr(reason) << endl;
+  }
+
+  m_state = STATE_DISCONNECTED;
+  m_peer_tgs.clear();
+  m_sent_tgs.clear();
+  m_interest_sent = false;
+  m_peer_udp_port = 0;
+  TGHandler::instance()->removeTrunk(m_peer_name);
+
+  if (isOutbound())
+  {
+    m_con->setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
+      // Spread out the reconnects a bit so that all reflectors in a mesh
+      // do not hammer each other at the same time after a restart
+    m_reconnect_timer.setTimeout(RECONNECT_INTERVAL +
+                                 rand() % RECONNECT_INTERVAL);
+    m_reconnect_timer.setEnable(true);
+  }
+  else
+  {
+    m_con = 0;
+  }
+} /* TrunkLink::onDisconnected */
+
+
+void TrunkLink::onFrameReceived(Async::FramedTcpConnection *con,
+                                std::vector<uint8_t>& data)
+{
+  if ((con != m_con) || (m_state == STATE_DISCONNECTED))
+  {
+    return;
+  }
+
+  char *buf = reinterpret_cast<char*>(&data.front());
+  stringstream ss;
+  ss.write(buf, data.size());
+
+  ReflectorMsg header;
+  if (!header.unpack(ss))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Unpacking failed for trunk message header" << endl;
+    disconnect();
+    return;
+  }
+
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+
+  if ((m_state != STATE_UP) && (header.type() != MsgTrunkHello::TYPE) &&
+      (header.type() != MsgTrunkAuth::TYPE))
+  {
+    return;
+  }
+
+  switch (header.type())
+  {
+    case MsgHeartbeat::TYPE:
+      break;
+    case MsgTrunkHello::TYPE:
+      handleMsgTrunkHello(ss);
+      break;
+    case MsgTrunkAuth::TYPE:
+      handleMsgTrunkAuth(ss);
+      break;
+    case MsgTrunkTgInterest::TYPE:
+      handleMsgTrunkTgInterest(ss);
+      break;
+    case MsgTrunkTalkerStart::TYPE:
+      handleMsgTrunkTalkerStart(ss);
+      break;
+    case MsgTrunkTalkerStop::TYPE:
+      handleMsgTrunkTalkerStop(ss);
+      break;
+    default:
+      // Ignore unknown messages to make it possible to extend the protocol
+      break;
+  }
+} /* TrunkLink::onFrameReceived */
+
+
+void TrunkLink::handleMsgTrunkHello(std::istream& is)
+{
+  MsgTrunkHello msg;
+  if ((m_state != STATE_EXPECT_HELLO) || !msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Unexpected or malformed MsgTrunkHello" << endl;
+    disconnect();
+    return;
+  }
+  if (msg.protoVer() != MsgTrunkHello::PROTO_VER)
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Unsupported trunk protocol version " << msg.protoVer()
+         << endl;
+    disconnect();
+    return;
+  }
+  if (msg.name() != m_peer_name)
+  {
+    cerr << "*** WARNING[" << m_section << "]: Expected trunk peer \""
+         << m_peer_name << "\" but \"" << msg.name() << "\" answered" << endl;
+    disconnect();
+    return;
+  }
+  m_peer_udp_port = msg.udpPort();
+  sendMsg(MsgTrunkAuth(m_secret, msg.nonce(), m_local_name));
+  m_state = STATE_EXPECT_AUTH;
+} /* TrunkLink::handleMsgTrunkHello */
+
+
+void TrunkLink::handleMsgTrunkAuth(std::istream& is)
+{
+  MsgTrunkAuth msg;
+  if ((m_state != STATE_EXPECT_AUTH) || !msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Unexpected or malformed MsgTrunkAuth" << endl;
+    disconnect();
+    return;
+  }
+  if (!msg.verify(m_secret, m_nonce, m_peer_name))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Trunk authentication failed for peer \"" << m_peer_name
+         << "\"" << endl;
+    disconnect();
+    return;
+  }
+
+  m_con->setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+  m_state = STATE_UP;
+  m_udp_tx_seq = 0;
+  m_next_udp_rx_seq = 0;
+  cout << m_section << ": Trunk to " << m_peer_name << " up" << endl;
+
+  updateInterest();
+  sendLocalTalkers();
+} /* TrunkLink::handleMsgTrunkAuth */
+
+
+void TrunkLink::handleMsgTrunkTgInterest(std::istream& is)
+{
+  MsgTrunkTgInterest msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Could not unpack MsgTrunkTgInterest" << endl;
+    return;
+  }
+  m_peer_tgs = msg.tgs();
+} /* TrunkLink::handleMsgTrunkTgInterest */
+
+
+void TrunkLink::handleMsgTrunkTalkerStart(std::istream& is)
+{
+  MsgTrunkTalkerStart msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Could not unpack MsgTrunkTalkerStart" << endl;
+    return;
+  }
+
+    // Find out which reflector currently hold the talk group, if any. The
+    // reflector with the lowest name win a collision. Since all reflectors
+    // see the same talker starts, they all come to the same conclusion.
+  TGHandler *tgh = TGHandler::instance();
+  string holder, callsign;
+  if (tgh->talkerForTG(msg.tg()) != 0)
+  {
+    holder = m_local_name;
+    callsign = tgh->talkerForTG(msg.tg())->callsign();
+  }
+  else
+  {
+    tgh->remoteTalkerForTG(msg.tg(), holder, callsign);
+  }
+  if (!holder.empty() && (holder != m_peer_name) && (holder < m_peer_name))
+  {
+    cout << m_section << ": Talker collision on TG #" << msg.tg()
+         << ". Keeping " << callsign << "@" << holder << " over "
+         << msg.callsign() << "@" << m_peer_name << endl;
+    return;
+  }
+
+  cout << msg.callsign() << "@" << m_peer_name << ": Talker start on TG #"
+       << msg.tg() << endl;
+  tgh->setRemoteTalkerForTG(msg.tg(), m_peer_name, msg.callsign());
+} /* TrunkLink::handleMsgTrunkTalkerStart */
+
+
+void TrunkLink::handleMsgTrunkTalkerStop(std::istream& is)
+{
+  MsgTrunkTalkerStop msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << m_section
+         << "]: Could not unpack MsgTrunkTalkerStop" << endl;
+    return;
+  }
+
+  TGHandler *tgh = TGHandler::instance();
+  string trunk, callsign;
+  if (tgh->remoteTalkerForTG(msg.tg(), trunk, callsign) &&
+      (trunk == m_peer_name) && (callsign == msg.callsign()))
+  {
+    cout << msg.callsign() << "@" << m_peer_name << ": Talker stop on TG #"
+         << msg.tg() << endl;
+    tgh->clearRemoteTalkerForTG(msg.tg());
+  }
+} /* TrunkLink::handleMsgTrunkTalkerStop */
+
+
+void TrunkLink::sendHello(void)
+{
+  MsgTrunkHello hello(m_local_name, m_udp_port);
+  m_nonce = hello.nonce();
+  sendMsg(hello);
+} /* TrunkLink::sendHello */
+
+
+void TrunkLink::sendMsg(const ReflectorMsg& msg)
+{
+  if ((m_con == 0) || !m_con->isConnected())
+  {
+    return;
+  }
+
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+
+  ReflectorMsg header(msg.type());
+  ostringstream ss;
+  if (!header.pack(ss) || !msg.pack(ss))
+  {
+    cerr << "*** ERROR[" << m_section << "]: Failed to pack trunk message"
+         << endl;
+    return;
+  }
+  m_con->write(ss.str().data(), ss.str().size());
+} /* TrunkLink::sendMsg */
+
+
+void TrunkLink::sendUdpMsg(const ReflectorUdpMsg& msg)
+{
+  if ((m_udp_sock == 0) || (m_peer_udp_port == 0))
+  {
+    return;
+  }
+
+  ReflectorUdpMsg header(msg.type(), 0, m_udp_tx_seq++);
+  ostringstream ss;
+  if (!header.pack(ss) || !msg.pack(ss))
+  {
+    cerr << "*** ERROR[" << m_section
+         << "]: Failed to pack trunk UDP message" << endl;
+    return;
+  }
+  m_udp_sock->write(m_peer_addr, m_peer_udp_port, ss.str().data(),
+                    ss.str().size());
+} /* TrunkLink::sendUdpMsg */
+
+
+void TrunkLink::sendLocalTalkers(void)
+{
+  TGHandler *tgh = TGHandler::instance();
+  std::set<uint32_t> tgs;
+  tgh->activeTGs(tgs);
+  for (uint32_t tg : tgs)
+  {
+    ReflectorClient *talker = tgh->talkerForTG(tg);
+    if (talker != 0)
+    {
+      sendTalkerStart(tg, talker->callsign());
+    }
+  }
+} /* TrunkLink::sendLocalTalkers */
+
+
+void TrunkLink::disconnect(void)
+{
+  FramedTcpConnection *con = m_con;
+  if (con == 0)
+  {
+    return;
+  }
+  if (con == m_client)
+  {
+    m_client->disconnect();
+    onDisconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+  }
+  else
+  {
+      // Emitting the signal make the trunk server delete the connection
+    con->disconnect();
+    con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+  }
+} /* TrunkLink::disconnect */
+
+
+void TrunkLink::heartbeat(Async::Timer *t)
+{
+  if (m_state == STATE_DISCONNECTED)
+  {
+    return;
+  }
+
+  if (--m_heartbeat_tx_cnt == 0)
+  {
+    sendMsg(MsgHeartbeat());
+  }
+
+  if (--m_heartbeat_rx_cnt == 0)
+  {
+    cerr << "*** WARNING[" << m_section << "]: Trunk heartbeat timeout"
+         << endl;
+    disconnect();
+  }
+} /* TrunkLink::heartbeat */
+
+
+void TrunkLink::reconnect(Async::Timer *t)
+{
+  m_reconnect_timer.setEnable(false);
+  if ((m_client != 0) && !m_client->isConnected())
+  {
+    m_client->connect();
+  }
+} /* TrunkLink::reconnect */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,326 @@
+/**
+@file	 TrunkLink.h
+@brief   A trunk link to another reflector
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TRUNK_LINK_INCLUDED
+#define TRUNK_LINK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTcpClient.h>
+#include <AsyncFramedTcpConnection.h>
+#include <AsyncTimer.h>
+#include <AsyncIpAddress.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TrunkMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class Config;
+  class UdpSocket;
+};
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A trunk link to another reflector
+@author agent
+@date   2026-10-18
+
+A trunk link connect this reflector to another reflector so that talk groups
+span both of them. One object of this class is created for each configured
+trunk. If a host is configured for the trunk, the link will connect to the
+other reflector and keep reconnecting if the connection is lost. Otherwise
+the link wait for the other reflector to connect to the trunk port of this
+reflector. The reflector hand incoming connections over to the link with
+the matching peer name.
+
+When the link is up, the two reflectors exchange:
+
+  - The talk groups that have local listeners
+  - Talker start and stop for all talk groups
+  - Audio, over UDP, for talk groups that the other side has listeners on
+
+Talker arbitration is done using the remote talker support in TGHandler. If
+two reflectors get a talker on the same talk group at the same time, the
+talker on the reflector with the lowest name win. All reflectors must be
+connected to each other (full mesh) since nothing received on a trunk is
+forwarded to other trunks.
+*/
+class TrunkLink : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param 	cfg The configuration object
+     * @param 	section The configuration section for this trunk
+     * @param 	local_name The trunk name of this reflector
+     * @param   udp_sock The UDP socket used for trunk audio
+     * @param   udp_port The local port number of the UDP socket
+     */
+    TrunkLink(Async::Config& cfg, const std::string& section,
+              const std::string& local_name, Async::UdpSocket* udp_sock,
+              uint16_t udp_port);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~TrunkLink(void);
+
+    /**
+     * @brief 	Initialize the trunk link
+     * @return	Return \em true on success or else \em false
+     */
+    bool initialize(void);
+
+    /**
+     * @brief   Get the name of the configuration section
+     * @return  Returns the name of the configuration section
+     */
+    const std::string& section(void) const { return m_section; }
+
+    /**
+     * @brief   Get the trunk name of the reflector on the other side
+     * @return  Returns the name of the other reflector
+     */
+    const std::string& peerName(void) const { return m_peer_name; }
+
+    /**
+     * @brief   Check if the link is up
+     * @return  Returns \em true if the link is authenticated and up
+     */
+    bool isUp(void) const { return m_state == STATE_UP; }
+
+    /**
+     * @brief   Check if this side initiate the connection
+     * @return  Returns \em true if a host is configured for the trunk
+     */
+    bool isOutbound(void) const { return m_client != 0; }
+
+    /**
+     * @brief   Get the talk groups that the other side has listeners on
+     * @return  Returns a set of talk groups
+     */
+    const std::set<uint32_t>& peerTGs(void) const { return m_peer_tgs; }
+
+    /**
+     * @brief   Take over an incoming connection
+     * @param   con The connection
+     * @param   hello The hello message received on the connection
+     *
+     * This function is called by the reflector when a MsgTrunkHello with
+     * the peer name of this link has been received on the trunk port.
+     */
+    void acceptConnection(Async::FramedTcpConnection *con,
+                          const MsgTrunkHello& hello);
+
+    /**
+     * @brief   Check if a UDP datagram come from the other side
+     * @param   addr The source IP address
+     * @param   port The source UDP port
+     * @return  Returns \em true if the datagram is from the other side
+     */
+    bool isUdpPeer(const Async::IpAddress& addr, uint16_t port) const
+    {
+      return (m_state == STATE_UP) && (port == m_peer_udp_port) &&
+             (addr == m_peer_addr);
+    }
+
+    /**
+     * @brief   Handle a UDP datagram received from the other side
+     * @param   header The already unpacked message header
+     * @param   is The stream to unpack the message body from
+     */
+    void udpMsgReceived(const ReflectorUdpMsg& header, std::istream& is);
+
+    /**
+     * @brief   Tell the other side about the local talk groups
+     *
+     * The message is only sent if the set of talk groups has changed since
+     * the last time.
+     */
+    void updateInterest(void);
+
+    /**
+     * @brief   Tell the other side that a local talker has started
+     * @param   tg The talk group
+     * @param   callsign The callsign of the talker
+     */
+    void sendTalkerStart(uint32_t tg, const std::string& callsign);
+
+    /**
+     * @brief   Tell the other side that a local talker has stopped
+     * @param   tg The talk group
+     * @param   callsign The callsign of the talker
+     */
+    void sendTalkerStop(uint32_t tg, const std::string& callsign);
+
+    /**
+     * @brief   Send local audio to the other side
+     * @param   tg The talk group
+     * @param   audio The encoded audio
+     *
+     * The audio is only sent if the other side has listeners on the talk
+     * group.
+     */
+    void sendAudio(uint32_t tg, const std::vector<uint8_t>& audio);
+
+    /**
+     * @brief   A signal that is emitted when audio is received
+     * @param   tg The talk group
+     * @param   audio The encoded audio
+     *
+     * The signal is only emitted if the talker on the other side hold the
+     * talk group.
+     */
+    sigc::signal<void, uint32_t, const std::vector<uint8_t>&> audioReceived;
+
+  private:
+    typedef Async::TcpClient<Async::FramedTcpConnection> FramedTcpClient;
+
+    typedef enum
+    {
+      STATE_DISCONNECTED, STATE_EXPECT_HELLO, STATE_EXPECT_AUTH, STATE_UP
+    } ConState;
+
+    static const unsigned DEFAULT_PORT            = 5302;
+    static const unsigned HEARTBEAT_TX_CNT_RESET  = 10;
+    static const unsigned HEARTBEAT_RX_CNT_RESET  = 15;
+    static const unsigned RECONNECT_INTERVAL      = 5000;
+
+    Async::Config&                m_cfg;
+    std::string                   m_section;
+    std::string                   m_local_name;
+    Async::UdpSocket*             m_udp_sock;
+    uint16_t                      m_udp_port;
+    std::string                   m_peer_name;
+    std::string                   m_secret;
+    FramedTcpClient*              m_client;
+    Async::FramedTcpConnection*   m_con;
+    ConState                      m_state;
+    std::vector<uint8_t>          m_nonce;
+    Async::IpAddress              m_peer_addr;
+    uint16_t                      m_peer_udp_port;
+    std::set<uint32_t>            m_peer_tgs;
+    std::set<uint32_t>            m_sent_tgs;
+    bool                          m_interest_sent;
+    uint16_t                      m_udp_tx_seq;
+    uint16_t                      m_next_udp_rx_seq;
+    Async::Timer                  m_heartbeat_timer;
+    Async::Timer                  m_reconnect_timer;
+    unsigned                      m_heartbeat_tx_cnt;
+    unsigned                      m_heartbeat_rx_cnt;
+
+    TrunkLink(const TrunkLink&);
+    TrunkLink& operator=(const TrunkLink&);
+    void onConnected(void);
+    void onDisconnected(Async::FramedTcpConnection *con,
+                        Async::FramedTcpConnection::DisconnectReason reason);
+    void onFrameReceived(Async::FramedTcpConnection *con,
+                         std::vector<uint8_t>& data);
+    void handleMsgTrunkHello(std::istream& is);
+    void handleMsgTrunkAuth(std::istream& is);
+    void handleMsgTrunkTgInterest(std::istream& is);
+    void handleMsgTrunkTalkerStart(std::istream& is);
+    void handleMsgTrunkTalkerStop(std::istream& is);
+    void sendHello(void);
+    void sendMsg(const ReflectorMsg& msg);
+    void sendUdpMsg(const ReflectorUdpMsg& msg);
+    void sendLocalTalkers(void);
+    void disconnect(void);
+    void heartbeat(Async::Timer *t);
+    void reconnect(Async::Timer *t);
+
+};  /* class TrunkLink */
+
+
+#endif /* TRUNK_LINK_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,335 @@
+/**
+@file	 TrunkMsg.h
+@brief   Reflector trunk protocol message definitions
+@author  agent
+@date	 2026-10-18
+
+The trunk protocol is used between svxreflector instances. It use the same
+framing and message header as the client protocol but it is spoken on a
+separate port so the message types do not interfere with each other.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TRUNK_MSG_INCLUDED
+#define TRUNK_MSG_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <gcrypt.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <set>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	 Trunk hello TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is the first message sent by both sides of a trunk link. The
+side that initiated the connection send it directly after connecting and the
+other side answer with its own hello. The nonce is used by the other side to
+prove that it know the shared secret. The UDP port is the port that the
+sender expect to receive trunk audio on.
+*/
+class MsgTrunkHello : public ReflectorMsgBase<200>
+{
+  public:
+    static const uint16_t PROTO_VER = 1;
+    static const size_t   NONCE_LEN = 20;
+
+    MsgTrunkHello(void) : m_proto_ver(0), m_udp_port(0) {}
+    MsgTrunkHello(const std::string& name, uint16_t udp_port)
+      : m_proto_ver(PROTO_VER), m_name(name), m_nonce(NONCE_LEN),
+        m_udp_port(udp_port)
+    {
+      gcry_create_nonce(&m_nonce.front(), NONCE_LEN);
+    }
+
+    uint16_t protoVer(void) const { return m_proto_ver; }
+    const std::string& name(void) const { return m_name; }
+    const std::vector<uint8_t>& nonce(void) const { return m_nonce; }
+    uint16_t udpPort(void) const { return m_udp_port; }
+
+    ASYNC_MSG_MEMBERS(m_proto_ver, m_name, m_nonce, m_udp_port)
+
+  private:
+    uint16_t              m_proto_ver;
+    std::string           m_name;
+    std::vector<uint8_t>  m_nonce;
+    uint16_t              m_udp_port;
+}; /* MsgTrunkHello */
+
+
+/**
+@brief	 Trunk authentication TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is sent by both sides of a trunk link as an answer to the
+MsgTrunkHello message received from the other side. The digest is a HMAC,
+keyed with the shared secret, over the nonce received from the other side
+and the name of the sender.
+*/
+class MsgTrunkAuth : public ReflectorMsgBase<201>
+{
+  public:
+    static const int      ALGO        = GCRY_MD_SHA1;
+    static const size_t   DIGEST_LEN  = 20;
+
+    MsgTrunkAuth(void) {}
+
+    /**
+     * @brief   Constructor
+     * @param   secret The secret shared by both sides of the trunk
+     * @param   nonce The nonce received from the other side
+     * @param   name The name of the sending reflector
+     */
+    MsgTrunkAuth(const std::string& secret, const std::vector<uint8_t>& nonce,
+                 const std::string& name)
+      : m_digest(DIGEST_LEN)
+    {
+      if (!calcDigest(&m_digest.front(), secret, nonce, name))
+      {
+        m_digest.clear();
+      }
+    }
+
+    /**
+     * @brief   Verify the digest
+     * @param   secret The secret shared by both sides of the trunk
+     * @param   nonce The nonce previously sent to the other side
+     * @param   name The name of the other side
+     * @return  Returns \em true if the digest is correct
+     */
+    bool verify(const std::string& secret, const std::vector<uint8_t>& nonce,
+                const std::string& name) const
+    {
+      unsigned char digest[DIGEST_LEN];
+      bool ok = calcDigest(digest, secret, nonce, name);
+      return ok && (m_digest.size() == DIGEST_LEN) &&
+             (memcmp(&m_digest.front(), digest, DIGEST_LEN) == 0);
+    }
+
+    ASYNC_MSG_MEMBERS(m_digest)
+
+  private:
+    std::vector<uint8_t>  m_digest;
+
+    bool calcDigest(unsigned char *digest, const std::string& secret,
+                    const std::vector<uint8_t>& nonce,
+                    const std::string& name) const
+    {
+      unsigned char *digest_ptr = 0;
+      gcry_md_hd_t hd = { 0 };
+      gcry_error_t err = gcry_md_open(&hd, ALGO, GCRY_MD_FLAG_HMAC);
+      if (err) goto error;
+      err = gcry_md_setkey(hd, secret.c_str(), secret.size());
+      if (err) goto error;
+      gcry_md_write(hd, nonce.data(), nonce.size());
+      gcry_md_write(hd, name.data(), name.size());
+      digest_ptr = gcry_md_read(hd, 0);
+      memcpy(digest, digest_ptr, DIGEST_LEN);
+      gcry_md_close(hd);
+      return true;
+
+      error:
+        gcry_md_close(hd);
+        std::cerr << "*** ERROR: gcrypt error: "
+                  << gcry_strsource(err) << "/" << gcry_strerror(err)
+                  << std::endl;
+        return false;
+    }
+}; /* MsgTrunkAuth */
+
+
+/**
+@brief	 Trunk TG interest TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is sent by a reflector to tell the other side of the trunk which
+talk groups that have local listeners. Audio for a talk group is only sent
+over the trunk if the other side has listeners on it. The message is sent
+when the link comes up and then each time the set of talk groups change.
+*/
+class MsgTrunkTgInterest : public ReflectorMsgBase<202>
+{
+  public:
+    MsgTrunkTgInterest(void) {}
+    MsgTrunkTgInterest(const std::set<uint32_t>& tgs) : m_tgs(tgs) {}
+
+    const std::set<uint32_t>& tgs(void) const { return m_tgs; }
+
+    ASYNC_MSG_MEMBERS(m_tgs)
+
+  private:
+    std::set<uint32_t> m_tgs;
+}; /* MsgTrunkTgInterest */
+
+
+/**
+@brief	 Trunk talker start TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is sent when a local client start talking on a talk group. It
+is sent to all trunks, not only the ones with listeners on the talk group,
+so that all reflectors agree on who hold the talk group.
+*/
+class MsgTrunkTalkerStart : public ReflectorMsgBase<203>
+{
+  public:
+    MsgTrunkTalkerStart(void) : m_tg(0) {}
+    MsgTrunkTalkerStart(uint32_t tg, const std::string& callsign)
+      : m_tg(tg), m_callsign(callsign) {}
+
+    uint32_t tg(void) const { return m_tg; }
+    const std::string& callsign(void) const { return m_callsign; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_callsign)
+
+  private:
+    uint32_t    m_tg;
+    std::string m_callsign;
+}; /* MsgTrunkTalkerStart */
+
+
+/**
+@brief	 Trunk talker stop TCP network message
+@author  agent
+@date    2026-10-18
+
+This message is sent when a local talker stop talking on a talk group.
+*/
+class MsgTrunkTalkerStop : public ReflectorMsgBase<204>
+{
+  public:
+    MsgTrunkTalkerStop(void) : m_tg(0) {}
+    MsgTrunkTalkerStop(uint32_t tg, const std::string& callsign)
+      : m_tg(tg), m_callsign(callsign) {}
+
+    uint32_t tg(void) const { return m_tg; }
+    const std::string& callsign(void) const { return m_callsign; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_callsign)
+
+  private:
+    uint32_t    m_tg;
+    std::string m_callsign;
+}; /* MsgTrunkTalkerStop */
+
+
+/**
+@brief   Trunk audio UDP network message
+@author  agent
+@date    2026-10-18
+
+This message is used to transmit encoded audio for a talk group over a trunk.
+The audio is passed on as is so no transcoding is done in the reflectors.
+*/
+class MsgTrunkUdpAudio : public ReflectorUdpMsgBase<200>
+{
+  public:
+    MsgTrunkUdpAudio(void) : m_tg(0) {}
+    MsgTrunkUdpAudio(uint32_t tg, const std::vector<uint8_t>& audio_data)
+      : m_tg(tg), m_audio_data(audio_data) {}
+
+    uint32_t tg(void) const { return m_tg; }
+    const std::vector<uint8_t>& audioData(void) const { return m_audio_data; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_audio_data)
+
+  private:
+    uint32_t              m_tg;
+    std::vector<uint8_t>  m_audio_data;
+}; /* MsgTrunkUdpAudio */
+
+
+#endif /* TRUNK_MSG_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
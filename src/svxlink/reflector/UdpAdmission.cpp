@@ -0,0 +1,231 @@
+/**
+@file   UdpAdmission.cpp
+@brief  Admission control for incoming reflector UDP traffic
+@author agent
+@date   2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "UdpAdmission.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+const char* UdpAdmission::reasonName(Reason reason)
+{
+  switch (reason)
+  {
+    case REJECT_SHORT:          return "short";
+    case REJECT_SOURCE_RATE:    return "sourceRate";
+    case REJECT_UNKNOWN_CLIENT: return "unknownClient";
+    case REJECT_WRONG_HOST:     return "wrongHost";
+    case REJECT_WRONG_PORT:     return "wrongPort";
+    case REJECT_CLIENT_RATE:    return "clientRate";
+    case REJECT_OUT_OF_SEQ:     return "outOfSequence";
+    case REJECT_FRAMES_LOST:    return "framesLost";
+    case REJECT_REASON_CNT:     break;
+  }
+  return "?";
+} /* UdpAdmission::reasonName */
+
+
+UdpAdmission::UdpAdmission(void)
+  : m_client_rate(0), m_source_rate(0)
+{
+} /* UdpAdmission::UdpAdmission */
+
+
+UdpAdmission::~UdpAdmission(void)
+{
+} /* UdpAdmission::~UdpAdmission */
+
+
+bool UdpAdmission::admitSource(const IpAddress& addr)
+{
+  if (m_source_rate == 0)
+  {
+    return true;
+  }
+  Clock::time_point now = Clock::now();
+  pruneIdle(now);
+  TokenBucket& bucket = m_sources[addr.ip4Addr().s_addr];
+  return bucket.take(now, m_source_rate, m_source_rate);
+} /* UdpAdmission::admitSource */
+
+
+bool UdpAdmission::admitClient(ReflectorUdpMsg::ClientId client_id)
+{
+  if (m_client_rate == 0)
+  {
+    return true;
+  }
+  Clock::time_point now = Clock::now();
+  pruneIdle(now);
+  TokenBucket& bucket = m_clients[client_id];
+  return bucket.take(now, m_client_rate, m_client_rate);
+} /* UdpAdmission::admitClient */
+
+
+bool UdpAdmission::reject(Reason reason, unsigned long& suppressed)
+{
+  RejectStat& stat = m_reject[reason];
+  stat.cnt += 1;
+  Clock::time_point now = Clock::now();
+  if ((stat.last_log != Clock::time_point()) &&
+      (now - stat.last_log < std::chrono::seconds(LOG_INTERVAL)))
+  {
+    stat.suppressed += 1;
+    return false;
+  }
+  stat.last_log = now;
+  suppressed = stat.suppressed;
+  stat.suppressed = 0;
+  return true;
+} /* UdpAdmission::reject */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+template <class Map>
+void UdpAdmission::pruneIdle(Map& map, Clock::time_point now)
+{
+  for (auto it = map.begin(); it != map.end(); )
+  {
+    if (now - it->second.lastUsed() > std::chrono::seconds(IDLE_TIMEOUT))
+    {
+      it = map.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* UdpAdmission::pruneIdle */
+
+
+void UdpAdmission::pruneIdle(Clock::time_point now)
+{
+  if (now - m_last_prune < std::chrono::seconds(IDLE_TIMEOUT))
+  {
+    return;
+  }
+  m_last_prune = now;
+  pruneIdle(m_sources, now);
+  pruneIdle(m_clients, now);
+} /* UdpAdmission::pruneIdle */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,297 @@
+/**
+@file   UdpAdmission.h
+@brief  Admission control for incoming reflector UDP traffic
+@author agent
+@date   2026-10-18
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef UDP_ADMISSION_INCLUDED
+#define UDP_ADMISSION_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncIpAddress.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A token bucket rate limiter
+@author agent
+@date   2026-10-18
+
+The bucket is filled with tokens at a constant rate up to a maximum, the
+burst size. Each admitted packet takes one token. The rate and burst size is
+given on each call so that a configuration change apply to all existing
+buckets at once. A new bucket starts out full.
+*/
+class TokenBucket
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief   Try to take a token from the bucket
+     * @param   now The current time
+     * @param   rate The fill rate in tokens per second
+     * @param   burst The maximum number of tokens in the bucket
+     * @return  Returns \em true if a token was available
+     */
+    bool take(Clock::time_point now, double rate, double burst)
+    {
+      if (m_last == Clock::time_point())
+      {
+        m_tokens = burst;
+      }
+      else
+      {
+        std::chrono::duration<double> elapsed = now - m_last;
+        m_tokens = std::min(burst, m_tokens + elapsed.count() * rate);
+      }
+      m_last = now;
+      if (m_tokens < 1.0)
+      {
+        return false;
+      }
+      m_tokens -= 1.0;
+      return true;
+    }
+
+    /**
+     * @brief   Get the time when the bucket was last used
+     * @return  Returns the time of the last call to take
+     */
+    Clock::time_point lastUsed(void) const { return m_last; }
+
+  private:
+    double            m_tokens  = 0.0;
+    Clock::time_point m_last;
+
+};  /* class TokenBucket */
+
+
+/**
+@brief  Admission control for incoming reflector UDP traffic
+@author agent
+@date   2026-10-18
+
+This class is used by the reflector to sort out unwanted UDP traffic as
+cheaply as possible, before a datagram is unpacked. Each source IP address
+and each client is rate limited using a token bucket. Buckets that have not
+been used for a while are removed.
+
+All rejected datagrams are counted per reason. Logging of rejected datagrams
+is rate limited so that a flood of bad traffic cannot keep the reflector busy
+writing log messages. At most one message per reason is logged per log
+interval. The number of suppressed messages is reported with the next message
+that is logged. The same log rate limiting is used for accepted datagrams that
+reveal that earlier datagrams were lost, since a client can cause those at
+will by skipping sequence numbers.
+*/
+class UdpAdmission
+{
+  public:
+    using Clock = TokenBucket::Clock;
+
+    /**
+     * @brief   The reasons for rejecting a datagram
+     */
+    enum Reason
+    {
+      REJECT_SHORT,           ///< Too short to contain a header
+      REJECT_SOURCE_RATE,     ///< The source IP rate limit was exceeded
+      REJECT_UNKNOWN_CLIENT,  ///< No client with the given client id
+      REJECT_WRONG_HOST,      ///< Not from the IP address of the client
+      REJECT_WRONG_PORT,      ///< Not from the UDP port of the client
+      REJECT_CLIENT_RATE,     ///< The client rate limit was exceeded
+      REJECT_OUT_OF_SEQ,      ///< The sequence number is out of sequence
+      REJECT_FRAMES_LOST,     ///< Accepted, but frames before it were lost
+      REJECT_REASON_CNT
+    };
+
+    /**
+     * @brief   Get a short name for a reject reason
+     * @param   reason The reject reason
+     * @return  Returns a name suitable for use in status reports
+     */
+    static const char* reasonName(Reason reason);
+
+    /**
+     * @brief   Default constructor
+     */
+    UdpAdmission(void);
+
+    /**
+     * @brief   Destructor
+     */
+    ~UdpAdmission(void);
+
+    /**
+     * @brief   Set the rate limit for each client
+     * @param   pps The maximum number of packets per second (0=unlimited)
+     *
+     * The burst size is set to one seconds worth of packets.
+     */
+    void setClientRateLimit(unsigned pps) { m_client_rate = pps; }
+
+    /**
+     * @brief   Set the rate limit for each source IP address
+     * @param   pps The maximum number of packets per second (0=unlimited)
+     *
+     * The burst size is set to one seconds worth of packets.
+     */
+    void setSourceRateLimit(unsigned pps) { m_source_rate = pps; }
+
+    /**
+     * @brief   Check the rate limit for a source IP address
+     * @param   addr The source address of the datagram
+     * @return  Returns \em true if the datagram should be accepted
+     *
+     * A bucket is created for each new address so this function must only
+     * be called for addresses that belong to a connected client. Otherwise
+     * a flood of datagrams from spoofed addresses would grow the table
+     * without limit.
+     */
+    bool admitSource(const Async::IpAddress& addr);
+
+    /**
+     * @brief   Check the rate limit for a client
+     * @param   client_id The client id given in the datagram header
+     * @return  Returns \em true if the datagram should be accepted
+     */
+    bool admitClient(ReflectorUdpMsg::ClientId client_id);
+
+    /**
+     * @brief   Count a rejected datagram
+     * @param   reason The reason for rejecting the datagram
+     * @param   suppressed Set to the number of suppressed log messages
+     * @return  Returns \em true if the caller should log the event
+     */
+    bool reject(Reason reason, unsigned long& suppressed);
+
+    /**
+     * @brief   Get the total number of rejected datagrams for a reason
+     * @param   reason The reject reason
+     * @return  Returns the number of datagrams rejected for that reason
+     */
+    unsigned long rejectCount(Reason reason) const
+    {
+      return m_reject[reason].cnt;
+    }
+
+  private:
+    struct RejectStat
+    {
+      unsigned long     cnt         = 0;
+      unsigned long     suppressed  = 0;
+      Clock::time_point last_log;
+    };
+    using SourceMap = std::unordered_map<uint32_t, TokenBucket>;
+    using ClientMap = std::unordered_map<ReflectorUdpMsg::ClientId,
+                                         TokenBucket>;
+
+    static const unsigned LOG_INTERVAL  = 10;   // Seconds
+    static const unsigned IDLE_TIMEOUT  = 60;   // Seconds
+
+    unsigned          m_client_rate;
+    unsigned          m_source_rate;
+    SourceMap         m_sources;
+    ClientMap         m_clients;
+    RejectStat        m_reject[REJECT_REASON_CNT];
+    Clock::time_point m_last_prune;
+
+    UdpAdmission(const UdpAdmission&);
+    UdpAdmission& operator=(const UdpAdmission&);
+    template <class Map> void pruneIdle(Map& map, Clock::time_point now);
+    void pruneIdle(Clock::time_point now);
+
+};  /* class UdpAdmission */
+
+
+#endif /* UDP_ADMISSION_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,168 @@
+/**
+@file	 reflector_msg_test.cpp
+@brief   Tests for the reflector protocol messages
+@author  agent
+@date	 2026-10-18
+
+Check that reflector protocol messages that are sent before login fit in the
+frame size limit that both the reflector and the client enforce before login.
+The program exit with a non-zero status if a check fails.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static int errors = 0;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static void check(bool ok, const string& what)
+{
+  cout << (ok ? "PASS: " : "FAIL: ") << what << endl;
+  if (!ok)
+  {
+    ++errors;
+  }
+} /* check */
+
+
+  /*
+   * Pack a message in the same way as ReflectorLogic::sendMsg does and
+   * return the size of the frame payload
+   */
+static size_t packedFrameSize(const ReflectorMsg& msg)
+{
+  ostringstream ss;
+  ReflectorMsg header(msg.type());
+  if (!header.pack(ss) || !msg.pack(ss))
+  {
+    return 0;
+  }
+  return ss.str().size();
+} /* packedFrameSize */
+
+
+static void testSessionResume(const string& callsign, bool expect_fit)
+{
+  const string key = "A very secret key";
+  vector<uint8_t> token(MsgSessionToken::TOKEN_LEN);
+  for (size_t i=0; i<token.size(); ++i)
+  {
+    token[i] = 0xa0 + i;
+  }
+  MsgSessionResume msg(callsign, key, token);
+  const size_t size = packedFrameSize(msg);
+
+  ostringstream what;
+  what << "MsgSessionResume for \"" << callsign << "\" is " << size
+       << " bytes (limit " << ReflectorMsg::MAX_PREAUTH_FRAME_SIZE << ")";
+  check((size > 0) &&
+        ((size <= ReflectorMsg::MAX_PREAUTH_FRAME_SIZE) == expect_fit) &&
+        (msg.fitsPreAuthFrame() == expect_fit), what.str());
+
+  stringstream ss;
+  ReflectorMsg header(msg.type());
+  MsgSessionResume rx_msg;
+  check(header.pack(ss) && msg.pack(ss) && header.unpack(ss) &&
+        (header.type() == MsgSessionResume::TYPE) && rx_msg.unpack(ss) &&
+        (rx_msg.callsign() == callsign) && (rx_msg.token() == token) &&
+        rx_msg.verify(key) && !rx_msg.verify(key + "x"),
+        "MsgSessionResume for \"" + callsign + "\" unpack and verify");
+} /* testSessionResume */
+
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  if (!gcry_check_version(NULL))
+  {
+    cerr << "*** ERROR: Failed to initialize the Libgcrypt library\n";
+    exit(1);
+  }
+  gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0);
+
+  testSessionResume("SM0SVX", true);
+  testSessionResume("SM0SVX-L", true);
+  testSessionResume("SK3BR-RPT/P", true);
+  testSessionResume(string(21, 'X'), true);
+  testSessionResume(string(22, 'X'), false);
+
+  if (errors > 0)
+  {
+    cout << errors << " check(s) failed" << endl;
+    exit(1);
+  }
+  return 0;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
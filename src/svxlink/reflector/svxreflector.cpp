@@ -64,6 +64,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncCppApplication.h>
 #include <AsyncFdWatch.h>
+#include <AsyncTrace.h>
 #include <AsyncConfig.h>
 #include <config.h>
 
@@ -410,6 +411,8 @@ int main(int argc, const char *argv[])
   }
 
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
+  app.loopMonitor()->configure(cfg, "GLOBAL");
+  Trace::configure(cfg, "GLOBAL");
 
   cout << PROGRAM_NAME " v" SVXREFLECTOR_VERSION
           " Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX\n\n";
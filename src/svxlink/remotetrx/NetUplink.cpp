@@ -90,6 +90,43 @@ using namespace NetTrxMsg;
  *
  ****************************************************************************/
 
+/**
+ * Keep track of the sample clock time (@see Rx::sampleClock) of the audio
+ * coming from the receiver. The clock is advanced by the number of samples
+ * received so that the timestamps are as smooth as the audio itself. It is
+ * anchored to the realtime clock when the audio starts after a pause and
+ * whenever the sound card clock has drifted too far away from it.
+ */
+class RxSampleClock : public Async::AudioSink
+{
+  public:
+    RxSampleClock(void) : m_ts(0) {}
+
+    uint64_t timestamp(void) const { return m_ts; }
+
+    virtual int writeSamples(const float *samples, int count)
+    {
+      const uint64_t now = Rx::sampleClock();
+      m_ts += count;
+      if ((m_ts > now + MAX_DRIFT) || (m_ts + MAX_DRIFT < now))
+      {
+        m_ts = now;
+      }
+      return count;
+    }
+
+    virtual void flushSamples(void)
+    {
+      sourceAllSamplesFlushed();
+    }
+
+  private:
+    static const uint64_t MAX_DRIFT = INTERNAL_SAMPLE_RATE / 20;
+
+    uint64_t m_ts;
+
+};  /* class RxSampleClock */
+
 
 
 /****************************************************************************
@@ -128,8 +165,9 @@ NetUplink::NetUplink(Config &cfg, const string &name, Rx *rx, Tx *tx,
   : server(0), con(0), recv_cnt(0), recv_exp(0), rx(rx), tx(tx), fifo(0),
     cfg(cfg), name(name), last_msg_timestamp(), heartbeat_timer(0),
     audio_enc(0), audio_dec(0), loopback_con(0), rx_splitter(0),
-    tx_selector(0), state(STATE_DISC), mute_tx_timer(0), tx_muted(false),
-    fallback_enabled(false), tx_ctrl_mode(Tx::TX_OFF)
+    rx_clock(0), timestamps_enabled(false), tx_selector(0),
+    state(STATE_DISC), mute_tx_timer(0),
+    tx_muted(false), fallback_enabled(false), tx_ctrl_mode(Tx::TX_OFF)
 {
   heartbeat_timer = new Timer(10000);
   heartbeat_timer->setEnable(false);
@@ -151,6 +189,7 @@ NetUplink::~NetUplink(void)
   delete fifo;
   delete tx_selector;
   delete rx_splitter;
+  delete rx_clock;
   delete loopback_con;
   delete server;
   delete heartbeat_timer;
@@ -227,6 +266,11 @@ bool NetUplink::initialize(void)
   
   rx_splitter->addSink(loopback_con);
 
+    // The clock must be added before the audio encoder so that it has been
+    // updated when the encoder write the encoded samples
+  rx_clock = new RxSampleClock;
+  rx_splitter->addSink(rx_clock);
+
   tx_selector = new AudioSelector;
   tx_selector->addSource(loopback_con);
 
@@ -294,6 +338,7 @@ void NetUplink::handleIncomingConnection(TcpConnection *incoming_con)
   recv_cnt = 0;
   heartbeat_timer->setEnable(true);
   gettimeofday(&last_msg_timestamp, NULL);
+  timestamps_enabled = false;
   
   setState(STATE_CON_SETUP);
 
@@ -304,6 +349,7 @@ void NetUplink::handleIncomingConnection(TcpConnection *incoming_con)
   {
     MsgAuthOk *auth_msg = new MsgAuthOk;
     sendMsg(auth_msg);
+    sendMsg(new MsgTimestampsAvailable);
     setState(STATE_READY);
   }
   else
@@ -485,6 +531,7 @@ void NetUplink::handleMsg(Msg *msg)
         {
           MsgAuthOk *ok_msg = new MsgAuthOk;
           sendMsg(ok_msg);
+          sendMsg(new MsgTimestampsAvailable);
         }
         setState(STATE_READY);
       }
@@ -514,6 +561,13 @@ void NetUplink::handleMsg(Msg *msg)
       break;
     }
     
+    case MsgEnableTimestamps::TYPE:
+    {
+      cout << rx->name() << ": EnableTimestamps\n";
+      timestamps_enabled = true;
+      break;
+    }
+    
     case MsgSetRxFq::TYPE:
     {
       MsgSetRxFq *fq_msg = reinterpret_cast<MsgSetRxFq*>(msg);
@@ -780,6 +834,10 @@ void NetUplink::writeEncodedSamples(const void *buf, int size)
   {
     const int bufsize = MsgAudio::BUFSIZE;
     int len = min(size, bufsize);
+    if (timestamps_enabled)
+    {
+      sendMsg(new MsgTimestamp(rx_clock->timestamp()));
+    }
     MsgAudio *msg = new MsgAudio(ptr, len);
     sendMsg(msg);
     size -= len;
@@ -869,6 +927,10 @@ void NetUplink::setFallbackActive(bool activate)
 
 void NetUplink::signalLevelUpdated(float siglev)
 {
+  if (timestamps_enabled)
+  {
+    sendMsg(new MsgTimestamp(Rx::sampleClock()));
+  }
   MsgSiglevUpdate *msg = new MsgSiglevUpdate(rx->signalStrength(),
 					     rx->sqlRxId());
   sendMsg(msg);  
@@ -100,6 +100,7 @@ namespace NetTrxMsg
  *
  ****************************************************************************/
 
+class RxSampleClock;
 
 
 /****************************************************************************
@@ -181,6 +182,8 @@ class NetUplink : public Uplink
     Async::AudioDecoder     *audio_dec;
     Async::AudioPassthrough *loopback_con;
     Async::AudioSplitter    *rx_splitter;
+    RxSampleClock           *rx_clock;
+    bool                    timestamps_enabled;
     Async::AudioSelector    *tx_selector;
     State                   state;
     std::string             auth_key;
@@ -65,6 +65,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncCppApplication.h>
 #include <AsyncConfig.h>
 #include <AsyncFdWatch.h>
+#include <AsyncLoopMonitor.h>
+#include <AsyncMetricsHttpServer.h>
 #include <AsyncAudioIO.h>
 #include <Rx.h>
 #include <Tx.h>
@@ -472,6 +474,7 @@ int main(int argc, char **argv)
   }
   
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
+  app.loopMonitor()->configure(cfg, "GLOBAL");
   
   cout << PROGRAM_NAME " v" REMOTE_TRX_VERSION
           " Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX\n\n";
@@ -559,7 +562,9 @@ int main(int argc, char **argv)
   
   if (!trx_handlers.empty())
   {
+    MetricsHttpServer *metrics_srv = MetricsHttpServer::create(cfg, "GLOBAL");
     app.exec();
+    delete metrics_srv;
   }
   else
   {
@@ -25,55 +25,6 @@ variable fq;
 # The amplitude of the CW audio
 variable amplitude;
 
-# Morse code table
-array set letters {
-  "A" ".-"
-  "B" "-..."
-  "C" "-.-."
-  "D" "-.."
-  "E" "."
-  "F" "..-."
-  "G" "--."
-  "H" "...."
-  "I" ".."
-  "J" ".---"
-  "K" "-.-"
-  "L" ".-.."
-  "M" "--"
-  "N" "-."  
-  "O" "---"
-  "P" ".--."
-  "Q" "--.-"
-  "R" ".-."
-  "S" "..."
-  "T" "-"
-  "U" "..-"
-  "V" "...-"
-  "W" ".--"
-  "X" "-..-"
-  "Y" "-.--"
-  "Z" "--.."
-  
-  "0" "-----"
-  "1" ".----"
-  "2" "..---"
-  "3" "...--"
-  "4" "....-"
-  "5" "....."
-  "6" "-...."
-  "7" "--..."
-  "8" "---.."
-  "9" "----."
-  
-  "." ".-.-.-"
-  "," "--..--"
-  "?" "..--.."
-  "/" "-..-."
-  "=" "-...-"
-
-  " " " "
-}
-
 
 # Private function
 proc calculateTimings {} {
@@ -169,13 +120,8 @@ proc loadDefaults {} {
 #
 proc play {txt {cpm 0} {pitch 0} {amp -1000000}} {
   variable short_len;
-  variable long_len;
-  variable char_spacing;
-  variable letter_spacing;
-  variable word_spacing;
   variable fq;
   variable amplitude;
-  variable letters;
 
   set load_defaults 0
   if {$cpm > 0} {
@@ -191,28 +137,9 @@ proc play {txt {cpm 0} {pitch 0} {amp -1000000}} {
     set load_defaults 1
   }
 
-  set txt [string toupper $txt];
-  set first_letter 1;
-  foreach letter [split $txt ""] {
-    if {!$first_letter} {
-      playSilence $letter_spacing;
-    }
-    set first_letter 0;
-    set first_char 1;
-    foreach char [split $letters($letter) ""] {
-      if {!$first_char} {
-      	playSilence $char_spacing;
-      }
-      set first_char 0;
-      if {$char == "."} {
-      	playTone $fq $amplitude $short_len;
-      } elseif {$char == "-"} {
-      	playTone $fq $amplitude $long_len;  
-      } elseif {$char == " "} {
-      	playSilence $word_spacing;
-      }
-    }
-  }
+  # The whole message is rendered and queued as one unit by the native
+  # playCw command, using the same timing as calculateTimings.
+  playCw $txt $short_len $fq $amplitude
 
   if {$load_defaults} {
     loadDefaults
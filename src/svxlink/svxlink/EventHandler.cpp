@@ -33,9 +33,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <iostream>
+#include <iomanip>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <chrono>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -55,6 +59,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "EventHandler.h"
+#include "ToneSynth.h"
 #include "Module.h"
 
 
@@ -148,6 +153,7 @@ EventHandler::EventHandler(const string& event_script, const string& logic_name)
   Tcl_CreateCommand(interp, "publishStateEvent", publishStateEventHandler,
                     this, NULL);
   Tcl_CreateCommand(interp, "playDtmf", playDtmfHandler, this, NULL);
+  Tcl_CreateCommand(interp, "playCw", playCwHandler, this, NULL);
   Tcl_CreateCommand(interp, "injectDtmf", injectDtmfHandler, this, NULL);
   Tcl_CreateCommand(interp, "setConfigValue", setConfigValueHandler,
                     this, NULL);
@@ -159,6 +165,14 @@ EventHandler::EventHandler(const string& event_script, const string& logic_name)
 
 EventHandler::~EventHandler(void)
 {
+  for (auto& item : events)
+  {
+    if (item.second.cmd != nullptr)
+    {
+      Tcl_DecrRefCount(item.second.cmd);
+    }
+  }
+  events.clear();
   if (interp != 0)
   {
     Tcl_Preserve(interp);
@@ -178,6 +192,7 @@ bool EventHandler::initialize(void)
     return false;
   }
   
+  invalidateEventCache();
   if (Tcl_EvalFile(interp, event_script.c_str()) != TCL_OK)
   {
     cerr << event_script << " in logic " << logic_name << ": "
@@ -225,22 +240,107 @@ bool EventHandler::processEvent(const string& event)
     return false;
   }
   
+  string::size_type name_end = event.find_first_of(" \t");
+  string name(event, 0, name_end);
+  EventInfo& info = events[name];
+  if (!info.probed)
+  {
+    Tcl_CmdInfo cmd_info;
+    info.probed = true;
+    info.exists = (Tcl_GetCommandInfo(interp, name.c_str(), &cmd_info) != 0);
+    if (!info.exists)
+    {
+      cerr << "*** ERROR: Unable to handle event: " << event
+           << " in logic " << logic_name << " (invalid command name \""
+           << name << "\")" << endl;
+      return false;
+    }
+  }
+  if (!info.exists)
+  {
+    return false;
+  }
+
+    // Commands that are not namespace qualified events, like "namespace eval"
+    // or "source", may define new event handlers
+  if (name.find("::") == string::npos)
+  {
+    invalidateEventCache();
+  }
+
   bool success = true;
   Tcl_Preserve(interp);
-  if (Tcl_Eval(interp, (event + ";").c_str()) != TCL_OK)
+  auto start = std::chrono::steady_clock::now();
+  if (evalEvent(info, event, name_end) != TCL_OK)
   {
     cerr << "*** ERROR: Unable to handle event: " << event
          << " in logic " << logic_name << " ("
          << Tcl_GetStringResult(interp) << ")" << endl;
     success = false;
   }
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
   Tcl_Release(interp);
-  
+
+  info.count += 1;
+  info.total_ms += elapsed.count();
+  info.max_ms = std::max(info.max_ms, elapsed.count());
+
   return success;
   
 } /* EventHandler::processEvent */
 
 
+void EventHandler::invalidateEventCache(void)
+{
+  for (auto& item : events)
+  {
+    item.second.probed = false;
+  }
+} /* EventHandler::invalidateEventCache */
+
+
+void EventHandler::printEventStats(std::ostream& os, bool reset)
+{
+  std::vector<std::pair<std::string, const EventInfo*>> sorted;
+  for (const auto& item : events)
+  {
+    if (item.second.count > 0)
+    {
+      sorted.push_back(std::make_pair(item.first, &item.second));
+    }
+  }
+  std::sort(sorted.begin(), sorted.end(),
+      [](const std::pair<std::string, const EventInfo*>& a,
+         const std::pair<std::string, const EventInfo*>& b)
+      {
+        return a.second->total_ms > b.second->total_ms;
+      });
+
+  os << logic_name << ": TCL event execution time "
+        "(event: count total_ms avg_ms max_ms)" << endl;
+  std::ios_base::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(3);
+  for (const auto& item : sorted)
+  {
+    const EventInfo& info = *item.second;
+    os << "  " << item.first << ": " << info.count << " " << info.total_ms
+       << " " << (info.total_ms / info.count) << " " << info.max_ms << endl;
+  }
+  os.flags(flags);
+
+  if (reset)
+  {
+    for (auto& item : events)
+    {
+      item.second.count = 0;
+      item.second.total_ms = 0.0;
+      item.second.max_ms = 0.0;
+    }
+  }
+} /* EventHandler::printEventStats */
+
+
 const string EventHandler::eventResult(void) const
 {
   if (interp == 0)
@@ -430,6 +530,44 @@ int EventHandler::playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
 } /* EventHandler::playDtmfHandler */
 
 
+int EventHandler::playCwHandler(ClientData cdata, Tcl_Interp *irp,
+                                int argc, const char *argv[])
+{
+  if(argc != 5)
+  {
+    static char msg[] = "Usage: playCw <text> <dot length ms> <fq> <amp>";
+    Tcl_SetResult(irp, msg, TCL_STATIC);
+    return TCL_ERROR;
+  }
+  EventHandler *self = static_cast<EventHandler *>(cdata);
+  int dot_len = atoi(argv[2]);
+  int fq = atoi(argv[3]);
+  int amp = atoi(argv[4]);
+  if (!self->playCw.empty())
+  {
+    self->playCw(argv[1], dot_len, fq, amp);
+    return TCL_OK;
+  }
+
+  ToneSynth::CwElements elems;
+  ToneSynth::cwEncode(argv[1], dot_len, elems);
+  ToneSynth::CwElements::const_iterator it;
+  for (it=elems.begin(); it!=elems.end(); ++it)
+  {
+    if (it->key_down)
+    {
+      self->playTone(fq, amp, it->length);
+    }
+    else
+    {
+      self->playSilence(it->length);
+    }
+  }
+
+  return TCL_OK;
+} /* EventHandler::playCwHandler */
+
+
 int EventHandler::injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                                     int argc, const char *argv[])
 {
@@ -469,11 +607,58 @@ int EventHandler::setConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
   //          << tag << "=" << value << std::endl;
   EventHandler *self = static_cast<EventHandler *>(cdata);
   self->setConfigValue(section, tag, value);
+  self->invalidateEventCache();
 
   return TCL_OK;
 } /* EventHandler::setConfigValueHandler */
 
 
+int EventHandler::evalEvent(EventInfo& info, const std::string& event,
+                            std::string::size_type args_pos)
+{
+  string args;
+  if (args_pos != string::npos)
+  {
+    args = event.substr(args_pos);
+  }
+
+    // Arguments that need substitution or that contain more than one command
+    // must be evaluated as a script
+  if (args.find_first_of("$[;\\\r\n") != string::npos)
+  {
+    return Tcl_Eval(interp, (event + ";").c_str());
+  }
+
+  if (info.cmd == nullptr)
+  {
+    info.cmd = Tcl_NewStringObj(event.c_str(),
+        (args_pos == string::npos) ? -1 : static_cast<int>(args_pos));
+    Tcl_IncrRefCount(info.cmd);
+  }
+
+  if (args.find_first_not_of(" \t") == string::npos)
+  {
+    return Tcl_EvalObjv(interp, 1, &info.cmd, 0);
+  }
+
+  Tcl_Obj *args_obj = Tcl_NewStringObj(args.c_str(), args.size());
+  Tcl_IncrRefCount(args_obj);
+  int args_objc = 0;
+  Tcl_Obj **args_objv = nullptr;
+  int ret = Tcl_ListObjGetElements(interp, args_obj, &args_objc, &args_objv);
+  if (ret == TCL_OK)
+  {
+    std::vector<Tcl_Obj*> objv;
+    objv.reserve(args_objc + 1);
+    objv.push_back(info.cmd);
+    objv.insert(objv.end(), args_objv, args_objv + args_objc);
+    ret = Tcl_EvalObjv(interp, objv.size(), objv.data(), 0);
+  }
+  Tcl_DecrRefCount(args_obj);
+  return ret;
+} /* EventHandler::evalEvent */
+
+
 int EventHandler::genericCommandHandler(ClientData cdata, Tcl_Interp *irp,
                                         int argc, const char *argv[])
 {
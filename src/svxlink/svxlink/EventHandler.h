@@ -40,6 +40,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <sstream>
 #include <functional>
+#include <unordered_map>
+#include <ostream>
 
 
 /****************************************************************************
@@ -178,8 +180,31 @@ class EventHandler : public sigc::trackable
      * @brief 	Process the given event
      * @param 	event The event must be a valid TCL function call
      * @return	Returns \em true on success or else \em false
+     *
+     * The first word of the event is the name of the TCL function to call.
+     * The function is looked up once and then called directly using a cached
+     * command object, without parsing the event as a script, as long as the
+     * arguments do not need substitution. Events for which there is no TCL
+     * function are reported once and are then skipped until the cache is
+     * invalidated.
      */
     bool processEvent(const std::string& event);
+
+    /**
+     * @brief   Forget which events that have no TCL function
+     *
+     * This function is called automatically when the script is loaded, when
+     * a configuration variable is set from TCL and when a command that is
+     * not a namespace qualified event, e.g. "namespace eval", is processed.
+     */
+    void invalidateEventCache(void);
+
+    /**
+     * @brief   Print the TCL execution time for each event
+     * @param   os The stream to print to
+     * @param   reset Set to \em true to clear the statistics afterwards
+     */
+    void printEventStats(std::ostream& os, bool reset=true);
   
     /**
      * @brief 	Return the event result from the last call
@@ -219,6 +244,19 @@ class EventHandler : public sigc::trackable
      */
     sigc::signal<void, const std::string&, int, int> playDtmf;
 
+    /**
+     * @brief 	A signal that is emitted when the TCL script want to play
+     *	      	back a CW message
+     * @param 	txt       The text to send
+     * @param 	dot_len   The length of a dot in milliseconds
+     * @param 	fq        The pitch of the CW tone
+     * @param 	amp   	  The amplitude of the CW tone (0-1000)
+     *
+     * If nothing is connected to this signal, the message is played using
+     * the playTone and playSilence signals instead.
+     */
+    sigc::signal<void, const std::string&, int, int, int> playCw;
+
     /**
      * @brief 	A signal that is emitted when the TCL script want to start
      *	      	a recording
@@ -269,9 +307,24 @@ class EventHandler : public sigc::trackable
   protected:
 
   private:
+    struct EventInfo
+    {
+      Tcl_Obj*      cmd         = nullptr;
+      bool          probed      = false;
+      bool          exists      = false;
+      unsigned long count       = 0;
+      double        total_ms    = 0.0;
+      double        max_ms      = 0.0;
+    };
+    typedef std::unordered_map<std::string, EventInfo> EventMap;
+
     std::string   event_script;
     std::string   logic_name;
     Tcl_Interp *  interp;
+    EventMap      events;
+
+    int evalEvent(EventInfo& info, const std::string& event,
+                  std::string::size_type args_pos);
 
     static int playFileHandler(ClientData cdata, Tcl_Interp *irp,
       	      	    int argc, const char *argv[]);
@@ -287,6 +340,8 @@ class EventHandler : public sigc::trackable
       	            int argc, const char *argv[]);
     static int playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
+    static int playCwHandler(ClientData cdata, Tcl_Interp *irp,
+                    int argc, const char *argv[]);
     static int injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
     static int setConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
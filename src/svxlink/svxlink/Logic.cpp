@@ -60,6 +60,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
+#include <AsyncApplication.h>
+#include <AsyncLoopMonitor.h>
+#include <AsyncTrace.h>
 #include <Rx.h>
 #include <Tx.h>
 #include <AsyncAudioPassthrough.h>
@@ -170,7 +173,8 @@ Logic::Logic(void)
     currently_set_tx_ctrl_mode(Tx::TX_OFF), is_online(true),
     dtmf_digit_handler(0),                  state_pty(0),
     dtmf_ctrl_pty(0),                       command_pty(0),
-    m_ctcss_to_tg_timer(-1),                m_ctcss_to_tg_last_fq(0.0f)
+    m_ctcss_to_tg_timer(-1),                m_ctcss_to_tg_last_fq(0.0f),
+    m_event_stats_interval(0),              m_event_stats_cnt(0)
 {
   rgr_sound_timer.expired.connect(sigc::hide(
         mem_fun(*this, &Logic::sendRgrSound)));
@@ -252,6 +256,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
     rgr_sound_timer.setTimeout(rgr_sound_delay);
   }
   cfg().getValue(name(), "REPORT_CTCSS", report_ctcss);
+  cfg().getValue(name(), "EVENT_STATS_INTERVAL", m_event_stats_interval);
 
   string state_pty_path;
   cfg().getValue(name(), "STATE_PTY", state_pty_path);
@@ -610,6 +615,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   event_handler->publishStateEvent.connect(
           mem_fun(*this, &Logic::onPublishStateEvent));
   event_handler->playDtmf.connect(mem_fun(*this, &Logic::playDtmf));
+  event_handler->playCw.connect(mem_fun(*this, &Logic::playCw));
   event_handler->injectDtmf.connect(mem_fun(*this, &Logic::injectDtmf));
   event_handler->setConfigValue.connect(
           sigc::mem_fun(cfg(), &Async::Config::setValue<std::string>));
@@ -794,10 +800,19 @@ void Logic::playTone(int fq, int amp, int len)
 
 void Logic::playDtmf(const std::string& digits, int amp, int len)
 {
-  for (string::size_type i=0; i < digits.size(); ++i)
+  if (report_events_as_idle)
+  {
+      // Only the silence between the digits is idle marked so the digits
+      // must be queued one by one
+    for (string::size_type i=0; i < digits.size(); ++i)
+    {
+      msg_handler->playDtmf(digits[i], amp, len);
+      msg_handler->playSilence(50, true);
+    }
+  }
+  else
   {
-    msg_handler->playDtmf(digits[i], amp, len);
-    msg_handler->playSilence(50, report_events_as_idle);
+    msg_handler->playDtmf(digits, amp, len, 50);
   }
 
   if (!msg_handler->isIdle())
@@ -809,6 +824,19 @@ void Logic::playDtmf(const std::string& digits, int amp, int len)
 } /* Logic::playDtmf */
 
 
+void Logic::playCw(const std::string& txt, int dot_len, int fq, int amp)
+{
+  msg_handler->playCw(txt, dot_len, fq, amp, report_events_as_idle);
+
+  if (!msg_handler->isIdle())
+  {
+    updateTxCtcss(true, TX_CTCSS_ANNOUNCEMENT);
+  }
+
+  checkIdle();
+} /* Logic::playCw */
+
+
 void Logic::recordStart(const string& filename, unsigned max_time)
 {
   recordStop();
@@ -1178,11 +1206,61 @@ void Logic::commandPtyCmdReceived(const void *buf, size_t count)
       processEvent(event);
     }
   }
+  else if (cmd == "LOOPSTATS")
+  {
+    std::string arg;
+    ss >> arg;
+    if ((!arg.empty() && (arg != "RESET")) || !(ss >> std::ws).eof())
+    {
+      std::cerr << "*** ERROR: Invalid PTY command in logic "
+                << name() << ": \"" << cmdline << "\". "
+                << "Usage: LOOPSTATS [RESET]"
+                << std::endl;
+      return;
+    }
+    Async::LoopMonitor *mon = Async::Application::app().loopMonitor();
+    if (mon == 0)
+    {
+      std::cerr << "*** WARNING: Loop monitoring not supported" << std::endl;
+      return;
+    }
+    mon->print(std::cout);
+    if (arg == "RESET")
+    {
+      mon->reset();
+    }
+  }
+  else if (cmd == "TRACE")
+  {
+    std::string subcmd, path;
+    double window_s = 0.0;
+    ss >> subcmd;
+    if ((subcmd == "ON") || (subcmd == "OFF"))
+    {
+      Async::Trace::setEnabled(subcmd == "ON");
+    }
+    else if (subcmd == "CLEAR")
+    {
+      Async::Trace::clear();
+    }
+    else if ((subcmd == "DUMP") && (ss >> path))
+    {
+      ss >> window_s;
+      Async::Trace::dumpToFile(path, window_s);
+    }
+    else
+    {
+      std::cerr << "*** ERROR: Invalid PTY command in logic "
+                << name() << ": \"" << cmdline << "\". "
+                << "Usage: TRACE ON|OFF|CLEAR|DUMP <file> [<seconds>]"
+                << std::endl;
+    }
+  }
   else
   {
     std::cerr << "*** ERROR: Unknown PTY command in logic "
               << name() << ": \"" << cmdline << "\". "
-              << "Valid commands are: CFG, EVENT"
+              << "Valid commands are: CFG, EVENT, LOOPSTATS, TRACE"
               << std::endl;
   }
 } /* Logic::commandPtyCmdReceived */
@@ -1659,6 +1737,13 @@ void Logic::everyMinute(AtTimer *t)
 {
   processEvent("every_minute");
   timeoutNextMinute();
+
+  if ((m_event_stats_interval > 0) &&
+      (++m_event_stats_cnt >= m_event_stats_interval))
+  {
+    m_event_stats_cnt = 0;
+    event_handler->printEventStats(cout);
+  }
 } /* Logic::everyMinute */
 
 
@@ -173,6 +173,7 @@ class Logic : public LogicBase
     virtual void playSilence(int length);
     virtual void playTone(int fq, int amp, int len);
     virtual void playDtmf(const std::string& digits, int amp, int len);
+    void playCw(const std::string& txt, int dot_len, int fq, int amp);
     void recordStart(const std::string& filename, unsigned max_time);
     void recordStop(void);
     void injectDtmf(const std::string& digits, int len);
@@ -297,6 +298,8 @@ class Logic : public LogicBase
     Async::Pty                      *command_pty;
     Async::Timer                    m_ctcss_to_tg_timer;
     float                           m_ctcss_to_tg_last_fq;
+    unsigned                        m_event_stats_interval;
+    unsigned                        m_event_stats_cnt;
 
     void loadModules(void);
     void loadModule(const std::string& module_name);
@@ -70,6 +70,7 @@ extern "C" {
  ****************************************************************************/
 
 #include "MsgHandler.h"
+#include "ToneSynth.h"
 
 
 
@@ -130,41 +131,17 @@ class SilenceQueueItem : public QueueItem
     
 };
 
-class ToneQueueItem : public QueueItem
+class SynthQueueItem : public QueueItem
 {
   public:
-    ToneQueueItem(int fq, int amp, int len, int sample_rate, bool idle_marked)
-      : QueueItem(idle_marked), fq(fq), amp(amp),
-      	tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
+    SynthQueueItem(ToneSynth::BufferPtr buf, bool idle_marked)
+      : QueueItem(idle_marked), buf(buf), pos(0) {}
     int readSamples(float *samples, int len);
     void unreadSamples(int len);
 
   private:
-    int fq;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
-    
-};
-
-class DtmfQueueItem : public QueueItem
-{
-  public:
-    DtmfQueueItem(int fqh, int fql, int amp, int len, int sample_rate,
-                  bool idle_marked)
-      : QueueItem(idle_marked), fqh(fqh), fql(fql), amp(amp),
-        tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
-    int readSamples(float *samples, int len);
-    void unreadSamples(int len);
-
-  private:
-    int fqh;
-    int fql;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
+    ToneSynth::BufferPtr  buf;
+    int                   pos;
 
 };
 
@@ -277,7 +254,8 @@ class WavFileQueueItem : public QueueItem
 
 MsgHandler::MsgHandler(int sample_rate)
   : sample_rate(sample_rate), nesting_level(0), pending_play_next(false),
-    current(0), is_writing_message(false), non_idle_cnt(0)
+    current(0), is_writing_message(false), non_idle_cnt(0),
+    synth(new ToneSynth(sample_rate))
 {
   
 }
@@ -286,6 +264,7 @@ MsgHandler::MsgHandler(int sample_rate)
 MsgHandler::~MsgHandler(void)
 {
   clearP();
+  delete synth;
 } /* MsgHandler::~MsgHandler */
 
 
@@ -318,44 +297,40 @@ void MsgHandler::playSilence(int length, bool idle_marked)
 
 void MsgHandler::playTone(int fq, int amp, int length, bool idle_marked)
 {
-  QueueItem *item = new ToneQueueItem(fq, amp, length, sample_rate,
-      	      	      	      	      idle_marked);
+  QueueItem *item = new SynthQueueItem(synth->renderTone(fq, amp, length),
+                                       idle_marked);
   addItemToQueue(item);
 } /* MsgHandler::playTone */
 
 
 void MsgHandler::playDtmf(char digit, int amp, int length, bool idle_marked)
 {
-  static map<char, pair<int, int> > tone_map;
-  tone_map['1'] = pair<int, int>(697, 1209);
-  tone_map['2'] = pair<int, int>(697, 1336);
-  tone_map['3'] = pair<int, int>(697, 1477);
-  tone_map['A'] = pair<int, int>(697, 1633);
-  tone_map['4'] = pair<int, int>(770, 1209);
-  tone_map['5'] = pair<int, int>(770, 1336);
-  tone_map['6'] = pair<int, int>(770, 1477);
-  tone_map['B'] = pair<int, int>(770, 1633);
-  tone_map['7'] = pair<int, int>(852, 1209);
-  tone_map['8'] = pair<int, int>(852, 1336);
-  tone_map['9'] = pair<int, int>(852, 1477);
-  tone_map['C'] = pair<int, int>(852, 1633);
-  tone_map['*'] = pair<int, int>(941, 1209);
-  tone_map['0'] = pair<int, int>(941, 1336);
-  tone_map['#'] = pair<int, int>(941, 1477);
-  tone_map['D'] = pair<int, int>(941, 1633);
-
-  int fql = tone_map[digit].first;
-  int fqh = tone_map[digit].second;
-
-  if (fql > 0)
+  playDtmf(string(1, digit), amp, length, 0, idle_marked);
+} /* MsgHandler::playDtmf */
+
+
+void MsgHandler::playDtmf(const string& digits, int amp, int length,
+                          int spacing, bool idle_marked)
+{
+  ToneSynth::BufferPtr buf = synth->renderDtmf(digits, amp, length, spacing);
+  if (!buf->empty())
   {
-    QueueItem *item = new DtmfQueueItem(fqh, fql, amp, length, sample_rate,
-                                        idle_marked);
-    addItemToQueue(item);
+    addItemToQueue(new SynthQueueItem(buf, idle_marked));
   }
 } /* MsgHandler::playDtmf */
 
 
+void MsgHandler::playCw(const string& txt, int dot_len, int fq, int amp,
+                        bool idle_marked)
+{
+  ToneSynth::BufferPtr buf = synth->renderCw(txt, dot_len, fq, amp);
+  if (!buf->empty())
+  {
+    addItemToQueue(new SynthQueueItem(buf, idle_marked));
+  }
+} /* MsgHandler::playCw */
+
+
 void MsgHandler::clear(void)
 {
   clearP();
@@ -1032,56 +1007,25 @@ void SilenceQueueItem::unreadSamples(int len)
 
 /****************************************************************************
  *
- * Private member functions for class ToneQueueItem
+ * Private member functions for class SynthQueueItem
  *
  ****************************************************************************/
 
-int ToneQueueItem::readSamples(float *samples, int len)
+int SynthQueueItem::readSamples(float *samples, int len)
 {
-  int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * sin(2 * M_PI * fq * pos / sample_rate);
-    ++pos;
-  }
-  
-  return read_cnt;
-  
-} /* ToneQueueItem::readSamples */
-
-
-void ToneQueueItem::unreadSamples(int len)
-{
-  pos -= len;
-} /* ToneQueueItem::unreadSamples */
-
-
-
-/****************************************************************************
- *
- * Private member functions for class DtmfQueueItem
- *
- ****************************************************************************/
-
-int DtmfQueueItem::readSamples(float *samples, int len)
-{
-  int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * (
-                sin(2 * M_PI * fqh * pos / sample_rate) +
-                sin(2 * M_PI * fql * pos / sample_rate));
-    ++pos;
-  }
+  int read_cnt = min(len, static_cast<int>(buf->size()) - pos);
+  memcpy(samples, buf->data() + pos, sizeof(*samples) * read_cnt);
+  pos += read_cnt;
 
   return read_cnt;
-} /* DtmfQueueItem::readSamples */
+
+} /* SynthQueueItem::readSamples */
 
 
-void DtmfQueueItem::unreadSamples(int len)
+void SynthQueueItem::unreadSamples(int len)
 {
   pos -= len;
-} /* DtmfQueueItem::unreadSamples */
+} /* SynthQueueItem::unreadSamples */
 
 
 
@@ -70,6 +70,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 class QueueItem;
+class ToneSynth;
 
 
 
@@ -179,6 +180,33 @@ class MsgHandler : public sigc::trackable, public Async::AudioSource
      *
      */
     void playDtmf(char digit, int amp, int length, bool idle_marked=false);
+
+    /**
+     * @brief 	Play a sequence of DTMF digits
+     * @param 	digits The DTMF digits to play
+     * @param 	amp The amplitude of the individual DTMF tones (0-1000)
+     * @param 	length The length in milliseconds of each digit
+     * @param 	spacing The silence in milliseconds after each digit
+     * @param   idle_marked Choose if the playback should be idle marked or not
+     *
+     * The whole sequence is rendered, and cached, as one message.
+     */
+    void playDtmf(const std::string& digits, int amp, int length,
+                  int spacing, bool idle_marked=false);
+
+    /**
+     * @brief 	Play a CW message
+     * @param 	txt The text to send
+     * @param 	dot_len The length of a dot in milliseconds
+     * @param 	fq The pitch of the CW tone
+     * @param 	amp The amplitude of the CW tone (0-1000)
+     * @param   idle_marked Choose if the playback should be idle marked or not
+     *
+     * The whole message is rendered, and cached, as one message. The timing
+     * is the same as the one used by the TCL CW::play function.
+     */
+    void playCw(const std::string& txt, int dot_len, int fq, int amp,
+                bool idle_marked=false);
     
     /**
      * @brief 	Check if a message is beeing written
@@ -245,6 +273,7 @@ class MsgHandler : public sigc::trackable, public Async::AudioSource
     QueueItem 	      	    *current;
     bool      	      	    is_writing_message;
     int       	      	    non_idle_cnt;
+    ToneSynth                *synth;
     
     MsgHandler(const MsgHandler&);
     MsgHandler& operator=(const MsgHandler&);
@@ -152,7 +152,10 @@ ReflectorLogic::ReflectorLogic(void)
     m_mute_first_tx_loc(true), m_mute_first_tx_rem(false),
     m_tmp_monitor_timer(1000, Async::Timer::TYPE_PERIODIC),
     m_tmp_monitor_timeout(DEFAULT_TMP_MONITOR_TIMEOUT), m_use_prio(true),
-    m_qsy_pending_timer(-1), m_verbose(true)
+    m_qsy_pending_timer(-1), m_verbose(true),
+    m_reconnect_min_time(1000 * DEFAULT_RECONNECT_MIN_TIME),
+    m_reconnect_max_time(1000 * DEFAULT_RECONNECT_MAX_TIME),
+    m_reconnect_backoff(m_reconnect_min_time), m_resume_pending(false)
 {
   m_reconnect_timer.expired.connect(
       sigc::hide(mem_fun(*this, &ReflectorLogic::reconnect)));
@@ -454,6 +457,23 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
   cfg().getValue(name(), "UDP_HEARTBEAT_INTERVAL",
       m_udp_heartbeat_tx_cnt_reset);
 
+    // Spread out reconnects so that all nodes do not hit the reflector at
+    // the same time, e.g. after a reflector restart. The wait time doubles
+    // for each failed attempt and a random time of up to the same length is
+    // added.
+  unsigned reconnect_min_time = DEFAULT_RECONNECT_MIN_TIME;
+  cfg().getValue(name(), "RECONNECT_MIN_TIME", reconnect_min_time);
+  unsigned reconnect_max_time = DEFAULT_RECONNECT_MAX_TIME;
+  cfg().getValue(name(), "RECONNECT_MAX_TIME", reconnect_max_time);
+  m_reconnect_min_time = 1000 * std::max(reconnect_min_time, 1U);
+  m_reconnect_max_time = 1000 * std::max(reconnect_max_time,
+                                         reconnect_min_time);
+  m_reconnect_backoff = m_reconnect_min_time;
+  m_con.setReconnectMinTime(m_reconnect_min_time);
+  m_con.setReconnectMaxTime(m_reconnect_max_time);
+  m_con.setReconnectBackoffPercent(100);
+  m_con.setReconnectRandomizePercent(100);
+
   connect();
 
   return true;
@@ -776,6 +796,26 @@ void ReflectorLogic::onConnected(void)
             << " (" << (m_con.isPrimary() ? "primary" : "secondary") << ")"
             << std::endl;
   sendMsg(MsgProtoVer());
+  m_resume_pending = false;
+  if (!m_session_token.empty() &&
+      (std::chrono::steady_clock::now() < m_session_token_expire))
+  {
+      // Send the resume request right away, without waiting for the
+      // authentication challenge, to save one round trip. The selected and
+      // monitored talk groups are sent after login, as for a normal login.
+      // A request that is too large to be sent before login, e.g. due to a
+      // very long callsign, is skipped.
+    MsgSessionResume msg(m_callsign, m_auth_key, m_session_token);
+    if (msg.fitsPreAuthFrame())
+    {
+      std::cout << name() << ": Trying to resume previous session"
+                << std::endl;
+      sendMsg(msg);
+      m_resume_pending = true;
+    }
+  }
+    // A session token is only used once
+  m_session_token.clear();
   m_udp_heartbeat_tx_cnt = m_udp_heartbeat_tx_cnt_reset;
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
   m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
@@ -796,8 +836,15 @@ void ReflectorLogic::onDisconnected(TcpConnection *con,
   cout << name() << ": Disconnected from " << m_con.remoteHost() << ":"
        << m_con.remotePort() << ": "
        << TcpConnection::disconnectReasonStr(reason) << endl;
-  //m_reconnect_timer.setTimeout(1000 + std::rand() % 5000);
-  m_reconnect_timer.setEnable(reason == TcpConnection::DR_ORDERED_DISCONNECT);
+  if (reason == TcpConnection::DR_ORDERED_DISCONNECT)
+  {
+    m_reconnect_timer.setTimeout(nextReconnectTime());
+    m_reconnect_timer.setEnable(true);
+  }
+  else
+  {
+    m_reconnect_timer.setEnable(false);
+  }
   delete m_udp_sock;
   m_udp_sock = 0;
   m_next_udp_tx_seq = 0;
@@ -862,6 +909,12 @@ void ReflectorLogic::onFrameReceived(FramedTcpConnection *con,
     case MsgAuthOk::TYPE:
       handleMsgAuthOk();
       break;
+    case MsgSessionResumeFailed::TYPE:
+      handleMsgSessionResumeFailed(ss);
+      break;
+    case MsgSessionToken::TYPE:
+      handleMsgSessionToken(ss);
+      break;
     case MsgServerInfo::TYPE:
       handleMsgServerInfo(ss);
       break;
@@ -950,7 +1003,17 @@ void ReflectorLogic::handleMsgAuthChallenge(std::istream& is)
     disconnect();
     return;
   }
-  sendMsg(MsgAuthResponse(m_callsign, m_auth_key, challenge));
+  if (m_resume_pending)
+  {
+      // Wait for the outcome of the resume request. The challenge is only
+      // answered if the session could not be resumed.
+    m_auth_challenge.assign(challenge,
+                            challenge + MsgAuthChallenge::CHALLENGE_LEN);
+  }
+  else
+  {
+    sendMsg(MsgAuthResponse(m_callsign, m_auth_key, challenge));
+  }
   m_con_state = STATE_EXPECT_AUTH_OK;
 } /* ReflectorLogic::handleMsgAuthChallenge */
 
@@ -963,12 +1026,59 @@ void ReflectorLogic::handleMsgAuthOk(void)
     disconnect();
     return;
   }
-  cout << name() << ": Authentication OK" << endl;
+  if (m_resume_pending)
+  {
+    cout << name() << ": Session resumed" << endl;
+    m_resume_pending = false;
+  }
+  else
+  {
+    cout << name() << ": Authentication OK" << endl;
+  }
   m_con_state = STATE_EXPECT_SERVER_INFO;
   m_con.setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
 } /* ReflectorLogic::handleMsgAuthOk */
 
 
+void ReflectorLogic::handleMsgSessionResumeFailed(std::istream& is)
+{
+  if (!m_resume_pending || (m_con_state != STATE_EXPECT_AUTH_OK))
+  {
+    cerr << "*** ERROR[" << name() << "]: Unexpected MsgSessionResumeFailed\n";
+    disconnect();
+    return;
+  }
+
+  MsgSessionResumeFailed msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << name()
+         << "]: Could not unpack MsgSessionResumeFailed\n";
+    disconnect();
+    return;
+  }
+  cout << name() << ": Could not resume session: " << msg.reason()
+       << ". Logging in." << endl;
+  m_resume_pending = false;
+  sendMsg(MsgAuthResponse(m_callsign, m_auth_key, m_auth_challenge.data()));
+} /* ReflectorLogic::handleMsgSessionResumeFailed */
+
+
+void ReflectorLogic::handleMsgSessionToken(std::istream& is)
+{
+  MsgSessionToken msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << name() << "]: Could not unpack MsgSessionToken\n";
+    disconnect();
+    return;
+  }
+  m_session_token = msg.token();
+  m_session_token_expire = std::chrono::steady_clock::now() +
+                           std::chrono::seconds(msg.lifetime());
+} /* ReflectorLogic::handleMsgSessionToken */
+
+
 void ReflectorLogic::handleMsgServerInfo(std::istream& is)
 {
   if (m_con_state != STATE_EXPECT_SERVER_INFO)
@@ -1037,6 +1147,7 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
       mem_fun(*this, &ReflectorLogic::udpDatagramReceived));
 
   m_con_state = STATE_CONNECTED;
+  m_reconnect_backoff = m_reconnect_min_time;
 
   std::ostringstream node_info_os;
   Json::StreamWriterBuilder builder;
@@ -1483,6 +1594,15 @@ void ReflectorLogic::reconnect(void)
 } /* ReflectorLogic::reconnect */
 
 
+unsigned ReflectorLogic::nextReconnectTime(void)
+{
+  unsigned t = m_reconnect_backoff;
+  m_reconnect_backoff = std::min(2 * m_reconnect_backoff,
+                                 m_reconnect_max_time);
+  return t + std::rand() % t;
+} /* ReflectorLogic::nextReconnectTime */
+
+
 bool ReflectorLogic::isConnected(void) const
 {
   return m_con.isConnected();
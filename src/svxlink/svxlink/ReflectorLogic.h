@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sys/time.h>
 #include <string>
+#include <vector>
+#include <chrono>
 #include <json/json.h>
 
 
@@ -210,6 +212,8 @@ class ReflectorLogic : public LogicBase
     static const unsigned TCP_HEARTBEAT_RX_CNT_RESET          = 15;
     static const unsigned DEFAULT_TG_SELECT_TIMEOUT           = 30;
     static const int      DEFAULT_TMP_MONITOR_TIMEOUT         = 3600;
+    static const unsigned DEFAULT_RECONNECT_MIN_TIME          = 2;
+    static const unsigned DEFAULT_RECONNECT_MAX_TIME          = 120;
 
     std::string                       m_reflector_host;
     FramedTcpClient                   m_con;
@@ -257,6 +261,13 @@ class ReflectorLogic : public LogicBase
     bool                              m_use_prio;
     Async::Timer                      m_qsy_pending_timer;
     bool                              m_verbose;
+    unsigned                          m_reconnect_min_time;
+    unsigned                          m_reconnect_max_time;
+    unsigned                          m_reconnect_backoff;
+    std::vector<uint8_t>              m_session_token;
+    std::chrono::steady_clock::time_point m_session_token_expire;
+    bool                              m_resume_pending;
+    std::vector<uint8_t>              m_auth_challenge;
 
     ReflectorLogic(const ReflectorLogic&);
     ReflectorLogic& operator=(const ReflectorLogic&);
@@ -275,6 +286,8 @@ class ReflectorLogic : public LogicBase
     void handleMsgTalkerStop(std::istream& is);
     void handleMsgRequestQsy(std::istream& is);
     void handleMsgAuthOk(void);
+    void handleMsgSessionResumeFailed(std::istream& is);
+    void handleMsgSessionToken(std::istream& is);
     void handleMsgServerInfo(std::istream& is);
     void sendMsg(const ReflectorMsg& msg);
     void sendEncodedAudio(const void *buf, int count);
@@ -285,6 +298,7 @@ class ReflectorLogic : public LogicBase
     void connect(void);
     void disconnect(void);
     void reconnect(void);
+    unsigned nextReconnectTime(void);
     bool isConnected(void) const;
     bool isLoggedIn(void) const { return m_con_state == STATE_CONNECTED; }
     void allEncodedSamplesFlushed(void);
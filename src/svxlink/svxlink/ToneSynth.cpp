@@ -0,0 +1,454 @@
+/**
+@file	 ToneSynth.cpp
+@brief   Synthesize tones, CW and DTMF messages
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ToneSynth.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  /*
+   * A recursive sine oscillator, y[n] = 2cos(w)y[n-1] - y[n-2]. The state
+   * is kept in double precision so that the amplitude does not drift
+   * noticeably over the length of a message.
+   */
+  class Oscillator
+  {
+    public:
+      Oscillator(double fq, double sample_rate)
+      {
+        double w = 2.0 * M_PI * fq / sample_rate;
+        k = 2.0 * cos(w);
+        y1 = -sin(w);
+        y2 = -sin(2.0 * w);
+      }
+
+      double next(void)
+      {
+        double y = k * y1 - y2;
+        y2 = y1;
+        y1 = y;
+        return y;
+      }
+
+    private:
+      double k;
+      double y1;
+      double y2;
+  };
+
+  struct MorseEntry
+  {
+    char        ch;
+    const char  *code;
+  };
+
+  const MorseEntry morse_table[] =
+  {
+    {'A', ".-"},    {'B', "-..."},  {'C', "-.-."},  {'D', "-.."},
+    {'E', "."},     {'F', "..-."},  {'G', "--."},   {'H', "...."},
+    {'I', ".."},    {'J', ".---"},  {'K', "-.-"},   {'L', ".-.."},
+    {'M', "--"},    {'N', "-."},    {'O', "---"},   {'P', ".--."},
+    {'Q', "--.-"},  {'R', ".-."},   {'S', "..."},   {'T', "-"},
+    {'U', "..-"},   {'V', "...-"},  {'W', ".--"},   {'X', "-..-"},
+    {'Y', "-.--"},  {'Z', "--.."},
+
+    {'0', "-----"}, {'1', ".----"}, {'2', "..---"}, {'3', "...--"},
+    {'4', "....-"}, {'5', "....."}, {'6', "-...."}, {'7', "--..."},
+    {'8', "---.."}, {'9', "----."},
+
+    {'.', ".-.-.-"}, {',', "--..--"}, {'?', "..--.."}, {'/', "-..-."},
+    {'=', "-...-"},
+
+    {' ', " "}
+  };
+
+  const char dtmf_digits[] = "123A456B789C*0#D";
+  const int dtmf_low[] = { 697, 770, 852, 941 };
+  const int dtmf_high[] = { 1209, 1336, 1477, 1633 };
+
+} /* anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+const char *ToneSynth::morseCode(char ch)
+{
+  ch = toupper(ch);
+  for (size_t i=0; i<sizeof(morse_table)/sizeof(*morse_table); ++i)
+  {
+    if (morse_table[i].ch == ch)
+    {
+      return morse_table[i].code;
+    }
+  }
+  return 0;
+} /* ToneSynth::morseCode */
+
+
+bool ToneSynth::dtmfTones(char digit, int& fql, int& fqh)
+{
+  const char *pos = (digit != 0) ? strchr(dtmf_digits, toupper(digit)) : 0;
+  if (pos == 0)
+  {
+    return false;
+  }
+  int idx = pos - dtmf_digits;
+  fql = dtmf_low[idx / 4];
+  fqh = dtmf_high[idx % 4];
+  return true;
+} /* ToneSynth::dtmfTones */
+
+
+void ToneSynth::cwEncode(const string& txt, int dot_len, CwElements& elems)
+{
+    // The timing is the same as the one used by CW.tcl
+  const CwElement char_spacing = { false, dot_len };
+  const CwElement letter_spacing = { false, 3 * dot_len };
+  const CwElement word_spacing = { false, 7 * dot_len };
+  const CwElement dot = { true, dot_len };
+  const CwElement dash = { true, 3 * dot_len };
+
+  bool first_letter = true;
+  for (string::const_iterator it=txt.begin(); it!=txt.end(); ++it)
+  {
+    const char *code = morseCode(*it);
+    if (code == 0)
+    {
+      continue;
+    }
+    if (!first_letter)
+    {
+      elems.push_back(letter_spacing);
+    }
+    first_letter = false;
+    for (const char *ch=code; *ch != 0; ++ch)
+    {
+      if (ch != code)
+      {
+        elems.push_back(char_spacing);
+      }
+      switch (*ch)
+      {
+        case '.':
+          elems.push_back(dot);
+          break;
+        case '-':
+          elems.push_back(dash);
+          break;
+        default:
+          elems.push_back(word_spacing);
+          break;
+      }
+    }
+  }
+} /* ToneSynth::cwEncode */
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ToneSynth::ToneSynth(int sample_rate)
+  : m_sample_rate(sample_rate), m_cache_samples(0)
+{
+  size_t ramp_len = msToSamples(RAMP_LENGTH);
+  m_ramp.resize(ramp_len);
+  for (size_t i=0; i<ramp_len; ++i)
+  {
+    m_ramp[i] = 0.5f - 0.5f * cosf(M_PI * (i + 0.5f) / ramp_len);
+  }
+} /* ToneSynth::ToneSynth */
+
+
+ToneSynth::~ToneSynth(void)
+{
+} /* ToneSynth::~ToneSynth */
+
+
+ToneSynth::BufferPtr ToneSynth::renderTone(int fq, int amp, int length)
+{
+  shared_ptr<Buffer> buf(new Buffer);
+  size_t len = msToSamples(length);
+  buf->reserve(len);
+  appendTone(*buf, fq, 0, amp / 1000.0f, len, false);
+  return buf;
+} /* ToneSynth::renderTone */
+
+
+ToneSynth::BufferPtr ToneSynth::renderCw(const string& txt, int dot_len,
+                                         int fq, int amp)
+{
+  string utxt(txt);
+  transform(utxt.begin(), utxt.end(), utxt.begin(), ::toupper);
+  ostringstream key;
+  key << "CW:" << dot_len << ":" << fq << ":" << amp << ":" << utxt;
+  BufferPtr cached = cacheLookup(key.str());
+  if (cached)
+  {
+    return cached;
+  }
+
+  CwElements elems;
+  cwEncode(utxt, dot_len, elems);
+  size_t len = 0;
+  for (CwElements::const_iterator it=elems.begin(); it!=elems.end(); ++it)
+  {
+    len += msToSamples(it->length);
+  }
+
+  shared_ptr<Buffer> buf(new Buffer);
+  buf->reserve(len);
+  for (CwElements::const_iterator it=elems.begin(); it!=elems.end(); ++it)
+  {
+    if (it->key_down)
+    {
+      appendTone(*buf, fq, 0, amp / 1000.0f, msToSamples(it->length), true);
+    }
+    else
+    {
+      appendSilence(*buf, msToSamples(it->length));
+    }
+  }
+
+  cacheStore(key.str(), buf);
+  return buf;
+} /* ToneSynth::renderCw */
+
+
+ToneSynth::BufferPtr ToneSynth::renderDtmf(const string& digits, int amp,
+                                           int length, int spacing)
+{
+  ostringstream key;
+  key << "DTMF:" << length << ":" << spacing << ":" << amp << ":" << digits;
+  BufferPtr cached = cacheLookup(key.str());
+  if (cached)
+  {
+    return cached;
+  }
+
+  shared_ptr<Buffer> buf(new Buffer);
+  size_t tone_len = msToSamples(length);
+  size_t spacing_len = msToSamples(spacing);
+  buf->reserve(digits.size() * (tone_len + spacing_len));
+  for (string::const_iterator it=digits.begin(); it!=digits.end(); ++it)
+  {
+    int fql, fqh;
+    if (dtmfTones(*it, fql, fqh))
+    {
+      appendTone(*buf, fql, fqh, amp / 1000.0f, tone_len, true);
+      appendSilence(*buf, spacing_len);
+    }
+  }
+
+  cacheStore(key.str(), buf);
+  return buf;
+} /* ToneSynth::renderDtmf */
+
+
+void ToneSynth::clearCache(void)
+{
+  m_cache_map.clear();
+  m_cache_list.clear();
+  m_cache_samples = 0;
+} /* ToneSynth::clearCache */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+size_t ToneSynth::msToSamples(int ms) const
+{
+  return (ms > 0) ? static_cast<size_t>(ms) * m_sample_rate / 1000 : 0;
+} /* ToneSynth::msToSamples */
+
+
+void ToneSynth::appendTone(Buffer& buf, int fq1, int fq2, float amp,
+                           size_t len, bool keyed) const
+{
+  Oscillator osc1(fq1, m_sample_rate);
+  Oscillator osc2(fq2, m_sample_rate);
+  size_t ramp_len = keyed ? min(m_ramp.size(), len / 2) : 0;
+  for (size_t i=0; i<len; ++i)
+  {
+    float sample = osc1.next();
+    if (fq2 > 0)
+    {
+      sample += osc2.next();
+    }
+    sample *= amp;
+    if (i < ramp_len)
+    {
+      sample *= m_ramp[i * m_ramp.size() / ramp_len];
+    }
+    else if (i >= len - ramp_len)
+    {
+      sample *= m_ramp[(len - 1 - i) * m_ramp.size() / ramp_len];
+    }
+    buf.push_back(sample);
+  }
+} /* ToneSynth::appendTone */
+
+
+void ToneSynth::appendSilence(Buffer& buf, size_t len) const
+{
+  buf.insert(buf.end(), len, 0.0f);
+} /* ToneSynth::appendSilence */
+
+
+ToneSynth::BufferPtr ToneSynth::cacheLookup(const string& key)
+{
+  CacheMap::iterator it = m_cache_map.find(key);
+  if (it == m_cache_map.end())
+  {
+    return BufferPtr();
+  }
+  m_cache_list.splice(m_cache_list.begin(), m_cache_list, it->second);
+  return it->second->second;
+} /* ToneSynth::cacheLookup */
+
+
+void ToneSynth::cacheStore(const string& key, BufferPtr buf)
+{
+  if (buf->size() > MAX_CACHE_SAMPLES)
+  {
+    return;
+  }
+  m_cache_list.push_front(make_pair(key, buf));
+  m_cache_map[key] = m_cache_list.begin();
+  m_cache_samples += buf->size();
+  while ((m_cache_list.size() > MAX_CACHE_ENTRIES) ||
+         (m_cache_samples > MAX_CACHE_SAMPLES))
+  {
+    m_cache_samples -= m_cache_list.back().second->size();
+    m_cache_map.erase(m_cache_list.back().first);
+    m_cache_list.pop_back();
+  }
+} /* ToneSynth::cacheStore */
+
+
+
+/*
+ * This file has not been truncated
+ */
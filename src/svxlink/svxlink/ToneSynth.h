@@ -0,0 +1,251 @@
+/**
+@file	 ToneSynth.h
+@brief   Synthesize tones, CW and DTMF messages
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TONE_SYNTH_INCLUDED
+#define TONE_SYNTH_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Synthesize tones, CW and DTMF messages
+@author agent
+@date   2026-10-18
+
+This class render tones, CW messages and DTMF digit sequences into sample
+buffers. The sine waves are generated using a recursive oscillator so no
+trigonometric function is called per sample. CW elements and DTMF digits are
+keyed using a raised cosine envelope to avoid key clicks.
+
+A complete CW or DTMF message is rendered in one go and the result is kept
+in a small cache, keyed by the text and all parameters, so that recurring
+messages like the CW identification only are rendered once.
+*/
+class ToneSynth
+{
+  public:
+    typedef std::vector<float>            Buffer;
+    typedef std::shared_ptr<const Buffer> BufferPtr;
+
+    /**
+     * @brief   An element of a CW message
+     */
+    struct CwElement
+    {
+      bool  key_down;   ///< True for a tone, false for silence
+      int   length;     ///< The length of the element in milliseconds
+    };
+    typedef std::vector<CwElement> CwElements;
+
+    /**
+     * @brief   Look up the morse code for a character
+     * @param   ch The character to look up
+     * @return  Returns a string of dots and dashes or 0 if unknown
+     *
+     * A space character is encoded as a single space.
+     */
+    static const char *morseCode(char ch);
+
+    /**
+     * @brief   Look up the tone pair for a DTMF digit
+     * @param   digit The DTMF digit (0-9, A-D, *, #)
+     * @param   fql   Return the low tone frequency
+     * @param   fqh   Return the high tone frequency
+     * @return  Returns \em true if the digit is valid or else \em false
+     */
+    static bool dtmfTones(char digit, int& fql, int& fqh);
+
+    /**
+     * @brief   Split a text into CW elements
+     * @param   txt     The text to encode
+     * @param   dot_len The length of a dot in milliseconds
+     * @param   elems   The elements are appended to this vector
+     *
+     * Unknown characters are ignored.
+     */
+    static void cwEncode(const std::string& txt, int dot_len,
+                         CwElements& elems);
+
+    /**
+     * @brief 	Constructor
+     * @param 	sample_rate The sample rate to render at
+     */
+    explicit ToneSynth(int sample_rate);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~ToneSynth(void);
+
+    /**
+     * @brief   Render a sine tone
+     * @param   fq      The frequency of the tone
+     * @param   amp     The amplitude of the tone (0-1000)
+     * @param   length  The length of the tone in milliseconds
+     * @return  Returns the rendered samples
+     *
+     * The tone is not keyed with an envelope and it is not cached.
+     */
+    BufferPtr renderTone(int fq, int amp, int length);
+
+    /**
+     * @brief   Render a CW message
+     * @param   txt     The text to send
+     * @param   dot_len The length of a dot in milliseconds
+     * @param   fq      The pitch of the CW tone
+     * @param   amp     The amplitude of the CW tone (0-1000)
+     * @return  Returns the rendered samples
+     */
+    BufferPtr renderCw(const std::string& txt, int dot_len, int fq, int amp);
+
+    /**
+     * @brief   Render a sequence of DTMF digits
+     * @param   digits  The digits to render (0-9, A-D, *, #)
+     * @param   amp     The amplitude of each of the two tones (0-1000)
+     * @param   length  The length of each digit in milliseconds
+     * @param   spacing The silence after each digit in milliseconds
+     * @return  Returns the rendered samples
+     *
+     * Invalid digits are ignored.
+     */
+    BufferPtr renderDtmf(const std::string& digits, int amp, int length,
+                         int spacing);
+
+    /**
+     * @brief   Remove all rendered messages from the cache
+     */
+    void clearCache(void);
+
+  private:
+    static const int    RAMP_LENGTH = 5;  // Milliseconds
+    static const size_t MAX_CACHE_ENTRIES = 32;
+    static const size_t MAX_CACHE_SAMPLES = 1000000;
+
+    typedef std::list<std::pair<std::string, BufferPtr> > CacheList;
+    typedef std::map<std::string, CacheList::iterator>    CacheMap;
+
+    int                 m_sample_rate;
+    std::vector<float>  m_ramp;
+    CacheList           m_cache_list;   // Most recently used first
+    CacheMap            m_cache_map;
+    size_t              m_cache_samples;
+
+    ToneSynth(const ToneSynth&);
+    ToneSynth& operator=(const ToneSynth&);
+    size_t msToSamples(int ms) const;
+    void appendTone(Buffer& buf, int fq1, int fq2, float amp, size_t len,
+                    bool keyed) const;
+    void appendSilence(Buffer& buf, size_t len) const;
+    BufferPtr cacheLookup(const std::string& key);
+    void cacheStore(const std::string& key, BufferPtr buf);
+
+};  /* class ToneSynth */
+
+
+//} /* namespace */
+
+#endif /* TONE_SYNTH_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
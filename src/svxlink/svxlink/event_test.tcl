@@ -19,6 +19,11 @@ proc playSilence {milliseconds} {
 }
 
 
+proc playCw {txt dot_len fq amp} {
+  puts "playCw(\"$txt\", $dot_len, $fq, $amp);";
+}
+
+
 proc reportActiveModuleState {} {
   puts "reportActiveModuleState;";
 }
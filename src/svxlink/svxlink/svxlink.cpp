@@ -67,6 +67,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
 #include <AsyncFdWatch.h>
+#include <AsyncTrace.h>
+#include <AsyncMetricsHttpServer.h>
 #include <AsyncAudioIO.h>
 #include <LocationInfo.h>
 #include <common.h>
@@ -430,6 +432,8 @@ int main(int argc, char **argv)
   }
   
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
+  app.loopMonitor()->configure(cfg, "GLOBAL");
+  Trace::configure(cfg, "GLOBAL");
   
   cout << PROGRAM_NAME " v" SVXLINK_VERSION
           " Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX\n\n";
@@ -524,8 +528,11 @@ int main(int argc, char **argv)
     stdin_watch->activity.connect(sigc::ptr_fun(&stdinHandler));
   }
 
+  MetricsHttpServer *metrics_srv = MetricsHttpServer::create(cfg, "GLOBAL");
+
   app.exec();
 
+  delete metrics_srv;
   LinkManager::deleteInstance();
   LocationInfo::deleteInstance();
 
@@ -8,7 +8,7 @@ This file contains a class that handle local digital drop receivers.
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -101,23 +101,169 @@ using namespace Async;
  ****************************************************************************/
 
 namespace {
+    /**
+     * @brief Calculate a dot product using independent partial sums
+     * @param x The samples
+     * @param c The coefficients
+     * @param len The number of values, must be a multiple of 8
+     * @param sum Eight partial sums are returned here
+     *
+     * The eight partial sums are kept apart so that the compiler can map the
+     * inner loop directly onto SIMD instructions (SSE/AVX/NEON) without
+     * having to reorder floating point additions.
+     */
+  inline void dotProduct8(const float *x, const float *c, size_t len,
+                          float *sum)
+  {
+    float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i=0; i<len; i+=8)
+    {
+      for (size_t j=0; j<8; ++j)
+      {
+        acc[j] += x[i+j] * c[i+j];
+      }
+    }
+    for (size_t j=0; j<8; ++j)
+    {
+      sum[j] = acc[j];
+    }
+  }
+
+
+    /**
+     * @brief Fast four quadrant arctangent
+     * @param y The imaginary part
+     * @param x The real part
+     * @return Returns the angle in the range -pi to pi
+     *
+     * A branch free polynomial approximation of atan2 with a maximum error
+     * of about 1e-5 radians, which is far below the noise floor of the
+     * demodulated audio. Being branch free, loops calling this function can
+     * be vectorized by the compiler.
+     */
+  inline float fastAtan2(float y, float x)
+  {
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float mx = max(ax, ay);
+    const float mn = min(ax, ay);
+    const float a = mn / max(mx, 1.0e-30f);
+    const float s = a * a;
+    float r = ((((-0.0117212f * s + 0.05265332f) * s - 0.11643287f) * s +
+                0.19354346f) * s - 0.33262347f) * s + 0.99997726f;
+    r *= a;
+    r = (ay > ax) ? 1.57079637f - r : r;
+    r = (x < 0.0f) ? 3.14159274f - r : r;
+    return (y < 0.0f) ? -r : r;
+  }
+
+
+    /**
+     * @brief A phase accumulator numerically controlled oscillator
+     *
+     * Used to mix a complex signal down by a fixed frequency offset. The
+     * phase is accumulated in double precision once per chunk of samples and
+     * a precalculated table of rotations is used within the chunk. This keeps
+     * the per sample work down to a complex multiplication that vectorize
+     * well, without the phase drift of a recursive oscillator and without the
+     * potentially huge tables needed for an exact lookup table.
+     */
+  class Nco
+  {
+    public:
+      Nco(unsigned samp_rate, int offset)
+        : samp_rate(samp_rate), offset(0), phase(0.0), phase_inc(0.0)
+      {
+        setOffset(offset);
+      }
+
+      void setOffset(int offset)
+      {
+        this->offset = offset;
+        phase = 0.0;
+        phase_inc = -2.0 * M_PI * offset * CHUNK / samp_rate;
+        for (size_t k=0; k<CHUNK; ++k)
+        {
+          double arg = -2.0 * M_PI * offset * k / samp_rate;
+          rot_re[k] = cos(arg);
+          rot_im[k] = sin(arg);
+        }
+      }
+
+      int frequency(void) const { return offset; }
+
+        /**
+         * @brief Mix samples with the oscillator
+         * @param dst Where to write mixed samples (may be the same as src)
+         * @param src The samples to mix
+         * @param cnt The number of samples
+         */
+      void mix(complex<float> *dst, const complex<float> *src, size_t cnt)
+      {
+        if (offset == 0)
+        {
+          if (dst != src)
+          {
+            memcpy(dst, src, cnt * sizeof(*dst));
+          }
+          return;
+        }
+
+          // A complex<float> array is guaranteed to be laid out as an array
+          // of interleaved real and imaginary float values
+        const float *s = reinterpret_cast<const float*>(src);
+        float *d = reinterpret_cast<float*>(dst);
+        float lo_re[CHUNK], lo_im[CHUNK];
+        size_t idx = 0;
+        while (idx < cnt)
+        {
+          size_t len = min(CHUNK, cnt - idx);
+          const float ph_re = cos(phase);
+          const float ph_im = sin(phase);
+          for (size_t k=0; k<CHUNK; ++k)
+          {
+            lo_re[k] = ph_re * rot_re[k] - ph_im * rot_im[k];
+            lo_im[k] = ph_re * rot_im[k] + ph_im * rot_re[k];
+          }
+          const float *sp = s + 2 * idx;
+          float *dp = d + 2 * idx;
+          for (size_t k=0; k<len; ++k)
+          {
+            const float re = sp[2*k];
+            const float im = sp[2*k+1];
+            dp[2*k]   = re * lo_re[k] - im * lo_im[k];
+            dp[2*k+1] = re * lo_im[k] + im * lo_re[k];
+          }
+          phase += phase_inc * len / CHUNK;
+          phase = remainder(phase, 2.0 * M_PI);
+          idx += len;
+        }
+      }
+
+    private:
+      static const size_t CHUNK = 32;
+
+      unsigned  samp_rate;
+      int       offset;
+      double    phase;
+      double    phase_inc;
+      float     rot_re[CHUNK];
+      float     rot_im[CHUNK];
+  }; /* Nco */
+
+
   template <class T>
   class Decimator
   {
     public:
-      Decimator(void) : dec_fact(0), p_Z(0), taps(0) {}
+      Decimator(void) : dec_fact(0), taps(0), win_len(0), gain(1.0f) {}
 
       Decimator(int dec_fact, const float *coeff, int taps)
-        : dec_fact(dec_fact), p_Z(0), taps(taps)
+        : dec_fact(0), taps(0), win_len(0), gain(1.0f)
       {
         setDecimatorParams(dec_fact, coeff, taps);
       }
 
-      ~Decimator(void)
-      {
-        delete [] p_Z;
-      }
-
       int decFact(void) const { return dec_fact; }
 
       void setDecimatorParams(int dec_fact, const float *coeff, int taps)
@@ -126,63 +272,106 @@ namespace {
 
         set_coeff.assign(coeff, coeff + taps);
         this->dec_fact = dec_fact;
-        this->coeff = set_coeff;
         this->taps = taps;
+        gain = 1.0f;
 
-        delete [] p_Z;
-        p_Z = new T[taps]();
+          // The filter window is padded with zero coefficients so that the
+          // number of float values in it is a multiple of eight
+        win_len = (taps * FLOATS + 7) / 8 * 8 / FLOATS;
+        hist.assign(win_len - 1, T(0));
+        updateCoeff();
       }
 
       void setGain(double gain_adjust)
       {
-        coeff = set_coeff;
-        for (vector<float>::iterator it=coeff.begin(); it!=coeff.end(); ++it)
-        {
-          *it *= pow(10.0, gain_adjust / 20.0);
-        }
+        gain = pow(10.0, gain_adjust / 20.0);
+        updateCoeff();
       }
 
-      void decimate(vector<T> &out, const vector<T> &in)
+      void decimate(vector<T> &out, const vector<T> &in, Nco *nco=0)
       {
-        int orig_count = in.size();
-
           // this implementation assumes in.size() is a multiple of factor_M
         assert(in.size() % dec_fact == 0);
 
-        int num_out = 0;
-        typename vector<T>::const_iterator src = in.begin();
-        out.clear();
-        out.reserve(in.size() / dec_fact);
-        while (src != in.end())
+          // The delay line is stored in chronological order with the newest
+          // sample last so that each output sample is a contiguous dot
+          // product. It is followed by the new input samples, mixed by the
+          // NCO if one was given.
+        const size_t hist_len = win_len - 1;
+        hist.resize(hist_len + in.size());
+        load(&hist[hist_len], in.empty() ? 0 : &in[0], in.size(), nco);
+
+        const size_t num_out = in.size() / dec_fact;
+        out.resize(num_out);
+        const float *x = reinterpret_cast<const float*>(&hist[0]);
+        const size_t len = win_len * FLOATS;
+        for (size_t m=0; m<num_out; ++m)
         {
-            // shift Z delay line up to make room for next samples
-          memmove(p_Z + dec_fact, p_Z, (taps - dec_fact) * sizeof(T));
-
-            // copy next samples from input buffer to bottom of Z delay line
-          for (int tap = dec_fact - 1; tap >= 0; tap--)
-          {
-            assert(src != in.end());
-            p_Z[tap] = *src++;
-          }
-
-            // calculate FIR sum
-          T sum(0);
-          for (int tap = 0; tap < taps; tap++)
-          {
-            sum += coeff[tap] * p_Z[tap];
-          }
-          out.push_back(sum);     /* store sum */
-          num_out++;
+          float sum[8];
+          dotProduct8(x + (m * dec_fact + dec_fact - 1) * FLOATS,
+                      &coeff[0], len, sum);
+          reduce(out[m], sum);
         }
-        assert(num_out == orig_count / dec_fact);
+
+        copy(hist.end() - hist_len, hist.end(), hist.begin());
+        hist.resize(hist_len);
       }
 
     private:
+      static const size_t FLOATS = sizeof(T) / sizeof(float);
+
       int             dec_fact;
-      T               *p_Z;
       int             taps;
+      size_t          win_len;
+      float           gain;
       vector<float>   set_coeff;
       vector<float>   coeff;
+      vector<T>       hist;
+
+      void updateCoeff(void)
+      {
+          // Reverse the coefficients, to match the chronological delay line,
+          // and repeat each one for every float component of a sample
+        coeff.assign(win_len * FLOATS, 0.0f);
+        for (int tap=0; tap<taps; ++tap)
+        {
+          for (size_t f=0; f<FLOATS; ++f)
+          {
+            coeff[(win_len - 1 - tap) * FLOATS + f] = gain * set_coeff[tap];
+          }
+        }
+      }
+
+      static void load(float *dst, const float *src, size_t cnt, Nco *nco)
+      {
+        assert(nco == 0);
+        copy(src, src + cnt, dst);
+      }
+
+      static void load(complex<float> *dst, const complex<float> *src,
+                       size_t cnt, Nco *nco)
+      {
+        if (nco != 0)
+        {
+          nco->mix(dst, src, cnt);
+        }
+        else
+        {
+          copy(src, src + cnt, dst);
+        }
+      }
+
+      static void reduce(float &out, const float *sum)
+      {
+        out = ((sum[0] + sum[1]) + (sum[2] + sum[3])) +
+              ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      }
+
+      static void reduce(complex<float> &out, const float *sum)
+      {
+        out = complex<float>((sum[0] + sum[2]) + (sum[4] + sum[6]),
+                             (sum[1] + sum[3]) + (sum[5] + sum[7]));
+      }
   };
 
   template <class T>
@@ -192,7 +381,8 @@ namespace {
       virtual ~DecimatorMS(void) {}
       virtual void setGain(float new_gain) = 0;
       virtual int decFact(void) const = 0;
-      virtual void decimate(vector<T> &out, const vector<T> &in) = 0;
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0) = 0;
   };
 
   template <class T>
@@ -205,13 +395,14 @@ namespace {
         gain = pow(10.0, gain_db / 20.0);
       }
       virtual int decFact(void) const { return 1; }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        out.clear();
-        out.reserve(in.size());
+        assert(nco == 0);
+        out.resize(in.size());
         for (size_t i=0; i<in.size(); ++i)
         {
-          out.push_back(gain * in[i]);
+          out[i] = gain * in[i];
         }
       }
 
@@ -226,9 +417,10 @@ namespace {
       DecimatorMS1(Decimator<T> &d1) : d1(d1) {}
       virtual void setGain(float gain_db) { d1.setGain(gain_db); }
       virtual int decFact(void) const { return d1.decFact(); }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        d1.decimate(out, in);
+        d1.decimate(out, in, nco);
       }
 
     private:
@@ -242,15 +434,16 @@ namespace {
       DecimatorMS2(Decimator<T> &d1, Decimator<T> &d2) : d1(d1), d2(d2) {}
       virtual void setGain(float gain_db) { d2.setGain(gain_db); }
       virtual int decFact(void) const { return d1.decFact() * d2.decFact(); }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        vector<T> dec_samp1;
-        d1.decimate(dec_samp1, in);
+        d1.decimate(dec_samp1, in, nco);
         d2.decimate(out, dec_samp1);
       }
 
     private:
       Decimator<T> &d1, &d2;
+      vector<T> dec_samp1;
   };
 
   template <class T>
@@ -264,16 +457,17 @@ namespace {
       {
         return d1.decFact() * d2.decFact() * d3.decFact();
       }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        vector<T> dec_samp1, dec_samp2;
-        d1.decimate(dec_samp1, in);
+        d1.decimate(dec_samp1, in, nco);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(out, dec_samp2);
       }
 
     private:
       Decimator<T> &d1, &d2, &d3;
+      vector<T> dec_samp1, dec_samp2;
   };
 
   template <class T>
@@ -288,10 +482,10 @@ namespace {
       {
         return d1.decFact() * d2.decFact() * d3.decFact() * d4.decFact();
       }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        vector<T> dec_samp1, dec_samp2, dec_samp3;
-        d1.decimate(dec_samp1, in);
+        d1.decimate(dec_samp1, in, nco);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(dec_samp3, dec_samp2);
         d4.decimate(out, dec_samp3);
@@ -299,6 +493,7 @@ namespace {
 
     private:
       Decimator<T> &d1, &d2, &d3, &d4;
+      vector<T> dec_samp1, dec_samp2, dec_samp3;
   };
 
   template <class T>
@@ -314,10 +509,10 @@ namespace {
         return d1.decFact() * d2.decFact() * d3.decFact() *
                d4.decFact() * d5.decFact();
       }
-      virtual void decimate(vector<T> &out, const vector<T> &in)
+      virtual void decimate(vector<T> &out, const vector<T> &in,
+                            Nco *nco=0)
       {
-        vector<T> dec_samp1, dec_samp2, dec_samp3, dec_samp4;
-        d1.decimate(dec_samp1, in);
+        d1.decimate(dec_samp1, in, nco);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(dec_samp3, dec_samp2);
         d4.decimate(dec_samp4, dec_samp3);
@@ -326,6 +521,7 @@ namespace {
 
     private:
       Decimator<T> &d1, &d2, &d3, &d4, &d5;
+      vector<T> dec_samp1, dec_samp2, dec_samp3, dec_samp4;
   };
 
 
@@ -361,12 +557,14 @@ namespace {
       {
         if (exp_lut.size() > 0)
         {
-          out.clear();
-          out.reserve(in.size());
-          vector<WbRxRtlSdr::Sample>::const_iterator it;
-          for (it = in.begin(); it != in.end(); ++it)
+          out.resize(in.size());
+          for (size_t idx=0; idx<in.size(); ++idx)
           {
-            out.push_back(*it * exp_lut[n]);
+            const WbRxRtlSdr::Sample &samp = in[idx];
+            const complex<float> &e = exp_lut[n];
+            out[idx] = WbRxRtlSdr::Sample(
+                samp.real() * e.real() - samp.imag() * e.imag(),
+                samp.real() * e.imag() + samp.imag() * e.real());
             if (++n == exp_lut.size())
             {
               n = 0;
@@ -379,6 +577,36 @@ namespace {
         }
       }
 
+        /**
+         * @brief Translate the signal and only keep the real part
+         * @param out The real part of the translated signal
+         * @param in The signal to translate
+         */
+      void mixReal(vector<float> &out, const vector<WbRxRtlSdr::Sample> &in)
+      {
+        out.resize(in.size());
+        if (exp_lut.size() > 0)
+        {
+          for (size_t idx=0; idx<in.size(); ++idx)
+          {
+            const WbRxRtlSdr::Sample &samp = in[idx];
+            const complex<float> &e = exp_lut[n];
+            out[idx] = samp.real() * e.real() - samp.imag() * e.imag();
+            if (++n == exp_lut.size())
+            {
+              n = 0;
+            }
+          }
+        }
+        else
+        {
+          for (size_t idx=0; idx<in.size(); ++idx)
+          {
+            out[idx] = in[idx].real();
+          }
+        }
+      }
+
     private:
       unsigned samp_rate;
       vector<complex<float> > exp_lut;
@@ -423,17 +651,14 @@ namespace {
       void iq_received(vector<WbRxRtlSdr::Sample> &out,
                        const vector<WbRxRtlSdr::Sample> &in)
       {
-        out.clear();
-        out.reserve(in.size());
+        out.resize(in.size());
         float P = 0.0f;
-        for (vector<WbRxRtlSdr::Sample>::const_iterator it = in.begin();
-             it != in.end();
-             ++it)
+        for (size_t idx=0; idx<in.size(); ++idx)
         {
-          const WbRxRtlSdr::Sample &samp = *it;
+          const WbRxRtlSdr::Sample &samp = in[idx];
           WbRxRtlSdr::Sample osamp = m_gain * samp;
           P = osamp.real() * osamp.real() + osamp.imag() * osamp.imag();
-          out.push_back(osamp);
+          out[idx] = osamp;
 
           float err = m_reference - P;
           float rate;
@@ -473,7 +698,8 @@ namespace {
     public:
       virtual ~Demodulator(void) {}
 
-      virtual void iq_received(vector<WbRxRtlSdr::Sample> samples) = 0;
+      virtual void iq_received(
+          const vector<WbRxRtlSdr::Sample> &samples) = 0;
 
       /**
        * @brief Resume audio output to the sink
@@ -553,7 +779,7 @@ namespace {
         dec->setGain(adj_db);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
           // From article-sdr-is-qs.pdf: Watch your Is and Qs:
           //   FM = (Qn.In-1 - In.Qn-1)/(In.In-1 + Qn.Qn-1)
@@ -561,24 +787,30 @@ namespace {
           // A more indepth report:
           //   Implementation of FM demodulator algorithms on a
           //   high performance digital signal processor
-        vector<float> audio;
-        for (size_t idx=0; idx<samples.size(); ++idx)
+          //
+          // The angle between two consecutive samples does not depend on
+          // the amplitude so the samples do not need to be normalized. Each
+          // output sample only depend on the input samples which make the
+          // loop vectorizable.
+        const size_t cnt = samples.size();
+        if (cnt == 0)
         {
-          complex<float> samp = samples[idx];
-
-            // Normalize signal amplitude
-          samp = samp / abs(samp);
-
-            // Mixed demodulator (delay demodulator + phase adapter demodulator)
-          float i = samp.real();
-          float q = samp.imag();
-          double demod = atan2(q*iold - i*qold, i*iold + q*qold);
-          iold = i;
-          qold = q;
-
-          audio.push_back(demod);
+          return;
+        }
+        const float *s = reinterpret_cast<const float*>(&samples[0]);
+        audio.resize(cnt);
+        audio[0] = fastAtan2(s[1]*iold - s[0]*qold, s[0]*iold + s[1]*qold);
+        for (size_t idx=1; idx<cnt; ++idx)
+        {
+          const float i = s[2*idx];
+          const float q = s[2*idx+1];
+          const float ip = s[2*idx-2];
+          const float qp = s[2*idx-1];
+          audio[idx] = fastAtan2(q*ip - i*qp, i*ip + q*qp);
         }
-        vector<float> dec_audio;
+        iold = s[2*cnt-2];
+        qold = s[2*cnt-1];
+
         dec->decimate(dec_audio, audio);
         sinkWriteSamples(&dec_audio[0], dec_audio.size());
       }
@@ -589,6 +821,8 @@ namespace {
       Decimator<float> audio_dec_wb;
       Decimator<float> audio_dec;
       DecimatorMS<float> *dec;
+      vector<float> audio;
+      vector<float> dec_audio;
   };
 
 
@@ -602,23 +836,31 @@ namespace {
         agc.setReference(1);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
+        if (samples.empty())
+        {
+          return;
+        }
         agc.iq_received(gain_adjusted, samples);
 
-        vector<float> audio;
-        for (size_t idx=0; idx<gain_adjusted.size(); ++idx)
+          // Calculate the envelope without calling abs(), which use hypot
+          // and thus can not be vectorized
+        const float *s = reinterpret_cast<const float*>(&gain_adjusted[0]);
+        audio.resize(gain_adjusted.size());
+        for (size_t idx=0; idx<audio.size(); ++idx)
         {
-          complex<float> samp = gain_adjusted[idx];
-          float demod = abs(samp);
-          audio.push_back(demod);
+          const float i = s[2*idx];
+          const float q = s[2*idx+1];
+          audio[idx] = sqrtf(i*i + q*q);
         }
         sinkWriteSamples(&audio[0], audio.size());
       }
 
     private:
-      AGC              agc;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<float>               audio;
   };
 
 
@@ -639,7 +881,7 @@ namespace {
         use_lsb = use;
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
         vector<float> Q, Qh, audio;
         Q.reserve(samples.size());
@@ -690,29 +932,18 @@ namespace {
         trans.setOffset(lsb ? 2000 : -2000);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
-
-        vector<WbRxRtlSdr::Sample> translated;
-        trans.iq_received(translated, gain_adjusted);
-
-        vector<float> audio;
-        audio.reserve(gain_adjusted.size());
-        for (vector<WbRxRtlSdr::Sample>::const_iterator it = translated.begin();
-             it != translated.end();
-             ++it)
-        {
-          float demod = it->real();
-          audio.push_back(demod);
-        }
+        trans.mixReal(audio, gain_adjusted);
         sinkWriteSamples(&audio[0], audio.size());
       }
 
     private:
-      Translate         trans;
-      AGC               agc;
+      Translate                   trans;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<float>               audio;
   };
 #endif
 
@@ -728,28 +959,18 @@ namespace {
         agc.setReference(0.05);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
-
-        vector<WbRxRtlSdr::Sample> translated;
-        trans.iq_received(translated, gain_adjusted);
-        vector<float> audio;
-        audio.reserve(translated.size());
-        for (vector<WbRxRtlSdr::Sample>::const_iterator it = translated.begin();
-             it != translated.end();
-             ++it)
-        {
-          float demod = it->real();
-          audio.push_back(demod);
-        }
+        trans.mixReal(audio, gain_adjusted);
         sinkWriteSamples(&audio[0], audio.size());
       }
 
     private:
-      Translate         trans;
-      AGC               agc;
+      Translate                   trans;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<float>               audio;
   };
 
 
@@ -765,7 +986,8 @@ namespace {
       virtual void setBw(Bandwidth bw) = 0;
       virtual unsigned chSampRate(void) const = 0;
       virtual void iq_received(vector<WbRxRtlSdr::Sample> &out,
-                               const vector<WbRxRtlSdr::Sample> &in) = 0;
+                               const vector<WbRxRtlSdr::Sample> &in,
+                               Nco *nco) = 0;
 
       sigc::signal<void, const std::vector<RtlTcp::Sample>&> preDemod;
   };
@@ -843,9 +1065,10 @@ namespace {
       }
 
       virtual void iq_received(vector<WbRxRtlSdr::Sample> &out,
-                               const vector<WbRxRtlSdr::Sample> &in)
+                               const vector<WbRxRtlSdr::Sample> &in,
+                               Nco *nco)
       {
-        dec->decimate(out, in);
+        dec->decimate(out, in, nco);
         preDemod(out);
       }
 
@@ -941,9 +1164,10 @@ namespace {
       }
 
       virtual void iq_received(vector<WbRxRtlSdr::Sample> &out,
-                               const vector<WbRxRtlSdr::Sample> &in)
+                               const vector<WbRxRtlSdr::Sample> &in,
+                               Nco *nco)
       {
-        dec->decimate(out, in);
+        dec->decimate(out, in, nco);
         preDemod(out);
       }
 
@@ -969,7 +1193,7 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
     Channel(int fq_offset, unsigned sample_rate)
       : sample_rate(sample_rate), channelizer(0),
         fm_demod(32000, 5000.0), ssb_demod(16000), cw_demod(16000), demod(0),
-        trans(sample_rate, fq_offset), enabled(true), ch_offset(0),
+        nco(sample_rate, fq_offset), enabled(true), ch_offset(0),
         fq_offset(fq_offset)
     {
     }
@@ -1003,7 +1227,7 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
     void setFqOffset(int fq_offset)
     {
       this->fq_offset = fq_offset;
-      trans.setOffset(fq_offset - ch_offset);
+      nco.setOffset(fq_offset - ch_offset);
     }
 
     void setModulation(Modulation::Type mod)
@@ -1076,13 +1300,13 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
       return channelizer->chSampRate();
     }
 
-    void iq_received(vector<WbRxRtlSdr::Sample> samples)
+    void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
     {
       if (enabled)
       {
-        vector<WbRxRtlSdr::Sample> translated, channelized;
-        trans.iq_received(translated, samples);
-        channelizer->iq_received(channelized, translated);
+          // The frequency translation is done by the first decimation stage
+          // in the channelizer while loading its delay line
+        channelizer->iq_received(channelized, samples, &nco);
         demod->iq_received(channelized);
       }
     };
@@ -1109,7 +1333,8 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
     DemodulatorSsb ssb_demod;
     DemodulatorCw cw_demod;
     Demodulator *demod;
-    Translate trans;
+    Nco nco;
+    vector<WbRxRtlSdr::Sample> channelized;
     bool enabled;
     int ch_offset;
     int fq_offset;
@@ -0,0 +1,184 @@
+/**
+@file	 DdrBench.cpp
+@brief   Benchmark the Digital Drop Receiver (DDR) using recorded IQ samples
+@author  agent
+@date	 2026-10-18
+
+Usage: DdrBench <iq file> <sample rate> <center fq> <channels> [modulation]
+
+The IQ file is replayed as fast as possible through an RtlFile wideband
+receiver. The given number of Ddr receivers are spread out over the
+spectrum and the throughput per channel and per core is reported when the end
+of the file is reached. An IQ file can be recorded using the CAPTURE_FILE
+configuration variable in a WBRX section or using the rtl_sdr utility.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+
+#include "Rx.h"
+#include "WbRxRtlSdr.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  const char *WBRX_NAME = "WbRx";
+
+  CppApplication *app = 0;
+  WbRxRtlSdr *wbrx = 0;
+  uint64_t samp_cnt = 0;
+
+  double cpuTime(void)
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1.0e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1.0e6;
+  }
+
+  double wallTime(void)
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+  }
+
+  void iqReceived(const vector<WbRxRtlSdr::Sample> &samples)
+  {
+    samp_cnt += samples.size();
+  }
+
+  void wbrxReadyStateChanged(void)
+  {
+    if (!wbrx->isReady())
+    {
+      app->quit();
+    }
+  }
+};
+
+
+int main(int argc, char **argv)
+{
+  if (argc < 5)
+  {
+    cerr << "Usage: DdrBench <iq file> <sample rate> <center fq> "
+            "<channels> [modulation]\n";
+    exit(1);
+  }
+  string iq_file(argv[1]);
+  unsigned sample_rate = atoi(argv[2]);
+  unsigned center_fq = atoi(argv[3]);
+  unsigned ch_cnt = atoi(argv[4]);
+  string modulation((argc > 5) ? argv[5] : "FM");
+  if ((sample_rate == 0) || (center_fq == 0) || (ch_cnt == 0))
+  {
+    cerr << "*** ERROR: Illegal arguments\n";
+    exit(1);
+  }
+
+  CppApplication the_app;
+  app = &the_app;
+
+  Config cfg;
+  cfg.setValue(WBRX_NAME, "TYPE", "RtlFile");
+  cfg.setValue(WBRX_NAME, "FILE", iq_file);
+  cfg.setValue(WBRX_NAME, "REALTIME", "0");
+  cfg.setValue(WBRX_NAME, "SAMPLE_RATE", sample_rate);
+  cfg.setValue(WBRX_NAME, "CENTER_FQ", center_fq);
+
+    // Spread the channels evenly over the usable part of the spectrum,
+    // avoiding the center frequency
+  const int usable_bw = sample_rate - 2 * 12500 - 25000;
+  vector<Rx*> rxs;
+  for (unsigned i=0; i<ch_cnt; ++i)
+  {
+    ostringstream name;
+    name << "Ddr" << (i + 1);
+    int offset = -usable_bw / 2 + (i + 1) * usable_bw / (ch_cnt + 1);
+    offset += (offset < 0) ? -12500 : 12500;
+    cfg.setValue(name.str(), "TYPE", "Ddr");
+    cfg.setValue(name.str(), "WBRX", WBRX_NAME);
+    cfg.setValue(name.str(), "FQ", center_fq + offset);
+    cfg.setValue(name.str(), "MODULATION", modulation);
+    cfg.setValue(name.str(), "SQL_DET", "OPEN");
+
+    Rx *rx = RxFactory::createNamedRx(cfg, name.str());
+    if ((rx == 0) || !rx->initialize())
+    {
+      cerr << "*** ERROR: Could not initialize receiver " << name.str()
+           << endl;
+      exit(1);
+    }
+    rx->setMuteState(Rx::MUTE_NONE);
+    rxs.push_back(rx);
+  }
+
+  wbrx = WbRxRtlSdr::instance(cfg, WBRX_NAME);
+  if (!wbrx->isReady())
+  {
+    exit(1);
+  }
+  wbrx->iqReceived.connect(sigc::ptr_fun(iqReceived));
+  wbrx->readyStateChanged.connect(sigc::ptr_fun(wbrxReadyStateChanged));
+
+  double start_cpu = cpuTime();
+  double start_wall = wallTime();
+  app->exec();
+  double cpu = cpuTime() - start_cpu;
+  double wall = wallTime() - start_wall;
+
+  double audio = static_cast<double>(samp_cnt) / sample_rate;
+  cout << "Channels            : " << ch_cnt << " (" << modulation << ")\n";
+  cout << "Samples replayed    : " << samp_cnt << " (" << audio << "s)\n";
+  cout << "Wall time           : " << wall << "s\n";
+  cout << "CPU time            : " << cpu << "s\n";
+  if ((cpu > 0.0) && (audio > 0.0))
+  {
+      // The wideband rate is the number of wideband samples that one core
+      // can handle with all channels active. The channel rate is the number
+      // of wideband samples that one core can handle for a single channel.
+    cout << "Wideband samples/s  : " << samp_cnt / cpu << " per core\n";
+    cout << "Samples/s/channel   : " << samp_cnt * ch_cnt / cpu
+         << " per core\n";
+    cout << "Realtime channels   : " << ch_cnt * audio / cpu << " per core\n";
+  }
+
+  for (vector<Rx*>::iterator it=rxs.begin(); it!=rxs.end(); ++it)
+  {
+    delete *it;
+  }
+
+  return 0;
+}
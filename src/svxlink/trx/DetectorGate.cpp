@@ -0,0 +1,297 @@
+/**
+@file	 DetectorGate.cpp
+@brief   Suspend audio detectors while the squelch is closed
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "DetectorGate.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define BLOCK_SIZE  256
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+DetectorGate::DetectorGate(unsigned lookback_ms, unsigned flush_ms)
+  : lookback(lookback_ms * INTERNAL_SAMPLE_RATE / 1000),
+    lookback_head(0), lookback_cnt(0),
+    flush_len(flush_ms * INTERNAL_SAMPLE_RATE / 1000), is_open(false),
+    is_flushing(false)
+{
+} /* DetectorGate::DetectorGate */
+
+
+DetectorGate::~DetectorGate(void)
+{
+} /* DetectorGate::~DetectorGate */
+
+
+void DetectorGate::setOpen(bool do_open)
+{
+  if (do_open == is_open)
+  {
+    return;
+  }
+  is_open = do_open;
+
+  if (is_open)
+  {
+    writeLookback();
+  }
+  else
+  {
+    writeSilence();
+    lookback_head = 0;
+    lookback_cnt = 0;
+    if (is_flushing)
+    {
+      is_flushing = false;
+      sourceAllSamplesFlushed();
+    }
+  }
+} /* DetectorGate::setOpen */
+
+
+void DetectorGate::clear(void)
+{
+  lookback_head = 0;
+  lookback_cnt = 0;
+} /* DetectorGate::clear */
+
+
+int DetectorGate::writeSamples(const float *samples, int count)
+{
+  is_flushing = false;
+
+  if (is_open)
+  {
+      // The look-back audio must reach the sink before any live audio
+    if (!writeLookback())
+    {
+      return 0;
+    }
+    return sinkWriteSamples(samples, count);
+  }
+
+  if (lookback.empty())
+  {
+    return count;
+  }
+
+    // Only the last part of a large block can end up in the buffer
+  const float *src = samples;
+  size_t len = count;
+  if (len > lookback.size())
+  {
+    src += len - lookback.size();
+    len = lookback.size();
+  }
+  while (len > 0)
+  {
+    size_t chunk = min(len, lookback.size() - lookback_head);
+    copy(src, src + chunk, lookback.begin() + lookback_head);
+    lookback_head = (lookback_head + chunk) % lookback.size();
+    src += chunk;
+    len -= chunk;
+  }
+  lookback_cnt = min(lookback_cnt + count, lookback.size());
+
+  return count;
+} /* DetectorGate::writeSamples */
+
+
+void DetectorGate::flushSamples(void)
+{
+  if (is_open)
+  {
+    is_flushing = true;
+    if (lookback_cnt == 0)
+    {
+      sinkFlushSamples();
+    }
+  }
+  else
+  {
+    sourceAllSamplesFlushed();
+  }
+} /* DetectorGate::flushSamples */
+
+
+void DetectorGate::resumeOutput(void)
+{
+  if (is_open && (lookback_cnt > 0))
+  {
+    if (!writeLookback())
+    {
+      return;
+    }
+    if (is_flushing)
+    {
+      sinkFlushSamples();
+      return;
+    }
+  }
+  sourceResumeOutput();
+} /* DetectorGate::resumeOutput */
+
+
+void DetectorGate::allSamplesFlushed(void)
+{
+  if (is_flushing)
+  {
+    is_flushing = false;
+    sourceAllSamplesFlushed();
+  }
+} /* DetectorGate::allSamplesFlushed */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+bool DetectorGate::writeLookback(void)
+{
+  while (lookback_cnt > 0)
+  {
+      // The oldest sample is located lookback_cnt samples behind the head
+    size_t pos = (lookback_head + lookback.size() - lookback_cnt) %
+                 lookback.size();
+    size_t chunk = min(lookback_cnt, lookback.size() - pos);
+    int written = sinkWriteSamples(&lookback[pos], chunk);
+    if (written <= 0)
+    {
+      return false;
+    }
+    lookback_cnt -= written;
+  }
+  lookback_head = 0;
+  return true;
+} /* DetectorGate::writeLookback */
+
+
+void DetectorGate::writeSilence(void)
+{
+  float silence[BLOCK_SIZE];
+  fill(silence, silence + BLOCK_SIZE, 0.0f);
+  size_t len = flush_len;
+  while (len > 0)
+  {
+    size_t chunk = min(len, static_cast<size_t>(BLOCK_SIZE));
+    sinkWriteSamples(silence, chunk);
+    len -= chunk;
+  }
+} /* DetectorGate::writeSilence */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,216 @@
+/**
+@file	 DetectorGate.h
+@brief   Suspend audio detectors while the squelch is closed
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef DETECTOR_GATE_INCLUDED
+#define DETECTOR_GATE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Suspend audio detectors while the squelch is closed
+@author agent
+@date   2026-10-18
+
+This class is used in front of detectors (DTMF, selcall, tone, AFSK...) that
+do not need any audio while the squelch is closed. When the gate is closed
+no audio is passed on, so the detectors behind it use no CPU. The most
+recent audio is kept in a look-back buffer though. When the gate is opened,
+the look-back buffer is written to the detectors before the live audio so
+that a tone that caused the squelch to open is not lost.
+
+When the gate is closed, a short block of silence is written to the
+detectors. This make sure that all detectors have returned to their idle
+state, e.g. that an active DTMF digit is reported as released, before they
+are suspended. Since the detectors see silence, followed by the look-back
+audio, when the gate is opened, they always start from a well defined state.
+
+The detectors must always accept all samples written to them when the gate is
+closed, since the silence written is not buffered. When the gate is open, the
+flow control of the sink is honored. If the sink does not accept all of the
+look-back audio, the rest is kept in the buffer and written when the sink
+resume output. No live audio is accepted until the look-back buffer has been
+emptied.
+
+The gate is also useful as a cheap pre-roll buffer in front of an audio path
+that is only engaged now and then, like the satellite receivers in the voter.
+Use a zero flush length in that case.
+*/
+class DetectorGate : public Async::AudioSink, public Async::AudioSource
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param   lookback_ms The length of the look-back buffer in milliseconds
+     * @param   flush_ms The length of silence to write when closing
+     */
+    DetectorGate(unsigned lookback_ms, unsigned flush_ms=100);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~DetectorGate(void);
+
+    /**
+     * @brief 	Open or close the gate
+     * @param 	do_open Set to \em true to open the gate
+     */
+    void setOpen(bool do_open);
+
+    /**
+     * @brief   Check if the gate is open
+     * @return  Returns \em true if the gate is open
+     */
+    bool isOpen(void) const { return is_open; }
+
+    /**
+     * @brief   Discard all audio in the look-back buffer
+     */
+    void clear(void);
+
+    /**
+     * @brief 	Write samples into the gate
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief 	Tell the gate to flush the previously written samples
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief Resume audio output to the sink
+     */
+    virtual void resumeOutput(void);
+
+    /**
+     * @brief The registered sink has flushed all samples
+     */
+    virtual void allSamplesFlushed(void);
+
+  protected:
+
+  private:
+    std::vector<float>  lookback;
+    size_t              lookback_head;
+    size_t              lookback_cnt;
+    unsigned            flush_len;
+    bool                is_open;
+    bool                is_flushing;
+
+    DetectorGate(const DetectorGate&);
+    DetectorGate& operator=(const DetectorGate&);
+    bool writeLookback(void);
+    void writeSilence(void);
+
+};  /* class DetectorGate */
+
+
+//} /* namespace */
+
+#endif /* DETECTOR_GATE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -134,6 +134,31 @@ class DtmfDecoder : public sigc::trackable, public Async::AudioSink
      * before using it.
      */
     virtual bool initialize(void);
+
+    /**
+     * @brief   Set the sample rate of the audio fed to the decoder
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the decoder can handle the given rate
+     *
+     * All decoders can handle audio at the internal sample rate. Some
+     * decoders can also handle audio at a lower sample rate, which save CPU
+     * time. This function must be called before the initialize function.
+     */
+    bool setSampleRate(unsigned rate)
+    {
+      if (!sampleRateSupported(rate))
+      {
+        return false;
+      }
+      m_sample_rate = rate;
+      return true;
+    }
+
+    /**
+     * @brief   Get the sample rate of the audio fed to the decoder
+     * @returns Returns the sample rate in Hz
+     */
+    unsigned sampleRate(void) const { return m_sample_rate; }
     
     /**
      * @brief 	Find out what the configured hangtime is
@@ -182,10 +207,24 @@ class DtmfDecoder : public sigc::trackable, public Async::AudioSink
      * DtmfDecoder objects are created by calling DtmfDecoder::create.
      */
     DtmfDecoder(Async::Config &cfg, const std::string &name)
-      : m_cfg(cfg), m_name(name), m_hangtime(DEFAULT_HANGTIME) {}
+      : m_cfg(cfg), m_name(name), m_hangtime(DEFAULT_HANGTIME),
+        m_sample_rate(INTERNAL_SAMPLE_RATE) {}
     
     Async::Config &cfg(void) { return m_cfg; }
     const std::string &name(void) const { return m_name; }
+
+    /**
+     * @brief   Check if the decoder can handle the given sample rate
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the sample rate is supported
+     *
+     * Reimplement this function in decoders that can handle other sample
+     * rates than the internal sample rate.
+     */
+    virtual bool sampleRateSupported(unsigned rate) const
+    {
+      return rate == INTERNAL_SAMPLE_RATE;
+    }
     
     
   private:
@@ -194,6 +233,7 @@ class DtmfDecoder : public sigc::trackable, public Async::AudioSink
     Async::Config&  m_cfg;
     std::string     m_name;
     unsigned   	    m_hangtime;
+    unsigned        m_sample_rate;
     
 };  /* class DtmfDecoder */
 
@@ -1,283 +1,641 @@
+/*
+ * Accuracy and throughput test bench for the software DTMF decoders
+ *
+ * Usage: DtmfDecoderTest [--decoder <type>]... [--rate <Hz>] [--digits <n>]
+ *                        [--talkoff <file>]... [--talkoff-time <s>] [--debug]
+ *
+ * Test vectors in the style of the ETSI ES 201 235-3 and Bellcore
+ * GR-181-CORE receiver tests are synthesized with a fixed seed: nominal
+ * digits, level, twist, frequency offset, tone duration, inter digit pause and
+ * white noise. Conditions marked "detect" must be detected and conditions
+ * marked "reject" must not. Talk-off is measured using synthetic speech and
+ * optionally using recorded speech in raw 16 bit files at the internal sample
+ * rate. All audio is passed through a voiceband filter and is decimated in
+ * the same way as in the receiver when a lower sample rate is selected.
+ *
+ * The decoders are fed as fast as possible and the CPU time spent in the
+ * decoder, as measured by the thread CPU clock, is reported per second of
+ * audio. The default is to test all
+ * software decoders, INTERNAL and DH1DM.
+ */
+
 #include <iostream>
+#include <iomanip>
 #include <string>
+#include <vector>
 #include <fstream>
+#include <random>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
+#include <time.h>
 
 #include <AsyncConfig.h>
-#include <AsyncAudioNoiseAdder.h>
+#include <AsyncAudioSource.h>
+#include <AsyncAudioSink.h>
 #include <AsyncAudioFilter.h>
-#include <AsyncAudioPassthrough.h>
-#include <CppStdCompat.h>
+#include <AsyncAudioDecimator.h>
+#include <AsyncBench.h>
 
 #include "DtmfDecoder.h"
 #include "DtmfEncoder.h"
+#include "multirate_filter_coeff.h"
 
 using namespace std;
 using namespace Async;
 
 
-class FileWriter : public Async::AudioProcessor
-{
-  public:
-    FileWriter(const string &path)
-      : samppos(0)
-    {
-      ofs.open(path.c_str(), ios::out | ios::binary);
-      if (ofs.fail())
-      {
-        cout << "Could not open output file: " << path << endl;
-        exit(1);
-      }
-    }
+namespace {
 
-    ~FileWriter(void)
-    {
-      ofs.close();
-    }
+  // The voiceband filter used for all test signals and its bandwidth
+const char *VOICEBAND_FILTER = "BpCh10/-0.1/300-5000";
+const float VOICEBAND_BW = 4700.0f;
 
-    int sampPos(void) { return samppos; }
+  // The acceptance criteria, in percent, for detect and reject conditions
+const float MIN_DETECT_RATE = 99.0f;
+const float MAX_FALSE_RATE = 1.0f;
 
-  protected:
-    void processSamples(float *dest, const float *src, int count)
-    {
-      ofs.write(reinterpret_cast<const char*>(src), count * sizeof(*src));
-      for (int i=0; i<count; ++i)
-      {
-        dest[i] = src[i];
-      }
-      samppos += count;
-    }
+  // Silence before the first digit in each test vector
+const unsigned LEAD_IN_MS = 200;
 
-  private:
-    ofstream ofs;
-    int samppos;
+struct Condition
+{
+  const char *name;
+  bool        detect;
+  unsigned    tone_ms;
+  unsigned    pause_ms;
+  float       level_db;       // Low group tone level in dBFS
+  float       twist_db;       // High group level relative to the low group
+  float       offset_pct;     // Frequency offset for both tones
+  float       snr_db;         // SNR in the voiceband, relative to one tone
 };
 
+const float NO_NOISE = 1000.0f;
 
-namespace {
-string send_digits = "00112233445566778899AABBCCDD**##";
-//string send_digits = "0123456789ABCD*#";
-//string send_digits = "1";
-string received_digits;
-FileWriter *fwriter = 0;
+const Condition CONDITIONS[] =
+{
+  { "nominal",              true,  50, 50, -16.0f,   0.0f,  0.0f, NO_NOISE },
+  { "level -6dBFS",         true,  50, 50,  -6.0f,   0.0f,  0.0f, NO_NOISE },
+  { "level -36dBFS",        true,  50, 50, -36.0f,   0.0f,  0.0f, NO_NOISE },
+  { "twist +4dB",           true,  50, 50, -18.0f,   4.0f,  0.0f, NO_NOISE },
+  { "twist -4dB",           true,  50, 50, -16.0f,  -4.0f,  0.0f, NO_NOISE },
+  { "twist -8dB",           true,  50, 50, -16.0f,  -8.0f,  0.0f, NO_NOISE },
+  { "freq offset +1.5%",    true, 100, 50, -16.0f,   0.0f,  1.5f, NO_NOISE },
+  { "freq offset -1.5%",    true, 100, 50, -16.0f,   0.0f, -1.5f, NO_NOISE },
+  { "freq offset +3.5%",    false, 50, 50, -16.0f,   0.0f,  3.5f, NO_NOISE },
+  { "freq offset -3.5%",    false, 50, 50, -16.0f,   0.0f, -3.5f, NO_NOISE },
+  { "duration 40ms",        true,  40, 60, -16.0f,   0.0f,  0.0f, NO_NOISE },
+  { "duration 20ms",        false, 20, 80, -16.0f,   0.0f,  0.0f, NO_NOISE },
+  { "pause 40ms",           true,  50, 40, -16.0f,   0.0f,  0.0f, NO_NOISE },
+  { "snr 18dB",             true,  50, 50, -16.0f,   0.0f,  0.0f,    18.0f },
+  { "snr 12dB",             true,  50, 50, -16.0f,   0.0f,  0.0f,    12.0f },
+};
+const size_t CONDITION_CNT = sizeof(CONDITIONS) / sizeof(*CONDITIONS);
 
-void digit_detected(char ch, int duration)
+struct Vector
 {
-  cout << " pos=" << fwriter->sampPos()
-       << " (" << (static_cast<float>(fwriter->sampPos()) / (60*16000)) << "m)";
-  cout << endl;
-  /*
-  cout << " digit=" << ch
-       << " duration=" << duration << endl;
-  */
-  received_digits += ch;
-}
+  string          name;
+  bool            detect;
+  vector<float>   samples;
+  vector<char>    digits;     // Empty for talk-off vectors
+  unsigned        slot_len;   // In samples at the decoder sample rate
+  unsigned        lead_in;    // In samples at the decoder sample rate
 };
 
+struct Score
+{
+  unsigned  sent;
+  unsigned  detected;
+  unsigned  wrong;
+  unsigned  extra;
+
+  Score(void) : sent(0), detected(0), wrong(0), extra(0) {}
+};
 
-class FileReader : public AudioSource
+
+  /*
+   * Push a buffer through an audio processor and return its output
+   */
+vector<float> process(AudioProcessor *proc, const vector<float>& samples)
 {
-  public:
-    FileReader(void)
+  vector<float> output;
+  Bench::Source src;
+  Bench::Sink sink;
+  sink.received.connect(
+      [&output](const float *buf, int count)
+      {
+        output.insert(output.end(), buf, buf + count);
+      });
+  src.registerSink(proc);
+  proc->registerSink(&sink);
+  size_t pos = 0;
+  while (pos < samples.size())
+  {
+    const int count = min(static_cast<size_t>(320), samples.size() - pos);
+    const int written = src.write(&samples[pos], count);
+    if (written <= 0)
     {
+      break;
     }
+    pos += written;
+  }
+  src.unregisterSink();
+  proc->unregisterSink();
+  return output;
+}
+
+
+  /*
+   * Add white gaussian noise. The noise power is given relative to a sine
+   * with an amplitude of 1 and is measured in the voiceband only.
+   */
+void addNoise(vector<float>& samples, float power_db, mt19937& rng)
+{
+  float power = powf(10.0f, power_db / 10.0f) / 2.0f;
+  power *= (INTERNAL_SAMPLE_RATE / 2.0f) / VOICEBAND_BW;
+  normal_distribution<float> noise(0.0f, sqrtf(power));
+  for (size_t i=0; i<samples.size(); ++i)
+  {
+    samples[i] += noise(rng);
+  }
+}
+
+
+  /*
+   * Return the CPU time, in seconds, that has been used by this thread
+   */
+double threadCpuTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1.0e9;
+}
+
 
-    virtual ~FileReader(void)
+Vector dtmfVector(const Condition& cond, unsigned digit_cnt, mt19937& rng)
+{
+  const unsigned rate = INTERNAL_SAMPLE_RATE;
+  const unsigned tone_len = cond.tone_ms * rate / 1000;
+  const unsigned slot_len = (cond.tone_ms + cond.pause_ms) * rate / 1000;
+  const unsigned lead_in = LEAD_IN_MS * rate / 1000;
+  const float low_amp = powf(10.0f, cond.level_db / 20.0f);
+  const float high_amp = powf(10.0f, (cond.level_db + cond.twist_db) / 20.0f);
+  const float fq_factor = 1.0f + cond.offset_pct / 100.0f;
+
+  Vector vec;
+  vec.name = cond.name;
+  vec.detect = cond.detect;
+  vec.slot_len = slot_len;
+  vec.lead_in = lead_in;
+  vec.samples.assign(lead_in + digit_cnt * slot_len + lead_in, 0.0f);
+  uniform_real_distribution<double> phase_dist(0.0, 2.0 * M_PI);
+  for (unsigned d=0; d<digit_cnt; ++d)
+  {
+    const char digit = DtmfEncoder::DIGITS[d % strlen(DtmfEncoder::DIGITS)];
+    vec.digits.push_back(digit);
+    unsigned low_fq = 0, high_fq = 0;
+    DtmfEncoder::digitFrequencies(digit, low_fq, high_fq);
+    const double wl = 2.0 * M_PI * low_fq * fq_factor / rate;
+    const double wh = 2.0 * M_PI * high_fq * fq_factor / rate;
+    const double pl = phase_dist(rng);
+    const double ph = phase_dist(rng);
+    float *dest = &vec.samples[lead_in + d * slot_len];
+    for (unsigned i=0; i<tone_len; ++i)
     {
-      ifs.close();
+      dest[i] = low_amp * sin(wl * i + pl) + high_amp * sin(wh * i + ph);
     }
+  }
+  if (cond.snr_db < NO_NOISE)
+  {
+    addNoise(vec.samples, cond.level_db - cond.snr_db, rng);
+  }
+  return vec;
+}
 
-    bool open(const string &path)
+
+  /*
+   * Synthesize speech like audio. A pulse train with a varying fundamental
+   * frequency is passed through three formant resonators that move between
+   * vowel targets. The rich harmonic content is what cause talk-off in real
+   * speech.
+   */
+Vector speechVector(float duration_s, mt19937& rng)
+{
+  static const float VOWELS[][3] =
+  {
+    { 730, 1090, 2440 }, { 270, 2290, 3010 }, { 300, 870, 2240 },
+    { 530, 1840, 2480 }, { 570, 840, 2410 }, { 660, 1720, 2410 },
+    { 440, 1020, 2240 }, { 390, 1990, 2550 }
+  };
+  static const float BANDWIDTHS[3] = { 80.0f, 100.0f, 120.0f };
+  const size_t vowel_cnt = sizeof(VOWELS) / sizeof(*VOWELS);
+  const float rate = INTERNAL_SAMPLE_RATE;
+
+  Vector vec;
+  vec.name = "talk-off synthetic speech";
+  vec.detect = false;
+  vec.slot_len = 0;
+  vec.lead_in = 0;
+
+  uniform_real_distribution<float> uni(0.0f, 1.0f);
+  normal_distribution<float> gauss(0.0f, 1.0f);
+  const size_t total = static_cast<size_t>(duration_s * rate);
+  double y1[3] = { 0.0, 0.0, 0.0 };
+  double y2[3] = { 0.0, 0.0, 0.0 };
+  float phase = 0.0f;
+  float f0_base = 100.0f + 120.0f * uni(rng);
+  while (vec.samples.size() < total)
+  {
+    const size_t syllable_len = static_cast<size_t>(
+        (0.12f + 0.18f * uni(rng)) * rate);
+    const size_t gap_len = static_cast<size_t>(
+        (0.03f + 0.12f * uni(rng)) * rate);
+    const float *from = VOWELS[static_cast<size_t>(uni(rng) * vowel_cnt)];
+    const float *to = VOWELS[static_cast<size_t>(uni(rng) * vowel_cnt)];
+    const float f0_start = f0_base * (0.8f + 0.4f * uni(rng));
+    const float f0_end = f0_base * (0.8f + 0.4f * uni(rng));
+    const bool voiced = uni(rng) < 0.85f;
+    for (size_t i=0; i<syllable_len; ++i)
     {
-      ifs.open(path.c_str(), ios::in | ios::binary);
-      if (ifs.fail())
+      const float t = static_cast<float>(i) / syllable_len;
+      float excitation;
+      if (voiced)
+      {
+        const float f0 = f0_start + (f0_end - f0_start) * t;
+        phase += f0 / rate;
+        excitation = 0.0f;
+        if (phase >= 1.0f)
+        {
+          phase -= 1.0f;
+          excitation = 1.0f;
+        }
+      }
+      else
       {
-        cout << "Could not open input file: " << path << endl;
-        return false;
+        excitation = 0.1f * gauss(rng);
       }
-      writeAudio();
-      return true;
+      double sample = excitation;
+      for (unsigned f=0; f<3; ++f)
+      {
+        const float fq = from[f] + (to[f] - from[f]) * t;
+        const double r = exp(-M_PI * BANDWIDTHS[f] / rate);
+        const double a1 = 2.0 * r * cos(2.0 * M_PI * fq / rate);
+        const double a2 = -r * r;
+        const double y = (1.0 - r) * sample + a1 * y1[f] + a2 * y2[f];
+        y2[f] = y1[f];
+        y1[f] = y;
+        sample = y;
+      }
+      const float env = sinf(M_PI * t);
+      vec.samples.push_back(env * sample);
     }
+    vec.samples.insert(vec.samples.end(), gap_len, 0.0f);
+    f0_base = max(80.0f, min(250.0f, f0_base * (0.9f + 0.2f * uni(rng))));
+  }
+  vec.samples.resize(total);
 
-    virtual void resumeOutput(void)
+    // Normalize to -16dBFS in the voiced parts, the nominal DTMF tone level
+  double power = 0.0;
+  for (size_t i=0; i<vec.samples.size(); ++i)
+  {
+    power += static_cast<double>(vec.samples[i]) * vec.samples[i];
+  }
+  power /= vec.samples.size();
+  const double gain = powf(10.0f, -16.0f / 20.0f) / sqrt(2.0 * power);
+  for (size_t i=0; i<vec.samples.size(); ++i)
+  {
+    vec.samples[i] *= gain;
+  }
+  addNoise(vec.samples, -56.0f, rng);
+  return vec;
+}
+
+
+bool fileVector(const string& path, Vector& vec)
+{
+  ifstream ifs(path.c_str(), ios::in | ios::binary);
+  if (ifs.fail())
+  {
+    cerr << "*** ERROR: Could not open talk-off file: " << path << endl;
+    return false;
+  }
+  vec.name = "talk-off " + path;
+  vec.detect = false;
+  vec.slot_len = 0;
+  vec.lead_in = 0;
+  int16_t buf[256];
+  while (ifs.read(reinterpret_cast<char*>(buf), sizeof(buf)) ||
+         (ifs.gcount() > 0))
+  {
+    const size_t cnt = ifs.gcount() / sizeof(*buf);
+    for (size_t i=0; i<cnt; ++i)
     {
-      writeAudio();
+      vec.samples.push_back(static_cast<float>(buf[i]) / 32767.0f);
     }
-    
+  }
+  return true;
+}
+
+
+  /*
+   * Pass a vector through the receiver audio path so that it is ready to be
+   * fed to a decoder running at the given sample rate
+   */
+void prepare(Vector& vec, unsigned rate)
+{
+  AudioFilter voiceband(VOICEBAND_FILTER);
+  vec.samples = process(&voiceband, vec.samples);
+  if (rate != INTERNAL_SAMPLE_RATE)
+  {
+    AudioDecimator decimator(2, coeff_16_8, coeff_16_8_taps);
+    vec.samples = process(&decimator, vec.samples);
+    vec.slot_len /= 2;
+    vec.lead_in /= 2;
+  }
+}
 
-  protected:
-    virtual void allSamplesFlushed(void)
+
+class DecoderRun : public sigc::trackable
+{
+  public:
+    DecoderRun(DtmfDecoder *dec, unsigned block_size)
+      : m_dec(dec), m_block_size(block_size), m_pos(0), m_cpu_time(0.0),
+        m_audio_samples(0)
     {
+      m_dec->digitActivated.connect(
+          sigc::mem_fun(*this, &DecoderRun::digitActivated));
     }
 
-  private:
-    ifstream ifs;
+    double cpuTime(void) const { return m_cpu_time; }
+    size_t audioSamples(void) const { return m_audio_samples; }
 
-    void writeAudio()
+      /*
+       * Feed a vector to the decoder and return the sample position at
+       * which each digit was activated
+       */
+    void run(const Vector& vec, vector<pair<size_t, char> >& activations)
     {
-      if (!ifs.good())
+      m_activations.clear();
+      m_pos = 0;
+      const float *samples = &vec.samples[0];
+      const size_t size = vec.samples.size();
+      while (m_pos < size)
       {
-        return;
+        const int count = min(static_cast<size_t>(m_block_size),
+                              size - m_pos);
+        const double start = threadCpuTime();
+        m_dec->writeSamples(samples + m_pos, count);
+        m_cpu_time += threadCpuTime() - start;
+        m_pos += count;
       }
-
-      int samp_written = 0;
-      do
+        // Let the decoder see silence so that the last digit is terminated
+      vector<float> silence(m_block_size * 10, 0.0f);
+      for (size_t pos=0; pos<silence.size(); pos+=m_block_size)
       {
-        int16_t buf[256];
-        ifs.read(reinterpret_cast<char*>(buf), sizeof(buf));
-        int samp_cnt = ifs.gcount() / sizeof(*buf);
-        if (samp_cnt == 0)
-        {
-          break;
-        }
-        float samples[samp_cnt];
-        for (int i=0; i<samp_cnt; ++i)
-        {
-          samples[i] = static_cast<float>(buf[i]) / 32767.0f;
-        }
-        samp_written = sinkWriteSamples(samples, samp_cnt);
-        if (samp_written < 0)
-        {
-          cout << "*** ERROR: Could not write samples\n";
-          return;
-        }
-        int left =  samp_cnt - samp_written;
-        if (left > 0)
-        {
-          ifs.seekg(left, istream::cur);
-        }
-      } while ((samp_written > 0) && ifs.good());
+        m_dec->writeSamples(&silence[pos], m_block_size);
+      }
+      m_audio_samples += size;
+      activations.swap(m_activations);
+    }
+
+  private:
+    DtmfDecoder*                  m_dec;
+    unsigned                      m_block_size;
+    size_t                        m_pos;
+    double                        m_cpu_time;
+    size_t                        m_audio_samples;
+    vector<pair<size_t, char> >   m_activations;
+
+    void digitActivated(char digit)
+    {
+      m_activations.push_back(make_pair(m_pos, digit));
     }
 };
 
 
-class PowerPlotter : public Async::AudioPassthrough
+  /*
+   * Assign each activation to the latest digit slot that started before it.
+   * The first activation in a slot is compared to the sent digit and any
+   * further activations are counted as extra.
+   */
+Score score(const Vector& vec, const vector<pair<size_t, char> >& activations)
 {
-  public:
-    PowerPlotter(void) : prev_power(0.0f) { }
-
-    virtual int writeSamples(const float *samples, int count)
+  Score score;
+  score.sent = vec.digits.size();
+  vector<unsigned> hits(vec.digits.size(), 0);
+  for (size_t i=0; i<activations.size(); ++i)
+  {
+    const size_t pos = activations[i].first;
+    if (vec.digits.empty() || (pos <= vec.lead_in))
     {
-      double power = 0.0;
-      for (int i=0; i<count; ++i)
-      {
-        power += static_cast<double>(samples[i]) * samples[i];
-      }
-      power /= count;
-      power = ALPHA * power + (1-ALPHA) * prev_power;
-      prev_power = power;
-      cout << "pwr=" << power << endl;
-      return sinkWriteSamples(samples, count);
+      score.extra += 1;
+      continue;
+    }
+    const size_t slot = min((pos - vec.lead_in - 1) / vec.slot_len,
+                            vec.digits.size() - 1);
+    if (hits[slot]++ > 0)
+    {
+      score.extra += 1;
     }
+    else if (activations[i].second == vec.digits[slot])
+    {
+      score.detected += 1;
+    }
+    else
+    {
+      score.wrong += 1;
+    }
+  }
+  return score;
+}
 
-  private:
-    static CONSTEXPR float ALPHA = 0.05;
-    float prev_power;
 
-}; /* class PowerPlotter */
+void usage(const char *prog)
+{
+  cerr << "Usage: " << prog << " [--decoder <type>]... [--rate <Hz>] "
+          "[--digits <n>]\n"
+          "       [--talkoff <file>]... [--talkoff-time <s>] [--debug]\n";
+}
 
+}; /* anonymous namespace */
 
-int main()
-{
-  Config cfg;
-  cfg.setValue("Test", "DTMF_DEC_TYPE", "INTERNAL");
-  //cfg.setValue("Test", "DTMF_DEC_TYPE", "DH1DM");
-  //cfg.setValue("Test", "DTMF_MAX_FWD_TWIST", "6");
-  //cfg.setValue("Test", "DTMF_MAX_REV_TWIST", "6");
-  //cfg.setValue("Test", "DTMF_HANGTIME", "100");
-  cfg.setValue("Test", "DTMF_DEBUG", "1");
-
-  AudioSource *prev_src = 0;
-#define SIMULATE
-#ifdef SIMULATE
-  DtmfEncoder enc;
-  enc.setDigitDuration(40);
-  enc.setDigitSpacing(40);
-  enc.setDigitPower(-10);
-  prev_src = &enc;
-
-  //float noise_pwr = 0;
-  //float noise_pwr = -10;
-  //float noise_pwr = -13;
-  //float noise_pwr = -16;
-  float noise_pwr = -22;
-  //float noise_pwr = -100;
-  noise_pwr += 10.0f * log10f(0.5f / 0.30f); // 300-5000Hz filter
-  //noise_pwr += 10.0f * log10f(0.5f / 0.18f); // 480-3400Hz filter
-  AudioNoiseAdder *noise_adder = new AudioNoiseAdder(noise_pwr);
-  prev_src->registerSink(noise_adder, true);
-  prev_src = noise_adder;
-
-  AudioFilter *voiceband_filter = new AudioFilter("BpCh10/-0.1/300-5000");
-  //AudioFilter *voiceband_filter = new AudioFilter("BpCh10/-0.1/480-3400");
-  prev_src->registerSink(voiceband_filter, true);
-  prev_src = voiceband_filter;
 
-  /*
-  PowerPlotter pp;
-  prev_src->registerSink(&pp);
-  prev_src = &pp;
-  */
-#else
-  FileReader rdr;
-  prev_src = &rdr;
-#endif
-
-  fwriter = new FileWriter("/tmp/samples.raw");
-  prev_src->registerSink(fwriter, true);
-  prev_src = fwriter;
-
-  DtmfDecoder *dec = DtmfDecoder::create(0, cfg, "Test");
-  if (!dec->initialize())
+int main(int argc, char **argv)
+{
+  vector<string> decoders;
+  vector<string> talkoff_files;
+  unsigned samp_rate = INTERNAL_SAMPLE_RATE;
+  unsigned digit_cnt = 160;
+  float talkoff_time = 60.0f;
+  bool debug = false;
+  for (int i=1; i<argc; ++i)
   {
-    cout << "*** ERROR: Could not initialize DTMF decoder\n";
-    exit(1);
+    const string arg(argv[i]);
+    const bool has_value = (i + 1 < argc);
+    if ((arg == "--decoder") && has_value)
+    {
+      decoders.push_back(argv[++i]);
+    }
+    else if ((arg == "--rate") && has_value)
+    {
+      samp_rate = atoi(argv[++i]);
+    }
+    else if ((arg == "--digits") && has_value)
+    {
+      digit_cnt = atoi(argv[++i]);
+    }
+    else if ((arg == "--talkoff") && has_value)
+    {
+      talkoff_files.push_back(argv[++i]);
+    }
+    else if ((arg == "--talkoff-time") && has_value)
+    {
+      talkoff_time = atof(argv[++i]);
+    }
+    else if (arg == "--debug")
+    {
+      debug = true;
+    }
+    else
+    {
+      usage(argv[0]);
+      exit(1);
+    }
   }
-  dec->digitDeactivated.connect(sigc::ptr_fun(digit_detected));
-  prev_src->registerSink(dec, true);
-  prev_src = 0;
-
-#ifdef SIMULATE
-  int tone_amp = enc.digitPower();
-  enc.setDigitPower(-100);
-  enc.send("0");
-  enc.setDigitPower(tone_amp);
-  string digits;
-  for (int i=0; i<50; ++i)
+  if ((samp_rate != INTERNAL_SAMPLE_RATE) &&
+      (samp_rate * 2 != INTERNAL_SAMPLE_RATE))
   {
-    digits += send_digits;
+    cerr << "*** ERROR: Unsupported sample rate " << samp_rate << endl;
+    exit(1);
   }
-  enc.send(digits);
-  enc.setDigitPower(-100);
-  enc.send("0");
-#else
-  if (!rdr.open("/tmp/output.raw"))
-  //if (!rdr.open("/tmp/selected.raw"))
-  //if (!rdr.open("/tmp/false11.raw"))
+  if (digit_cnt == 0)
   {
+    cerr << "*** ERROR: The number of digits must be at least one\n";
     exit(1);
   }
-#endif
-  if (!received_digits.empty())
+  if (decoders.empty())
   {
-    cout << "Digits detected(" << received_digits.size() << "): "
-         << received_digits << endl;
+    decoders.push_back("INTERNAL");
+    decoders.push_back("DH1DM");
   }
-#ifdef SIMULATE
-  if (received_digits != digits)
+
+  mt19937 rng(0x44544d46);
+  vector<Vector> vectors;
+  for (size_t i=0; i<CONDITION_CNT; ++i)
   {
-    cout << "received(" << received_digits.size() << ") != sent("
-         << digits.size() << ") => "
-         << (100.0 * received_digits.size() / digits.size()) << "%\n";
-    return 1;
+    vectors.push_back(dtmfVector(CONDITIONS[i], digit_cnt, rng));
   }
-#else
-  if (!received_digits.empty())
+  if (talkoff_time > 0.0f)
   {
-    return 1;
+    vectors.push_back(speechVector(talkoff_time, rng));
+  }
+  for (size_t i=0; i<talkoff_files.size(); ++i)
+  {
+    Vector vec;
+    if (!fileVector(talkoff_files[i], vec))
+    {
+      exit(1);
+    }
+    vectors.push_back(vec);
+  }
+  for (size_t i=0; i<vectors.size(); ++i)
+  {
+    prepare(vectors[i], samp_rate);
   }
-#endif
-  return 0;
-}
 
+  cout << fixed;
+  int ret = 0;
+  for (size_t d=0; d<decoders.size(); ++d)
+  {
+    const string& type = decoders[d];
+    Config cfg;
+    cfg.setValue("Test", "DTMF_DEC_TYPE", type);
+    if (debug)
+    {
+      cfg.setValue("Test", "DTMF_DEBUG", "1");
+    }
+    DtmfDecoder *dec = DtmfDecoder::create(0, cfg, "Test");
+    if (dec == 0)
+    {
+      ret = 1;
+      continue;
+    }
+    if (!dec->setSampleRate(samp_rate))
+    {
+      cout << type << ": Sample rate " << samp_rate
+           << "Hz not supported\n\n";
+      delete dec;
+      continue;
+    }
+    if (!dec->initialize())
+    {
+      cerr << "*** ERROR: Could not initialize the " << type
+           << " DTMF decoder\n";
+      delete dec;
+      ret = 1;
+      continue;
+    }
+
+    cout << type << " @ " << samp_rate << "Hz\n";
+    cout << left << setw(28) << "Condition" << right
+         << setw(8) << "Expect" << setw(7) << "Sent" << setw(9) << "Detect"
+         << setw(7) << "Wrong" << setw(7) << "Extra" << setw(9) << "Rate"
+         << setw(8) << "Result" << endl;
+
+    DecoderRun run(dec, samp_rate / 50);
+    unsigned failed = 0;
+    float talkoff_s = 0.0f;
+    unsigned talkoff_hits = 0;
+    for (size_t v=0; v<vectors.size(); ++v)
+    {
+      const Vector& vec = vectors[v];
+      vector<pair<size_t, char> > activations;
+      run.run(vec, activations);
+      const Score s = score(vec, activations);
+      if (vec.digits.empty())
+      {
+        const float duration = static_cast<float>(vec.samples.size()) /
+                               samp_rate;
+        talkoff_s += duration;
+        talkoff_hits += s.extra;
+        cout << left << setw(28) << vec.name << right << setw(8) << "reject"
+             << setw(7) << "-" << setw(9) << "-" << setw(7) << "-"
+             << setw(7) << s.extra << setw(8) << setprecision(1)
+             << (60.0f * s.extra / duration) << "/m"
+             << setw(7) << (s.extra == 0 ? "PASS" : "FAIL") << endl;
+        failed += (s.extra == 0) ? 0 : 1;
+        continue;
+      }
+      const unsigned accepted = s.detected + s.wrong;
+      const float rate = 100.0f * (vec.detect ? s.detected : accepted) /
+                         s.sent;
+      const float false_rate = 100.0f *
+          (vec.detect ? s.wrong + s.extra : accepted + s.extra) / s.sent;
+      const bool pass = vec.detect
+          ? ((rate >= MIN_DETECT_RATE) && (false_rate <= MAX_FALSE_RATE))
+          : (false_rate <= MAX_FALSE_RATE);
+      failed += pass ? 0 : 1;
+      cout << left << setw(28) << vec.name << right
+           << setw(8) << (vec.detect ? "detect" : "reject")
+           << setw(7) << s.sent << setw(9) << s.detected << setw(7) << s.wrong
+           << setw(7) << s.extra << setw(8) << setprecision(1) << rate << "%"
+           << setw(8) << (pass ? "PASS" : "FAIL") << endl;
+    }
+
+    const double audio_s = static_cast<double>(run.audioSamples()) /
+                           samp_rate;
+    cout << "Conditions failed: " << failed << endl;
+    if (talkoff_s > 0.0f)
+    {
+      cout << "Talk-off: " << talkoff_hits << " false detections in "
+           << setprecision(1) << talkoff_s << "s of speech\n";
+    }
+    cout << "CPU per audio-second: " << setprecision(3)
+         << (1000.0 * run.cpuTime() / audio_s) << "ms ("
+         << setprecision(2) << (100.0 * run.cpuTime() / audio_s)
+         << "% of one core)\n\n";
+    delete dec;
+  }
+
+  return ret;
+}
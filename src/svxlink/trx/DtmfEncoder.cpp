@@ -32,8 +32,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-#include <map>
-#include <utility>
+#include <cstring>
 #include <cmath>
 
 
@@ -106,7 +105,41 @@ using namespace std;
  *
  ****************************************************************************/
 
-static map<char, pair<int, int> > tone_map;
+  // The digits laid out as on the keypad, row by row
+static const char DIGIT_ROWS[4][5] = { "123A", "456B", "789C", "*0#D" };
+
+
+
+/****************************************************************************
+ *
+ * Public static functions
+ *
+ ****************************************************************************/
+
+const char DtmfEncoder::DIGITS[] = "0123456789ABCD*#";
+const unsigned DtmfEncoder::ROW_FQ[4] = { 697, 770, 852, 941 };
+const unsigned DtmfEncoder::COL_FQ[4] = { 1209, 1336, 1477, 1633 };
+
+
+bool DtmfEncoder::digitFrequencies(char digit, unsigned& low_fq,
+                                   unsigned& high_fq)
+{
+  if (digit == 0)
+  {
+    return false;
+  }
+  for (unsigned row=0; row<4; ++row)
+  {
+    const char *col = strchr(DIGIT_ROWS[row], digit);
+    if (col != 0)
+    {
+      low_fq = ROW_FQ[row];
+      high_fq = COL_FQ[col - DIGIT_ROWS[row]];
+      return true;
+    }
+  }
+  return false;
+} /* DtmfEncoder::digitFrequencies */
 
 
 /****************************************************************************
@@ -121,26 +154,6 @@ DtmfEncoder::DtmfEncoder(int sampling_rate)
     high_tone(0), pos(0), length(0), is_playing(false),
     is_sending_digits(false)
 {
-  if (tone_map.empty())
-  {
-    tone_map['1'] = make_pair(697, 1209);
-    tone_map['2'] = make_pair(697, 1336);
-    tone_map['3'] = make_pair(697, 1477);
-    tone_map['A'] = make_pair(697, 1633);
-    tone_map['4'] = make_pair(770, 1209);
-    tone_map['5'] = make_pair(770, 1336);
-    tone_map['6'] = make_pair(770, 1477);
-    tone_map['B'] = make_pair(770, 1633);
-    tone_map['7'] = make_pair(852, 1209);
-    tone_map['8'] = make_pair(852, 1336);
-    tone_map['9'] = make_pair(852, 1477);
-    tone_map['C'] = make_pair(852, 1633);
-    tone_map['*'] = make_pair(941, 1209);
-    tone_map['0'] = make_pair(941, 1336);
-    tone_map['#'] = make_pair(941, 1477);
-    tone_map['D'] = make_pair(941, 1633);
-  }
-  
 } /* DtmfEncoder::DtmfEncoder */
 
 
@@ -284,7 +297,7 @@ void DtmfEncoder::playNextDigit(void)
   char digit = send_queue.front().digit;
   length = send_queue.front().duration;
   send_queue.pop_front();
-  if (tone_map.count(digit) == 0)
+  if (!digitFrequencies(digit, low_tone, high_tone))
   {
     playNextDigit();
     return;
@@ -292,13 +305,12 @@ void DtmfEncoder::playNextDigit(void)
   
   //printf("Playing digit %c...\n", digit);
   
-  low_tone = tone_map[digit].first;
-  high_tone = tone_map[digit].second;
   pos = 0;
   if (length <= 0)
   {
     length = tone_length;
   }
+  renderDigit();
   is_playing = true;
   
   writeAudio();
@@ -316,15 +328,7 @@ void DtmfEncoder::writeAudio(void)
     unsigned count = min(BLOCK_SIZE, length - pos);
     for (unsigned i=0; i<count; ++i)
     {
-      if (low_tone > 0)
-      {
-      	block[i] = tone_amp * sin(2 * M_PI * low_tone * pos / sampling_rate) +
-      		   tone_amp * sin(2 * M_PI * high_tone * pos / sampling_rate);
-      }
-      else
-      {
-      	block[i] = 0;
-      }
+      block[i] = (low_tone > 0) ? tone_buf[pos] : 0;
       ++pos;
     }
 
@@ -340,6 +344,31 @@ void DtmfEncoder::writeAudio(void)
 } /* DtmfEncoder::writeAudio */
 
 
+void DtmfEncoder::renderDigit(void)
+{
+    // The two tones are generated using recursive oscillators,
+    // y[n] = 2cos(w)y[n-1] - y[n-2], so that no sin() call is needed
+    // per sample.
+  const double wl = 2.0 * M_PI * low_tone / sampling_rate;
+  const double wh = 2.0 * M_PI * high_tone / sampling_rate;
+  const double kl = 2.0 * cos(wl);
+  const double kh = 2.0 * cos(wh);
+  double yl1 = -sin(wl), yl2 = -sin(2.0 * wl);
+  double yh1 = -sin(wh), yh2 = -sin(2.0 * wh);
+  tone_buf.resize(length);
+  for (unsigned i=0; i<length; ++i)
+  {
+    double yl = kl * yl1 - yl2;
+    yl2 = yl1;
+    yl1 = yl;
+    double yh = kh * yh1 - yh2;
+    yh2 = yh1;
+    yh1 = yh;
+    tone_buf[i] = tone_amp * (yl + yh);
+  }
+} /* DtmfEncoder::renderDigit */
+
+
 
 /*
  * This file has not been truncated
@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <deque>
+#include <vector>
 #include <sigc++/sigc++.h>
 
 
@@ -116,6 +117,31 @@ from a sequence of DTMF digits.
 class DtmfEncoder : public Async::AudioSource, sigc::trackable
 {
   public:
+    /**
+     * @brief   All DTMF digits
+     */
+    static const char DIGITS[];
+
+    /**
+     * @brief   The low group (row) tone frequencies in Hz
+     */
+    static const unsigned ROW_FQ[4];
+
+    /**
+     * @brief   The high group (column) tone frequencies in Hz
+     */
+    static const unsigned COL_FQ[4];
+
+    /**
+     * @brief   Look up the tone frequencies for a DTMF digit
+     * @param   digit   The digit (0-9, A-D, *, #)
+     * @param   low_fq  Set to the low group frequency in Hz
+     * @param   high_fq Set to the high group frequency in Hz
+     * @returns Returns \em false if the digit is not a DTMF digit
+     */
+    static bool digitFrequencies(char digit, unsigned& low_fq,
+                                 unsigned& high_fq);
+
     /**
      * @brief 	Default constuctor
      */
@@ -225,6 +251,7 @@ class DtmfEncoder : public Async::AudioSource, sigc::trackable
     unsigned    high_tone;
     unsigned    pos;
     unsigned    length;
+    std::vector<float> tone_buf;
     bool      	is_playing;
     bool      	is_sending_digits;
 
@@ -232,6 +259,7 @@ class DtmfEncoder : public Async::AudioSource, sigc::trackable
     DtmfEncoder& operator=(const DtmfEncoder&);
     void playNextDigit(void);
     void writeAudio(void);
+    void renderDigit(void);
     
 };  /* class DtmfEncoder */
 
@@ -41,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cmath>
 #include <cstring>
 #include <limits>
+#include <set>
 #include <json/json.h>
 
 
@@ -87,6 +88,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "HdlcDeframer.h"
 #include "Tx.h"
 #include "Emphasis.h"
+#include "DetectorGate.h"
 
 
 /****************************************************************************
@@ -110,6 +112,8 @@ using namespace Async;
 #define TONE_1750_MUTING_PRE    75
 #define TONE_1750_MUTING_POST   100
 #define DEFAULT_LIMITER_THRESH  -1.0
+#define DEFAULT_SQL_GATED_LOOKBACK  100
+#define DECIMATED_DET_MAX_FQ    3400
 
 
 /****************************************************************************
@@ -240,7 +244,10 @@ LocalRxBase::LocalRxBase(Config &cfg, const std::string& name)
     tone_dets(0), sql_valve(0), delay(0), sql_tail_elim(0),
     preamp_gain(0), mute_valve(0), sql_hangtime(0), sql_extended_hangtime(0),
     sql_extended_hangtime_thresh(0), input_fifo(0), dtmf_muting_pre(0),
-    ob_afsk_deframer(0), ib_afsk_deframer(0), audio_dev_keep_open(false)
+    ob_afsk_deframer(0), ib_afsk_deframer(0), audio_dev_keep_open(false),
+    fullband_splitter(0), gated_tone_dets(0),
+    sql_gated_lookback(DEFAULT_SQL_GATED_LOOKBACK), sql_gated_audio(false),
+    audio_gate(0), det_samp_rate(INTERNAL_SAMPLE_RATE)
 {
 } /* LocalRxBase::LocalRxBase */
 
@@ -285,6 +292,42 @@ bool LocalRxBase::initialize(void)
   
   bool peak_meter = false;
   cfg().getValue(name(), "PEAK_METER", peak_meter);
+
+    // Detectors that do not need any audio when the squelch is closed
+  std::set<std::string> sql_gated_dets;
+  if (!cfg().getValue(name(), "SQL_GATED_DETECTORS", sql_gated_dets, true))
+  {
+    cerr << "*** ERROR: Illegal format for config variable " << name()
+         << "/SQL_GATED_DETECTORS\n";
+    return false;
+  }
+  for (const auto& det : sql_gated_dets)
+  {
+    if ((det != "DTMF") && (det != "SEL5") && (det != "TONE") &&
+        (det != "AFSK") && (det != "1750"))
+    {
+      cerr << "*** ERROR: Unknown detector \"" << det << "\" specified in "
+           << "config variable " << name() << "/SQL_GATED_DETECTORS. "
+           << "Legal values are: DTMF, SEL5, TONE, AFSK, 1750\n";
+      return false;
+    }
+  }
+  cfg().getValue(name(), "SQL_GATED_LOOKBACK", sql_gated_lookback);
+
+    // Detectors may run on a shared voiceband branch that has been
+    // decimated to 8kHz to save CPU
+  cfg().getValue(name(), "DETECTOR_SAMPLE_RATE", det_samp_rate);
+  if ((det_samp_rate != INTERNAL_SAMPLE_RATE) &&
+      ((INTERNAL_SAMPLE_RATE != 16000) || (det_samp_rate != 8000)))
+  {
+    cerr << "*** ERROR: Illegal value for config variable " << name()
+         << "/DETECTOR_SAMPLE_RATE. Legal values are: " << INTERNAL_SAMPLE_RATE
+#if (INTERNAL_SAMPLE_RATE == 16000)
+         << ", 8000"
+#endif
+         << endl;
+    return false;
+  }
   
     // Get the audio source object
   AudioSource *prev_src = audioSource();
@@ -447,7 +490,25 @@ bool LocalRxBase::initialize(void)
   squelchOpen.connect(
       sigc::hide(sigc::mem_fun(*this, &LocalRxBase::publishSquelchState)));
 
+    // If requested, suspend the rest of the audio path while the squelch is
+    // closed so that only the squelch and signal level detectors run
+  Async::AudioSplitter *content_splitter = fullband_splitter;
+  if (sql_gated_audio)
+  {
+    audio_gate = new DetectorGate(sql_gated_lookback);
+    fullband_splitter->addSink(audio_gate, true);
+    content_splitter = new AudioSplitter;
+    audio_gate->registerSink(content_splitter, true);
+    prev_src = content_splitter;
+  }
+
     // Set up out of band AFSK demodulator if configured
+  Async::AudioSplitter *afsk_splitter = content_splitter;
+  if (sql_gated_dets.count("AFSK") > 0)
+  {
+    afsk_splitter = createGatedSplitter(content_splitter);
+  }
+
   float voice_gain = 0.0f;
   bool ob_afsk_enable = false;
   if (cfg().getValue(name(), "OB_AFSK_ENABLE", ob_afsk_enable) && ob_afsk_enable)
@@ -473,7 +534,7 @@ bool LocalRxBase::initialize(void)
     coeff[46] = 0.39811024;
     AudioFsf *fsf = new AudioFsf(N, coeff);
     //prev_src->registerSink(fsf, true);
-    fullband_splitter->addSink(fsf, true);
+    afsk_splitter->addSink(fsf, true);
     AudioSource *prev_src = fsf;
 
     AfskDemodulator *fsk_demod =
@@ -505,7 +566,7 @@ bool LocalRxBase::initialize(void)
 
     AfskDemodulator *fsk_demod =
       new AfskDemodulator(fc - shift/2, fc + shift/2, baudrate);
-    fullband_splitter->addSink(fsk_demod, true);
+    afsk_splitter->addSink(fsk_demod, true);
     AudioSource *prev_src = fsk_demod;
 
     Synchronizer *sync = new Synchronizer(baudrate);
@@ -523,6 +584,10 @@ bool LocalRxBase::initialize(void)
   tone_dets = new AudioSplitter;
   prev_src->registerSink(tone_dets, true);
   prev_src = tone_dets;
+  if (sql_gated_dets.count("TONE") > 0)
+  {
+    gated_tone_dets = createGatedSplitter(tone_dets);
+  }
 
     // Filter out the voice band, removing high- and subaudible frequencies,
     // for example CTCSS.
@@ -540,12 +605,28 @@ bool LocalRxBase::initialize(void)
   prev_src->registerSink(voiceband_splitter, true);
   prev_src = voiceband_splitter;
 
+    // Create a splitter for voiceband detectors that should be suspended
+    // when the squelch is closed
+  AudioSplitter *gated_voiceband_splitter = 0;
+  if ((sql_gated_dets.count("DTMF") > 0) ||
+      (sql_gated_dets.count("SEL5") > 0) ||
+      (mute_1750 && (sql_gated_dets.count("1750") > 0)))
+  {
+    gated_voiceband_splitter = createGatedSplitter(voiceband_splitter);
+  }
+
     // Create the configured type of DTMF decoder and add it to the splitter
   string dtmf_dec_type("NONE");
   cfg().getValue(name(), "DTMF_DEC_TYPE", dtmf_dec_type);
   if (dtmf_dec_type != "NONE")
   {
     DtmfDecoder *dtmf_dec = DtmfDecoder::create(this, cfg(), name());
+    if ((dtmf_dec != 0) && !dtmf_dec->setSampleRate(det_samp_rate))
+    {
+      cout << "*** WARNING: The " << dtmf_dec_type << " DTMF decoder "
+           << "cannot run at " << det_samp_rate << "Hz in receiver "
+           << name() << ". Using " << INTERNAL_SAMPLE_RATE << "Hz.\n";
+    }
     if ((dtmf_dec == 0) || !dtmf_dec->initialize())
     {
       // FIXME: Cleanup?
@@ -556,7 +637,10 @@ bool LocalRxBase::initialize(void)
         mem_fun(*this, &LocalRxBase::dtmfDigitActivated));
     dtmf_dec->digitDeactivated.connect(
         mem_fun(*this, &LocalRxBase::dtmfDigitDeactivated));
-    voiceband_splitter->addSink(dtmf_dec, true);
+    AudioSplitter *dtmf_splitter = (sql_gated_dets.count("DTMF") > 0)
+        ? gated_voiceband_splitter : voiceband_splitter;
+    detectorSplitter(dtmf_splitter, dtmf_dec->sampleRate())
+      ->addSink(dtmf_dec, true);
 
     bool dtmf_muting = false;
     cfg().getValue(name(), "DTMF_MUTING", dtmf_muting);
@@ -573,6 +657,12 @@ bool LocalRxBase::initialize(void)
   if (sel5_dec_type != "NONE")
   {
     Sel5Decoder *sel5_dec = Sel5Decoder::create(cfg(), name());
+    if ((sel5_dec != 0) && !sel5_dec->setSampleRate(det_samp_rate))
+    {
+      cout << "*** WARNING: The " << sel5_dec_type << " Sel5 decoder "
+           << "cannot run at " << det_samp_rate << "Hz in receiver "
+           << name() << ". Using " << INTERNAL_SAMPLE_RATE << "Hz.\n";
+    }
     if (sel5_dec == 0 || !sel5_dec->initialize())
     {
       cerr << "*** ERROR: Sel5 decoder initialization failed for RX \""
@@ -581,7 +671,10 @@ bool LocalRxBase::initialize(void)
     }
     sel5_dec->sequenceDetected.connect(
         mem_fun(*this, &LocalRxBase::sel5Detected));
-    voiceband_splitter->addSink(sel5_dec, true);
+    AudioSplitter *sel5_splitter = (sql_gated_dets.count("SEL5") > 0)
+        ? gated_voiceband_splitter : voiceband_splitter;
+    detectorSplitter(sel5_splitter, sel5_dec->sampleRate())
+      ->addSink(sel5_dec, true);
   }
 
     // Create an audio valve to use as squelch and connect it to the splitter
@@ -705,11 +798,13 @@ bool LocalRxBase::initialize(void)
   
   if (mute_1750)
   {
-    ToneDetector *calldet = new ToneDetector(1750, 50, 100);
+    ToneDetector *calldet = new ToneDetector(1750, 50, 100, det_samp_rate);
     assert(calldet != 0);
     calldet->setPeakThresh(13);
     calldet->activated.connect(mem_fun(*this, &LocalRxBase::tone1750detected));
-    voiceband_splitter->addSink(calldet, true);
+    AudioSplitter *calldet_splitter = (sql_gated_dets.count("1750") > 0)
+        ? gated_voiceband_splitter : voiceband_splitter;
+    detectorSplitter(calldet_splitter, det_samp_rate)->addSink(calldet, true);
     //cout << "### Enabling 1750Hz muting\n";
   }
 
@@ -754,6 +849,11 @@ void LocalRxBase::setMuteState(MuteState new_mute_state)
           }
           squelch_det->reset();
           siglevdet->reset();
+          setDetectorGatesOpen(false);
+          if (audio_gate != 0)
+          {
+            audio_gate->setOpen(false);
+          }
           setSquelchState(false, "MUTED");
           break;
 
@@ -798,14 +898,25 @@ bool LocalRxBase::addToneDetector(float fq, int bw, float thresh,
 {
   //printf("Adding tone detector with fq=%d  bw=%d  req_dur=%d\n",
   //    	 fq, bw, required_duration);
-  ToneDetector *det = new ToneDetector(fq, 2*bw, required_duration);
+    // Tones close to the upper edge of the decimated branch are detected
+    // at full rate since the decimation filter attenuate them
+  unsigned samp_rate = INTERNAL_SAMPLE_RATE;
+  if (fq + bw < DECIMATED_DET_MAX_FQ)
+  {
+    samp_rate = det_samp_rate;
+  }
+  ToneDetector *det = new ToneDetector(fq, 2*bw, required_duration,
+                                       samp_rate);
   assert(det != 0);
   det->setPeakThresh(thresh);
   det->setDetectOverlapPercent(75);
   det->setDetectToneFrequencyTolerancePercent(50.0f * bw / fq);
   det->detected.connect(sigc::mem_fun(*this, &LocalRxBase::onToneDetected));
   
-  tone_dets->addSink(det, true);
+  AudioSplitter *splitter = detectorSplitter(
+      (gated_tone_dets != 0) ? gated_tone_dets : tone_dets, samp_rate);
+  splitter->addSink(det, true);
+  tone_det_sinks.push_back(std::make_pair(splitter, det));
   
   return true;
 
@@ -831,7 +942,15 @@ char LocalRxBase::sqlRxId(void) const
 void LocalRxBase::reset(void)
 {
   setMuteState(Rx::MUTE_ALL);
-  tone_dets->removeAllSinks();
+
+    // Only remove the tone detectors. Other sinks, like detector gates and
+    // decimators, are part of the receiver setup.
+  for (const auto& sink : tone_det_sinks)
+  {
+    sink.first->removeSink(sink.second);
+  }
+  tone_det_sinks.clear();
+
   if (delay != 0)
   {
     delay->mute(false);
@@ -959,6 +1078,12 @@ void LocalRxBase::onSquelchOpen(bool is_open)
     if (delay != 0)
     {
       delay->clear();
+    }
+      // Start the audio path before opening the squelch valve so that the
+      // look-back audio reach the detectors but not the output
+    if (audio_gate != 0)
+    {
+      audio_gate->setOpen(true);
     }
     setSquelchState(true, squelch_det->activityInfo());
     if (muteState() == MUTE_NONE)
@@ -968,6 +1093,7 @@ void LocalRxBase::onSquelchOpen(bool is_open)
     setSqlHangtimeFromSiglev(siglevdet->lastSiglev());
     siglevdet->setIntegrationTime(1000);
     siglevdet->setContinuousUpdateInterval(1000);
+    setDetectorGatesOpen(true);
   }
   else
   {
@@ -985,6 +1111,11 @@ void LocalRxBase::onSquelchOpen(bool is_open)
     }
     siglevdet->setIntegrationTime(0);
     siglevdet->setContinuousUpdateInterval(0);
+    setDetectorGatesOpen(false);
+    if (audio_gate != 0)
+    {
+      audio_gate->setOpen(false);
+    }
   }
 } /* LocalRxBase::onSquelchOpen */
 
@@ -1034,6 +1165,53 @@ void LocalRxBase::rxReadyStateChanged(void)
 } /* LocalRxBase::rxReadyStateChanged */
 
 
+Async::AudioSplitter *LocalRxBase::createGatedSplitter(
+    Async::AudioSplitter *src)
+{
+  DetectorGate *gate = new DetectorGate(sql_gated_lookback);
+  src->addSink(gate, true);
+  det_gates.push_back(gate);
+  AudioSplitter *splitter = new AudioSplitter;
+  gate->registerSink(splitter, true);
+  return splitter;
+} /* LocalRxBase::createGatedSplitter */
+
+
+void LocalRxBase::setDetectorGatesOpen(bool do_open)
+{
+  for (auto gate : det_gates)
+  {
+    gate->setOpen(do_open);
+  }
+} /* LocalRxBase::setDetectorGatesOpen */
+
+
+Async::AudioSplitter *LocalRxBase::detectorSplitter(
+    Async::AudioSplitter *src, unsigned rate)
+{
+  if (rate == INTERNAL_SAMPLE_RATE)
+  {
+    return src;
+  }
+
+    // The decimated branch is created on first use and then shared by all
+    // detectors connected to the same source splitter
+  auto it = decimated_splitters.find(src);
+  if (it != decimated_splitters.end())
+  {
+    return it->second;
+  }
+  assert(rate * 2 == INTERNAL_SAMPLE_RATE);
+  AudioDecimator *decimator =
+    new AudioDecimator(2, coeff_16_8, coeff_16_8_taps);
+  src->addSink(decimator, true);
+  AudioSplitter *splitter = new AudioSplitter;
+  decimator->registerSink(splitter, true);
+  decimated_splitters[src] = splitter;
+  return splitter;
+} /* LocalRxBase::detectorSplitter */
+
+
 void LocalRxBase::publishSquelchState(void)
 {
   //std::cout << "### LocalRxBase::publishSquelchState: " << std::endl;
@@ -42,6 +42,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/time.h>
 #include <stdint.h>
 #include <vector>
+#include <map>
+#include <utility>
 
 
 /****************************************************************************
@@ -79,6 +81,7 @@ namespace Async
 
 class Squelch;
 class HdlcDeframer;
+class DetectorGate;
 
 
 /****************************************************************************
@@ -156,6 +159,15 @@ class LocalRxBase : public Rx
      */
     virtual void setMuteState(MuteState new_mute_state) override;
 
+    /**
+     * @brief   Suspend the audio path while the squelch is closed
+     * @param   enable Set to \em true to suspend the audio path
+     */
+    virtual void setSquelchGatedAudio(bool enable) override
+    {
+      sql_gated_audio = enable;
+    }
+
     /**
      * @brief 	Call this function to add a tone detector to the RX
      * @param 	fq The tone frequency to detect
@@ -281,6 +293,15 @@ class LocalRxBase : public Rx
     HdlcDeframer *              ib_afsk_deframer;
     bool                        audio_dev_keep_open;
     Async::AudioSplitter *      fullband_splitter;
+    Async::AudioSplitter *      gated_tone_dets;
+    std::vector<DetectorGate*>  det_gates;
+    unsigned                    sql_gated_lookback;
+    bool                        sql_gated_audio;
+    DetectorGate *              audio_gate;
+    unsigned                    det_samp_rate;
+    std::map<Async::AudioSplitter*, Async::AudioSplitter*> decimated_splitters;
+    std::vector<std::pair<Async::AudioSplitter*, Async::AudioSink*> >
+                                tone_det_sinks;
 
     int audioRead(float *samples, int count);
     void dtmfDigitActivated(char digit);
@@ -296,6 +317,10 @@ class LocalRxBase : public Rx
     void setSqlHangtimeFromSiglev(float siglev);
     void rxReadyStateChanged(void);
     void publishSquelchState(void);
+    Async::AudioSplitter *createGatedSplitter(Async::AudioSplitter *src);
+    void setDetectorGatesOpen(bool do_open);
+    Async::AudioSplitter *detectorSplitter(Async::AudioSplitter *src,
+                                           unsigned rate);
     void cfgUpdated(const std::string& section, const std::string& tag);
 
 };  /* class LocalRxBase */
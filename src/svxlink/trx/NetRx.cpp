@@ -78,6 +78,10 @@ using namespace NetTrxMsg;
  *
  ****************************************************************************/
 
+  // The number of timestamps it takes for the link delay estimate to rise
+  // to about 63% of a step increase in delay. Decreases are tracked directly.
+#define LINK_DELAY_RISE_TIME  64
+
 
 
 /****************************************************************************
@@ -136,7 +140,8 @@ NetRx::NetRx(Config &cfg, const string& name)
     log_disconnects_once(false), log_disconnect(true),
     last_signal_strength(0.0), last_sql_rx_id(Rx::ID_UNKNOWN),
     unflushed_samples(false), sql_is_open(false), audio_dec(0), fq(0),
-    modulation(Modulation::MOD_UNKNOWN)
+    modulation(Modulation::MOD_UNKNOWN), next_ts(0), audio_ts(0),
+    link_delay(0.0), link_delay_valid(false)
 {
 } /* NetRx::NetRx */
 
@@ -296,6 +301,20 @@ bool NetRx::addToneDetector(float fq, int bw, float thresh,
 } /* NetRx::addToneDetector */
 
 
+bool NetRx::audioTimestamp(uint64_t& ts) const
+{
+  ts = audio_ts;
+  return (audio_ts != 0);
+} /* NetRx::audioTimestamp */
+
+
+bool NetRx::linkDelay(int& delay_ms) const
+{
+  delay_ms = static_cast<int>(link_delay * 1000 / INTERNAL_SAMPLE_RATE);
+  return link_delay_valid;
+} /* NetRx::linkDelay */
+
+
 void NetRx::reset(void)
 {
   list<ToneDet*>::iterator it;
@@ -422,6 +441,10 @@ void NetRx::connectionReady(bool is_ready)
     }
 
     log_disconnect = !log_disconnects_once;
+
+    next_ts = 0;
+    audio_ts = 0;
+    link_delay_valid = false;
     
     sql_is_open = false;
     if (unflushed_samples)
@@ -469,6 +492,19 @@ void NetRx::handleMsg(Msg *msg)
       break;
     }
     
+    case MsgTimestampsAvailable::TYPE:
+    {
+      sendMsg(new MsgEnableTimestamps);
+      break;
+    }
+
+    case MsgTimestamp::TYPE:
+    {
+      MsgTimestamp *ts_msg = reinterpret_cast<MsgTimestamp*>(msg);
+      next_ts = ts_msg->timestamp();
+      break;
+    }
+    
     case MsgSiglevUpdate::TYPE:
     {
       if (muteState() != Rx::MUTE_ALL)
@@ -476,6 +512,7 @@ void NetRx::handleMsg(Msg *msg)
         MsgSiglevUpdate *sql_msg = reinterpret_cast<MsgSiglevUpdate*>(msg);
         last_signal_strength = sql_msg->signalStrength();
         last_sql_rx_id = sql_msg->sqlRxId();
+        updateLinkDelay(next_ts);
         signalLevelUpdated(last_signal_strength);
         publishSquelchState();
       }
@@ -508,6 +545,8 @@ void NetRx::handleMsg(Msg *msg)
       {
 	MsgAudio *audio_msg = reinterpret_cast<MsgAudio*>(msg);
 	unflushed_samples = true;
+        audio_ts = next_ts;
+        updateLinkDelay(audio_ts);
         audio_dec->writeEncodedSamples(audio_msg->buf(), audio_msg->size());
       }
       break;
@@ -560,6 +599,11 @@ void NetRx::publishSquelchState(void)
   rx["id"] = std::string(&rx_id, &rx_id+1);
   rx["sql_open"] = squelchIsOpen();
   rx["siglev"] = static_cast<int>(siglev);
+  int delay_ms;
+  if (linkDelay(delay_ms))
+  {
+    rx["delay"] = delay_ms;
+  }
   Json::StreamWriterBuilder builder;
   builder["commentStyle"] = "None";
   builder["indentation"] = ""; //The JSON document is written on a single line
@@ -571,6 +615,28 @@ void NetRx::publishSquelchState(void)
 } /* NetRx::publishSquelchState */
 
 
+void NetRx::updateLinkDelay(uint64_t ts)
+{
+  if (ts == 0)
+  {
+    return;
+  }
+
+    // The minimum delay is the transport delay. Delays above it are caused
+    // by jitter so the estimate only rise slowly.
+  double delay = static_cast<double>(static_cast<int64_t>(sampleClock() - ts));
+  if (!link_delay_valid || (delay < link_delay))
+  {
+    link_delay = delay;
+    link_delay_valid = true;
+  }
+  else
+  {
+    link_delay += (delay - link_delay) / LINK_DELAY_RISE_TIME;
+  }
+} /* NetRx::updateLinkDelay */
+
+
 
 /*
  * This file has not been truncated
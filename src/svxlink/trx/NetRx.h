@@ -172,6 +172,20 @@ class NetRx : public Rx
      * @returns Returns the RX ID
      */
     char sqlRxId(void) const { return last_sql_rx_id; }
+
+    /**
+     * @brief   Get the timestamp of the last audio sample from the receiver
+     * @param   ts Set to the sample clock time of the last audio sample
+     * @returns Returns \em true if the remote receiver provide timestamps
+     */
+    virtual bool audioTimestamp(uint64_t& ts) const;
+
+    /**
+     * @brief   Get the estimated delay from the remote receiver
+     * @param   delay_ms Set to the estimated delay in milliseconds
+     * @returns Returns \em true if there is an estimate available
+     */
+    virtual bool linkDelay(int& delay_ms) const;
         
     /**
      * @brief 	Reset the receiver object to its default settings
@@ -215,12 +229,17 @@ class NetRx : public Rx
     unsigned            fq;
     Modulation::Type    modulation;
     std::string         last_sql_activity_info;
+    uint64_t            next_ts;
+    uint64_t            audio_ts;
+    double              link_delay;
+    bool                link_delay_valid;
 
     void connectionReady(bool is_ready);
     void handleMsg(NetTrxMsg::Msg *msg);
     void sendMsg(NetTrxMsg::Msg *msg);
     void allEncodedSamplesFlushed(void);
     void publishSquelchState(void);
+    void updateLinkDelay(uint64_t ts);
 
 };  /* class NetRx */
 
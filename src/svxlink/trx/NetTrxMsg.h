@@ -277,6 +277,20 @@ class MsgAuthOk : public Msg
 };  /* MsgAuthOk */
 
 
+  /*
+   * Sent by a remote receiver that can timestamp its audio and signal level
+   * updates, after MsgAuthOk. Older clients ignore it. A client that want
+   * timestamps answer with MsgEnableTimestamps.
+   */
+class MsgTimestampsAvailable : public Msg
+{
+  public:
+    static const unsigned TYPE = 13;
+    MsgTimestampsAvailable(void) : Msg(TYPE, sizeof(MsgTimestampsAvailable)) {}
+
+};  /* MsgTimestampsAvailable */
+
+
 
 
 
@@ -429,6 +443,26 @@ class MsgAudio : public Msg
 }; /* MsgAudio */
 
 
+  /*
+   * Sent by the remote receiver, when timestamps have been enabled, just
+   * before each MsgAudio and MsgSiglevUpdate message. The timestamp is the
+   * sample clock time (see Rx::sampleClock) of the last sample encoded into
+   * the audio message or of the signal level update.
+   */
+class MsgTimestamp : public Msg
+{
+  public:
+    static const unsigned TYPE = 103;
+    MsgTimestamp(uint64_t timestamp)
+      : Msg(TYPE, sizeof(MsgTimestamp)), m_timestamp(timestamp) {}
+    uint64_t timestamp(void) const { return m_timestamp; }
+
+  private:
+    uint64_t m_timestamp;
+
+}; /* MsgTimestamp */
+
+
 
 /******************************** RX Messages ********************************/
 
@@ -504,6 +538,20 @@ class MsgSetRxModulation : public Msg
 }; /* MsgSetRxModulation */
 
 
+  /*
+   * Ask the remote receiver to send MsgTimestamp messages. Only sent in
+   * answer to MsgTimestampsAvailable so that older remote receivers never
+   * see it.
+   */
+class MsgEnableTimestamps : public Msg
+{
+  public:
+    static const unsigned TYPE = 205;
+    MsgEnableTimestamps(void) : Msg(TYPE, sizeof(MsgEnableTimestamps)) {}
+
+}; /* MsgEnableTimestamps */
+
+
 
 
 class MsgSquelch : public Msg
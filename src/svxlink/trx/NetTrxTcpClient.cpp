@@ -356,10 +356,12 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
     case STATE_VER_WAIT:
       if (msg->type() == MsgProtoVer::TYPE)
       {
+          // A newer minor version is accepted since optional protocol
+          // features, like timestamps, are negotiated after login
         MsgProtoVer *ver_msg = reinterpret_cast<MsgProtoVer *>(msg);
         if ((msg->size() != sizeof(MsgProtoVer)) ||
             (ver_msg->majorVer() != MsgProtoVer::MAJOR) ||
-            (ver_msg->minorVer() != MsgProtoVer::MINOR))
+            (ver_msg->minorVer() < MsgProtoVer::MINOR))
         {
           cerr << "*** ERROR: Incompatible protocol version. Disconnecting from "
                << remoteHost().toString() << ":" << remotePort() << "...\n";
@@ -0,0 +1,195 @@
+/**
+@file	 RtlFile.cpp
+@brief   Replay recorded RTL2832u IQ samples from a file
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "RtlFile.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+RtlFile::RtlFile(const string &filename, bool loop, bool realtime)
+  : filename(filename), loop(loop),
+    replay_timer(realtime ? BLOCK_TIME : 0, Timer::TYPE_PERIODIC, false),
+    buf(0)
+{
+  buf = new char[blockSize()];
+  replay_timer.expired.connect(hide(mem_fun(*this, &RtlFile::replayBlock)));
+
+  file.open(filename.c_str(), ios::in | ios::binary);
+  if (!file.is_open())
+  {
+    cerr << "*** ERROR: Could not open RtlFile \"" << filename << "\": "
+         << strerror(errno) << endl;
+    return;
+  }
+  replay_timer.setEnable(true);
+} /* RtlFile::RtlFile */
+
+
+RtlFile::~RtlFile(void)
+{
+  delete [] buf;
+} /* RtlFile::~RtlFile */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void RtlFile::handleSetSampleRate(uint32_t rate)
+{
+  delete [] buf;
+  buf = new char[blockSize()];
+} /* RtlFile::handleSetSampleRate */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void RtlFile::replayBlock(void)
+{
+  assert(file.is_open());
+
+  file.read(buf, blockSize());
+  size_t cnt = file.gcount();
+  if ((cnt < blockSize()) && loop)
+  {
+    file.clear();
+    file.seekg(0);
+    file.read(buf + cnt, blockSize() - cnt);
+    cnt += file.gcount();
+  }
+
+  int iq_cnt = cnt / 2;
+  if (iq_cnt > 0)
+  {
+    handleIq(reinterpret_cast<complex<uint8_t>*>(buf), iq_cnt);
+  }
+
+  if (cnt < blockSize())
+  {
+    replay_timer.setEnable(false);
+    file.close();
+    readyStateChanged();
+  }
+} /* RtlFile::replayBlock */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,233 @@
+/**
+@file	 RtlFile.h
+@brief   Replay recorded RTL2832u IQ samples from a file
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef RTL_FILE_INCLUDED
+#define RTL_FILE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <fstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "RtlSdr.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Replay recorded RTL2832u IQ samples from a file
+@author agent
+@date   2026-10-18
+
+Use this class to replay IQ samples previously captured from an RTL2832u
+based DVB-T dongle. The file format is the one used by the rtl_sdr utility,
+that is, interleaved unsigned 8 bit I and Q samples without any header. Such a
+file can also be recorded using the capture functionality in the RtlSdr class
+(@see RtlSdr::setCaptureFile). The samples can either be replayed in real time
+or as fast as possible, which is useful for benchmarking the wideband receiver
+chain without any hardware.
+
+All tuner settings are accepted but ignored since the samples are already
+recorded. The sample rate must be set to the rate used when capturing. When
+the end of the file is reached, and looping is not enabled, the tuner will
+change state to not ready.
+*/
+class RtlFile : public RtlSdr
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param   filename  The name of the file to replay
+     * @param   loop      Set to \em true to restart at the end of the file
+     * @param   realtime  Set to \em false to replay as fast as possible
+     */
+    explicit RtlFile(const std::string &filename, bool loop=false,
+                     bool realtime=true);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~RtlFile(void);
+
+    /**
+     * @brief   Find out if the RTL dongle is ready for operation
+     * @returns Returns \em true if the dongle is ready for operation
+     */
+    virtual bool isReady(void) const { return file.is_open(); }
+
+    /**
+     * @brief   Return a string which identifies the specific dongle
+     * @returns Returns a string that uniquely identifies the dongle
+     *
+     * This function returns a string that uniquely identifies the specific
+     * dongle used for this instance of RtlSdr. The string is for example used
+     * when printing out messages associated with the dongle.
+     */
+    virtual const std::string displayName(void) const { return filename; }
+
+  protected:
+    /**
+     * @brief   Set tuner IF gain for the specified stage
+     * @param   stage The number of the gain stage to set
+     * @param   gain The gain in tenths of a dB to set (105=10.5dB)
+     */
+    virtual void handleSetTunerIfGain(uint16_t stage, int16_t gain) {}
+
+    /**
+     * @brief   Set the center frequency of the tuner
+     * @param   fq The new center frequency, in Hz, to set
+     */
+    virtual void handleSetCenterFq(uint32_t fq) {}
+
+    /**
+     * @brief   Set the tuner sample rate
+     * @param   rate The new sample, in Hz, rate to set
+     */
+    virtual void handleSetSampleRate(uint32_t rate);
+
+    /**
+     * @brief   Set the gain mode
+     * @param   mode The gain mode to set: 0=automatic, 1=manual
+     */
+    virtual void handleSetGainMode(uint32_t mode) {}
+
+    /**
+     * @brief   Set manual gain
+     * @param   gain The gain in tenths of a dB to set (105=10.5dB)
+     */
+    virtual void handleSetGain(int32_t gain) {}
+
+    /**
+     * @brief   Set frequency correction factor
+     * @param   corr The frequency correction factor in PPM
+     */
+    virtual void handleSetFqCorr(int corr) {}
+
+    /**
+     * @brief   Enable or disable test mode
+     * @param   enable Set to \em true to enable testing
+     */
+    virtual void handleEnableTestMode(bool enable) {}
+
+    /**
+     * @brief   Enable or disable the digital AGC of the RTL2832
+     * @param   enable Set to \em true to enable the digital AGC
+     */
+    virtual void handleEnableDigitalAgc(bool enable) {}
+
+  private:
+    static const int BLOCK_TIME = 10; // ms, @see RtlSdr::setSampleRate
+
+    std::string         filename;
+    std::ifstream       file;
+    bool                loop;
+    Async::Timer        replay_timer;
+    char                *buf;
+
+    RtlFile(const RtlFile&);
+    RtlFile& operator=(const RtlFile&);
+
+    void replayBlock(void);
+
+};  /* class RtlFile */
+
+
+//} /* namespace */
+
+#endif /* RTL_FILE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
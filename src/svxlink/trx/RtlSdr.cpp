@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iterator>
 #include <algorithm>
 #include <iostream>
+#include <cerrno>
 
 
 /****************************************************************************
@@ -270,6 +271,30 @@ vector<int> RtlSdr::getTunerGains(void) const
 
 
 
+bool RtlSdr::setCaptureFile(const std::string &filename)
+{
+  if (capture_file.is_open())
+  {
+    capture_file.close();
+  }
+  capture_file.clear();
+  if (filename.empty())
+  {
+    return true;
+  }
+
+  capture_file.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!capture_file.is_open())
+  {
+    cerr << "*** ERROR: Could not open IQ capture file \"" << filename
+         << "\": " << strerror(errno) << endl;
+    return false;
+  }
+  return true;
+} /* RtlSdr::setCaptureFile */
+
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -279,6 +304,16 @@ vector<int> RtlSdr::getTunerGains(void) const
 void RtlSdr::handleIq(const complex<uint8_t> *samples, int samp_count)
 {
   //cout << "RtlSdr::handleIq: samp_count=" << samp_count << endl;
+  if (capture_file.is_open())
+  {
+    capture_file.write(reinterpret_cast<const char*>(samples), 2 * samp_count);
+    if (!capture_file.good())
+    {
+      cerr << "*** ERROR: Failed to write to IQ capture file for Rtl tuner "
+           << displayName() << ". Capture stopped.\n";
+      capture_file.close();
+    }
+  }
 
   vector<Sample> iq;
   iq.reserve(samp_count);
@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <complex>
 #include <string>
 #include <vector>
+#include <fstream>
 #include <stdint.h>
 
 
@@ -272,6 +273,19 @@ class RtlSdr : public sigc::trackable
      */
     std::vector<int> getTunerGains(void) const;
 
+    /**
+     * @brief   Capture all received IQ samples to a file
+     * @param   filename The name of the file to write samples to
+     * @returns Returns \em true on success or \em false on failure
+     *
+     * Use this function to write all raw IQ samples received from the dongle
+     * to a file. The file format is the same as for the rtl_sdr utility, that
+     * is interleaved unsigned 8 bit I and Q samples without any header. The
+     * capture can be replayed later using the RtlFile class. Give an empty
+     * filename to stop capturing.
+     */
+    bool setCaptureFile(const std::string &filename);
+
     /**
      * @brief   Find out if the RTL dongle is ready for operation
      * @returns Returns \em true if the dongle is ready for operation
@@ -296,7 +310,7 @@ class RtlSdr : public sigc::trackable
      * dongle. The format is a vector of complex floats (I/Q) with a range from
      * -1 to 1.
      */
-    sigc::signal<void, std::vector<Sample> > iqReceived;
+    sigc::signal<void, const std::vector<Sample>&> iqReceived;
     
     /**
      * @brief   A signal that is emitted when the ready state changes
@@ -416,6 +430,7 @@ class RtlSdr : public sigc::trackable
     bool              use_digital_agc_set;
     bool              use_digital_agc;
     int               dist_print_cnt;
+    std::ofstream     capture_file;
 
     RtlSdr(const RtlSdr&);
     RtlSdr& operator=(const RtlSdr&);
@@ -32,6 +32,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <time.h>
+
 #include <iostream>
 #include <cstdlib>
 
@@ -214,6 +216,16 @@ std::string Rx::muteStateToString(MuteState mute_state)
 } /* Rx::muteStateToString */
 
 
+uint64_t Rx::sampleClock(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return static_cast<uint64_t>(now.tv_sec) * INTERNAL_SAMPLE_RATE +
+         static_cast<uint64_t>(now.tv_nsec) * INTERNAL_SAMPLE_RATE /
+         1000000000ULL;
+} /* Rx::sampleClock */
+
+
 Rx::Rx(Config &cfg, const string& name)
   : m_name(name), m_verbose(true), m_sql_open(false), m_cfg(cfg),
     m_sql_tmo_timer(0), m_mute_state(MUTE_ALL)
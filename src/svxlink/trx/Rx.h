@@ -143,6 +143,16 @@ class Rx : public sigc::trackable, public Async::AudioSource
      */
     static std::string muteStateToString(MuteState mute_state);
 
+    /**
+     * @brief   Read the sample clock
+     * @returns Returns the current time in samples since the Unix epoch
+     *
+     * The sample clock count samples at INTERNAL_SAMPLE_RATE since the Unix
+     * epoch, using the realtime clock of the host. Timestamps from different
+     * hosts can be compared if their clocks are synchronized, e.g. using NTP.
+     */
+    static uint64_t sampleClock(void);
+
     /**
      * @brief 	Default constuctor
      */
@@ -177,6 +187,20 @@ class Rx : public sigc::trackable, public Async::AudioSource
      */
     virtual void setVerbose(bool verbose) { m_verbose = verbose; }
 
+    /**
+     * @brief   Suspend the audio path while the squelch is closed
+     * @param   enable Set to \em true to suspend the audio path
+     *
+     * When enabled, only the squelch and signal level detectors are run
+     * while the squelch is closed. The rest of the audio path, filters and
+     * detectors included, is started when the squelch open and the most
+     * recent audio is then run through it first. This is used by the voter
+     * for the satellite receivers. It must be called before initialize.
+     * Receivers that do not process any audio while the squelch is closed
+     * ignore it.
+     */
+    virtual void setSquelchGatedAudio(bool enable) {}
+
     /**
      * @brief 	Set the mute state for this receiver
      * @param 	new_mute_state The mute state to set for this receiver
@@ -227,6 +251,29 @@ class Rx : public sigc::trackable, public Async::AudioSource
      * @returns Returns the RX ID
      */
     virtual char sqlRxId(void) const { return ID_UNKNOWN; }
+
+    /**
+     * @brief   Get the timestamp of the last audio sample from the receiver
+     * @param   ts Set to the sample clock time of the last audio sample
+     * @returns Returns \em true if the receiver provide timestamps
+     *
+     * The timestamp is the sample clock time (@see sampleClock) when the last
+     * sample written to the audio sink was received by the radio. Receivers
+     * that do not know this return \em false and the caller should use the
+     * arrival time instead.
+     */
+    virtual bool audioTimestamp(uint64_t& ts) const { return false; }
+
+    /**
+     * @brief   Get the estimated delay from the radio to this receiver object
+     * @param   delay_ms Set to the estimated delay in milliseconds
+     * @returns Returns \em true if there is an estimate available
+     *
+     * The delay is only known for remote receivers that provide timestamps.
+     * It is the delay without network jitter, given that the clocks of the
+     * two hosts are synchronized.
+     */
+    virtual bool linkDelay(int& delay_ms) const { return false; }
     
     /**
      * @brief 	Reset the receiver object to its default settings
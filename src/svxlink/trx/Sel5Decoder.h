@@ -161,6 +161,31 @@ class Sel5Decoder : public sigc::trackable, public Async::AudioSink
      */
     virtual bool initialize(void);
 
+    /**
+     * @brief   Set the sample rate of the audio fed to the decoder
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the decoder can handle the given rate
+     *
+     * All decoders can handle audio at the internal sample rate. Some
+     * decoders can also handle audio at a lower sample rate, which save CPU
+     * time. This function must be called before the initialize function.
+     */
+    bool setSampleRate(unsigned rate)
+    {
+      if (!sampleRateSupported(rate))
+      {
+        return false;
+      }
+      m_sample_rate = rate;
+      return true;
+    }
+
+    /**
+     * @brief   Get the sample rate of the audio fed to the decoder
+     * @returns Returns the sample rate in Hz
+     */
+    unsigned sampleRate(void) const { return m_sample_rate; }
+
     /**
      * @brief 	Find out what the configured hangtime is
      * @returns Returns the configured hangtime in milliseconds
@@ -205,14 +230,28 @@ class Sel5Decoder : public sigc::trackable, public Async::AudioSink
      * Sel5Decoder objects are created by calling Sel5Decoder::create.
      */
     Sel5Decoder(Async::Config &cfg, const std::string &name)
-      : m_cfg(cfg), m_name(name) {}
+      : m_cfg(cfg), m_name(name), m_sample_rate(INTERNAL_SAMPLE_RATE) {}
 
     Async::Config &cfg(void) { return m_cfg; }
     const std::string &name(void) const { return m_name; }
 
+    /**
+     * @brief   Check if the decoder can handle the given sample rate
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the sample rate is supported
+     *
+     * Reimplement this function in decoders that can handle other sample
+     * rates than the internal sample rate.
+     */
+    virtual bool sampleRateSupported(unsigned rate) const
+    {
+      return rate == INTERNAL_SAMPLE_RATE;
+    }
+
   private:
     Async::Config&  m_cfg;
     std::string     m_name;
+    unsigned        m_sample_rate;
 
 };  /* class Sel5Decoder */
 
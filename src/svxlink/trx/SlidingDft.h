@@ -0,0 +1,316 @@
+/**
+@file	 SlidingDft.h
+@brief   A sliding DFT that update a few bins for every sample
+@author  agent
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef SLIDING_DFT_INCLUDED
+#define SLIDING_DFT_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A sliding DFT that update a few bins for every sample
+@author agent
+@date   2026-10-18
+
+The sliding DFT calculate the same result as the Goertzel algorithm but for
+the block ending at the latest sample instead of for consecutive blocks. The
+DFT for each bin is updated recursively for each new sample by removing the
+contribution of the sample that fall out of the block and adding the
+contribution of the new one:
+
+  X(n) = e^(jw) * (X(n-1) - x(n-N)) + e^(-jw(N-1)) * x(n)
+
+This cost the same for every sample no matter how often the result is read.
+A Goertzel filter that is run over blocks overlapping by 75% has to process
+every sample four times, so the sliding DFT pay off when a detector need a
+high overlap to get a short detection delay.
+
+The bins may be placed at any frequency, just as with the Goertzel algorithm.
+The result for a bin is the DFT of the last block_len samples with the phase
+referenced to the first sample in the block. An optional Hamming window is
+applied in the frequency domain, which is possible since the window is a sum
+of cosines. Each windowed bin then need two extra bins placed one bin width
+below and above the bin frequency.
+
+The sums are kept in double precision so that the rounding errors of the
+recursion stay far below the resolution of the float result, even after days
+of continuous operation.
+
+Initialize the object with the frequencies of interest, the block length and
+the sample rate. Call "calc" for each sample. When "isFull" return true, the
+result for each bin can be read at any time using "result" or
+"magnitudeSquared".
+*/
+class SlidingDft
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     *
+     * This constructor will create an uninitialized object. Use the
+     * initialize method to initialize it.
+     */
+    SlidingDft(void)
+      : block_len(0), pos(0), cnt(0), energy(0.0), bins_per_fq(1) {}
+
+    /**
+     * @brief 	Destructor
+     */
+    ~SlidingDft(void) {}
+
+    /**
+     * @brief  Initialize the object
+     * @param  fqs          The frequencies of interest, in Hz
+     * @param  len          The block length in samples
+     * @param  sample_rate  The sample rate used
+     * @param  use_window   Set to \em true to apply a Hamming window
+     *
+     * This method will initialize the object. It may be called more than
+     * once if something need to be changed.
+     */
+    void initialize(const std::vector<float>& fqs, size_t len,
+                    unsigned sample_rate, bool use_window)
+    {
+      block_len = len;
+      hist.assign(block_len, 0.0f);
+      bins.clear();
+      const double bin_w = 2.0 * M_PI / block_len;
+      const double side_gain = -(1.0 - HAMMING_A0) / 2.0;
+      for (size_t i=0; i<fqs.size(); ++i)
+      {
+        const double w = 2.0 * M_PI * fqs[i] / sample_rate;
+        if (use_window)
+        {
+          bins.push_back(Bin(w - bin_w, block_len, side_gain));
+          bins.push_back(Bin(w, block_len, HAMMING_A0));
+          bins.push_back(Bin(w + bin_w, block_len, side_gain));
+        }
+        else
+        {
+          bins.push_back(Bin(w, block_len, 1.0));
+        }
+      }
+      bins_per_fq = use_window ? 3 : 1;
+      reset();
+    }
+
+    /**
+     * @brief 	Forget all previous samples
+     */
+    void reset(void)
+    {
+      std::fill(hist.begin(), hist.end(), 0.0f);
+      for (std::vector<Bin>::iterator it=bins.begin(); it!=bins.end(); ++it)
+      {
+        it->re = it->im = 0.0;
+      }
+      pos = 0;
+      cnt = 0;
+      energy = 0.0;
+    }
+
+    /**
+     * @brief 	Call this function for each sample
+     * @param 	sample The sample to process
+     */
+    inline void calc(float sample)
+    {
+      const float old = hist[pos];
+      hist[pos] = sample;
+      if (++pos >= block_len)
+      {
+        pos = 0;
+      }
+      if (cnt < block_len)
+      {
+        ++cnt;
+      }
+      energy += static_cast<double>(sample) * sample -
+                static_cast<double>(old) * old;
+        // The complex multiplications are written out since the operators
+        // for std::complex are slow unless compiling with -ffast-math
+      for (std::vector<Bin>::iterator it=bins.begin(); it!=bins.end(); ++it)
+      {
+        const double re = it->re - old;
+        it->re = it->rot_re * re - it->rot_im * it->im + it->last_re * sample;
+        it->im = it->rot_re * it->im + it->rot_im * re + it->last_im * sample;
+      }
+    }
+
+    /**
+     * @brief  Check if a whole block of samples have been processed
+     * @return Returns \em true if at least block_len samples have been
+     *         processed since the last reset
+     */
+    bool isFull(void) const { return cnt >= block_len; }
+
+    /**
+     * @brief  Get the result for a bin in complex form
+     * @param  idx The index of the frequency given to initialize
+     * @return Returns the DFT of the last block_len samples
+     */
+    std::complex<float> result(size_t idx) const
+    {
+      std::complex<double> res = 0.0;
+      const Bin *bin = &bins[idx * bins_per_fq];
+      for (size_t i=0; i<bins_per_fq; ++i)
+      {
+        res += bin[i].gain * std::complex<double>(bin[i].re, bin[i].im);
+      }
+      return std::complex<float>(res);
+    }
+
+    /**
+     * @brief  Get the magnitude squared for a bin
+     * @param  idx The index of the frequency given to initialize
+     * @return Returns the magnitude squared of the DFT
+     */
+    float magnitudeSquared(size_t idx) const { return std::norm(result(idx)); }
+
+    /**
+     * @brief  Get the energy of the last block_len samples
+     * @return Returns the sum of the squared samples
+     */
+    double blockEnergy(void) const { return energy > 0.0 ? energy : 0.0; }
+
+  private:
+      // The same Hamming window coefficient as used by ToneDetector
+    static constexpr double HAMMING_A0 = 25.0 / 46.0;
+
+    struct Bin
+    {
+      double rot_re;    // e^(jw)
+      double rot_im;
+      double last_re;   // e^(-jw(N-1))
+      double last_im;
+      double re;        // The current DFT result
+      double im;
+      double gain;      // Window coefficient
+
+      Bin(double w, size_t block_len, double gain)
+        : rot_re(cos(w)), rot_im(sin(w)),
+          last_re(cos(w * (block_len - 1))),
+          last_im(-sin(w * (block_len - 1))),
+          re(0.0), im(0.0), gain(gain)
+      {
+      }
+    };
+
+    size_t              block_len;
+    size_t              pos;
+    size_t              cnt;
+    double              energy;
+    size_t              bins_per_fq;
+    std::vector<float>  hist;
+    std::vector<Bin>    bins;
+
+};  /* class SlidingDft */
+
+
+//} /* namespace */
+
+#endif /* SLIDING_DFT_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
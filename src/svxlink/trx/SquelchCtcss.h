@@ -323,6 +323,7 @@ class SquelchCtcss : public Squelch
 
             det->setDetectBw(16.0f);
             det->setDetectOverlapPercent(OVERLAP_PERCENT);
+            det->setDetectUseSlidingDft(true);
             det->setDetectDelay(100);
             det->setDetectToneFrequencyTolerancePercent(TONE_FQ_TOLERANCE);
             det->setDetectUseWindowing(USE_WINDOWING);
@@ -331,6 +332,7 @@ class SquelchCtcss : public Squelch
 
             det->setUndetectBw(8.0f);
             det->setUndetectOverlapPercent(OVERLAP_PERCENT);
+            det->setUndetectUseSlidingDft(true);
             det->setUndetectDelay(100);
             det->setUndetectUseWindowing(USE_WINDOWING);
             det->setUndetectPeakThresh(0.0f);
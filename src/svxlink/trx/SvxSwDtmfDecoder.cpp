@@ -125,7 +125,8 @@ namespace {
 
 SvxSwDtmfDecoder::SvxSwDtmfDecoder(Config &cfg, const string &name)
   : DtmfDecoder(cfg, name), twist_nrm_thresh(0), twist_rev_thresh(0),
-    row(8), col(8), block_size(0), block_pos(0), det_cnt(0), undet_cnt(0),
+    row(8), col(8), block_size(0), step_size(0), block_pos(0), det_cnt(0),
+    undet_cnt(0),
     last_digit_active(0), min_det_cnt(DEFAULT_MIN_DET_CNT),
     min_undet_cnt(DEFAULT_MIN_UNDET_CNT), det_state(STATE_IDLE),
     det_cnt_weight(0), duration(0), undet_thresh(0), debug(false),
@@ -133,43 +134,52 @@ SvxSwDtmfDecoder::SvxSwDtmfDecoder(Config &cfg, const string &name)
 {
   twist_nrm_thresh = powf(10.0f, DEFAULT_MAX_NORMAL_TWIST_DB / 10.0f);
   twist_rev_thresh = powf(10.0f, -(DEFAULT_MAX_REV_TWIST_DB / 10.0f));
+} /* SvxSwDtmfDecoder::SvxSwDtmfDecoder */
+
+
+bool SvxSwDtmfDecoder::initialize(void)
+{
+  if (!DtmfDecoder::initialize())
+  {
+    return false;
+  }
+
+    // The block and step sizes are fixed in time so all detection
+    // parameters stay the same independent of the sample rate
+  block_size = BLOCK_SIZE_MS * sampleRate() / 1000;
+  step_size = STEP_SIZE_MS * sampleRate() / 1000;
+  block.assign(block_size, 0.0f);
+  block_pos = 0;
 
     // Row detectors
   for (size_t i=0; i<4; ++i)
   {
-    row[i].initialize(row_fqs[i]);
-    row[i+4].initialize(3.0f * row_fqs[i]); // Third overtone
+    row[i].initialize(row_fqs[i], sampleRate());
+    row[i+4].initialize(3.0f * row_fqs[i], sampleRate()); // Third overtone
   }
 
     // Column detectors
   for (size_t i=0; i<4; ++i)
   {
-    col[i].initialize(col_fqs[i]);
-    col[i+4].initialize(3.0f * col_fqs[i]); // Third overtone
+    col[i].initialize(col_fqs[i], sampleRate());
+    col[i+4].initialize(3.0f * col_fqs[i], sampleRate()); // Third overtone
   }
 
     // Initialize window function
-  for (size_t n=0; n<BLOCK_SIZE; ++n)
+  win.resize(block_size);
+  win_pwr_comp = 0.0f;
+  for (size_t n=0; n<block_size; ++n)
   {
       // Hamming window
-    win[n] = 0.53836 - 0.46164 * cosf(2.0f * M_PI * n / (BLOCK_SIZE - 1));
+    win[n] = 0.53836 - 0.46164 * cosf(2.0f * M_PI * n / (block_size - 1));
       // Hann window
-    //win[n] = 0.5 - 0.5 * cosf(2.0f * M_PI * n / (BLOCK_SIZE - 1));
+    //win[n] = 0.5 - 0.5 * cosf(2.0f * M_PI * n / (block_size - 1));
       // Rectangular window
     //win[n] = 1.0f;
     win_pwr_comp += win[n] * win[n];
   }
-  win_pwr_comp /= BLOCK_SIZE;
+  win_pwr_comp /= block_size;
   win_pwr_comp = 1.0f / win_pwr_comp;
-} /* SvxSwDtmfDecoder::SvxSwDtmfDecoder */
-
-
-bool SvxSwDtmfDecoder::initialize(void)
-{
-  if (!DtmfDecoder::initialize())
-  {
-    return false;
-  }
   
   float cfg_max_normal_twist = -1.0f;
   if (cfg().getValue(name(), "DTMF_MAX_FWD_TWIST", cfg_max_normal_twist))
@@ -191,12 +201,10 @@ bool SvxSwDtmfDecoder::initialize(void)
 
   if (hangtime() > 0)
   {
-    const size_t block_size_ms = 1000 * BLOCK_SIZE / INTERNAL_SAMPLE_RATE;
-    const size_t step_size_ms = 1000 * STEP_SIZE / INTERNAL_SAMPLE_RATE;
     min_undet_cnt = 1;
-    if (hangtime() > block_size_ms)
+    if (hangtime() > BLOCK_SIZE_MS)
     {
-      min_undet_cnt = 1 + (hangtime() - block_size_ms) / step_size_ms;
+      min_undet_cnt = 1 + (hangtime() - BLOCK_SIZE_MS) / STEP_SIZE_MS;
     }
   }
   
@@ -212,15 +220,15 @@ int SvxSwDtmfDecoder::writeSamples(const float *buf, int len)
   for (int i = 0; i < len; i++)
   {
     block[block_pos] = buf[i];
-    if (++block_pos >= BLOCK_SIZE)
+    if (++block_pos >= block_size)
     {
       processBlock();
-      if (STEP_SIZE < BLOCK_SIZE)
+      if (step_size < block_size)
       {
-        memmove(block, block + STEP_SIZE,
-                (BLOCK_SIZE - STEP_SIZE) * sizeof(*buf));
+        memmove(&block[0], &block[step_size],
+                (block_size - step_size) * sizeof(*buf));
       }
-      block_pos = BLOCK_SIZE - STEP_SIZE;
+      block_pos = block_size - step_size;
     }
   }
 
@@ -256,7 +264,7 @@ void SvxSwDtmfDecoder::processBlock(void)
     // Calculate the total block energy and energy for all individual
     // Goertzel detectors over the block
   double block_energy = 0.0;
-  for (size_t i=0; i<BLOCK_SIZE; ++i)
+  for (size_t i=0; i<block_size; ++i)
   {
     float sample = block[i] * win[i];
     block_energy += static_cast<double>(sample) * sample;
@@ -274,7 +282,7 @@ void SvxSwDtmfDecoder::processBlock(void)
   {
     cout << setprecision(2) << fixed;
     cout << "### pwr=" << setw(6) 
-         << 10.0f * log10f(2 * win_pwr_comp * block_energy / BLOCK_SIZE)
+         << 10.0f * log10f(2 * win_pwr_comp * block_energy / block_size)
          << "dB";
   }
 
@@ -294,7 +302,7 @@ void SvxSwDtmfDecoder::processBlock(void)
   size_t max_col_idx = 0;
   float max_row_ms = 0.0f;
   float max_col_ms = 0.0f;
-  if (block_energy > ENERGY_THRESH)
+  if (block_energy > ENERGY_THRESH * block_size)
   {
     float rel_energy = 0.0f;
     float row_sum = 0.0f;
@@ -318,7 +326,7 @@ void SvxSwDtmfDecoder::processBlock(void)
       col_sum += col_ms;
     }
 
-    rel_energy = 2 * (max_row_ms + max_col_ms) / (BLOCK_SIZE * block_energy);
+    rel_energy = 2 * (max_row_ms + max_col_ms) / (block_size * block_energy);
     //cout << " row=" << max_row_idx << " col=" << max_col_idx;
     const float twist = max_row_ms / max_col_ms;
     const float row_group_rel = max_row_ms / row_sum;
@@ -381,13 +389,17 @@ void SvxSwDtmfDecoder::processBlock(void)
     // the received tone is not a pure sine.
     // Intermodulation between the two selected tones can also be a sign of
     // that this is not a DTMF digit.
+    // An overtone above the Nyquist frequency, e.g. for the high columns at
+    // an 8kHz sample rate, would alias down into the voice band so it is not
+    // checked.
   if (digit_active)
   {
+    const float nyquist_fq = sampleRate() / 2.0f;
     Goertzel im(max_col.m_freq + max_col.m_freq - max_row.m_freq,
-                INTERNAL_SAMPLE_RATE);
+                sampleRate());
     row[max_row_idx+4].reset();
     col[max_col_idx+4].reset();
-    for (size_t i=0; i<BLOCK_SIZE; ++i)
+    for (size_t i=0; i<block_size; ++i)
     {
       float sample = block[i] * win[i];
       im.calc(sample);
@@ -395,8 +407,16 @@ void SvxSwDtmfDecoder::processBlock(void)
       col[max_col_idx+4].calc(sample);
     }
 
-    float row_ot_rel = row[max_row_idx+4].magnitudeSquared() / max_row_ms;
-    float col_ot_rel = col[max_col_idx+4].magnitudeSquared() / max_col_ms;
+    float row_ot_rel = 0.0f;
+    if (row[max_row_idx+4].m_freq < nyquist_fq)
+    {
+      row_ot_rel = row[max_row_idx+4].magnitudeSquared() / max_row_ms;
+    }
+    float col_ot_rel = 0.0f;
+    if (col[max_col_idx+4].m_freq < nyquist_fq)
+    {
+      col_ot_rel = col[max_col_idx+4].magnitudeSquared() / max_col_ms;
+    }
     float im_rel = im.magnitudeSquared() / (max_row_ms + max_col_ms);
     if (debug)
     {
@@ -433,7 +453,7 @@ void SvxSwDtmfDecoder::processBlock(void)
     complex<double> row_sum = 0;
     complex<double> col_sum = 0;
     size_t samp_cnt = 0;
-    for (size_t i=1; i<BLOCK_SIZE; ++i)
+    for (size_t i=1; i<block_size; ++i)
     {
       max_row.calc(block[i]);
       max_col.calc(block[i]);
@@ -453,8 +473,8 @@ void SvxSwDtmfDecoder::processBlock(void)
         prev_col_result = col_result;
       }
     }
-    float row_fq = INTERNAL_SAMPLE_RATE * arg(row_sum) / (8.0 * M_PI);
-    float col_fq = INTERNAL_SAMPLE_RATE * arg(col_sum) / (8.0 * M_PI);
+    float row_fq = sampleRate() * arg(row_sum) / (8.0 * M_PI);
+    float col_fq = sampleRate() * arg(col_sum) / (8.0 * M_PI);
     float row_fqdiff = 2.0 * (row_fq - max_row.m_freq);
     float col_fqdiff = 2.0 * (col_fq - max_col.m_freq);
     if (debug)
@@ -553,8 +573,8 @@ void SvxSwDtmfDecoder::processBlock(void)
       {
         if (++undet_cnt >= undet_thresh)
         {
-          const int first_block_time = 1000 * BLOCK_SIZE / INTERNAL_SAMPLE_RATE;
-          const int block_time = 1000 * STEP_SIZE / INTERNAL_SAMPLE_RATE;
+          const int first_block_time = BLOCK_SIZE_MS;
+          const int block_time = STEP_SIZE_MS;
           const int dur_ms = first_block_time + block_time * (duration - 1);
           if (debug)
           {
@@ -578,9 +598,10 @@ void SvxSwDtmfDecoder::processBlock(void)
 } /* SvxSwDtmfDecoder::processBlock */
 
 
-void SvxSwDtmfDecoder::DtmfGoertzel::initialize(float freq)
+void SvxSwDtmfDecoder::DtmfGoertzel::initialize(float freq,
+                                                unsigned sample_rate)
 {
-  Goertzel::initialize(freq, INTERNAL_SAMPLE_RATE);
+  Goertzel::initialize(freq, sample_rate);
   m_freq = freq;
   //m_max_fqdiff = m_freq * MAX_FQ_ERROR;
 } /* SvxSwDtmfDecoder::DtmfGoertzel::initialize */
@@ -164,13 +164,31 @@ class SvxSwDtmfDecoder : public DtmfDecoder
      */
     virtual int detectionTime(void) const { return 40; }
 
+  protected:
+    /**
+     * @brief   Check if the decoder can handle the given sample rate
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the sample rate is supported
+     *
+     * The decoder work with any sample rate that is a multiple of 100Hz, up
+     * to the internal sample rate. All DTMF tones are below 1700Hz so a
+     * sample rate of 8kHz is enough. The third overtone check is skipped for
+     * tones where the overtone is above the Nyquist frequency, which at 8kHz
+     * are the three highest columns.
+     */
+    virtual bool sampleRateSupported(unsigned rate) const
+    {
+      return (rate >= 8000) && (rate <= INTERNAL_SAMPLE_RATE) &&
+             (rate % 100 == 0);
+    }
+
   private:
     struct DtmfGoertzel : public Goertzel
     {
       float m_freq;
       float m_max_fqdiff;
 
-      void initialize(float freq);
+      void initialize(float freq, unsigned sample_rate);
     };
     typedef enum
     {
@@ -184,9 +202,9 @@ class SvxSwDtmfDecoder : public DtmfDecoder
     static CONSTEXPR size_t DET_CNT_LO_WEIGHT = 1;
     static CONSTEXPR size_t DEFAULT_MIN_DET_CNT = 2*DET_CNT_HI_WEIGHT;
     static CONSTEXPR size_t DEFAULT_MIN_UNDET_CNT = 3;
-    static CONSTEXPR size_t BLOCK_SIZE = 20*INTERNAL_SAMPLE_RATE/1000; // 20ms
-    static CONSTEXPR size_t STEP_SIZE = 10*INTERNAL_SAMPLE_RATE/1000; // 10ms
-    static CONSTEXPR float ENERGY_THRESH = 1e-6*BLOCK_SIZE; // Min pb energy
+    static CONSTEXPR size_t BLOCK_SIZE_MS = 20; // Block length 20ms
+    static CONSTEXPR size_t STEP_SIZE_MS = 10; // Block step 10ms
+    static CONSTEXPR float ENERGY_THRESH = 1e-6; // Min pb energy per sample
     static CONSTEXPR float REL_THRESH_LO = 0.5; // Tone/pb pwr low thresh
     static CONSTEXPR float REL_THRESH_MED = 0.73; // Tone/pb pwr medium thresh
     static CONSTEXPR float REL_THRESH_HI = 0.9; // Tone/pb pwr high thresh
@@ -200,8 +218,9 @@ class SvxSwDtmfDecoder : public DtmfDecoder
     float twist_rev_thresh;
     std::vector<DtmfGoertzel> row;
     std::vector<DtmfGoertzel> col;
-    float block[BLOCK_SIZE];
+    std::vector<float> block;
     size_t block_size;
+    size_t step_size;
     size_t block_pos;
     size_t det_cnt;
     size_t undet_cnt;
@@ -211,7 +230,7 @@ class SvxSwDtmfDecoder : public DtmfDecoder
     DetState det_state;
     size_t det_cnt_weight;
     int duration;
-    float win[BLOCK_SIZE];
+    std::vector<float> win;
     size_t undet_thresh;
     bool debug;
     float win_pwr_comp;
@@ -87,7 +87,7 @@ using namespace Async;
 // between the tone detectors is unavoidable, since they use different
 // block lengths.
 #define SEL5_BANDWIDTH              35     /* 35Hz */
-#define SEL5_BLOCK_LENGTH           (INTERNAL_SAMPLE_RATE / 1000)
+#define SEL5_BLOCK_LENGTH_MS        1
 
 
 /****************************************************************************
@@ -129,7 +129,7 @@ using namespace Async;
  ****************************************************************************/
 
 SwSel5Decoder::SwSel5Decoder(Config &cfg, const string &name)
-  : Sel5Decoder(cfg, name), sel5_table(0), samples_left(SEL5_BLOCK_LENGTH),
+  : Sel5Decoder(cfg, name), sel5_table(0), block_length(0), samples_left(0),
     last_hit(0), last_stable(0), stable_timer(0), active_timer(0), arr_len(0)
 {
 } /* SwSel5Decoder::SwSel5Decoder */
@@ -148,6 +148,9 @@ bool SwSel5Decoder::initialize(void)
     return false;
   }
 
+  block_length = SEL5_BLOCK_LENGTH_MS * sampleRate() / 1000;
+  samples_left = block_length;
+
   float tones[16];
   /*  the tones for each mode
    *                   0        1         2        3        4        5
@@ -398,7 +401,7 @@ void SwSel5Decoder::Sel5Receive(void)
     Sel5PostProcess(hit);
 
     /* Reset the sample counter. */
-    samples_left = SEL5_BLOCK_LENGTH;
+    samples_left = block_length;
 
 } /* SwSel5Decoder::Sel5Receive */
 
@@ -452,11 +455,11 @@ void SwSel5Decoder::Sel5PostProcess(uint8_t hit)
 void SwSel5Decoder::goertzelInit(GoertzelState *s, float freq, float bw, float offset)
 {
     /* Adjust the block length to minimize the DFT error. */
-    s->block_length = lrintf(ceilf(freq / bw) * INTERNAL_SAMPLE_RATE / freq);
+    s->block_length = lrintf(ceilf(freq / bw) * sampleRate() / freq);
     /* Scale output values to achieve same levels at different block lengths. */
     s->scale_factor = 1.0e6f / (s->block_length * s->block_length);
     /* Init detector frequency. */
-    s->fac = 2.0f * cosf(2.0f * M_PI * freq / INTERNAL_SAMPLE_RATE);
+    s->fac = 2.0f * cosf(2.0f * M_PI * freq / sampleRate());
     /* Reset the tone detector state. */
     s->v2 = s->v3 = 0.0f;
     s->samples_left = static_cast<int>(s->block_length * (1.0f - offset));
@@ -137,6 +137,22 @@ class SwSel5Decoder : public Sel5Decoder
      */
     virtual int writeSamples(const float *samples, int count);
 
+  protected:
+    /**
+     * @brief   Check if the decoder can handle the given sample rate
+     * @param   rate The sample rate in Hz
+     * @returns Returns \em true if the sample rate is supported
+     *
+     * The detection interval is one millisecond so the sample rate must be
+     * a multiple of 1000Hz. No selcall tone is above 2800Hz so a sample rate
+     * of 8kHz is enough.
+     */
+    virtual bool sampleRateSupported(unsigned rate) const
+    {
+      return (rate >= 8000) && (rate <= INTERNAL_SAMPLE_RATE) &&
+             (rate % 1000 == 0);
+    }
+
   private:
 
     // Tone detection descriptor
@@ -161,6 +177,8 @@ class SwSel5Decoder : public Sel5Decoder
     /*! Row tone signal level values. */
     float row_energy[16];
 
+    /*! The number of samples in one detection interval. */
+    int block_length;
     /*! Remaining sample count in the current detection interval. */
     int samples_left;
     /*! The result of the last tone analysis. */
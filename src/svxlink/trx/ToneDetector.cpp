@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2022  Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -58,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ToneDetector.h"
 #include "Goertzel.h"
+#include "SlidingDft.h"
 
 
 
@@ -113,6 +114,8 @@ struct ToneDetector::DetectorParams
   float               peak_to_tot_pwr_thresh  = DEFAULT_PEAK_TO_TOT_PWR_THRESH;
   float               snr_thresh              = DEFAULT_SNR_THRESH;
   float               passband_bw             = 0.0f;
+  bool                use_sliding_dft         = DEFAULT_USE_SLIDING_DFT;
+  SlidingDft          sdft;
 }; /* struct ToneDetector::DetectorParams */
 
 
@@ -163,8 +166,9 @@ namespace
  *
  ****************************************************************************/
 
-ToneDetector::ToneDetector(float tone_hz, float width_hz, int det_delay_ms)
-  : tone_fq(tone_hz), buf_pos(0), is_activated(false),
+ToneDetector::ToneDetector(float tone_hz, float width_hz, int det_delay_ms,
+                           unsigned sample_rate)
+  : tone_fq(tone_hz), samp_rate(sample_rate), buf_pos(0), is_activated(false),
     last_active(false), stable_count(0), phase_check_left(-1),
     par(nullptr), last_snr(0.0f), tone_fq_est(0.0f)
 {
@@ -178,12 +182,12 @@ ToneDetector::ToneDetector(float tone_hz, float width_hz, int det_delay_ms)
     // detect since if it is the other way around, the phase/fq relation
     // is not linear.
   det_par->period_block_len =
-	static_cast<int>(ceilf(INTERNAL_SAMPLE_RATE / tone_hz));
+	static_cast<int>(ceilf(samp_rate / tone_hz));
 
     // Calculate the actual frequency for the phase detector. This is used as
     // a reference but it's not the center frequency for the phase detector.
   det_par->phase_actual_fq =
-	static_cast<float>(INTERNAL_SAMPLE_RATE) / det_par->period_block_len;
+	static_cast<float>(samp_rate) / det_par->period_block_len;
 
     // Calculate the phase offset due to the difference between the requested
     // fq and the actual fq.
@@ -269,6 +273,7 @@ void ToneDetector::reset(void)
   par->lower.reset();
   par->upper.reset();
   par->overlap_buf.clear();
+  par->sdft.reset();
   par->prev_res_cmplx = 0;
   phaseCheckReset();
 } /* ToneDetector::reset */
@@ -339,6 +344,7 @@ void ToneDetector::setDetectPeakThresh(float thresh)
   {
     det_par->peak_thresh = 0.0f;
   }
+  setupSlidingDft(det_par);
 } /* ToneDetector::setDetectPeakThresh */
 
 
@@ -352,6 +358,7 @@ void ToneDetector::setUndetectPeakThresh(float thresh)
   {
     undet_par->peak_thresh = 0.0f;
   }
+  setupSlidingDft(undet_par);
 } /* ToneDetector::setUndetectPeakThresh */
 
 
@@ -442,11 +449,38 @@ void ToneDetector::setUndetectUseWindowing(bool enable)
 } /* ToneDetector::setUndetectUseWindowing */
 
 
+void ToneDetector::setDetectUseSlidingDft(bool enable)
+{
+  det_par->use_sliding_dft = enable;
+  setupSlidingDft(det_par);
+} /* ToneDetector::setDetectUseSlidingDft */
+
+
+void ToneDetector::setUndetectUseSlidingDft(bool enable)
+{
+  undet_par->use_sliding_dft = enable;
+  setupSlidingDft(undet_par);
+} /* ToneDetector::setUndetectUseSlidingDft */
+
+
 int ToneDetector::writeSamples(const float *buf, int len)
 {
   const float *end = buf + len;
   while (buf != end)
   {
+      // With a sliding DFT every sample is processed once. A new result is
+      // calculated each time the non-overlapping part of the block has been
+      // received.
+    if (useSlidingDft(par))
+    {
+      par->sdft.calc(*buf++);
+      if (++buf_pos >= par->block_len)
+      {
+        postProcess();
+      }
+      continue;
+    }
+
     float famp;
     if (buf_pos < par->overlap_buf.size())
     {
@@ -550,8 +584,11 @@ void ToneDetector::phaseCheck(void)
 
 void ToneDetector::postProcess(void)
 {
+  const bool sliding_dft = useSlidingDft(par);
+  const double block_energy =
+    sliding_dft ? par->sdft.blockEnergy() : passband_energy;
   bool active = true;
-  float bw = static_cast<float>(INTERNAL_SAMPLE_RATE) / par->block_len;
+  float bw = static_cast<float>(samp_rate) / par->block_len;
   float det_bw = bw;
   float win_comp_energy = 1.0f;
 
@@ -563,7 +600,8 @@ void ToneDetector::postProcess(void)
   }
 
     // Calculate the magnitude for the center bin
-  const std::complex<float> res_cmplx = par->center.result();
+  const std::complex<float> res_cmplx =
+    sliding_dft ? par->sdft.result(0) : par->center.result();
   float res_center = win_comp_energy * Goertzel::magnitudeSquared(res_cmplx);
 
     // Now determine if the tone is active or not. We start by checking
@@ -576,12 +614,16 @@ void ToneDetector::postProcess(void)
   {
       // Check if the center fq is above the lower fq bin by the peak threshold.
       // This is part of the "neighbour bin SNR" check.
-    float res_lower = win_comp_energy * par->lower.magnitudeSquared();
+    float res_lower = win_comp_energy *
+      (sliding_dft ? par->sdft.magnitudeSquared(1)
+                   : par->lower.magnitudeSquared());
     active = active && (res_center > (res_lower * par->peak_thresh));
 
       // Check if the center fq is above the upper fq bin by the peak threshold.
       // This is part of the "neighbour bin SNR" check.
-    float res_upper = win_comp_energy * par->upper.magnitudeSquared();
+    float res_upper = win_comp_energy *
+      (sliding_dft ? par->sdft.magnitudeSquared(2)
+                   : par->upper.magnitudeSquared());
     active = active && (res_center > (res_upper * par->peak_thresh));
   }
 
@@ -598,7 +640,7 @@ void ToneDetector::postProcess(void)
       //    float Ppassband = passband_energy / par->block_len;
       //    float peak_to_tot_pwr = Ptone / Ppassband;
     float peak_to_tot_pwr =
-	2.0f * res_center / (par->block_len * passband_energy);
+	2.0f * res_center / (par->block_len * block_energy);
     active = active && (peak_to_tot_pwr < 1.5f) &&
 	(peak_to_tot_pwr > par->peak_to_tot_pwr_thresh);
   }
@@ -609,7 +651,7 @@ void ToneDetector::postProcess(void)
     float Ptone = 2.0f * res_center / (par->block_len*par->block_len);
     
       // Calculate mean passband power
-    float Ppassband = passband_energy / par->block_len;
+    float Ppassband = block_energy / par->block_len;
     
       // Estimate the mean noise floor over the whole passband
     float Pnoise = (Ppassband - Ptone) / ((par->passband_bw-det_bw) / det_bw);
@@ -669,12 +711,20 @@ void ToneDetector::postProcess(void)
 
   if (par->freq_tol_hz > 0.0f)
   {
+      // The sliding DFT always give the phase at the start of the block so
+      // the expected phase advance is exactly that of the tone over one hop
+    double block_len_radians = par->block_len_radians;
+    if (sliding_dft)
+    {
+      block_len_radians = wrapToPi(2*M_PI * tone_fq *
+          (par->block_len - par->overlap_buf_size) / samp_rate);
+    }
     const double phase_err =
       wrapToPi(std::arg(res_cmplx * std::conj(par->prev_res_cmplx)) -
-          par->block_len_radians);
+          block_len_radians);
     par->prev_res_cmplx = res_cmplx;
     const double freq_err =
-      INTERNAL_SAMPLE_RATE * phase_err /
+      samp_rate * phase_err /
       (2*M_PI * (par->block_len - par->overlap_buf_size));
     tone_fq_est = tone_fq + freq_err;
     active = active && (abs(freq_err) < par->freq_tol_hz);
@@ -714,8 +764,13 @@ void ToneDetector::postProcess(void)
     // Point to the first windowing table entry
   win = par->window_table.begin();
 
-    // Reset sample counter
+    // Reset sample counter. The sliding DFT keep the overlapping samples so
+    // only the non-overlapping part of the next block need to be received.
   buf_pos = 0;
+  if (useSlidingDft(par) && par->sdft.isFull())
+  {
+    buf_pos = par->overlap_buf_size;
+  }
 
   par->center.reset();
   par->lower.reset();
@@ -743,6 +798,7 @@ void ToneDetector::setActivated(bool activated)
     par = det_par;
   }
   par->overlap_buf.clear();
+  par->sdft.reset();
 } /* ToneDetector::setActivated */
 
 
@@ -755,13 +811,13 @@ void ToneDetector::setToneFrequencyTolerancePercent(
     // Calculate the theoretical angle difference in radians between two DFT
     // blocks
   par->block_len_radians =
-    par->block_len * 2*M_PI * toneFq() / INTERNAL_SAMPLE_RATE;
+    par->block_len * 2*M_PI * toneFq() / samp_rate;
   if (par->overlap_buf_size > 0)
   {
     const float olap_ratio =
       static_cast<float>(par->block_len) / par->overlap_buf_size;
     const float bw =
-      static_cast<float>(INTERNAL_SAMPLE_RATE) / par->block_len;
+      static_cast<float>(samp_rate) / par->block_len;
     par->block_len_radians +=
       2*M_PI / olap_ratio * (olap_ratio - fmod(toneFq() / bw, olap_ratio));
   }
@@ -777,7 +833,7 @@ void ToneDetector::setDelay(ToneDetector::DetectorParams* par, int delay_ms)
   if (delay_ms > 0)
   {
     size_t block_cnt = 1;
-    size_t delay_cnt = delay_ms * INTERNAL_SAMPLE_RATE / 1000;
+    size_t delay_cnt = delay_ms * samp_rate / 1000;
     if (delay_cnt > par->block_len)
     {
       block_cnt += 1 + (delay_cnt - par->block_len) /
@@ -805,7 +861,7 @@ int ToneDetector::delay(ToneDetector::DetectorParams* par) const
   size_t samp_cnt = par->block_len;
   samp_cnt += (par->stable_count_thresh - 1) *
               (par->block_len - par->overlap_buf_size);
-  return samp_cnt * 1000 / INTERNAL_SAMPLE_RATE;
+  return samp_cnt * 1000 / samp_rate;
 } /* ToneDetector::delay */
 
 
@@ -837,7 +893,7 @@ void ToneDetector::setBw(ToneDetector::DetectorParams* par, float bw_hz)
   par->bw = bw_hz;
 
     // Adjust block length to minimize the DFT error
-  par->block_len = lrintf(INTERNAL_SAMPLE_RATE *
+  par->block_len = lrintf(samp_rate *
                           ceilf(tone_fq / bw_hz) / tone_fq);
 
   par->window_table.clear();
@@ -853,14 +909,42 @@ void ToneDetector::setBw(ToneDetector::DetectorParams* par, float bw_hz)
     }
   }
 
-  par->center.initialize(tone_fq, INTERNAL_SAMPLE_RATE);
-  par->lower.initialize(tone_fq - 2 * bw_hz, INTERNAL_SAMPLE_RATE);
-  par->upper.initialize(tone_fq + 2 * bw_hz, INTERNAL_SAMPLE_RATE);
+  par->center.initialize(tone_fq, samp_rate);
+  par->lower.initialize(tone_fq - 2 * bw_hz, samp_rate);
+  par->upper.initialize(tone_fq + 2 * bw_hz, samp_rate);
 
   setOverlapPercent(par, par->overlap_percent);
+  setupSlidingDft(par);
 } /* ToneDetector::setBw */
 
 
+void ToneDetector::setupSlidingDft(ToneDetector::DetectorParams* par)
+{
+  if (!par->use_sliding_dft)
+  {
+    par->sdft = SlidingDft();
+    return;
+  }
+
+    // The same bins as calculated by the Goertzel filters, the center bin
+    // first followed by the neighbour bins if they are used
+  std::vector<float> fqs;
+  fqs.push_back(tone_fq);
+  if (par->peak_thresh > 0.0f)
+  {
+    fqs.push_back(tone_fq - 2 * par->bw);
+    fqs.push_back(tone_fq + 2 * par->bw);
+  }
+  par->sdft.initialize(fqs, par->block_len, samp_rate, par->use_windowing);
+} /* ToneDetector::setupSlidingDft */
+
+
+bool ToneDetector::useSlidingDft(const ToneDetector::DetectorParams* par)
+{
+  return par->use_sliding_dft && (par->phase_mean_thresh <= 0.0f);
+} /* ToneDetector::useSlidingDft */
+
+
 /*
  * This file has not been truncated
  */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2022  Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -115,14 +115,19 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
      * @param tone_hz The frequency in Hz of the tone that should be detected
      * @param width_hz The Bandwidth of the detecto in Hz
      * @param det_delay_ms The detection delay in milliseconds
+     * @param sample_rate The sample rate of the audio fed to the detector
      *
      * Constructs a new tone detector with the given frequency and
      * bandwidth. Note that if windowing is enabled (default), the
      * bandwidth will increase quite a bit. The detection delay say how
      * many audio blocks, measured in milliseconds, that have to
      * give the same detection result before the detector change state.
+     * All parameters are given in Hz and milliseconds so they do not
+     * depend on the sample rate. The sample rate must be more than twice
+     * the highest frequency that the detector look at.
      */
-    ToneDetector(float tone_hz, float width_hz, int det_delay_ms = 0);
+    ToneDetector(float tone_hz, float width_hz, int det_delay_ms = 0,
+                 unsigned sample_rate = INTERNAL_SAMPLE_RATE);
 
     /**
      * @brief   Destructor
@@ -135,6 +140,12 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
      */
     float toneFq(void) const { return tone_fq; }
 
+    /**
+     * @brief  Return the sample rate of the audio fed to the detector
+     * @return Returns the sample rate in Hz
+     */
+    unsigned sampleRate(void) const { return samp_rate; }
+
     /**
      * @brief  Return the estimated detection frequency
      * @return Returns the estimated detection frequency in Hz
@@ -478,6 +489,34 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
      * being detected.
      */
     void setUndetectUseWindowing(bool enable);
+
+    /**
+     * @brief  Choose if a sliding DFT should be used when inactive
+     * @param  enable Set to \em true to enable or \em false to disable
+     *
+     * The default is to run the Goertzel algorithm over each block. With
+     * overlap, the samples in the overlapping part of the block are
+     * processed again for each block, so 75% overlap cost four times as much
+     * as no overlap. A sliding DFT update the bins for each sample and the
+     * cost is the same no matter how much overlap is used. The result is
+     * the same as for the Goertzel algorithm but the Hamming window, if
+     * enabled, is the periodic variant.
+     * The phase detector need the Goertzel algorithm so it will be used
+     * instead when the phase detector has been set up.
+     * This function will choose the algorithm to use when the detector is
+     * in its inactive state, that is when a tone is not being detected.
+     */
+    void setDetectUseSlidingDft(bool enable);
+
+    /**
+     * @brief  Choose if a sliding DFT should be used when active
+     * @param  enable Set to \em true to enable or \em false to disable
+     *
+     * See setDetectUseSlidingDft for details.
+     * This function will choose the algorithm to use when the detector is
+     * in its active state, that is when a tone is being detected.
+     */
+    void setUndetectUseSlidingDft(bool enable);
     
     /**
      * @brief  Check if the tone detector is activated or not
@@ -543,6 +582,7 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
     struct DetectorParams;
 
     static CONSTEXPR bool   DEFAULT_USE_WINDOWING           = true;
+    static CONSTEXPR bool   DEFAULT_USE_SLIDING_DFT         = false;
     static CONSTEXPR float  DEFAULT_TONE_ENERGY_THRESH      = 0.1f;
     static CONSTEXPR float  DEFAULT_PEAK_THRESH             = 10.0;
     static CONSTEXPR float  DEFAULT_PHASE_MEAN_THRESH       = 0.0f;
@@ -554,6 +594,7 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
     static CONSTEXPR float  DEFAULT_SNR_THRESH              = 0.0f;
 
     const float         tone_fq;
+    const unsigned      samp_rate;
     size_t              buf_pos;
     bool                is_activated;
     bool                last_active;
@@ -581,6 +622,8 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
     void setOverlapPercent(DetectorParams* par, float overlap_percent);
     void setOverlapLength(ToneDetector::DetectorParams* par, size_t overlap);
     void setBw(DetectorParams* par, float bw_hz);
+    void setupSlidingDft(DetectorParams* par);
+    static bool useSlidingDft(const DetectorParams* par);
 
 };  /* class ToneDetector */
 
@@ -0,0 +1,255 @@
+/**
+@file	 TrxDspBench.cpp
+@brief   Micro-benchmarks for the tone detectors and DTMF decoders
+@author  agent
+@date	 2026-10-18
+
+Usage: TrxDspBench [--filter <substring>] [--json <file>]
+                   [--compare <baseline file>] [--threshold <percent>]
+
+Measure the time per sample and the number of heap allocations per block for
+the Goertzel filter, the tone detector and the software DTMF decoders, at the
+internal sample rate and at 8kHz where supported. This is the receiver side
+companion of AsyncAudioBench and it use the same options and JSON format.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+#include <AsyncBench.h>
+
+#include "Goertzel.h"
+#include "ToneDetector.h"
+#include "DtmfDecoder.h"
+#include "DtmfEncoder.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+    // 20ms blocks, the same block size as used by the audio pipe
+  const unsigned BLOCK_MS = 20;
+
+    /*
+     * Generate 100ms DTMF digits separated by 100ms of silence, with a little
+     * noise added
+     */
+  vector<float> dtmfSignal(unsigned sample_rate)
+  {
+    const unsigned tone_len = sample_rate / 10;
+    vector<float> signal;
+    uint32_t seed = 0x0d7f0001;
+    for (const char *digit=DtmfEncoder::DIGITS; *digit!=0; ++digit)
+    {
+      unsigned row_fq = 0, col_fq = 0;
+      DtmfEncoder::digitFrequencies(*digit, row_fq, col_fq);
+      for (unsigned i=0; i<2*tone_len; ++i)
+      {
+        seed = seed * 1664525 + 1013904223;
+        float sample = 0.001f * static_cast<int32_t>(seed) / 2147483648.0f;
+        if (i < tone_len)
+        {
+          sample += 0.2f * sinf(2.0f * M_PI * row_fq * i / sample_rate) +
+                    0.2f * sinf(2.0f * M_PI * col_fq * i / sample_rate);
+        }
+        signal.push_back(sample);
+      }
+    }
+    return signal;
+  }
+
+  class GoertzelFixture : public Bench::Fixture
+  {
+    public:
+      GoertzelFixture(Bench& bench, unsigned filter_cnt, unsigned sample_rate)
+        : m_block_size(sample_rate * BLOCK_MS / 1000),
+          m_feeder(m_block_size, sample_rate),
+          m_filters(filter_cnt), m_power(0.0f)
+      {
+        for (unsigned i=0; i<filter_cnt; ++i)
+        {
+          unsigned fq = (i < 4) ? DtmfEncoder::ROW_FQ[i]
+                                : DtmfEncoder::COL_FQ[i % 4];
+          m_filters[i].initialize(fq, sample_rate);
+        }
+        ostringstream name;
+        name << "Goertzel/" << filter_cnt << "filters/"
+             << sample_rate / 1000 << "k";
+        bench.add(name.str(), m_block_size, [this]() { processBlock(); });
+      }
+
+    private:
+      unsigned          m_block_size;
+      Bench::Feeder     m_feeder;
+      vector<Goertzel>  m_filters;
+      float             m_power;
+
+      void processBlock(void)
+      {
+        const float *block = m_feeder.nextBlock();
+        for (vector<Goertzel>::iterator it=m_filters.begin();
+             it!=m_filters.end(); ++it)
+        {
+          it->reset();
+          for (unsigned i=0; i<m_block_size; ++i)
+          {
+            it->calc(block[i]);
+          }
+          m_power += it->magnitudeSquared();
+        }
+      }
+  };
+
+    /*
+     * Set up a tone detector like the 1750Hz detector or the CTCSS squelch
+     * (mode 4) but with the given overlap and DFT algorithm
+     */
+  ToneDetector *overlapDetector(bool ctcss, float overlap, bool sliding_dft,
+                                unsigned sample_rate)
+  {
+    ToneDetector *det = 0;
+    if (ctcss)
+    {
+      det = new ToneDetector(136.5, 8.0f, 0, sample_rate);
+      det->setDetectBw(16.0f);
+      det->setDetectToneFrequencyTolerancePercent(0.75f);
+      det->setDetectUseWindowing(false);
+      det->setDetectPeakThresh(0.0f);
+      det->setDetectSnrThresh(15.0f, 250.0f);
+      det->setUndetectBw(8.0f);
+      det->setUndetectUseWindowing(false);
+      det->setUndetectPeakThresh(0.0f);
+      det->setUndetectSnrThresh(12.0f, 250.0f);
+    }
+    else
+    {
+      det = new ToneDetector(1750, 100, 100, sample_rate);
+      det->setPeakThresh(10.0f);
+      det->setDetectToneFrequencyTolerancePercent(50.0f * 50.0f / 1750.0f);
+    }
+    det->setDetectOverlapPercent(overlap);
+    det->setUndetectOverlapPercent(overlap);
+    det->setDetectUseSlidingDft(sliding_dft);
+    det->setUndetectUseSlidingDft(sliding_dft);
+    return det;
+  }
+
+  string rateName(const string& name, unsigned sample_rate)
+  {
+    ostringstream os;
+    os << name << "/" << sample_rate / 1000 << "k";
+    return os.str();
+  }
+
+  Bench::Fixture *sinkFixture(Bench& bench, const string& name,
+                              AudioSink *sink, const vector<float>& signal,
+                              unsigned sample_rate)
+  {
+    return new Bench::SinkFixture(bench, rateName(name, sample_rate), sink,
+                                  signal, sample_rate * BLOCK_MS / 1000);
+  }
+
+};
+
+
+int main(int argc, const char **argv)
+{
+  CppApplication app;
+
+  Bench bench("TrxDspBench");
+  if (!bench.parseArgs(argc, argv))
+  {
+    exit(1);
+  }
+
+  vector<unsigned> rates;
+  rates.push_back(INTERNAL_SAMPLE_RATE);
+  if (INTERNAL_SAMPLE_RATE != 8000)
+  {
+    rates.push_back(8000);
+  }
+
+  Config cfg;
+  vector<unique_ptr<Bench::Fixture> > fixtures;
+  for (vector<unsigned>::const_iterator rit=rates.begin();
+       rit!=rates.end(); ++rit)
+  {
+    const unsigned rate = *rit;
+    fixtures.push_back(unique_ptr<Bench::Fixture>(
+        new GoertzelFixture(bench, 1, rate)));
+    fixtures.push_back(unique_ptr<Bench::Fixture>(
+        new GoertzelFixture(bench, 8, rate)));
+
+      // The same parameters as the 1750Hz detector and the CTCSS squelch
+    vector<float> signal = Bench::testSignal(rate, rate);
+    ToneDetector *det = new ToneDetector(1750, 50, 100, rate);
+    fixtures.push_back(unique_ptr<Bench::Fixture>(sinkFixture(bench,
+        "ToneDetector/1750Hz", det, signal, rate)));
+    det = new ToneDetector(136.5, 8.0f, 0, rate);
+    fixtures.push_back(unique_ptr<Bench::Fixture>(sinkFixture(bench,
+        "ToneDetector/CTCSS136.5Hz", det, signal, rate)));
+    const float overlaps[] = { 75.0f, 90.0f };
+    for (size_t i=0; i<2*sizeof(overlaps)/sizeof(*overlaps); ++i)
+    {
+      const float overlap = overlaps[i / 2];
+      const bool sliding_dft = (i % 2) != 0;
+      ostringstream suffix;
+      suffix << "/" << overlap << "%" << (sliding_dft ? "/sliding" : "");
+      det = overlapDetector(false, overlap, sliding_dft, rate);
+      fixtures.push_back(unique_ptr<Bench::Fixture>(sinkFixture(bench,
+          "ToneDetector/1750Hz" + suffix.str(), det, signal, rate)));
+      det = overlapDetector(true, overlap, sliding_dft, rate);
+      fixtures.push_back(unique_ptr<Bench::Fixture>(sinkFixture(bench,
+          "ToneDetector/CTCSS136.5Hz" + suffix.str(), det, signal, rate)));
+    }
+
+    vector<float> dtmf = dtmfSignal(rate);
+      // The software DTMF decoders. The other types need hardware.
+    const char *dec_types[] = { "INTERNAL", "DH1DM" };
+    for (size_t i=0; i<sizeof(dec_types)/sizeof(*dec_types); ++i)
+    {
+      const string cfg_name = string("Rx") + dec_types[i];
+      cfg.setValue(cfg_name, "DTMF_DEC_TYPE", dec_types[i]);
+      DtmfDecoder *dec = DtmfDecoder::create(0, cfg, cfg_name);
+      if ((dec == 0) || !dec->setSampleRate(rate) || !dec->initialize())
+      {
+        delete dec;
+        continue;
+      }
+      fixtures.push_back(unique_ptr<Bench::Fixture>(sinkFixture(bench,
+          string("DtmfDecoder/") + dec_types[i], dec, dtmf, rate)));
+    }
+  }
+
+  app.runTask(sigc::mem_fun(bench, &Bench::run));
+  app.exec();
+
+  return bench.finish();
+}
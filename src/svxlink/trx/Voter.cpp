@@ -56,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioValve.h>
+#include <AsyncAudioPassthrough.h>
 #include <AsyncPty.h>
 #include <AsyncPtyStreamBuf.h>
 
@@ -67,6 +68,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "Voter.h"
+#include "DetectorGate.h"
 
 
 
@@ -106,18 +108,28 @@ using namespace Async;
  * its "subscribers".
  * When the receiver close its squelch, the squelch signal is delayed until
  * all audio has been flushed.
+ * With selected only buffering, audio is kept in a pre-roll buffer while the
+ * receiver is not selected. The pre-roll audio is moved to the FIFO when the
+ * output is started so only the selected receiver use the FIFO. The
+ * receiver is also told to only run its squelch and signal level detectors
+ * until the squelch open and it becomes a candidate.
  */
 class Voter::SatRx : public AudioSource, public sigc::trackable
 {
   public:
-    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms)
-      : rx_id(id), rx(0), fifo(0), sql_open(false), enabled(true),
-        mute_state(Rx::MUTE_ALL), sql_open_delay(0)
+    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms,
+          bool selected_only_buffering)
+      : rx_id(id), rx(0), preroll(0), fifo(0), sql_open(false), enabled(true),
+        mute_state(Rx::MUTE_ALL), sql_open_delay(0), align_ts(0)
     {
       rx = RxFactory::createNamedRx(cfg, rx_name);
       if (rx != 0)
       {
         mute_state = rx->muteState();
+        if (selected_only_buffering)
+        {
+          rx->setSquelchGatedAudio(true);
+        }
 	rx->dtmfDigitDetected.connect(
 		mem_fun(*this, &SatRx::onDtmfDigitDetected));
 	rx->selcallSequenceDetected.connect(
@@ -130,10 +142,22 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 
         // FIXME: We should take care of publishStateEvent
 
-	AudioSource *prev_src = rx;
+	tap.setRx(rx);
+	rx->registerSink(&tap);
+	AudioSource *prev_src = &tap;
 
 	if (fifo_length_ms > 0)
 	{
+	    // Only keep the most recent audio in a cheap circular buffer while
+	    // the receiver is not selected. The FIFO is only fed while the
+	    // output is started.
+	  if (selected_only_buffering)
+	  {
+	    preroll = new DetectorGate(fifo_length_ms, 0);
+	    prev_src->registerSink(preroll);
+	    prev_src = preroll;
+	  }
+
 	  fifo = new AudioFifo(fifo_length_ms * INTERNAL_SAMPLE_RATE / 1000);
 	  fifo->setOverwrite(true);
 	  prev_src->registerSink(fifo);
@@ -155,6 +179,7 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     ~SatRx(void)
     {
       delete fifo;
+      delete preroll;
       rx->reset();
       delete rx;
     }
@@ -218,12 +243,50 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     }
     
     bool squelchIsOpen(void) const { return sql_open; }
+
+    bool linkDelay(int& delay_ms) const { return rx->linkDelay(delay_ms); }
+
+      // Find out the sample clock time of the next sample that will be
+      // written to the output. Only possible if there is a FIFO.
+    bool nextOutputTimestamp(uint64_t& ts) const
+    {
+      if ((fifo == 0) || (tap.timestamp() == 0))
+      {
+        return false;
+      }
+      ts = tap.timestamp() + 1 - fifo->samplesInFifo(true);
+      return true;
+    }
+
+      // Make the output start at the given sample clock time the next time
+      // the output is started, by throwing away older buffered audio. This
+      // is used to continue at the same point in time as the previously
+      // active receiver so that no audio is repeated when switching.
+    void alignOutputTo(uint64_t ts)
+    {
+      align_ts = ts;
+    }
     
     void stopOutput(bool do_stop)
     {
-      valve.setOpen(!do_stop);
-      if (!do_stop)
+      if (do_stop)
+      {
+        valve.setOpen(false);
+        if (preroll != 0)
+        {
+          preroll->setOpen(false);
+        }
+        align_ts = 0;
+      }
+      else
       {
+        if (preroll != 0)
+        {
+          preroll->setOpen(true);
+        }
+        alignOutput();
+        valve.setOpen(true);
+
       	DtmfBuf::iterator dit;
       	for (dit=dtmf_buf.begin(); dit!=dtmf_buf.end(); ++dit)
 	{
@@ -266,9 +329,33 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
   private:
     typedef list<pair<char, int> >	DtmfBuf;
     typedef list<string>		SelcallBuf;
+
+      // Keep track of the sample clock time of the last audio sample
+      // received from the receiver
+    class InputTap : public AudioPassthrough
+    {
+      public:
+        InputTap(void) : rx(0), ts(0) {}
+        void setRx(const Rx *new_rx) { rx = new_rx; }
+        uint64_t timestamp(void) const { return ts; }
+        virtual int writeSamples(const float *samples, int count)
+        {
+          if (!rx->audioTimestamp(ts))
+          {
+            ts = Rx::sampleClock();
+          }
+          return AudioPassthrough::writeSamples(samples, count);
+        }
+
+      private:
+        const Rx  *rx;
+        uint64_t  ts;
+    };
     
     int		  rx_id;
     Rx		  *rx;
+    InputTap      tap;
+    DetectorGate  *preroll;
     AudioFifo 	  *fifo;
     AudioValve	  valve;
     DtmfBuf   	  dtmf_buf;
@@ -277,6 +364,25 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     bool          enabled;
     Rx::MuteState mute_state;
     unsigned      sql_open_delay;
+    uint64_t      align_ts;
+
+    void alignOutput(void)
+    {
+      uint64_t next_ts;
+      if ((align_ts != 0) && nextOutputTimestamp(next_ts) &&
+          (align_ts > next_ts))
+      {
+          // If all buffered audio is older than the alignment point, the
+          // clocks of the receivers are probably not synchronized so it's
+          // better to not touch the buffer at all.
+        uint64_t skip = align_ts - next_ts;
+        if (skip < fifo->samplesInFifo(true))
+        {
+          fifo->dropSamples(skip);
+        }
+      }
+      align_ts = 0;
+    }
     
     void onDtmfDigitDetected(char digit, int duration)
     {
@@ -343,6 +449,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
         {
           fifo->clear();
         }
+        if (preroll != 0)
+        {
+          preroll->clear();
+        }
         dtmf_buf.clear();
         selcall_buf.clear();
       }
@@ -514,6 +624,9 @@ bool Voter::initialize(void)
   }
   sm->setRxSwitchDelay(rx_switch_delay);
 
+  bool selected_only_buffering = false;
+  cfg.getValue(name(), "SELECTED_ONLY_BUFFERING", selected_only_buffering);
+
   cfg.getValue(name(), "VERBOSE", m_print_sat_squelch);
 
   selector = new AudioSelector;
@@ -540,7 +653,8 @@ bool Voter::initialize(void)
     if (!rx_name.empty())
     {
       cout << "\tAdding receiver: " << rx_name << endl;
-      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length);
+      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length,
+                             selected_only_buffering);
       srx->setSqlOpenDelay(sql_open_delay);
       srx->squelchOpen.connect(mem_fun(*this, &Voter::satSquelchOpen));
       srx->signalLevelUpdated.connect(
@@ -735,6 +849,11 @@ void Voter::publishSquelchState(void)
     rx["sql_open"] = sql_is_open;
     rx["active"] = is_active;
     rx["siglev"] = static_cast<int>(siglev);
+    int delay_ms;
+    if (srx->linkDelay(delay_ms))
+    {
+      rx["delay"] = delay_ms;
+    }
     event.append(rx);
   }
   Json::StreamWriterBuilder builder;
@@ -1141,8 +1260,16 @@ float Voter::SquelchOpen::signalStrength(void)
 
 void Voter::SquelchOpen::changeActiveSrx(SatRx *srx)
 {
+    // Remember where the output of the previously active receiver is so
+    // that the new receiver can continue at the same point in time
+  uint64_t ts;
+  bool align = activeSrx()->nextOutputTimestamp(ts);
   runTask(bind(mem_fun(activeSrx(), &SatRx::stopOutput), true));
   SUPER::changeActiveSrx(srx);
+  if (align)
+  {
+    activeSrx()->alignOutputTo(ts);
+  }
   runTask(bind(mem_fun(activeSrx(), &SatRx::stopOutput), false));  
 } /* Voter::SquelchOpen::changeActiveSrx */
 
@@ -57,6 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "WbRxRtlSdr.h"
 #include "RtlTcp.h"
+#include "RtlFile.h"
 #ifdef HAS_RTLSDR_SUPPORT
 #include "RtlUsb.h"
 #endif
@@ -154,6 +155,20 @@ WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
     //cout << "###   PORT        = " << tcp_port << endl;
     rtl = new RtlTcp(remote_host, tcp_port);
   }
+  else if (rtl_type == "RtlFile")
+  {
+    string filename;
+    if (!cfg.getValue(name, "FILE", filename))
+    {
+      cerr << "*** ERROR: Config variable " << name << "/FILE not set\n";
+      exit(1);
+    }
+    bool loop = false;
+    cfg.getValue(name, "LOOP", loop);
+    bool realtime = true;
+    cfg.getValue(name, "REALTIME", realtime);
+    rtl = new RtlFile(filename, loop, realtime);
+  }
 #ifdef HAS_RTLSDR_SUPPORT
   else if (rtl_type == "RtlUsb")
   {
@@ -206,6 +221,12 @@ WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
   bool peak_meter = false;
   cfg.getValue(name, "PEAK_METER", peak_meter);
   rtl->enableDistPrint(peak_meter);
+
+  string capture_file;
+  if (cfg.getValue(name, "CAPTURE_FILE", capture_file))
+  {
+    rtl->setCaptureFile(capture_file);
+  }
 } /* WbRxRtlSdr::WbRxRtlSdr */
 
 